@@ -0,0 +1,127 @@
+#include "class_file/ClassFile.h"
+#include "class_file/Descriptor.h"
+#include "common/Encoding.h"
+#include "vm/AotMethods.h"
+#include "vm/BaselineCompiler.h"
+#include "vm/Method.h"
+
+#include <argparse/argparse.hpp>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Compiles the methods of the given class files with the baseline compiler and links their code into a shared library
+// for `java -XX:AOTLibrary`. The code is written as an assembly file of raw bytes, which the C compiler assembles and
+// links, so no object file writer is needed.
+
+static void writeFunction(std::ostream& out, const std::string& symbol, const std::vector<geevm::types::u1>& code)
+{
+  out << "\t.globl " << symbol << "\n";
+  out << "\t.type " << symbol << ", @function\n";
+  out << "\t.p2align 4\n";
+  out << symbol << ":\n";
+  for (size_t i = 0; i < code.size(); i += 16) {
+    out << "\t.byte ";
+    for (size_t j = i; j < std::min(i + 16, code.size()); ++j) {
+      out << (j != i ? "," : "") << std::format("0x{:02x}", code[j]);
+    }
+    out << "\n";
+  }
+  out << "\t.size " << symbol << ", .-" << symbol << "\n";
+}
+
+static void writeHash(std::ostream& out, const std::string& symbol, uint64_t hash)
+{
+  out << "\t.section .rodata\n";
+  out << "\t.globl " << symbol << "\n";
+  out << "\t.type " << symbol << ", @object\n";
+  out << "\t.p2align 3\n";
+  out << symbol << ":\n";
+  out << std::format("\t.quad 0x{:016x}\n", hash);
+  out << "\t.size " << symbol << ", 8\n";
+  out << "\t.text\n";
+}
+
+int main(int argc, char* argv[])
+{
+  argparse::ArgumentParser program("geevm-aot");
+  program.add_argument("classes").help("class files to compile").nargs(argparse::nargs_pattern::at_least_one);
+  program.add_argument("-o", "--output").help("shared library to write").required();
+  program.add_argument("--cc").help("C compiler used to assemble and link the library").default_value(std::string{"cc"});
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  if (!geevm::BaselineCompiler::isSupported()) {
+    std::cerr << "Error: Ahead-of-time compilation is only supported on x86-64" << std::endl;
+    return 1;
+  }
+
+  auto output = std::filesystem::path(program.get<std::string>("--output"));
+  auto assemblyPath = std::filesystem::path(output).replace_extension(".s");
+  std::ofstream assembly(assemblyPath, std::ios::trunc);
+  if (!assembly) {
+    std::cerr << "Error: Could not open " << assemblyPath.string() << std::endl;
+    return 1;
+  }
+  assembly << "\t.text\n";
+
+  size_t methodCount = 0;
+  size_t compiledCount = 0;
+  for (const auto& path : program.get<std::vector<std::string>>("classes")) {
+    auto classFile = geevm::ClassFile::fromFile(path);
+    if (classFile == nullptr) {
+      std::cerr << "Error: Could not read class file " << path << std::endl;
+      return 1;
+    }
+
+    const geevm::ConstantPool& constantPool = classFile->constantPool();
+    geevm::types::JStringRef className = constantPool.getClassName(classFile->thisClass());
+    for (const geevm::MethodInfo& methodInfo : classFile->methods()) {
+      if (!methodInfo.hasCode()) {
+        continue;
+      }
+
+      geevm::types::JStringRef name = constantPool.getString(methodInfo.nameIndex());
+      geevm::types::JStringRef rawDescriptor = constantPool.getString(methodInfo.descriptorIndex());
+      auto descriptor = geevm::MethodDescriptor::parse(rawDescriptor);
+      if (!descriptor.has_value()) {
+        std::cerr << "Error: Invalid descriptor of method " << geevm::utf16ToUtf8(name) << " in " << path << std::endl;
+        return 1;
+      }
+
+      // Baseline code only depends on the bytecode, so the method does not need a loaded class
+      ++methodCount;
+      geevm::JMethod method(methodInfo, nullptr, geevm::types::JString{name}, geevm::types::JString{rawDescriptor}, *descriptor);
+      auto code = geevm::BaselineCompiler::compileRelocatable(method);
+      if (code.has_value()) {
+        writeFunction(assembly, geevm::aotSymbolName(className, name, rawDescriptor), *code);
+        // The code is only bound to classes loaded from the same class file
+        writeHash(assembly, geevm::aotClassFileHashSymbolName(className, name, rawDescriptor), classFile->contentHash());
+        ++compiledCount;
+      }
+    }
+  }
+
+  assembly << "\t.section .note.GNU-stack,\"\",@progbits\n";
+  assembly.close();
+
+  std::string command = std::format("{} -shared -nostdlib -o \"{}\" \"{}\"", program.get<std::string>("--cc"), output.string(), assemblyPath.string());
+  int status = std::system(command.c_str());
+  std::filesystem::remove(assemblyPath);
+  if (status != 0) {
+    std::cerr << "Error: Linking " << output.string() << " failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Compiled " << compiledCount << " of " << methodCount << " methods into " << output.string() << std::endl;
+  return 0;
+}
@@ -1,5 +1,8 @@
 #include "common/DynamicLibrary.h"
 #include "common/Encoding.h"
+#include "vm/HeapDump.h"
+#include "vm/Interpreter.h"
+#include "vm/Superinstructions.h"
 #include "vm/Thread.h"
 #include "vm/Value.h"
 #include "vm/Vm.h"
@@ -8,7 +11,31 @@
 #include <argparse/argparse.hpp>
 #include <common/System.h>
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <optional>
+#include <string_view>
+
+/// Parses a size in bytes with an optional `k`, `m` or `g` suffix.
+static size_t parseMemorySize(const std::string& value)
+{
+  size_t length = 0;
+  size_t size = std::stoull(value, &length);
+  std::string_view suffix = std::string_view(value).substr(length);
+  if (suffix == "k" || suffix == "K") {
+    return size * 1024;
+  }
+  if (suffix == "m" || suffix == "M") {
+    return size * 1024 * 1024;
+  }
+  if (suffix == "g" || suffix == "G") {
+    return size * 1024 * 1024 * 1024;
+  }
+  if (!suffix.empty()) {
+    throw std::invalid_argument("invalid memory size: " + value);
+  }
+  return size;
+}
 
 int main(int argc, char* argv[])
 {
@@ -17,11 +44,80 @@ int main(int argc, char* argv[])
   program.add_argument("args").remaining().default_value(std::vector<std::string>{});
   // Heap behavior
   program.add_argument("-Xgc-after-every-alloc").hidden().flag();
+  auto& gcGroup = program.add_mutually_exclusive_group();
+  gcGroup.add_argument("-XX:+UseSemiSpaceGC").help("use the copying semi-space garbage collector (default)").flag();
+  gcGroup.add_argument("-XX:+UseEpsilonGC").help("use a no-op garbage collector that never reclaims memory").flag();
+  // Heap diagnostics
+  program.add_argument("-XX:+PrintClassHistogram").help("print the number of instances and bytes per class at exit").flag();
+  program.add_argument("-XX:HeapDumpPath")
+      .help("write an HPROF heap dump to the given file at exit, or on the first OutOfMemoryError with -XX:+HeapDumpOnOutOfMemoryError");
+  program.add_argument("-XX:+HeapDumpOnOutOfMemoryError").help("write an HPROF heap dump when the first OutOfMemoryError is thrown").flag();
+  // Exceptions
+  auto& fastThrowGroup = program.add_mutually_exclusive_group();
+  fastThrowGroup.add_argument("-XX:+OmitStackTraceInFastThrow")
+      .help("throw preallocated exceptions without stack traces from locations that frequently throw implicit exceptions (default)")
+      .flag();
+  fastThrowGroup.add_argument("-XX:-OmitStackTraceInFastThrow").help("always create new implicit exceptions with full stack traces").flag();
+  // Interpreter
+  program.add_argument("-XX:+UseTopOfStackCaching").help("keep the topmost operand stack values in registers in the interpreter").flag();
+  // Each of these selects a different interpreter variant, so they cannot be combined
+  auto& interpreterGroup = program.add_mutually_exclusive_group();
+  interpreterGroup.add_argument("-Xgc-stress-interpreter").hidden().flag();
+  interpreterGroup.add_argument("-XX:+TraceBytecodes").help("log every instruction executed by the interpreter to stderr").flag();
+  interpreterGroup.add_argument("-XX:+CountBytecodes").help("print the number of instructions executed by the interpreter per opcode at exit").flag();
+  // Compilation
+  program.add_argument("-XX:+UseBaselineJIT").help("compile frequently executed methods to x86-64 machine code").flag();
+  program.add_argument("-XX:CompileThreshold")
+      .help("number of invocations and loop iterations after which a method is compiled")
+      .scan<'i', int>()
+      .default_value(static_cast<int>(geevm::VmSettings{}.compileThreshold));
+  program.add_argument("-XX:ReservedCodeCacheSize")
+      .help("size of the memory reserved for compiled code, in bytes with an optional k, m or g suffix")
+      .action(parseMemorySize)
+      .default_value(geevm::VmSettings{}.codeCacheSize);
+  program.add_argument("-XX:+UseOptimizingJIT").help("recompile methods that stay hot with the optimizing SSA compiler").flag();
+  program.add_argument("-XX:Tier2CompileThreshold")
+      .help("number of invocations and loop iterations after which a method is compiled by the optimizing compiler")
+      .scan<'i', int>()
+      .default_value(static_cast<int>(geevm::VmSettings{}.optimizeThreshold));
+  program.add_argument("-XX:AOTLibrary").help("use the methods compiled ahead of time into the given library by geevm-aot");
+  program.add_argument("-XX:ProfileFile").help("restore method profiles from the given file at startup and write them back at exit");
+  program.add_argument("-XX:+PrintBytecodePairs").help("print the most frequent pairs of opcodes in the executed methods at exit").flag();
+  program.add_argument("-XX:+UseLLVMJIT").help("generate the code of the optimizing compiler with LLVM, if built with LLVM").flag();
   // Initialization
   program.add_argument("-Xno-system-init").hidden().flag();
 
+  // Unified logging options (-Xlog:gc[:<output>[:<format>]]) carry their configuration in the option name itself,
+  // so they are handled before handing the arguments over to the parser.
+  // Options followed by a separate value, which must not be mistaken for the main class
+  constexpr std::string_view ValueOptions[] = {"-XX:HeapDumpPath",        "-XX:CompileThreshold", "-XX:ReservedCodeCacheSize",
+                                               "-XX:Tier2CompileThreshold", "-XX:AOTLibrary",       "-XX:ProfileFile"};
+  std::vector<std::string> arguments;
+  std::optional<geevm::GcLogSettings> gcLogSettings;
+  bool seenMainClass = false;
+  for (int i = 0; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (i != 0 && !seenMainClass && std::ranges::contains(ValueOptions, arg) && i + 1 < argc) {
+      arguments.emplace_back(arg);
+      arguments.emplace_back(argv[++i]);
+      continue;
+    }
+    // Everything after the main class belongs to the Java program
+    seenMainClass = seenMainClass || (i != 0 && !arg.starts_with("-"));
+    if (i != 0 && !seenMainClass && arg.starts_with("-Xlog:")) {
+      gcLogSettings = geevm::GcLogSettings::parse(arg.substr(std::string_view("-Xlog:").size()));
+      if (!gcLogSettings.has_value()) {
+        std::cerr << "Invalid -Xlog option: " << arg << std::endl;
+        std::cerr << "Expected -Xlog:gc[:<stdout|stderr|file>[:<text|json>]]" << std::endl;
+        return 1;
+      }
+      continue;
+    }
+    arguments.emplace_back(arg);
+  }
+
   try {
-    program.parse_args(argc, argv);
+    program.parse_args(arguments);
   } catch (const std::exception& e) {
     std::cerr << e.what() << std::endl;
     std::cerr << program;
@@ -37,9 +133,55 @@ int main(int argc, char* argv[])
   if (program["-Xgc-after-every-alloc"] == true) {
     settings.runGcAfterEveryAllocation = true;
   }
+  if (program["-Xgc-stress-interpreter"] == true) {
+    settings.stressGcInInterpreter = true;
+  }
   if (program["-Xno-system-init"] == true) {
     settings.noSystemInit = true;
   }
+  if (program["-XX:+UseEpsilonGC"] == true) {
+    settings.collector = geevm::GarbageCollectorKind::Epsilon;
+  } else if (program["-XX:+UseSemiSpaceGC"] == true) {
+    settings.collector = geevm::GarbageCollectorKind::SemiSpace;
+  }
+  settings.gcLog = gcLogSettings;
+  if (program["-XX:+HeapDumpOnOutOfMemoryError"] == true) {
+    settings.heapDumpOnOutOfMemoryError = true;
+    if (auto heapDumpPath = program.present("-XX:HeapDumpPath"); heapDumpPath.has_value()) {
+      settings.heapDumpPath = *heapDumpPath;
+    }
+  }
+  if (program["-XX:-OmitStackTraceInFastThrow"] == true) {
+    settings.omitStackTraceInFastThrow = false;
+  }
+  if (program["-XX:+UseTopOfStackCaching"] == true) {
+    settings.useStackCaching = true;
+  }
+  if (program["-XX:+TraceBytecodes"] == true) {
+    settings.traceBytecodes = true;
+  }
+  if (program["-XX:+CountBytecodes"] == true) {
+    settings.countBytecodes = true;
+  }
+  if (program["-XX:+UseBaselineJIT"] == true) {
+    settings.useBaselineJit = true;
+  }
+  settings.compileThreshold = static_cast<uint32_t>(std::max(program.get<int>("-XX:CompileThreshold"), 1));
+  // The code cache is mapped in whole pages
+  settings.codeCacheSize = std::max(program.get<size_t>("-XX:ReservedCodeCacheSize"), size_t{4096});
+  if (program["-XX:+UseOptimizingJIT"] == true) {
+    settings.useOptimizingJit = true;
+  }
+  settings.optimizeThreshold = static_cast<uint32_t>(std::max(program.get<int>("-XX:Tier2CompileThreshold"), 1));
+  if (program["-XX:+UseLLVMJIT"] == true) {
+    settings.useLlvmJit = true;
+  }
+  if (auto aotLibrary = program.present("-XX:AOTLibrary"); aotLibrary.has_value()) {
+    settings.aotLibrary = std::filesystem::absolute(*aotLibrary).string();
+  }
+  if (auto profileFile = program.present("-XX:ProfileFile"); profileFile.has_value()) {
+    settings.profileFile = *profileFile;
+  }
 
 #ifndef NDEBUG
   settings.runGcAfterEveryAllocation = true;
@@ -69,6 +211,10 @@ int main(int argc, char* argv[])
 
   vm->initialize();
 
+  if (geevm::ProfileStore* profiles = vm->profiles(); profiles != nullptr) {
+    profiles->preloadClasses(*vm);
+  }
+
   auto mainClass = vm->resolveClass(mainClassName);
 
   if (!mainClass) {
@@ -87,8 +233,12 @@ int main(int argc, char* argv[])
 
   // As the GC may run during string interning, we need to construct the array in two steps
   auto strArrayCls = vm->resolveClass(u"[Ljava/lang/String;");
-  geevm::ScopedGcRootRef<geevm::JavaArray<geevm::Instance*>> argsArray =
-      vm->heap().gc().pin(vm->heap().allocateArray<geevm::Instance*>((*strArrayCls)->asArrayClass(), programArgs.size()));
+  auto* allocatedArgs = vm->heap().allocateArray<geevm::Instance*>((*strArrayCls)->asArrayClass(), programArgs.size());
+  if (allocatedArgs == nullptr) {
+    std::cerr << "Error: Could not allocate the arguments of the main method" << std::endl;
+    return 1;
+  }
+  geevm::ScopedGcRootRef<geevm::JavaArray<geevm::Instance*>> argsArray = vm->heap().gc().pin(allocatedArgs);
 
   for (int32_t i = 0; i < programArgs.size(); i++) {
     auto utf16str = geevm::utf8ToUtf16(programArgs[i]);
@@ -98,5 +248,33 @@ int main(int argc, char* argv[])
 
   vm->mainThread().start(*mainMethod, {geevm::Value::from<geevm::Instance*>(argsArray.get())});
 
+  if (program["-XX:+PrintClassHistogram"] == true) {
+    // Only count objects that are still reachable
+    vm->heap().gc().performGarbageCollection();
+    geevm::printClassHistogram(*vm, std::cout);
+  }
+
+  if (settings.countBytecodes) {
+    geevm::printBytecodeCounts(*vm, std::cout);
+  }
+
+  if (program["-XX:+PrintBytecodePairs"] == true) {
+    geevm::printBytecodePairs(*vm, std::cout, 20);
+  }
+
+  if (auto heapDumpPath = program.present("-XX:HeapDumpPath"); heapDumpPath.has_value() && !settings.heapDumpOnOutOfMemoryError) {
+    std::ofstream heapDump(*heapDumpPath, std::ios::binary | std::ios::trunc);
+    if (!heapDump) {
+      std::cerr << "Error: Could not open heap dump file " << *heapDumpPath << std::endl;
+      return 1;
+    }
+    geevm::writeHeapDump(*vm, heapDump);
+  }
+
+  if (settings.profileFile.has_value() && !geevm::ProfileStore::save(*vm, *settings.profileFile)) {
+    std::cerr << "Error: Could not write profile file " << *settings.profileFile << std::endl;
+    return 1;
+  }
+
   return 0;
 }
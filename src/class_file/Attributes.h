@@ -2,6 +2,9 @@
 #define GEEVM_CLASS_FILE_ATTRIBUTES_H
 
 #include "common/JvmTypes.h"
+
+#include <algorithm>
+#include <optional>
 #include <span>
 #include <unordered_map>
 #include <vector>
@@ -49,6 +52,8 @@ public:
       mLineNumberTable{std::move(lineNumberTable)},
       mAttributes(std::move(attributes))
   {
+    // The class file format does not require any particular order, keep the table sorted for lookups
+    std::ranges::stable_sort(mLineNumberTable, {}, &LineNumberTableEntry::startPc);
   }
 
   Code(const Code&) = delete;
@@ -89,6 +94,19 @@ public:
     return mLineNumberTable;
   }
 
+  /// Returns the source line number of the instruction at bytecode offset \p pc, or an empty optional if the line
+  /// number table does not cover it.
+  std::optional<types::u2> lineNumberAt(size_t pc) const
+  {
+    // Find the last entry starting at or before pc
+    auto it = std::ranges::upper_bound(mLineNumberTable, pc, {}, &LineNumberTableEntry::startPc);
+    if (it == mLineNumberTable.begin()) {
+      return std::nullopt;
+    }
+
+    return std::prev(it)->lineNumber;
+  }
+
   const std::vector<types::u1>* getAttribute(const types::JString& name) const
   {
     if (auto it = mAttributes.find(name); it != mAttributes.end()) {
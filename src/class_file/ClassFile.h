@@ -193,7 +193,7 @@ public:
 
   ClassFile(types::u2 minorVersion, types::u2 majorVersion, std::unique_ptr<ConstantPool> constantPool, ClassAccessFlags accessFlags, types::u2 thisClass,
             types::u2 superClass, std::vector<types::u2> interfaces, std::vector<FieldInfo> fields, std::vector<MethodInfo> methods,
-            std::optional<types::u2> sourceFileIndex)
+            std::optional<types::u2> sourceFileIndex, uint64_t contentHash)
     : mMinorVersion(minorVersion),
       mMajorVersion(majorVersion),
       mConstantPool(std::move(constantPool)),
@@ -203,7 +203,8 @@ public:
       mInterfaces(std::move(interfaces)),
       mFields(std::move(fields)),
       mMethods(std::move(methods)),
-      mSourceFileIndex(sourceFileIndex)
+      mSourceFileIndex(sourceFileIndex),
+      mContentHash(contentHash)
   {
   }
 
@@ -255,6 +256,12 @@ public:
     return mSourceFileIndex;
   }
 
+  /// Hash of the bytes of the class file, used to tell whether data recorded for a class still matches it.
+  uint64_t contentHash() const
+  {
+    return mContentHash;
+  }
+
 private:
   types::u2 mMinorVersion;
   types::u2 mMajorVersion;
@@ -269,6 +276,8 @@ private:
 
   // Attributes
   std::optional<types::u2> mSourceFileIndex;
+
+  uint64_t mContentHash;
 };
 
 class ClassFileReadError : public std::runtime_error
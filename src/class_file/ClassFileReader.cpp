@@ -22,6 +22,7 @@ public:
   {
     char result;
     mStream.read(&result, 1);
+    this->hash(&result, 1);
 
     return static_cast<types::u1>(result);
   }
@@ -43,6 +44,7 @@ public:
   {
     std::array<types::u1, N> result;
     mStream.read(reinterpret_cast<char*>(result.data()), N);
+    this->hash(reinterpret_cast<char*>(result.data()), N);
 
     return result;
   }
@@ -57,6 +59,7 @@ public:
     if (mStream.fail()) {
       throw ClassFileReadError("not enough bytes in the stream ");
     }
+    this->hash(reinterpret_cast<char*>(result.data()), size);
     // Check if stream has enough bytes
     // mStream.read(reinterpret_cast<char*>(result.data()), size);
 
@@ -69,6 +72,7 @@ public:
     while (mStream && i < size) {
       char byte;
       mStream.read(&byte, 1);
+      this->hash(&byte, 1);
       i += 1;
     }
 
@@ -77,8 +81,23 @@ public:
     }
   }
 
+  /// FNV-1a hash of all bytes read so far.
+  uint64_t contentHash() const
+  {
+    return mHash;
+  }
+
+private:
+  void hash(const char* bytes, size_t size)
+  {
+    for (size_t i = 0; i < size; ++i) {
+      mHash = (mHash ^ static_cast<uint8_t>(bytes[i])) * 0x100000001b3;
+    }
+  }
+
 private:
   std::istream& mStream;
+  uint64_t mHash = 0xcbf29ce484222325;
 };
 
 class ClassFileReader
@@ -130,7 +149,7 @@ public:
     }
 
     return std::make_unique<ClassFile>(minorVersion, majorVersion, std::move(constantPool), classAccessFlags, thisClass, superClass, interfaces, fields,
-                                       std::move(methods), sourceFileIndex);
+                                       std::move(methods), sourceFileIndex, mStream.contentHash());
   }
 
   std::unique_ptr<ConstantPool> readConstantPool();
@@ -175,9 +175,9 @@ std::size_t FieldType::sizeOf() const
   return this->map([]<PrimitiveType Type>() {
     return sizeof(typename PrimitiveTypeTraits<Type>::Representation);
   }, [](types::JStringRef _) {
-    return sizeof(void*);
+    return HeapReferenceSize;
   }, [](const ArrayType& _) {
-    return sizeof(void*);
+    return HeapReferenceSize;
   });
 }
 
@@ -10,6 +10,19 @@ namespace
 class UnixDynamicLibary : public DynamicLibrary
 {
 public:
+  // The default handle looks up symbols of the program and all libraries it was linked with
+  UnixDynamicLibary() = default;
+
+  explicit UnixDynamicLibary(void* handle)
+    : mHandle(handle)
+  {
+  }
+
+  UnixDynamicLibary(const UnixDynamicLibary&) = delete;
+  UnixDynamicLibary& operator=(const UnixDynamicLibary&) = delete;
+
+  ~UnixDynamicLibary() override;
+
   void* findSymbol(const char* symbol) const override;
 
 private:
@@ -23,6 +36,23 @@ std::unique_ptr<DynamicLibrary> DynamicLibrary::create()
   return std::make_unique<UnixDynamicLibary>();
 }
 
+std::unique_ptr<DynamicLibrary> DynamicLibrary::open(const std::string& path)
+{
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    return nullptr;
+  }
+
+  return std::make_unique<UnixDynamicLibary>(handle);
+}
+
+UnixDynamicLibary::~UnixDynamicLibary()
+{
+  if (mHandle != nullptr) {
+    dlclose(mHandle);
+  }
+}
+
 void* UnixDynamicLibary::findSymbol(const char* symbol) const
 {
   void* handle = dlsym(mHandle, symbol);
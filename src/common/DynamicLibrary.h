@@ -2,6 +2,7 @@
 #define GEEVM_DYNAMICLIBRARY_H
 
 #include <memory>
+#include <string>
 
 namespace geevm
 {
@@ -14,6 +15,9 @@ protected:
 public:
   static std::unique_ptr<DynamicLibrary> create();
 
+  /// Loads the shared library at \p path, or returns nullptr if it cannot be loaded.
+  static std::unique_ptr<DynamicLibrary> open(const std::string& path);
+
   virtual ~DynamicLibrary() = default;
 
   virtual void* findSymbol(const char* symbol) const = 0;
@@ -26,6 +26,13 @@ void replaceAll(JString& str, JStringRef oldValue, JStringRef newValue);
 namespace geevm
 {
 
+/// Size of an object reference stored inside an object: in a field or as a reference array element.
+#ifdef GEEVM_COMPRESSED_OOPS
+inline constexpr std::size_t HeapReferenceSize = sizeof(std::uint32_t);
+#else
+inline constexpr std::size_t HeapReferenceSize = sizeof(void*);
+#endif
+
 enum class PrimitiveType
 {
   Byte,
@@ -58,12 +58,20 @@ JNIEXPORT jobject JNICALL Java_java_lang_Object_clone(JNIEnv* env, jobject obj)
   JClass* klass = jni::translate(env->GetObjectClass(obj))->target();
   if (auto instanceClass = klass->asInstanceClass(); instanceClass) {
     auto* newInstance = thread.heap().allocate<ObjectInstance>(instanceClass);
+    if (newInstance == nullptr) {
+      thread.throwOutOfMemoryError();
+      return nullptr;
+    }
     std::memcpy(newInstance, objectHandle.get(), instanceClass->allocationSize());
 
     result = thread.heap().gc().pin(newInstance).release();
   } else if (auto arrayClass = klass->asArrayClass(); arrayClass) {
     int32_t length = objectHandle.get()->toArrayInstance()->length();
     ArrayInstance* newInstance = thread.heap().allocateArray(arrayClass, length);
+    if (newInstance == nullptr) {
+      thread.throwOutOfMemoryError();
+      return nullptr;
+    }
     std::memcpy(newInstance, objectHandle.get(), arrayClass->allocationSize(length));
 
     result = thread.heap().gc().pin(newInstance).release();
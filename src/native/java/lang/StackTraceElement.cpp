@@ -1,3 +1,4 @@
+#include "vm/Backtrace.h"
 #include "vm/Instance.h"
 #include "vm/JniImplementation.h"
 
@@ -12,10 +13,11 @@ JNIEXPORT void JNICALL Java_java_lang_StackTraceElement_initStackTraceElements(J
 {
   auto stackTraceArray = jni::translate(elements);
   GcRootRef<JavaThrowable> throwableInstance = jni::translate(throwable);
-  auto storedBackTrace = throwableInstance->getFieldValue<Instance*>(u"backtrace", u"Ljava/lang/Object;")->toArray<Instance*>();
+  Backtrace backtrace(throwableInstance->mBacktrace->toArray<int64_t>());
 
-  for (int32_t i = 0; i < stackTraceArray->length(); i++) {
-    stackTraceArray->setArrayElement(i, *storedBackTrace->getArrayElement(i));
+  JavaHeap& heap = jni::threadFromJniEnv(env).heap();
+  for (int32_t i = 0; i < stackTraceArray->length() && i < backtrace.depth(); i++) {
+    backtrace.fillStackTraceElement(heap, i, *stackTraceArray->getArrayElement(i));
   }
 }
 }
@@ -1,5 +1,6 @@
 #include "common/Encoding.h"
 #include "vm/Class.h"
+#include "vm/Heap.h"
 #include "vm/Instance.h"
 #include "vm/JniImplementation.h"
 #include "vm/Thread.h"
@@ -106,6 +107,7 @@ JNIEXPORT void JNICALL Java_java_lang_System_arraycopy(JNIEnv* env, jclass klass
     for (int32_t i = 0; i < length; i++) {
       Instance* value = *sourceRefArray->getArrayElement(srcPos + i);
       targetRefArray->setArrayElement(destPos + i, value);
+      thread.heap().gc().writeBarrier(targetRefArray, value);
     }
   } else {
     thread.throwException(u"java/lang/ArrayStoreException", u"source and target arrays are of different type");
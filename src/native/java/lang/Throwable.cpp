@@ -1,3 +1,4 @@
+#include "vm/Backtrace.h"
 #include "vm/Instance.h"
 #include "vm/JniImplementation.h"
 
@@ -11,38 +12,48 @@ extern "C"
 
 JNIEXPORT jobject JNICALL Java_java_lang_Throwable_fillInStackTrace(JNIEnv* env, jobject throwable, jint depth)
 {
-  auto exceptionInstance = jni::translate(throwable);
   JavaThread& thread = jni::threadFromJniEnv(env);
-  auto array = thread.createStackTrace();
+  JavaArray<int64_t>* backtrace = Backtrace::capture(thread);
 
-  exceptionInstance->setFieldValue<Instance*>(u"stackTrace", u"[Ljava/lang/StackTraceElement;", array);
-  exceptionInstance->setFieldValue<Instance*>(u"backtrace", u"Ljava/lang/Object;", array);
-  exceptionInstance->setFieldValue<int32_t>(u"depth", u"I", array->toArrayInstance()->length());
+  // Stack trace elements are created lazily by Throwable from the backtrace
+  auto* exceptionInstance = static_cast<JavaThrowable*>(jni::translate(throwable).get());
+  exceptionInstance->mBacktrace = backtrace;
+  exceptionInstance->mDepth = backtrace != nullptr ? Backtrace(backtrace).depth() : 0;
 
   return throwable;
 }
 
 JNIEXPORT jint JNICALL Java_java_lang_Throwable_getStackTraceDepth(JNIEnv* env, jobject throwable)
 {
-  auto exceptionInstance = jni::translate(throwable);
-  auto backtrace = exceptionInstance->getFieldValue<Instance*>(u"backtrace", u"Ljava/lang/Object;");
+  auto* exceptionInstance = static_cast<JavaThrowable*>(jni::translate(throwable).get());
+  Instance* backtrace = exceptionInstance->mBacktrace;
 
   if (backtrace == nullptr) {
     return 0;
   }
 
-  return backtrace->toArrayInstance()->length();
+  return Backtrace(backtrace->toArray<int64_t>()).depth();
 }
 
 JNIEXPORT jobject JNICALL Java_java_lang_Throwable_getStackTraceElement(JNIEnv* env, jobject throwable, jint index)
 {
-  auto exceptionInstance = jni::translate(throwable);
-  auto backtrace = exceptionInstance->getFieldValue<Instance*>(u"backtrace", u"Ljava/lang/Object;");
-  auto elem = backtrace->toArray<Instance*>()->getArrayElement(index);
+  JavaThread& thread = jni::threadFromJniEnv(env);
+  auto stackTraceElementClass = thread.resolveClass(u"java/lang/StackTraceElement");
+  assert(stackTraceElementClass.has_value());
+
+  auto* elementInstance = thread.heap().allocate<ObjectInstance>((*stackTraceElementClass)->asInstanceClass());
+  if (elementInstance == nullptr) {
+    thread.throwOutOfMemoryError();
+    return nullptr;
+  }
+  auto element = thread.heap().gc().pin(elementInstance).release();
 
-  assert(elem.has_value());
+  // The backtrace is read after the allocation, as it might have been relocated
+  auto* exceptionInstance = static_cast<JavaThrowable*>(jni::translate(throwable).get());
+  Backtrace backtrace(exceptionInstance->mBacktrace->toArray<int64_t>());
+  assert(index >= 0 && index < backtrace.depth());
+  backtrace.fillStackTraceElement(thread.heap(), index, element.get());
 
-  auto elemRef = jni::threadFromJniEnv(env).heap().gc().pin(*elem).release();
-  return jni::translate(elemRef);
+  return jni::translate(element);
 }
 }
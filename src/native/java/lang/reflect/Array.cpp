@@ -31,7 +31,12 @@ JNIEXPORT jobject JNICALL Java_java_lang_reflect_Array_newArray(JNIEnv* env, jcl
   }
 
   auto arrayClass = thread.resolveClass(arrayClassName);
-  auto newArray = thread.heap().gc().pin(thread.heap().allocateArray((*arrayClass)->asArrayClass(), length)).release();
+  ArrayInstance* array = thread.heap().allocateArray((*arrayClass)->asArrayClass(), length);
+  if (array == nullptr) {
+    thread.throwOutOfMemoryError();
+    return nullptr;
+  }
+  auto newArray = thread.heap().gc().pin(array).release();
 
   return jni::translate(newArray);
 }
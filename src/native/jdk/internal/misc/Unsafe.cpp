@@ -79,17 +79,17 @@ JNIEXPORT jboolean JNICALL Java_jdk_internal_misc_Unsafe_compareAndSetLong(JNIEn
 JNIEXPORT jboolean JNICALL Java_jdk_internal_misc_Unsafe_compareAndSetReference(JNIEnv*, jobject unsafe, jobject object, jlong offset, jobject expected,
                                                                                 jobject desired)
 {
-  return compareAndSet<Instance*>(jni::translate(object), offset, jni::translate(expected).get(),
-                                  jni::translate(desired).get());
+  // References inside objects are stored in their heap representation, which may be compressed
+  return compareAndSet<HeapPtr<Instance>>(jni::translate(object), offset, jni::translate(expected).get(), jni::translate(desired).get());
 }
 
 JNIEXPORT jobject JNICALL Java_jdk_internal_misc_Unsafe_getReferenceVolatile(JNIEnv* env, jobject unsafe, jobject object, jlong offset)
 {
   GcRootRef<Instance> instance = jni::translate(object);
 
-  Instance** target = reinterpret_cast<Instance**>(reinterpret_cast<char*>(instance.get()) + offset);
-  std::atomic_ref<Instance**> atomicRef(target);
-  auto loaded = jni::threadFromJniEnv(env).heap().gc().pin(*atomicRef.load()).release();
+  auto* target = reinterpret_cast<HeapPtr<Instance>*>(reinterpret_cast<char*>(instance.get()) + offset);
+  std::atomic_ref<HeapPtr<Instance>> atomicRef(*target);
+  auto loaded = jni::threadFromJniEnv(env).heap().gc().pin(atomicRef.load().get()).release();
 
   return jni::translate(loaded);
 }
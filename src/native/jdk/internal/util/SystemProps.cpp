@@ -32,6 +32,10 @@ JNIEXPORT jobjectArray JNICALL Java_jdk_internal_util_SystemProps_00024Raw_platf
   auto targetClass = jni::translate(strArrayClass)->target();
 
   auto* allocatedArray = thread.heap().allocateArray<Instance*>(targetClass->asArrayClass(), arrayLength);
+  if (allocatedArray == nullptr) {
+    thread.throwOutOfMemoryError();
+    return nullptr;
+  }
   GcRootRef<JavaArray<Instance*>> propsArray = thread.heap().gc().pin(allocatedArray).release();
   propsArray->setArrayElement(18, thread.heap().intern(temp).get());
   propsArray->setArrayElement(36, thread.heap().intern(temp).get());
@@ -57,8 +61,12 @@ JNIEXPORT jobjectArray JNICALL Java_jdk_internal_util_SystemProps_00024Raw_vmPro
 
   auto targetClass = jni::translate(strArrayClass)->target();
 
-  GcRootRef<JavaArray<Instance*>> propsArray =
-      thread.heap().gc().pin(thread.heap().allocateArray<Instance*>(targetClass->asArrayClass(), arrayLength)).release();
+  auto* allocatedArray = thread.heap().allocateArray<Instance*>(targetClass->asArrayClass(), arrayLength);
+  if (allocatedArray == nullptr) {
+    thread.throwOutOfMemoryError();
+    return nullptr;
+  }
+  GcRootRef<JavaArray<Instance*>> propsArray = thread.heap().gc().pin(allocatedArray).release();
   propsArray->setArrayElement(0, thread.heap().intern(u"java.home").get());
   propsArray->setArrayElement(1, thread.heap().intern(utf8ToUtf16(thread.vm().settings().javaHome)).get());
 
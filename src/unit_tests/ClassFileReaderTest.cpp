@@ -179,3 +179,20 @@ TEST_F(ClassFileReaderTest, read_methods)
   EXPECT_EQ(classFile->constantPool().getClassName(classFile->methods()[12].exceptions()[0]), u"java/io/IOException");
   EXPECT_EQ(classFile->constantPool().getClassName(classFile->methods()[12].exceptions()[1]), u"org/geevm/tests/classfile/Methods$MyException");
 }
+
+TEST(CodeTest, line_number_lookup)
+{
+  // Entries are deliberately out of order, the table is sorted on construction
+  std::vector<Code::LineNumberTableEntry> lineNumbers{{10, 12}, {0, 10}, {4, 11}};
+  Code code{2, 1, std::vector<types::u1>(16), {}, {}, {}, std::move(lineNumbers), {}};
+
+  ASSERT_EQ(code.lineNumberAt(0), 10);
+  ASSERT_EQ(code.lineNumberAt(3), 10);
+  ASSERT_EQ(code.lineNumberAt(4), 11);
+  ASSERT_EQ(code.lineNumberAt(9), 11);
+  ASSERT_EQ(code.lineNumberAt(10), 12);
+  ASSERT_EQ(code.lineNumberAt(15), 12);
+
+  Code noLines{2, 1, std::vector<types::u1>(16), {}, {}, {}, {}, {}};
+  ASSERT_FALSE(noLines.lineNumberAt(0).has_value());
+}
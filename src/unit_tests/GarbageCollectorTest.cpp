@@ -142,3 +142,92 @@ TEST_F(GarbageCollectorTest, compare_scoped_root_ref_to_null)
 
   ASSERT_FALSE(pinned == nullptr);
 }
+
+TEST_F(GarbageCollectorTest, immortal_objects_are_not_relocated)
+{
+  gc().lockGC();
+
+  types::JString className = u"[Lorg/geevm/tests/classfile/HelloWorld;";
+  ArrayClass arrayClass{className, FieldType::parse(className).value()};
+  auto immortalArray = mVm.heap().allocateImmortalArray<Instance*>(&arrayClass, 1);
+  auto object = mVm.heap().allocate<ObjectInstance>(&mHelloWorldClass);
+  immortalArray->setArrayElement(0, object);
+
+  gc().unlockGC();
+
+  gc().performGarbageCollection();
+
+  // The immortal array was not pinned, but it is still valid as it was not moved
+  ASSERT_EQ(immortalArray->getClass(), &arrayClass);
+
+  // Objects referenced from the immortal region are kept alive and relocated
+  Instance* element = immortalArray->getArrayElement(0).value();
+  ASSERT_NE(element, object);
+  ASSERT_EQ(element->getClass(), &mHelloWorldClass);
+}
+
+TEST_F(GarbageCollectorTest, immortal_refs_are_not_pinned)
+{
+  auto object = mVm.heap().allocateImmortal<ObjectInstance>(&mHelloWorldClass);
+  auto ref = gc().immortalRef(object);
+
+  gc().performGarbageCollection();
+
+  ASSERT_EQ(ref, object);
+  ASSERT_EQ(ref->getClass(), &mHelloWorldClass);
+  for (Instance* pinned : gc().pinnedObjects()) {
+    ASSERT_NE(pinned, object);
+  }
+}
+
+TEST_F(GarbageCollectorTest, epsilon_collector_never_moves_objects)
+{
+  Vm epsilonVm{VmSettings{.collector = GarbageCollectorKind::Epsilon}};
+
+  auto object = epsilonVm.heap().allocate<ObjectInstance>(&mHelloWorldClass);
+  auto pinned = epsilonVm.heap().gc().pin(object);
+
+  epsilonVm.heap().gc().performGarbageCollection();
+
+  ASSERT_EQ(pinned, object);
+  ASSERT_EQ(epsilonVm.heap().gc().statistics().collections, 0);
+  ASSERT_EQ(pinned->getClass(), &mHelloWorldClass);
+}
+
+TEST_F(GarbageCollectorTest, collections_are_recorded_in_statistics)
+{
+  gc().lockGC();
+  auto object = mVm.heap().allocate<ObjectInstance>(&mHelloWorldClass);
+  gc().unlockGC();
+
+  auto pinned = gc().pin(object);
+  size_t collectionsBefore = mVm.heap().statistics().collections;
+
+  gc().performGarbageCollection();
+
+  GcStatistics stats = mVm.heap().statistics();
+  ASSERT_EQ(stats.collections, collectionsBefore + 1);
+  ASSERT_EQ(stats.pauses.count(), stats.collections);
+  ASSERT_TRUE(stats.lastCollection.has_value());
+  ASSERT_EQ(stats.lastCollection->cause, GcCause::Explicit);
+  ASSERT_GE(stats.lastCollection->roots.pinned, 1);
+  ASSERT_GE(stats.lastCollection->objectsCopied, 1);
+  ASSERT_EQ(stats.lastCollection->heapUsedAfter, stats.heapUsed);
+}
+
+TEST(GcLogSettingsTest, parse_log_options)
+{
+  auto defaults = GcLogSettings::parse("gc");
+  ASSERT_TRUE(defaults.has_value());
+  ASSERT_EQ(defaults->output, "stderr");
+  ASSERT_EQ(defaults->format, GcLogFormat::Text);
+
+  auto json = GcLogSettings::parse("gc:gc.log:json");
+  ASSERT_TRUE(json.has_value());
+  ASSERT_EQ(json->output, "gc.log");
+  ASSERT_EQ(json->format, GcLogFormat::Json);
+
+  ASSERT_FALSE(GcLogSettings::parse("class").has_value());
+  ASSERT_FALSE(GcLogSettings::parse("gc:").has_value());
+  ASSERT_FALSE(GcLogSettings::parse("gc:stdout:xml").has_value());
+}
@@ -0,0 +1,58 @@
+#include "BaseTest.h"
+
+#include "vm/HeapDump.h"
+#include "vm/Vm.h"
+
+#include <algorithm>
+#include <gmock/gmock.h>
+#include <sstream>
+
+using namespace geevm;
+
+static const std::string HelloWorldClass = "class_file/org/geevm/tests/classfile/HelloWorld.class";
+
+class HeapDumpTest : public geevm::testing::BaseTest
+{
+public:
+  explicit HeapDumpTest()
+    : mHelloWorldClass(ClassFile::fromFile(getResource(HelloWorldClass)))
+  {
+  }
+
+protected:
+  Vm mVm{VmSettings{}};
+  InstanceClass mHelloWorldClass;
+};
+
+TEST_F(HeapDumpTest, class_histogram_counts_instances)
+{
+  mVm.heap().gc().lockGC();
+  for (int i = 0; i < 3; i++) {
+    (void)mVm.heap().allocate<ObjectInstance>(&mHelloWorldClass);
+  }
+  mVm.heap().gc().unlockGC();
+
+  auto histogram = computeClassHistogram(mVm);
+  auto entry = std::ranges::find(histogram, &mHelloWorldClass, &ClassHistogramEntry::klass);
+
+  ASSERT_NE(entry, histogram.end());
+  ASSERT_EQ(entry->instances, 3);
+  ASSERT_EQ(entry->bytes, 3 * mHelloWorldClass.allocationSize());
+}
+
+TEST_F(HeapDumpTest, heap_dump_has_hprof_header)
+{
+  auto object = mVm.heap().gc().pin(mVm.heap().allocate<ObjectInstance>(&mHelloWorldClass));
+
+  std::ostringstream out;
+  writeHeapDump(mVm, out);
+
+  std::string dump = out.str();
+  std::string_view expectedFormat{"JAVA PROFILE 1.0.2\0", 19};
+
+  ASSERT_TRUE(dump.starts_with(expectedFormat));
+  // Identifier size, stored as a big-endian u4 after the format string
+  ASSERT_EQ(dump.substr(19, 4), std::string("\0\0\0\x08", 4));
+  // The file ends with an empty HEAP DUMP END record
+  ASSERT_EQ(dump.substr(dump.size() - 9), std::string("\x2C\0\0\0\0\0\0\0\0", 9));
+}
@@ -3,6 +3,8 @@
 #include "vm/Class.h"
 #include "vm/Vm.h"
 
+#include <unordered_set>
+
 using namespace geevm;
 
 class InstanceTest : public geevm::testing::BaseTest
@@ -59,3 +61,112 @@ TEST_F(InstanceTest, throwable_instance_layout)
   ASSERT_EQ(offsetof(JavaThrowable, mDepth), (*depth)->offset());
   ASSERT_EQ(offsetof(JavaThrowable, mSuppressedExceptions), (*suppressedExceptions)->offset());
 }
+
+TEST_F(InstanceTest, compact_object_header)
+{
+  auto objectClass = loadClass(u"java/lang/Object");
+  objectClass->prepare(mVm.bootstrapClassLoader(), mVm.heap());
+
+  // A plain object only consists of its 8-byte header
+  ASSERT_EQ(objectClass->asInstanceClass()->allocationSize(), sizeof(InstanceHeader));
+  ASSERT_EQ(sizeof(ObjectInstance), 8);
+  ASSERT_EQ(sizeof(ArrayInstance) % ObjectAlignment, 0);
+
+  auto* object = mVm.heap().allocate<ObjectInstance>(objectClass->asInstanceClass());
+  ASSERT_EQ(object->getClass(), objectClass);
+  ASSERT_EQ(ClassTable::get(objectClass->classId()), objectClass);
+
+  int32_t hash = object->hashCode();
+  ASSERT_NE(hash, 0);
+  ASSERT_EQ(object->hashCode(), hash);
+
+  // Computing the hash code must not touch the other header fields
+  auto* header = reinterpret_cast<InstanceHeader*>(object);
+  ASSERT_EQ(header->mClassId, objectClass->classId());
+  ASSERT_EQ(header->age(), 0u);
+  ASSERT_EQ(header->lockBits(), 0u);
+
+  // Setting every hash bit leaves the age and the lock state untouched
+  InstanceHeader packed{objectClass};
+  packed.setHashCode(static_cast<int32_t>(InstanceHeader::HashMask));
+  ASSERT_EQ(packed.hashCode(), static_cast<int32_t>(InstanceHeader::HashMask));
+  ASSERT_EQ(packed.age(), 0u);
+  ASSERT_EQ(packed.lockBits(), 0u);
+
+  // Aging saturates without overflowing into the hash or the lock state
+  for (uint32_t i = 0; i <= InstanceHeader::AgeMask; i++) {
+    packed.incrementAge();
+  }
+  ASSERT_EQ(packed.age(), InstanceHeader::AgeMask);
+  ASSERT_EQ(packed.hashCode(), static_cast<int32_t>(InstanceHeader::HashMask));
+  ASSERT_EQ(packed.lockBits(), 0u);
+
+  // Replacing the hash keeps the saturated age
+  packed.setHashCode(1);
+  ASSERT_EQ(packed.hashCode(), 1);
+  ASSERT_EQ(packed.age(), InstanceHeader::AgeMask);
+  ASSERT_EQ(packed.lockBits(), 0u);
+  ASSERT_EQ(packed.mClassId, objectClass->classId());
+}
+
+TEST_F(InstanceTest, identity_hashes_of_adjacent_objects_differ)
+{
+  auto objectClass = loadClass(u"java/lang/Object");
+  objectClass->prepare(mVm.bootstrapClassLoader(), mVm.heap());
+
+  mVm.heap().gc().lockGC();
+  std::unordered_set<int32_t> hashes;
+  int32_t lowBits = 0;
+  for (int i = 0; i < 1000; i++) {
+    int32_t hash = mVm.heap().allocate<ObjectInstance>(objectClass->asInstanceClass())->hashCode();
+    hashes.insert(hash);
+    lowBits |= hash & static_cast<int32_t>(ObjectAlignment - 1);
+  }
+  mVm.heap().gc().unlockGC();
+
+  ASSERT_EQ(hashes.size(), 1000);
+  // The alignment bits of the address must not leave the lowest bits of the hash unused
+  ASSERT_NE(lowBits, 0);
+}
+
+TEST_F(InstanceTest, heap_references_round_trip)
+{
+  auto objectClass = loadClass(u"java/lang/Object");
+  objectClass->prepare(mVm.bootstrapClassLoader(), mVm.heap());
+
+  auto* object = mVm.heap().allocate<ObjectInstance>(objectClass->asInstanceClass());
+
+  HeapPtr<Instance> ref = object;
+  ASSERT_EQ(ref.get(), object);
+  ASSERT_EQ(sizeof(ref), HeapReferenceSize);
+
+  HeapPtr<Instance> nullRef = nullptr;
+  ASSERT_EQ(nullRef.get(), nullptr);
+
+  ASSERT_EQ(FieldType::parse(u"Ljava/lang/Object;")->sizeOf(), HeapReferenceSize);
+  ASSERT_EQ(FieldType::parse(u"[I")->sizeOf(), HeapReferenceSize);
+}
+
+TEST_F(InstanceTest, packed_field_layout)
+{
+  auto arrayListClass = loadClass(u"java/util/ArrayList");
+  arrayListClass->prepare(mVm.bootstrapClassLoader(), mVm.heap());
+  auto abstractListClass = arrayListClass->superClass();
+
+  // Inherited fields keep the offsets of the superclass
+  for (JField* field : abstractListClass->instanceFields()) {
+    auto inherited = arrayListClass->lookupField(field->name(), field->descriptor());
+    ASSERT_TRUE(inherited.has_value());
+    ASSERT_EQ((*inherited)->offset(), field->offset());
+  }
+
+  // Fields never overlap
+  const auto& fields = arrayListClass->instanceFields();
+  ASSERT_EQ(arrayListClass->numInstanceFields(), fields.size());
+  for (size_t i = 1; i < fields.size(); i++) {
+    ASSERT_GE(fields[i]->offset(), fields[i - 1]->offset() + fields[i - 1]->fieldType().sizeOf());
+  }
+
+  // AbstractList.modCount, ArrayList.size and ArrayList.elementData are packed without padding
+  ASSERT_EQ(arrayListClass->asInstanceClass()->allocationSize(), sizeof(ObjectInstance) + 2 * sizeof(int32_t) + HeapReferenceSize);
+}
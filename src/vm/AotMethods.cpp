@@ -0,0 +1,48 @@
+#include "vm/AotMethods.h"
+#include "vm/Class.h"
+#include "vm/Method.h"
+
+#include <format>
+
+using namespace geevm;
+
+static void appendEscaped(std::string& symbol, types::JStringRef name)
+{
+  for (char16_t c : name) {
+    if ((c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') || (c >= u'0' && c <= u'9')) {
+      symbol += static_cast<char>(c);
+    } else {
+      symbol += std::format("_{:04x}", static_cast<uint16_t>(c));
+    }
+  }
+}
+
+std::string geevm::aotSymbolName(types::JStringRef className, types::JStringRef methodName, types::JStringRef descriptor)
+{
+  std::string symbol = "geevm_aot_";
+  appendEscaped(symbol, className);
+  symbol += "__";
+  appendEscaped(symbol, methodName);
+  symbol += "__";
+  appendEscaped(symbol, descriptor);
+  return symbol;
+}
+
+std::string geevm::aotClassFileHashSymbolName(types::JStringRef className, types::JStringRef methodName, types::JStringRef descriptor)
+{
+  // Escaped names never contain `__`, so the suffix cannot clash with the symbol of another method
+  return aotSymbolName(className, methodName, descriptor) + "__classfilehash";
+}
+
+void* AotMethodRegistry::getCompiledCode(const JMethod* method) const
+{
+  const InstanceClass* klass = method->getClass();
+  std::string hashSymbol = aotClassFileHashSymbolName(klass->className(), method->name(), method->rawDescriptor());
+  const auto* hash = static_cast<const uint64_t*>(mLibrary->findSymbol(hashSymbol.c_str()));
+  if (hash == nullptr || *hash != klass->classFileHash()) {
+    return nullptr;
+  }
+
+  std::string symbol = aotSymbolName(klass->className(), method->name(), method->rawDescriptor());
+  return mLibrary->findSymbol(symbol.c_str());
+}
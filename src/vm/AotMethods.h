@@ -0,0 +1,49 @@
+#ifndef GEEVM_VM_AOTMETHODS_H
+#define GEEVM_VM_AOTMETHODS_H
+
+#include "common/DynamicLibrary.h"
+#include "common/JvmTypes.h"
+
+#include <memory>
+#include <string>
+
+namespace geevm
+{
+
+class JMethod;
+
+/// Returns the symbol of the ahead-of-time compiled code of a method in an AOT library. Characters other than ASCII
+/// letters and digits are escaped as `_` followed by four hex digits, so the class name, method name and descriptor can
+/// be separated by `__`.
+std::string aotSymbolName(types::JStringRef className, types::JStringRef methodName, types::JStringRef descriptor);
+
+/// Returns the symbol of the hash of the class file a method in an AOT library was compiled from, see
+/// `aotSymbolName`. The hash is stored as a 64-bit value.
+std::string aotClassFileHashSymbolName(types::JStringRef className, types::JStringRef methodName, types::JStringRef descriptor);
+
+/// Methods compiled ahead of time by `geevm-aot` into a shared library.
+///
+/// The library contains the baseline code of the compiled methods under their `aotSymbolName`. The code is position
+/// independent and follows the contract of `BaselineCompiler` code, except that it does not count backward branches.
+/// Methods are bound to their code on first invocation, like native methods. The code refers to bytecode offsets and
+/// local variable slots of the class file it was compiled from, so it is only bound if the hash of that class file
+/// matches the loaded class.
+class AotMethodRegistry
+{
+public:
+  explicit AotMethodRegistry(std::unique_ptr<DynamicLibrary> library)
+    : mLibrary(std::move(library))
+  {
+  }
+
+  /// Returns the precompiled code of \p method, or nullptr if the library does not contain it or it was compiled from
+  /// another version of the class file.
+  void* getCompiledCode(const JMethod* method) const;
+
+private:
+  std::unique_ptr<DynamicLibrary> mLibrary;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_AOTMETHODS_H
@@ -0,0 +1,78 @@
+#include "vm/Backtrace.h"
+
+#include "vm/Class.h"
+#include "vm/Heap.h"
+#include "vm/Method.h"
+#include "vm/Thread.h"
+#include "vm/Vm.h"
+
+using namespace geevm;
+
+JavaArray<int64_t>* Backtrace::capture(JavaThread& thread)
+{
+  JClass* throwableClass = thread.vm().throwableClass();
+
+  // Frames are counted first so that the array can be allocated before it is filled. The call stack lives outside
+  // the Java heap, so it is not affected if the allocation triggers garbage collection.
+  int32_t skipped = 0;
+  int32_t depth = 0;
+  for (CallFrame& frame : thread.callStack()) {
+    if (depth == 0 && frame.currentClass()->isInstanceOf(throwableClass)) {
+      skipped++;
+    } else {
+      depth++;
+    }
+  }
+
+  JavaArray<int64_t>* frames = thread.heap().allocateArray<int64_t>(thread.vm().primitiveArrayClass(PrimitiveType::Long), 2 * depth);
+  if (frames == nullptr) {
+    return nullptr;
+  }
+
+  int32_t index = 0;
+  for (CallFrame& frame : thread.callStack()) {
+    if (skipped > 0) {
+      skipped--;
+      continue;
+    }
+    (*frames)[index++] = reinterpret_cast<int64_t>(frame.currentMethod());
+    (*frames)[index++] = frame.programCounter();
+  }
+
+  return frames;
+}
+
+int32_t Backtrace::lineNumber(int32_t index) const
+{
+  JMethod* method = this->method(index);
+  if (method->isNative()) {
+    // -2 is the magic line number in the JDK for native methods
+    return -2;
+  }
+
+  // The program counter of a frame already points past the opcode of the instruction being executed
+  int64_t pc = this->programCounter(index);
+  if (auto line = method->getCode().lineNumberAt(pc > 0 ? pc - 1 : 0); line.has_value()) {
+    return *line;
+  }
+
+  // We signify unknown line numbers as -1
+  return -1;
+}
+
+void Backtrace::fillStackTraceElement(JavaHeap& heap, int32_t index, Instance* element) const
+{
+  JMethod* method = this->method(index);
+  InstanceClass* klass = method->getClass();
+
+  GcRootRef<> sourceFile = nullptr;
+  if (auto sourceFileStr = klass->sourceFile(); sourceFileStr) {
+    sourceFile = heap.intern(*sourceFileStr);
+  }
+
+  element->setFieldValue<Instance*>(u"declaringClass", u"Ljava/lang/String;", heap.intern(klass->javaClassName()).get());
+  element->setFieldValue<Instance*>(u"declaringClassObject", u"Ljava/lang/Class;", klass->classInstance().get());
+  element->setFieldValue<Instance*>(u"methodName", u"Ljava/lang/String;", heap.intern(method->name()).get());
+  element->setFieldValue<Instance*>(u"fileName", u"Ljava/lang/String;", sourceFile.get());
+  element->setFieldValue<int32_t>(u"lineNumber", u"I", this->lineNumber(index));
+}
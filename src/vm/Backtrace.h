@@ -0,0 +1,63 @@
+#ifndef GEEVM_VM_BACKTRACE_H
+#define GEEVM_VM_BACKTRACE_H
+
+#include "vm/Instance.h"
+
+#include <cstdint>
+
+namespace geevm
+{
+
+class JavaHeap;
+class JavaThread;
+class JMethod;
+
+/// Compact representation of a Java call stack, as stored in the `backtrace` field of `java.lang.Throwable`.
+///
+/// A backtrace is a `long[]` holding two elements per frame: the address of the executed method and the bytecode
+/// offset of the frame, innermost frame first. Capturing a backtrace does not allocate anything besides this array,
+/// `java.lang.StackTraceElement` objects are only created once Java code asks for the stack trace.
+class Backtrace
+{
+public:
+  /// Captures the current call stack of \p thread. Frames at the top of the stack that execute methods of
+  /// `java.lang.Throwable` or its subclasses (i.e. the construction of the exception itself) are omitted. Returns
+  /// nullptr if the heap is exhausted, the exception then has no stack trace.
+  static JavaArray<int64_t>* capture(JavaThread& thread);
+
+  explicit Backtrace(JavaArray<int64_t>* frames)
+    : mFrames(frames)
+  {
+  }
+
+  /// Returns the number of frames in this backtrace.
+  int32_t depth() const
+  {
+    return mFrames->length() / 2;
+  }
+
+  JMethod* method(int32_t index) const
+  {
+    return reinterpret_cast<JMethod*>((*mFrames)[2 * index]);
+  }
+
+  int64_t programCounter(int32_t index) const
+  {
+    return (*mFrames)[2 * index + 1];
+  }
+
+  /// Returns the source line of the frame at \p index: -2 for native methods and -1 if the line is unknown,
+  /// following the conventions of `java.lang.StackTraceElement`.
+  int32_t lineNumber(int32_t index) const;
+
+  /// Initializes the fields of the `java.lang.StackTraceElement` instance \p element from the frame at \p index.
+  /// This never triggers garbage collection, as strings are interned in the immortal region.
+  void fillStackTraceElement(JavaHeap& heap, int32_t index, Instance* element) const;
+
+private:
+  JavaArray<int64_t>* mFrames;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_BACKTRACE_H
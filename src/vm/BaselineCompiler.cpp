@@ -0,0 +1,778 @@
+#include "vm/BaselineCompiler.h"
+#include "class_file/Opcode.h"
+#include "common/Debug.h"
+#include "vm/CompiledCode.h"
+#include "vm/Instance.h"
+#include "vm/Method.h"
+#include "vm/X86Assembler.h"
+
+#include <bit>
+#include <cassert>
+#include <deque>
+#include <optional>
+
+using namespace geevm;
+
+namespace
+{
+
+// Compiled code receives the local variable array in RDI and the operand stack in RSI (the first two integer arguments
+// of the System V calling convention). Both stay unchanged, RAX, RCX and RDX are used as scratch registers.
+constexpr Reg LocalsReg = Reg::RDI;
+constexpr Reg StackReg = Reg::RSI;
+
+constexpr int32_t SlotSize = sizeof(uint64_t);
+
+Mem local(size_t index)
+{
+  return Mem{.base = LocalsReg, .displacement = static_cast<int32_t>(index) * SlotSize};
+}
+
+Mem slot(int32_t index)
+{
+  return Mem{.base = StackReg, .displacement = index * SlotSize};
+}
+
+Mem arrayElement(Reg array, Reg index, uint8_t elementSize)
+{
+  return Mem{.base = array, .index = index, .scale = elementSize, .displacement = static_cast<int32_t>(ArrayInstance::elementsOffset())};
+}
+
+/// Compiles the bytecode of a single method.
+///
+/// The operand stack depth before every instruction is computed with a data flow pass from the entry instruction,
+/// which only follows supported instructions. Code is then emitted in bytecode order for every reached instruction, so
+/// that falling through to the next instruction needs no jump.
+class MethodCompiler
+{
+public:
+  MethodCompiler(JMethod& method, uint32_t* backedgeCounter, std::optional<uint32_t> tierUpThreshold, int64_t entryPc, int32_t entryDepth)
+    : mBytes(method.getCode().bytes()),
+      mMaxStack(method.getCode().maxStack()),
+      mBackedgeCounter(backedgeCounter),
+      mTierUpThreshold(tierUpThreshold),
+      mEntryPc(entryPc),
+      mEntryDepth(entryDepth),
+      mLabels(mBytes.size()),
+      mDepths(mBytes.size(), Unreached)
+  {
+  }
+
+  /// Compiles the method, returns false if it cannot be compiled.
+  bool compile();
+
+  const std::vector<types::u1>& code() const
+  {
+    return mAssembler.code();
+  }
+
+private:
+  static constexpr int32_t Unreached = -1;
+
+  Opcode opcodeAt(int64_t pc) const
+  {
+    return static_cast<Opcode>(mBytes[pc]);
+  }
+
+  types::u1 u1At(int64_t pc) const
+  {
+    return mBytes[pc];
+  }
+
+  types::u2 u2At(int64_t pc) const
+  {
+    return (mBytes[pc] << 8u) | mBytes[pc + 1];
+  }
+
+  int64_t branchTarget(int64_t pc) const
+  {
+    return jumpTarget(mBytes, pc);
+  }
+
+  bool computeStackDepths();
+  bool reach(int64_t pc, int32_t depth, std::vector<int64_t>& worklist);
+
+  void emitInstruction(int64_t pc, int32_t depth);
+  void emitExit(int64_t pc, int32_t depth);
+  X86Assembler::Label& exitLabel(int64_t pc, int32_t depth);
+
+  void emitIntBinary(Opcode opcode, int32_t depth);
+  void emitLongBinary(Opcode opcode, int32_t depth);
+  void emitDivision(Opcode opcode, int64_t pc, int32_t depth);
+  void emitArrayCheck(int64_t pc, int32_t depth, int32_t arraySlot);
+  void emitArrayLoad(Opcode opcode, int64_t pc, int32_t depth);
+  void emitArrayStore(Opcode opcode, int64_t pc, int32_t depth);
+  void emitBranch(Opcode opcode, int64_t pc, int32_t depth);
+  void emitJump(int64_t pc, std::optional<Cond> cond);
+
+private:
+  struct ExitStub
+  {
+    X86Assembler::Label label;
+    uint32_t state;
+  };
+
+  const std::vector<types::u1>& mBytes;
+  types::u2 mMaxStack;
+  // Not set for position-independent code, which cannot refer to the method
+  uint32_t* mBackedgeCounter;
+  std::optional<uint32_t> mTierUpThreshold;
+  // The method start, or the loop header of an OSR entry
+  int64_t mEntryPc;
+  int32_t mEntryDepth;
+  X86Assembler mAssembler;
+  // Label of every bytecode instruction, indexed by offset
+  std::vector<X86Assembler::Label> mLabels;
+  // Operand stack depth before every instruction, Unreached for instructions compiled code never executes
+  std::vector<int32_t> mDepths;
+  // Out-of-line exits of failed runtime checks, emitted after the method body. A deque keeps labels in place while
+  // jumps refer to them.
+  std::deque<ExitStub> mExitStubs;
+};
+
+bool MethodCompiler::reach(int64_t pc, int32_t depth, std::vector<int64_t>& worklist)
+{
+  if (pc < 0 || pc >= static_cast<int64_t>(mBytes.size())) {
+    return false;
+  }
+
+  if (mDepths[pc] == Unreached) {
+    mDepths[pc] = depth;
+    worklist.push_back(pc);
+    return true;
+  }
+
+  // Verified bytecode has the same stack depth at an instruction along every path
+  return mDepths[pc] == depth;
+}
+
+bool MethodCompiler::computeStackDepths()
+{
+  std::vector<int64_t> worklist;
+  if (mBytes.empty() || !this->reach(mEntryPc, mEntryDepth, worklist)) {
+    return false;
+  }
+
+  while (!worklist.empty()) {
+    int64_t pc = worklist.back();
+    worklist.pop_back();
+
+    auto effect = compiledStackEffect(opcodeAt(pc));
+    if (!effect.has_value()) {
+      // Compiled code exits to the interpreter here
+      continue;
+    }
+
+    int32_t depth = mDepths[pc];
+    int32_t nextDepth = depth - effect->pops + effect->pushes;
+    if (depth < effect->pops || nextDepth > mMaxStack || pc + effect->length > static_cast<int64_t>(mBytes.size())) {
+      return false;
+    }
+
+    Opcode opcode = opcodeAt(pc);
+    if (isJump(opcode) && !this->reach(branchTarget(pc), nextDepth, worklist)) {
+      return false;
+    }
+
+    bool fallsThrough = opcode != Opcode::GOTO && opcode != Opcode::GOTO_W;
+    if (fallsThrough && !this->reach(pc + effect->length, nextDepth, worklist)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool MethodCompiler::compile()
+{
+  if (!this->computeStackDepths() || !compiledStackEffect(opcodeAt(mEntryPc)).has_value()) {
+    // Code immediately exiting to the interpreter is not worth compiling
+    return false;
+  }
+
+  // Instructions before the loop header of an OSR entry may be reached from within the loop
+  if (mEntryPc != 0) {
+    mAssembler.jmp(mLabels[mEntryPc]);
+  }
+
+  for (int64_t pc = 0; pc < static_cast<int64_t>(mBytes.size()); ++pc) {
+    if (mDepths[pc] == Unreached) {
+      continue;
+    }
+
+    mAssembler.bind(mLabels[pc]);
+    this->emitInstruction(pc, mDepths[pc]);
+  }
+
+  for (ExitStub& stub : mExitStubs) {
+    mAssembler.bind(stub.label);
+    mAssembler.movImm32(Reg::RAX, stub.state);
+    mAssembler.ret();
+  }
+
+  return true;
+}
+
+void MethodCompiler::emitExit(int64_t pc, int32_t depth)
+{
+  mAssembler.movImm32(Reg::RAX, compiledCodeExitState(pc, depth));
+  mAssembler.ret();
+}
+
+X86Assembler::Label& MethodCompiler::exitLabel(int64_t pc, int32_t depth)
+{
+  return mExitStubs.emplace_back(ExitStub{.label = {}, .state = compiledCodeExitState(pc, depth)}).label;
+}
+
+void MethodCompiler::emitInstruction(int64_t pc, int32_t depth)
+{
+  Opcode opcode = opcodeAt(pc);
+  if (!compiledStackEffect(opcode).has_value()) {
+    this->emitExit(pc, depth);
+    return;
+  }
+
+  auto pushConstant = [&](uint64_t rawValue) {
+    mAssembler.movImm64(Reg::RAX, rawValue);
+    mAssembler.mov64(slot(depth), Reg::RAX);
+  };
+  auto pushInt = [&](int32_t value) {
+    pushConstant(std::bit_cast<uint32_t>(value));
+  };
+  // Local variables and stack slots are copied as raw 64-bit values, category two values only use their first slot
+  auto load = [&](size_t index) {
+    mAssembler.mov64(Reg::RAX, local(index));
+    mAssembler.mov64(slot(depth), Reg::RAX);
+  };
+  auto store = [&](size_t index, int32_t size) {
+    mAssembler.mov64(Reg::RAX, slot(depth - size));
+    mAssembler.mov64(local(index), Reg::RAX);
+  };
+
+  switch (opcode) {
+    using enum Opcode;
+    case NOP: break;
+    case ACONST_NULL: pushConstant(0); break;
+    case ICONST_M1:
+    case ICONST_0:
+    case ICONST_1:
+    case ICONST_2:
+    case ICONST_3:
+    case ICONST_4:
+    case ICONST_5: pushInt(static_cast<int32_t>(opcode) - static_cast<int32_t>(ICONST_0)); break;
+    case LCONST_0:
+    case LCONST_1: pushConstant(static_cast<uint64_t>(opcode) - static_cast<uint64_t>(LCONST_0)); break;
+    case FCONST_0:
+    case FCONST_1:
+    case FCONST_2: pushConstant(std::bit_cast<uint32_t>(static_cast<float>(static_cast<int32_t>(opcode) - static_cast<int32_t>(FCONST_0)))); break;
+    case DCONST_0:
+    case DCONST_1: pushConstant(std::bit_cast<uint64_t>(static_cast<double>(static_cast<int32_t>(opcode) - static_cast<int32_t>(DCONST_0)))); break;
+    case BIPUSH: pushInt(std::bit_cast<int8_t>(u1At(pc + 1))); break;
+    case SIPUSH: pushInt(std::bit_cast<int16_t>(u2At(pc + 1))); break;
+    case ILOAD:
+    case LLOAD:
+    case FLOAD:
+    case DLOAD:
+    case ALOAD: load(u1At(pc + 1)); break;
+    case ILOAD_0:
+    case ILOAD_1:
+    case ILOAD_2:
+    case ILOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(ILOAD_0)); break;
+    case LLOAD_0:
+    case LLOAD_1:
+    case LLOAD_2:
+    case LLOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(LLOAD_0)); break;
+    case FLOAD_0:
+    case FLOAD_1:
+    case FLOAD_2:
+    case FLOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(FLOAD_0)); break;
+    case DLOAD_0:
+    case DLOAD_1:
+    case DLOAD_2:
+    case DLOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(DLOAD_0)); break;
+    case ALOAD_0:
+    case ALOAD_1:
+    case ALOAD_2:
+    case ALOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(ALOAD_0)); break;
+    case ISTORE:
+    case FSTORE:
+    case ASTORE: store(u1At(pc + 1), 1); break;
+    case LSTORE:
+    case DSTORE: store(u1At(pc + 1), 2); break;
+    case ISTORE_0:
+    case ISTORE_1:
+    case ISTORE_2:
+    case ISTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(ISTORE_0), 1); break;
+    case LSTORE_0:
+    case LSTORE_1:
+    case LSTORE_2:
+    case LSTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(LSTORE_0), 2); break;
+    case FSTORE_0:
+    case FSTORE_1:
+    case FSTORE_2:
+    case FSTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(FSTORE_0), 1); break;
+    case DSTORE_0:
+    case DSTORE_1:
+    case DSTORE_2:
+    case DSTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(DSTORE_0), 2); break;
+    case ASTORE_0:
+    case ASTORE_1:
+    case ASTORE_2:
+    case ASTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(ASTORE_0), 1); break;
+    case IALOAD:
+    case LALOAD:
+    case FALOAD:
+    case DALOAD:
+    case BALOAD:
+    case CALOAD:
+    case SALOAD: this->emitArrayLoad(opcode, pc, depth); break;
+    case IASTORE:
+    case LASTORE:
+    case FASTORE:
+    case DASTORE:
+    case BASTORE:
+    case CASTORE:
+    case SASTORE: this->emitArrayStore(opcode, pc, depth); break;
+    case POP:
+    case POP2:
+      // Only the stack depth changes
+      break;
+    case DUP:
+      mAssembler.mov64(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(slot(depth), Reg::RAX);
+      break;
+    case DUP_X1:
+      mAssembler.mov64(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(Reg::RCX, slot(depth - 2));
+      mAssembler.mov64(slot(depth - 2), Reg::RAX);
+      mAssembler.mov64(slot(depth - 1), Reg::RCX);
+      mAssembler.mov64(slot(depth), Reg::RAX);
+      break;
+    case DUP2:
+      mAssembler.mov64(Reg::RAX, slot(depth - 2));
+      mAssembler.mov64(Reg::RCX, slot(depth - 1));
+      mAssembler.mov64(slot(depth), Reg::RAX);
+      mAssembler.mov64(slot(depth + 1), Reg::RCX);
+      break;
+    case SWAP:
+      mAssembler.mov64(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(Reg::RCX, slot(depth - 2));
+      mAssembler.mov64(slot(depth - 2), Reg::RAX);
+      mAssembler.mov64(slot(depth - 1), Reg::RCX);
+      break;
+    case IADD:
+    case ISUB:
+    case IMUL:
+    case IAND:
+    case IOR:
+    case IXOR:
+    case ISHL:
+    case ISHR:
+    case IUSHR: this->emitIntBinary(opcode, depth); break;
+    case LADD:
+    case LSUB:
+    case LMUL:
+    case LAND:
+    case LOR:
+    case LXOR:
+    case LSHL:
+    case LSHR:
+    case LUSHR: this->emitLongBinary(opcode, depth); break;
+    case IDIV:
+    case IREM:
+    case LDIV:
+    case LREM: this->emitDivision(opcode, pc, depth); break;
+    case INEG:
+      mAssembler.mov32(Reg::RAX, slot(depth - 1));
+      mAssembler.neg32(Reg::RAX);
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    case LNEG:
+      mAssembler.mov64(Reg::RAX, slot(depth - 2));
+      mAssembler.neg64(Reg::RAX);
+      mAssembler.mov64(slot(depth - 2), Reg::RAX);
+      break;
+    case IINC: {
+      size_t index = u1At(pc + 1);
+      mAssembler.mov32(Reg::RAX, local(index));
+      mAssembler.movImm32(Reg::RCX, std::bit_cast<uint32_t>(static_cast<int32_t>(std::bit_cast<int8_t>(u1At(pc + 2)))));
+      mAssembler.add32(Reg::RAX, Reg::RCX);
+      mAssembler.mov64(local(index), Reg::RAX);
+      break;
+    }
+    case I2L:
+      mAssembler.movsxd(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    case L2I:
+      // 32-bit moves clear the upper half of the register
+      mAssembler.mov32(Reg::RAX, slot(depth - 2));
+      mAssembler.mov64(slot(depth - 2), Reg::RAX);
+      break;
+    case I2B:
+      mAssembler.movsx8(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    case I2C:
+      mAssembler.movzx16(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    case I2S:
+      mAssembler.movsx16(Reg::RAX, slot(depth - 1));
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    case LCMP:
+      // (value1 > value2) - (value1 < value2)
+      mAssembler.mov64(Reg::RAX, slot(depth - 4));
+      mAssembler.mov64(Reg::RCX, slot(depth - 2));
+      mAssembler.cmp64(Reg::RAX, Reg::RCX);
+      mAssembler.setcc(Cond::Greater, Reg::RDX);
+      mAssembler.setcc(Cond::Less, Reg::RCX);
+      mAssembler.movzx8(Reg::RAX, Reg::RDX);
+      mAssembler.movzx8(Reg::RCX, Reg::RCX);
+      mAssembler.sub32(Reg::RAX, Reg::RCX);
+      mAssembler.mov64(slot(depth - 4), Reg::RAX);
+      break;
+    case IFEQ:
+    case IFNE:
+    case IFLT:
+    case IFGE:
+    case IFGT:
+    case IFLE:
+    case IFNULL:
+    case IFNONNULL:
+    case IF_ICMPEQ:
+    case IF_ICMPNE:
+    case IF_ICMPLT:
+    case IF_ICMPGE:
+    case IF_ICMPGT:
+    case IF_ICMPLE:
+    case IF_ACMPEQ:
+    case IF_ACMPNE: this->emitBranch(opcode, pc, depth); break;
+    case GOTO:
+    case GOTO_W: this->emitJump(pc, std::nullopt); break;
+    case ARRAYLENGTH:
+      this->emitArrayCheck(pc, depth, depth - 1);
+      mAssembler.mov32(Reg::RAX, Mem{.base = Reg::RAX, .displacement = static_cast<int32_t>(ArrayInstance::lengthOffset())});
+      mAssembler.mov64(slot(depth - 1), Reg::RAX);
+      break;
+    default: GEEVM_UNREACHBLE("Instruction without a template");
+  }
+}
+
+void MethodCompiler::emitIntBinary(Opcode opcode, int32_t depth)
+{
+  // Results are computed in 32-bit registers, which zero-extends them to the representation of ints in stack slots
+  mAssembler.mov32(Reg::RAX, slot(depth - 2));
+  mAssembler.mov32(Reg::RCX, slot(depth - 1));
+
+  switch (opcode) {
+    using enum Opcode;
+    case IADD: mAssembler.add32(Reg::RAX, Reg::RCX); break;
+    case ISUB: mAssembler.sub32(Reg::RAX, Reg::RCX); break;
+    case IMUL: mAssembler.imul32(Reg::RAX, Reg::RCX); break;
+    case IAND: mAssembler.and32(Reg::RAX, Reg::RCX); break;
+    case IOR: mAssembler.or32(Reg::RAX, Reg::RCX); break;
+    case IXOR: mAssembler.xor32(Reg::RAX, Reg::RCX); break;
+    // Shift counts are masked to 5 bits by the processor, as in Java
+    case ISHL: mAssembler.shl32(Reg::RAX); break;
+    case ISHR: mAssembler.sar32(Reg::RAX); break;
+    case IUSHR: mAssembler.shr32(Reg::RAX); break;
+    default: GEEVM_UNREACHBLE("Not an int binary operator");
+  }
+
+  mAssembler.mov64(slot(depth - 2), Reg::RAX);
+}
+
+void MethodCompiler::emitLongBinary(Opcode opcode, int32_t depth)
+{
+  if (opcode == Opcode::LSHL || opcode == Opcode::LSHR || opcode == Opcode::LUSHR) {
+    // The shift count is an int on top of the long value, counts are masked to 6 bits by the processor
+    mAssembler.mov64(Reg::RAX, slot(depth - 3));
+    mAssembler.mov32(Reg::RCX, slot(depth - 1));
+    switch (opcode) {
+      case Opcode::LSHL: mAssembler.shl64(Reg::RAX); break;
+      case Opcode::LSHR: mAssembler.sar64(Reg::RAX); break;
+      default: mAssembler.shr64(Reg::RAX); break;
+    }
+    mAssembler.mov64(slot(depth - 3), Reg::RAX);
+    return;
+  }
+
+  mAssembler.mov64(Reg::RAX, slot(depth - 4));
+  mAssembler.mov64(Reg::RCX, slot(depth - 2));
+
+  switch (opcode) {
+    using enum Opcode;
+    case LADD: mAssembler.add64(Reg::RAX, Reg::RCX); break;
+    case LSUB: mAssembler.sub64(Reg::RAX, Reg::RCX); break;
+    case LMUL: mAssembler.imul64(Reg::RAX, Reg::RCX); break;
+    case LAND: mAssembler.and64(Reg::RAX, Reg::RCX); break;
+    case LOR: mAssembler.or64(Reg::RAX, Reg::RCX); break;
+    case LXOR: mAssembler.xor64(Reg::RAX, Reg::RCX); break;
+    default: GEEVM_UNREACHBLE("Not a long binary operator");
+  }
+
+  mAssembler.mov64(slot(depth - 4), Reg::RAX);
+}
+
+void MethodCompiler::emitDivision(Opcode opcode, int64_t pc, int32_t depth)
+{
+  bool isLong = opcode == Opcode::LDIV || opcode == Opcode::LREM;
+  bool isRemainder = opcode == Opcode::IREM || opcode == Opcode::LREM;
+  int32_t dividendSlot = isLong ? depth - 4 : depth - 2;
+
+  X86Assembler::Label minusOne;
+  X86Assembler::Label done;
+
+  if (isLong) {
+    mAssembler.mov64(Reg::RAX, slot(dividendSlot));
+    mAssembler.mov64(Reg::RCX, slot(depth - 2));
+    mAssembler.test64(Reg::RCX, Reg::RCX);
+  } else {
+    mAssembler.mov32(Reg::RAX, slot(dividendSlot));
+    mAssembler.mov32(Reg::RCX, slot(depth - 1));
+    mAssembler.test32(Reg::RCX, Reg::RCX);
+  }
+  // The interpreter throws the ArithmeticException
+  mAssembler.jcc(Cond::Equal, this->exitLabel(pc, depth));
+
+  // Dividing the minimum value by -1 overflows, which traps on x86 but wraps around in Java
+  if (isLong) {
+    mAssembler.cmpImm64(Reg::RCX, -1);
+  } else {
+    mAssembler.cmpImm32(Reg::RCX, -1);
+  }
+  mAssembler.jcc(Cond::Equal, minusOne);
+
+  if (isLong) {
+    mAssembler.cqo();
+    mAssembler.idiv64(Reg::RCX);
+  } else {
+    mAssembler.cdq();
+    mAssembler.idiv32(Reg::RCX);
+  }
+  if (isRemainder) {
+    mAssembler.mov64(Reg::RAX, Reg::RDX);
+  }
+  mAssembler.jmp(done);
+
+  mAssembler.bind(minusOne);
+  if (isRemainder) {
+    mAssembler.xor32(Reg::RAX, Reg::RAX);
+  } else if (isLong) {
+    mAssembler.neg64(Reg::RAX);
+  } else {
+    mAssembler.neg32(Reg::RAX);
+  }
+
+  mAssembler.bind(done);
+  mAssembler.mov64(slot(dividendSlot), Reg::RAX);
+}
+
+void MethodCompiler::emitArrayCheck(int64_t pc, int32_t depth, int32_t arraySlot)
+{
+  // Leaves the array reference in RAX. The interpreter throws the NullPointerException.
+  mAssembler.mov64(Reg::RAX, slot(arraySlot));
+  mAssembler.test64(Reg::RAX, Reg::RAX);
+  mAssembler.jcc(Cond::Equal, this->exitLabel(pc, depth));
+}
+
+void MethodCompiler::emitArrayLoad(Opcode opcode, int64_t pc, int32_t depth)
+{
+  int32_t arraySlot = depth - 2;
+  this->emitArrayCheck(pc, depth, arraySlot);
+
+  // An unsigned comparison against the length also rejects negative indices. The upper half of RCX is zero, so
+  // the index can be used for addressing as is.
+  mAssembler.mov32(Reg::RCX, slot(depth - 1));
+  mAssembler.cmp32(Reg::RCX, Mem{.base = Reg::RAX, .displacement = static_cast<int32_t>(ArrayInstance::lengthOffset())});
+  mAssembler.jcc(Cond::AboveEqual, this->exitLabel(pc, depth));
+
+  switch (opcode) {
+    using enum Opcode;
+    case IALOAD:
+    case FALOAD: mAssembler.mov32(Reg::RAX, arrayElement(Reg::RAX, Reg::RCX, 4)); break;
+    case LALOAD:
+    case DALOAD: mAssembler.mov64(Reg::RAX, arrayElement(Reg::RAX, Reg::RCX, 8)); break;
+    case BALOAD: mAssembler.movsx8(Reg::RAX, arrayElement(Reg::RAX, Reg::RCX, 1)); break;
+    case CALOAD: mAssembler.movzx16(Reg::RAX, arrayElement(Reg::RAX, Reg::RCX, 2)); break;
+    case SALOAD: mAssembler.movsx16(Reg::RAX, arrayElement(Reg::RAX, Reg::RCX, 2)); break;
+    default: GEEVM_UNREACHBLE("Not a primitive array load");
+  }
+
+  mAssembler.mov64(slot(arraySlot), Reg::RAX);
+}
+
+void MethodCompiler::emitArrayStore(Opcode opcode, int64_t pc, int32_t depth)
+{
+  bool isCategoryTwo = opcode == Opcode::LASTORE || opcode == Opcode::DASTORE;
+  int32_t valueSlot = isCategoryTwo ? depth - 2 : depth - 1;
+  int32_t arraySlot = valueSlot - 2;
+  this->emitArrayCheck(pc, depth, arraySlot);
+
+  mAssembler.mov32(Reg::RCX, slot(arraySlot + 1));
+  mAssembler.cmp32(Reg::RCX, Mem{.base = Reg::RAX, .displacement = static_cast<int32_t>(ArrayInstance::lengthOffset())});
+  mAssembler.jcc(Cond::AboveEqual, this->exitLabel(pc, depth));
+
+  switch (opcode) {
+    using enum Opcode;
+    case IASTORE:
+    case FASTORE:
+      mAssembler.mov32(Reg::RDX, slot(valueSlot));
+      mAssembler.mov32(arrayElement(Reg::RAX, Reg::RCX, 4), Reg::RDX);
+      break;
+    case LASTORE:
+    case DASTORE:
+      mAssembler.mov64(Reg::RDX, slot(valueSlot));
+      mAssembler.mov64(arrayElement(Reg::RAX, Reg::RCX, 8), Reg::RDX);
+      break;
+    case BASTORE:
+      mAssembler.mov32(Reg::RDX, slot(valueSlot));
+      mAssembler.mov8(arrayElement(Reg::RAX, Reg::RCX, 1), Reg::RDX);
+      break;
+    case CASTORE:
+    case SASTORE:
+      mAssembler.mov32(Reg::RDX, slot(valueSlot));
+      mAssembler.mov16(arrayElement(Reg::RAX, Reg::RCX, 2), Reg::RDX);
+      break;
+    default: GEEVM_UNREACHBLE("Not a primitive array store");
+  }
+}
+
+void MethodCompiler::emitBranch(Opcode opcode, int64_t pc, int32_t depth)
+{
+  using enum Opcode;
+
+  Cond cond;
+  switch (opcode) {
+    case IFEQ:
+    case IF_ICMPEQ:
+    case IF_ACMPEQ:
+    case IFNULL: cond = Cond::Equal; break;
+    case IFNE:
+    case IF_ICMPNE:
+    case IF_ACMPNE:
+    case IFNONNULL: cond = Cond::NotEqual; break;
+    case IFLT:
+    case IF_ICMPLT: cond = Cond::Less; break;
+    case IFGE:
+    case IF_ICMPGE: cond = Cond::GreaterEqual; break;
+    case IFGT:
+    case IF_ICMPGT: cond = Cond::Greater; break;
+    case IFLE:
+    case IF_ICMPLE: cond = Cond::LessEqual; break;
+    default: GEEVM_UNREACHBLE("Not a conditional branch");
+  }
+
+  if (opcode == IFNULL || opcode == IFNONNULL) {
+    mAssembler.mov64(Reg::RAX, slot(depth - 1));
+    mAssembler.test64(Reg::RAX, Reg::RAX);
+  } else if (opcode == IF_ACMPEQ || opcode == IF_ACMPNE) {
+    mAssembler.mov64(Reg::RAX, slot(depth - 2));
+    mAssembler.mov64(Reg::RCX, slot(depth - 1));
+    mAssembler.cmp64(Reg::RAX, Reg::RCX);
+  } else if (opcode >= IF_ICMPEQ) {
+    mAssembler.mov32(Reg::RAX, slot(depth - 2));
+    mAssembler.mov32(Reg::RCX, slot(depth - 1));
+    mAssembler.cmp32(Reg::RAX, Reg::RCX);
+  } else {
+    mAssembler.mov32(Reg::RAX, slot(depth - 1));
+    mAssembler.test32(Reg::RAX, Reg::RAX);
+  }
+
+  this->emitJump(pc, cond);
+}
+
+void MethodCompiler::emitJump(int64_t pc, std::optional<Cond> cond)
+{
+  int64_t target = branchTarget(pc);
+  if (target > pc) {
+    if (cond.has_value()) {
+      mAssembler.jcc(*cond, mLabels[target]);
+    } else {
+      mAssembler.jmp(mLabels[target]);
+    }
+    return;
+  }
+
+  // Taken backward branches are counted like in the interpreter, so that methods spending their time in loops of
+  // baseline code still reach the threshold of the optimizing compiler
+  if (mBackedgeCounter == nullptr) {
+    if (cond.has_value()) {
+      mAssembler.jcc(*cond, mLabels[target]);
+    } else {
+      mAssembler.jmp(mLabels[target]);
+    }
+    return;
+  }
+
+  X86Assembler::Label notTaken;
+  if (cond.has_value()) {
+    mAssembler.jcc(negate(*cond), notTaken);
+  }
+  mAssembler.movImm64(Reg::RAX, reinterpret_cast<uint64_t>(mBackedgeCounter));
+  mAssembler.addImm32(Mem{.base = Reg::RAX}, 1);
+  if (mTierUpThreshold.has_value()) {
+    // Leave to the interpreter at the loop header once when the counter reaches the threshold, so that it replaces
+    // this loop with optimized code on its next backward branch
+    mAssembler.cmpImm32(Mem{.base = Reg::RAX}, static_cast<int32_t>(*mTierUpThreshold));
+    mAssembler.jcc(Cond::Equal, this->exitLabel(target, mDepths[target]));
+  }
+  mAssembler.jmp(mLabels[target]);
+  mAssembler.bind(notTaken);
+}
+
+} // namespace
+
+void* BaselineCompiler::compile(JMethod& method)
+{
+  assert(!method.isNative() && !method.isAbstract());
+
+  void* code = nullptr;
+  MethodCompiler compiler(method, method.backedgeCounter(), mTierUpThreshold, 0, 0);
+  if (compiler.compile()) {
+    code = mCodeCache.install(compiler.code());
+  }
+
+  if (code == nullptr) {
+    method.markNotCompilable(CompilationTier::Baseline);
+  } else {
+    method.setCompiledCode(code, CompilationTier::Baseline);
+  }
+
+  return code;
+}
+
+void* BaselineCompiler::compileOsr(JMethod& method, int64_t pc, int32_t depth)
+{
+  assert(!method.isNative() && !method.isAbstract());
+
+  void* code = nullptr;
+  MethodCompiler compiler(method, method.backedgeCounter(), mTierUpThreshold, pc, depth);
+  if (compiler.compile()) {
+    code = mCodeCache.install(compiler.code());
+  }
+
+  OsrEntry& entry = method.osrEntry(pc);
+  if (code == nullptr) {
+    entry.markNotCompilable(CompilationTier::Baseline);
+  } else {
+    entry.code = code;
+    entry.tier = CompilationTier::Baseline;
+  }
+
+  return code;
+}
+
+std::optional<std::vector<types::u1>> BaselineCompiler::compileRelocatable(JMethod& method)
+{
+  assert(!method.isNative() && !method.isAbstract());
+
+  MethodCompiler compiler(method, nullptr, std::nullopt, 0, 0);
+  if (!compiler.compile()) {
+    return std::nullopt;
+  }
+
+  return compiler.code();
+}
@@ -0,0 +1,68 @@
+#ifndef GEEVM_VM_BASELINECOMPILER_H
+#define GEEVM_VM_BASELINECOMPILER_H
+
+#include "vm/CodeCache.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace geevm
+{
+
+class JMethod;
+
+/// Template compiler translating the bytecode of hot methods into x86-64 machine code.
+///
+/// Every bytecode instruction is expanded into a fixed machine code sequence operating directly on the local variable
+/// array and the operand stack of the interpreter's call frame, so compiled code and the interpreter share the same
+/// frame layout and can hand over execution at any instruction boundary. The compiler only handles instructions that
+/// cannot allocate, call or throw: constants, local variable access, integer and long arithmetic, stack manipulation,
+/// branches and primitive array accesses. Any other instruction, returns, and runtime checks that fail (null array
+/// references, out of range indices, division by zero) end compiled code and return the bytecode offset and operand
+/// stack depth to continue from to the interpreter, which then executes the instruction as usual.
+///
+/// Code is entered through `runCompiledCode`, either at the start of a method or at a loop header for on-stack
+/// replacement of a running interpreted loop. Backward branches increment the counter of the method, and if a tier-up
+/// threshold is set, leave to the interpreter once the counter reaches it, so that the loop can continue in optimized
+/// code.
+class BaselineCompiler
+{
+public:
+  /// Returns true if compiled code can be executed on the host architecture.
+  static constexpr bool isSupported()
+  {
+#ifdef __x86_64__
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  BaselineCompiler(CodeCache& codeCache, std::optional<uint32_t> tierUpThreshold)
+    : mCodeCache(codeCache), mTierUpThreshold(tierUpThreshold)
+  {
+  }
+
+  /// Compiles \p method and installs the code into the method. If the method cannot be compiled, or the code cache is
+  /// full, the method is marked as not compilable by this tier and nullptr is returned.
+  void* compile(JMethod& method);
+
+  /// Compiles an OSR entry of \p method for the loop header at \p pc, where the interpreter has \p depth values on
+  /// the operand stack, and installs it into the OSR entries of the method. If it cannot be compiled, the loop header
+  /// is marked as not compilable by this tier and nullptr is returned.
+  void* compileOsr(JMethod& method, int64_t pc, int32_t depth);
+
+  /// Compiles \p method into position-independent code for ahead-of-time compilation, or returns an empty optional if
+  /// the method cannot be compiled. The code is not installed and does not count backward branches, as it cannot refer
+  /// to the method.
+  static std::optional<std::vector<types::u1>> compileRelocatable(JMethod& method);
+
+private:
+  CodeCache& mCodeCache;
+  std::optional<uint32_t> mTierUpThreshold;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_BASELINECOMPILER_H
@@ -9,10 +9,15 @@
 using namespace geevm;
 
 JClass::JClass(Kind kind, types::JString className)
-  : mKind(kind), mStatus(Status::Allocated), mClassName(std::move(className))
+  : mKind(kind), mStatus(Status::Allocated), mClassName(std::move(className)), mClassId(ClassTable::add(this))
 {
 }
 
+JClass::~JClass()
+{
+  ClassTable::remove(mClassId);
+}
+
 ArrayClass* JClass::asArrayClass()
 {
   if (mKind == Kind::Array) {
@@ -85,7 +90,7 @@ void JClass::prepare(BootstrapClassLoader& classLoader, JavaHeap& heap)
   }
 
   auto classClass = classLoader.loadClass(u"java/lang/Class");
-  mClassInstance = heap.gc().pin(heap.allocate<ClassInstance>((*classClass)->asInstanceClass(), this)).release();
+  mClassInstance = heap.gc().immortalRef(heap.allocateImmortal<ClassInstance>((*classClass)->asInstanceClass(), this));
 
   if (auto arrayClass = this->asArrayClass(); arrayClass != nullptr) {
     ClassInstance* elementClass = arrayClass->elementClass()
@@ -95,6 +100,8 @@ void JClass::prepare(BootstrapClassLoader& classLoader, JavaHeap& heap)
     mClassInstance->setFieldValue<Instance*>(u"componentType", u"Ljava/lang/Class;", elementClass);
   }
 
+  classLoader.classHierarchy().addClass(this);
+
   mStatus = Status::Prepared;
 }
 
@@ -155,18 +162,40 @@ void JClass::initialize(JavaThread& thread)
 
 void InstanceClass::linkFields()
 {
+  // The fields of java/lang/Class are linked early during VM startup and again when the class is prepared,
+  // so any previous layout is discarded first.
+  std::erase_if(mFields, [](const auto& entry) {
+    return !entry.second->isStatic();
+  });
+  mInstanceFields.clear();
+  mFieldGaps.clear();
+
   size_t currentOffset = this->headerSize();
-  if (this->superClass() != nullptr) {
-    for (auto& [name, field] : this->superClass()->fields()) {
-      if (!field->isStatic()) {
-        size_t fieldSize = field->fieldType().sizeOf();
-        currentOffset = alignTo(currentOffset, fieldSize);
-        mFields.try_emplace(name, std::make_unique<JField>(field->fieldInfo(), this, name.first, name.second, field->fieldType(), currentOffset));
-        currentOffset += fieldSize;
-      }
+
+  // Inherited fields keep their offsets, so that code compiled against the superclass layout stays valid.
+  if (auto superClass = this->superClass(); superClass != nullptr) {
+    for (JField* field : superClass->instanceFields()) {
+      NameAndDescriptor key{field->name(), field->descriptor()};
+      auto [it, _] = mFields.try_emplace(key, std::make_unique<JField>(field->fieldInfo(), this, field->name(), field->descriptor(),
+                                                                       field->fieldType(), field->offset()));
+      mInstanceFields.push_back(it->second.get());
     }
+
+    const InstanceClass* superInstanceClass = superClass->asInstanceClass();
+    currentOffset = std::max(currentOffset, superInstanceClass->allocationSize());
+    mFieldGaps = superInstanceClass->mFieldGaps;
   }
 
+  struct PendingField
+  {
+    const FieldInfo* info;
+    types::JStringRef name;
+    types::JStringRef descriptor;
+    FieldType fieldType;
+    size_t size;
+  };
+
+  std::vector<PendingField> declared;
   for (const FieldInfo& field : mClassFile->fields()) {
     if (hasAccessFlag(field.accessFlags(), FieldAccessFlags::ACC_STATIC)) {
       continue;
@@ -178,14 +207,64 @@ void InstanceClass::linkFields()
     assert(fieldType.has_value());
 
     size_t fieldSize = fieldType->sizeOf();
-    currentOffset = alignTo(currentOffset, fieldSize);
-    auto jfield = std::make_unique<JField>(field, this, types::JString{fieldName}, types::JString{descriptor}, *fieldType, currentOffset);
-    currentOffset += fieldSize;
+    declared.push_back(PendingField{&field, fieldName, descriptor, *fieldType, fieldSize});
+  }
+
+  // Pack the largest fields first so that no padding is needed between them. References are placed before
+  // primitives of the same size, which keeps them contiguous for the garbage collector. The sort is stable,
+  // so the layout only depends on the class file.
+  std::ranges::stable_sort(declared, [](const PendingField& lhs, const PendingField& rhs) {
+    if (lhs.size != rhs.size) {
+      return lhs.size > rhs.size;
+    }
+    return lhs.fieldType.isReferenceOrArray() && !rhs.fieldType.isReferenceOrArray();
+  });
+
+  for (PendingField& field : declared) {
+    NameAndDescriptor key{field.name, field.descriptor};
+    if (mFields.contains(key)) {
+      continue;
+    }
+
+    std::optional<size_t> offset;
 
-    NameAndDescriptor key{fieldName, descriptor};
+    // Primitive fields may be placed in a gap left by alignment
+    if (!field.fieldType.isReferenceOrArray()) {
+      for (auto it = mFieldGaps.begin(); it != mFieldGaps.end(); ++it) {
+        auto [gapStart, gapEnd] = *it;
+        size_t aligned = alignTo(gapStart, field.size);
+        if (aligned + field.size > gapEnd) {
+          continue;
+        }
+
+        offset = aligned;
+        it = mFieldGaps.erase(it);
+        if (aligned + field.size < gapEnd) {
+          it = mFieldGaps.insert(it, {aligned + field.size, gapEnd});
+        }
+        if (gapStart < aligned) {
+          mFieldGaps.insert(it, {gapStart, aligned});
+        }
+        break;
+      }
+    }
+
+    if (!offset.has_value()) {
+      size_t aligned = alignTo(currentOffset, field.size);
+      if (currentOffset < aligned) {
+        mFieldGaps.emplace_back(currentOffset, aligned);
+      }
+      offset = aligned;
+      currentOffset = aligned + field.size;
+    }
+
+    auto jfield = std::make_unique<JField>(*field.info, this, types::JString{field.name}, types::JString{field.descriptor}, field.fieldType, *offset);
+    mInstanceFields.push_back(jfield.get());
     mFields.try_emplace(key, std::move(jfield));
   }
 
+  std::ranges::sort(mInstanceFields, {}, &JField::offset);
+
   mAllocationSize = currentOffset;
 }
 
@@ -254,8 +333,9 @@ void InstanceClass::prepareMethods()
     // TODO: Verification error
     assert(parsedDescriptor.has_value() && "Cannot parse descriptor");
 
-    mMethods.try_emplace(NameAndDescriptor{name, descriptor},
-                         std::make_unique<JMethod>(method, this, types::JString{name}, types::JString{descriptor}, *parsedDescriptor));
+    auto jmethod = std::make_unique<JMethod>(method, this, types::JString{name}, types::JString{descriptor}, *parsedDescriptor);
+    jmethod->setIntrinsic(findIntrinsic(this->className(), name, descriptor));
+    mMethods.try_emplace(NameAndDescriptor{name, descriptor}, std::move(jmethod));
   }
 }
 
@@ -454,6 +534,15 @@ bool JClass::isInterface() const
   return false;
 }
 
+bool JClass::isFinal() const
+{
+  if (auto instanceClass = this->asInstanceClass(); instanceClass) {
+    return hasAccessFlag(instanceClass->mClassFile->accessFlags(), ClassAccessFlags::ACC_FINAL);
+  }
+  // Array classes cannot be extended
+  return true;
+}
+
 bool JClass::isClassType() const
 {
   if (auto instanceClass = this->asInstanceClass(); instanceClass) {
@@ -525,6 +614,5 @@ GcRootRef<ClassInstance> JClass::classInstance() const
 std::size_t ArrayClass::allocationSize(int32_t length) const
 {
   assert(length >= 0);
-  auto elementType = this->fieldType().asArrayType()->getElementType();
-  return this->headerSize() + length * elementType.sizeOf();
+  return sizeof(ArrayInstance) + length * mElementSize;
 }
@@ -49,7 +49,7 @@ public:
   JClass(const JClass&) = delete;
   JClass& operator=(const JClass&) = delete;
 
-  virtual ~JClass() = default;
+  virtual ~JClass();
 
   // Basic class metadata
   //==----------------------------------------------------------------------==//
@@ -73,6 +73,12 @@ public:
   GcRootRef<ClassInstance> classInstance() const;
   void setClassInstance(ClassInstance* instance);
 
+  /// The ID of this class in the class table, as stored in the headers of its instances.
+  uint32_t classId() const
+  {
+    return mClassId;
+  }
+
   // Methods and fields
   //==----------------------------------------------------------------------==//
   std::optional<JMethod*> getMethod(const types::JString& name, const types::JString& descriptor);
@@ -107,21 +113,26 @@ public:
   std::optional<JField*> lookupField(const types::JString& name, const types::JString& descriptor);
   std::optional<JField*> lookupFieldByName(types::JStringRef string);
 
+  /// Returns the methods declared by this class.
+  const std::unordered_map<NameAndDescriptor, std::unique_ptr<JMethod>, PairHash>& methods() const
+  {
+    return mMethods;
+  }
+
   const std::unordered_map<NameAndDescriptor, std::unique_ptr<JField>, PairHash>& fields() const
   {
     return mFields;
   }
 
+  /// Returns all instance fields of this class (including inherited ones), ordered by their offset.
+  const std::vector<JField*>& instanceFields() const
+  {
+    return mInstanceFields;
+  }
+
   size_t numInstanceFields() const
   {
-    // TODO: This should be a constant operation
-    size_t count = 0;
-    for (auto& [key, field] : mFields) {
-      if (!field->isStatic()) {
-        count++;
-      }
-    }
-    return count;
+    return mInstanceFields.size();
   }
 
   // Static polymorphism
@@ -146,6 +157,7 @@ public:
     return mKind == Kind::Array;
   }
   bool isInterface() const;
+  bool isFinal() const;
 
   bool isInstanceOf(const JClass* other) const;
   bool hasSuperInterface(const JClass* other) const;
@@ -178,6 +190,7 @@ protected:
 
 private:
   types::JString mClassName;
+  uint32_t mClassId;
   JClass* mSuperClass = nullptr;
   std::vector<JClass*> mSuperInterfaces;
 
@@ -220,6 +233,12 @@ public:
     return std::nullopt;
   }
 
+  /// Hash of the class file this class was loaded from.
+  uint64_t classFileHash() const
+  {
+    return mClassFile->contentHash();
+  }
+
 private:
   void initializeRuntimeConstantPool(JavaHeap& heap, BootstrapClassLoader& classLoader);
   Value getInitialFieldValue(const FieldType& fieldType, types::u2 cvIndex);
@@ -234,6 +253,8 @@ private:
   std::unique_ptr<ClassFile> mClassFile;
   std::unique_ptr<RuntimeConstantPool> mRuntimeConstantPool;
   size_t mAllocationSize;
+  // Unused [offset, end) ranges left between instance fields due to alignment, which may be filled by subclass fields
+  std::vector<std::pair<size_t, size_t>> mFieldGaps;
 };
 
 class ArrayClass : public JClass
@@ -242,7 +263,8 @@ class ArrayClass : public JClass
 
 public:
   explicit ArrayClass(types::JString className, FieldType type)
-    : JClass(Kind::Array, std::move(className)), mType(std::move(type))
+    : JClass(Kind::Array, std::move(className)), mType(std::move(type)), mElementType(mType.asArrayType()->getElementType()),
+      mElementSize(mElementType.sizeOf())
   {
   }
 
@@ -251,6 +273,11 @@ public:
     return mType;
   }
 
+  const FieldType& elementType() const
+  {
+    return mElementType;
+  }
+
   std::optional<JClass*> elementClass() const
   {
     return mElementClass;
@@ -260,6 +287,9 @@ public:
 
 private:
   FieldType mType;
+  // The element type and its size are cached, as they are needed for every array allocation
+  FieldType mElementType;
+  size_t mElementSize;
   std::optional<JClass*> mElementClass = std::nullopt;
 };
 
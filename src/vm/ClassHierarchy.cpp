@@ -0,0 +1,46 @@
+#include "vm/ClassHierarchy.h"
+#include "vm/Class.h"
+#include "vm/Method.h"
+
+using namespace geevm;
+
+static bool canBeOverridden(const JMethod* method)
+{
+  return !method->isStatic() && !method->isPrivate() && !method->name().starts_with(u"<");
+}
+
+void ClassHierarchy::addClass(JClass* klass)
+{
+  if (!klass->isClassType()) {
+    // Only classes can override methods of their superclasses
+    return;
+  }
+
+  for (const auto& [key, method] : klass->methods()) {
+    if (!canBeOverridden(method.get())) {
+      continue;
+    }
+
+    auto& [name, descriptor] = key;
+    for (JClass* superClass = klass->superClass(); superClass != nullptr; superClass = superClass->superClass()) {
+      if (auto overridden = superClass->getMethod(name, descriptor); overridden.has_value() && canBeOverridden(*overridden)) {
+        (*overridden)->markOverridden();
+        // Methods further up the hierarchy were marked when the class declaring the overridden method was added
+        break;
+      }
+    }
+  }
+}
+
+JMethod* ClassHierarchy::uniqueTarget(JMethod* method)
+{
+  if (method->isPrivate() || method->isFinal() || method->getClass()->isFinal()) {
+    return method;
+  }
+
+  if (method->isAbstract() || method->getClass()->isInterface() || method->isOverridden()) {
+    return nullptr;
+  }
+
+  return method;
+}
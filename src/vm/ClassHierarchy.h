@@ -0,0 +1,29 @@
+#ifndef GEEVM_VM_CLASSHIERARCHY_H
+#define GEEVM_VM_CLASSHIERARCHY_H
+
+namespace geevm
+{
+
+class JClass;
+class JMethod;
+
+/// Class hierarchy analysis over the loaded classes, used to devirtualize `invokevirtual` call sites.
+///
+/// Whenever a class is prepared, every method of a superclass that it overrides is marked as overridden. A virtual
+/// method that is final, private, declared in a final class or not overridden by any loaded class can only dispatch
+/// to itself, as no receiver of another class exists yet. Marking a method as overridden invalidates all call
+/// sites bound to it, as they query `uniqueTarget` on every call.
+class ClassHierarchy
+{
+public:
+  /// Records a newly prepared class, marking all superclass methods it overrides.
+  void addClass(JClass* klass);
+
+  /// Returns the only method a virtual call of \p method can dispatch to given the currently loaded classes, or
+  /// nullptr if the target depends on the receiver class.
+  static JMethod* uniqueTarget(JMethod* method);
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_CLASSHIERARCHY_H
@@ -52,6 +52,9 @@ JvmExpected<JClass*> BootstrapClassLoader::loadClass(const types::JString& name)
 
   klass->initializeRuntimeConstantPool(mVm.heap(), *this);
   klass->prepare(*this, mVm.heap());
+  if (ProfileStore* profiles = mVm.profiles(); profiles != nullptr) {
+    profiles->apply(*klass);
+  }
 
   return result->second.get();
 }
@@ -4,6 +4,7 @@
 #include "common/JvmError.h"
 #include "common/JvmTypes.h"
 #include "vm/Class.h"
+#include "vm/ClassHierarchy.h"
 #include "vm/ClassPath.h"
 
 namespace geevm
@@ -41,6 +42,12 @@ public:
 
   void registerClassLoader(std::unique_ptr<ClassLoader> classLoader);
 
+  /// Hierarchy analysis of all classes loaded by this class loader, updated whenever a class is prepared.
+  ClassHierarchy& classHierarchy()
+  {
+    return mClassHierarchy;
+  }
+
   using class_iterator = std::unordered_map<types::JString, std::unique_ptr<JClass>>::const_iterator;
   decltype(auto) loadedClasses()
   {
@@ -55,6 +62,7 @@ private:
   ClassPath mClassPath;
   std::vector<std::unique_ptr<ClassLoader>> mClassLoaders;
   std::unordered_map<types::JString, std::unique_ptr<JClass>> mClasses;
+  ClassHierarchy mClassHierarchy;
 };
 
 class BaseClassLoader : public ClassLoader
@@ -0,0 +1,54 @@
+#include "vm/CodeCache.h"
+
+#include "common/JvmError.h"
+#include "common/Memory.h"
+
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace geevm;
+
+// Entry points are aligned to a cache line, which keeps short methods from straddling two lines
+static constexpr size_t CodeAlignment = 64;
+
+CodeCache::CodeCache(size_t reservedSize)
+  : mReservedSize(reservedSize)
+{
+  // Both views map the same anonymous file, pages are only allocated once code is written to them
+  int fd = ::memfd_create("geevm-code-cache", MFD_CLOEXEC);
+  if (fd < 0 || ::ftruncate(fd, static_cast<off_t>(mReservedSize)) != 0) {
+    geevm_panic("failed to reserve memory for the code cache");
+  }
+
+  void* writable = ::mmap(nullptr, mReservedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_NORESERVE, fd, 0);
+  void* executable = ::mmap(nullptr, mReservedSize, PROT_READ | PROT_EXEC, MAP_SHARED | MAP_NORESERVE, fd, 0);
+  ::close(fd);
+  if (writable == MAP_FAILED || executable == MAP_FAILED) {
+    geevm_panic("failed to reserve memory for the code cache");
+  }
+
+  mRegion = static_cast<char*>(executable);
+  mWritableRegion = static_cast<char*>(writable);
+  mBumpPtr = mRegion;
+}
+
+void* CodeCache::install(std::span<const types::u1> code)
+{
+  size_t adjustedSize = alignTo(code.size(), CodeAlignment);
+  if (mBumpPtr + adjustedSize > mRegion + mReservedSize) {
+    return nullptr;
+  }
+
+  void* entry = mBumpPtr;
+  std::memcpy(mWritableRegion + (mBumpPtr - mRegion), code.data(), code.size());
+  mBumpPtr += adjustedSize;
+
+  return entry;
+}
+
+CodeCache::~CodeCache()
+{
+  ::munmap(mRegion, mReservedSize);
+  ::munmap(mWritableRegion, mReservedSize);
+}
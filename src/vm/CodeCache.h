@@ -0,0 +1,46 @@
+#ifndef GEEVM_VM_CODECACHE_H
+#define GEEVM_VM_CODECACHE_H
+
+#include "common/JvmTypes.h"
+
+#include <span>
+
+namespace geevm
+{
+
+/// Executable memory for compiled methods.
+///
+/// A single address range is reserved up front and code is bump-allocated from it. Compiled code is never freed, as
+/// classes are never unloaded. The memory of the cache is mapped twice: code is copied into a writable view and executed
+/// from an executable view, so no page is ever writable and executable at the same time, and installing code does not
+/// change the protection of pages other threads may be executing.
+class CodeCache
+{
+public:
+  explicit CodeCache(size_t reservedSize);
+
+  CodeCache(const CodeCache&) = delete;
+  CodeCache& operator=(const CodeCache&) = delete;
+
+  ~CodeCache();
+
+  /// Copies \p code into the cache and returns its entry point, or nullptr if the cache is full.
+  void* install(std::span<const types::u1> code);
+
+  size_t usedSize() const
+  {
+    return mBumpPtr - mRegion;
+  }
+
+private:
+  // Executable view of the cache, which entry points point into
+  char* mRegion;
+  // Writable view of the same memory
+  char* mWritableRegion;
+  char* mBumpPtr;
+  size_t mReservedSize;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_CODECACHE_H
@@ -0,0 +1,176 @@
+#include "vm/CompiledCode.h"
+#include "vm/Frame.h"
+
+#include <bit>
+#include <cassert>
+
+using namespace geevm;
+
+std::optional<StackEffect> geevm::compiledStackEffect(Opcode opcode)
+{
+  switch (opcode) {
+    using enum Opcode;
+    case NOP: return StackEffect{1, 0, 0};
+    case ACONST_NULL:
+    case ICONST_M1:
+    case ICONST_0:
+    case ICONST_1:
+    case ICONST_2:
+    case ICONST_3:
+    case ICONST_4:
+    case ICONST_5:
+    case FCONST_0:
+    case FCONST_1:
+    case FCONST_2: return StackEffect{1, 0, 1};
+    case LCONST_0:
+    case LCONST_1:
+    case DCONST_0:
+    case DCONST_1: return StackEffect{1, 0, 2};
+    case BIPUSH: return StackEffect{2, 0, 1};
+    case SIPUSH: return StackEffect{3, 0, 1};
+    case ILOAD:
+    case FLOAD:
+    case ALOAD: return StackEffect{2, 0, 1};
+    case LLOAD:
+    case DLOAD: return StackEffect{2, 0, 2};
+    case ILOAD_0:
+    case ILOAD_1:
+    case ILOAD_2:
+    case ILOAD_3:
+    case FLOAD_0:
+    case FLOAD_1:
+    case FLOAD_2:
+    case FLOAD_3:
+    case ALOAD_0:
+    case ALOAD_1:
+    case ALOAD_2:
+    case ALOAD_3: return StackEffect{1, 0, 1};
+    case LLOAD_0:
+    case LLOAD_1:
+    case LLOAD_2:
+    case LLOAD_3:
+    case DLOAD_0:
+    case DLOAD_1:
+    case DLOAD_2:
+    case DLOAD_3: return StackEffect{1, 0, 2};
+    case ISTORE:
+    case FSTORE:
+    case ASTORE: return StackEffect{2, 1, 0};
+    case LSTORE:
+    case DSTORE: return StackEffect{2, 2, 0};
+    case ISTORE_0:
+    case ISTORE_1:
+    case ISTORE_2:
+    case ISTORE_3:
+    case FSTORE_0:
+    case FSTORE_1:
+    case FSTORE_2:
+    case FSTORE_3:
+    case ASTORE_0:
+    case ASTORE_1:
+    case ASTORE_2:
+    case ASTORE_3: return StackEffect{1, 1, 0};
+    case LSTORE_0:
+    case LSTORE_1:
+    case LSTORE_2:
+    case LSTORE_3:
+    case DSTORE_0:
+    case DSTORE_1:
+    case DSTORE_2:
+    case DSTORE_3: return StackEffect{1, 2, 0};
+    case IALOAD:
+    case FALOAD:
+    case BALOAD:
+    case CALOAD:
+    case SALOAD: return StackEffect{1, 2, 1};
+    case LALOAD:
+    case DALOAD: return StackEffect{1, 2, 2};
+    case IASTORE:
+    case FASTORE:
+    case BASTORE:
+    case CASTORE:
+    case SASTORE: return StackEffect{1, 3, 0};
+    case LASTORE:
+    case DASTORE: return StackEffect{1, 4, 0};
+    case POP: return StackEffect{1, 1, 0};
+    case POP2: return StackEffect{1, 2, 0};
+    case DUP: return StackEffect{1, 1, 2};
+    case DUP_X1: return StackEffect{1, 2, 3};
+    case DUP2: return StackEffect{1, 2, 4};
+    case SWAP: return StackEffect{1, 2, 2};
+    case IADD:
+    case ISUB:
+    case IMUL:
+    case IDIV:
+    case IREM:
+    case IAND:
+    case IOR:
+    case IXOR:
+    case ISHL:
+    case ISHR:
+    case IUSHR: return StackEffect{1, 2, 1};
+    case LADD:
+    case LSUB:
+    case LMUL:
+    case LDIV:
+    case LREM:
+    case LAND:
+    case LOR:
+    case LXOR: return StackEffect{1, 4, 2};
+    case LSHL:
+    case LSHR:
+    case LUSHR: return StackEffect{1, 3, 2};
+    case INEG: return StackEffect{1, 1, 1};
+    case LNEG: return StackEffect{1, 2, 2};
+    case IINC: return StackEffect{3, 0, 0};
+    case I2L: return StackEffect{1, 1, 2};
+    case L2I: return StackEffect{1, 2, 1};
+    case I2B:
+    case I2C:
+    case I2S: return StackEffect{1, 1, 1};
+    case LCMP: return StackEffect{1, 4, 1};
+    case IFEQ:
+    case IFNE:
+    case IFLT:
+    case IFGE:
+    case IFGT:
+    case IFLE:
+    case IFNULL:
+    case IFNONNULL: return StackEffect{3, 1, 0};
+    case IF_ICMPEQ:
+    case IF_ICMPNE:
+    case IF_ICMPLT:
+    case IF_ICMPGE:
+    case IF_ICMPGT:
+    case IF_ICMPLE:
+    case IF_ACMPEQ:
+    case IF_ACMPNE: return StackEffect{3, 2, 0};
+    case GOTO: return StackEffect{3, 0, 0};
+    case GOTO_W: return StackEffect{5, 0, 0};
+    case ARRAYLENGTH: return StackEffect{1, 1, 1};
+    default: return std::nullopt;
+  }
+}
+
+bool geevm::isJump(Opcode opcode)
+{
+  return (opcode >= Opcode::IFEQ && opcode <= Opcode::GOTO) || opcode == Opcode::IFNULL || opcode == Opcode::IFNONNULL || opcode == Opcode::GOTO_W;
+}
+
+int64_t geevm::jumpTarget(const std::vector<types::u1>& bytes, int64_t pc)
+{
+  if (static_cast<Opcode>(bytes[pc]) == Opcode::GOTO_W) {
+    uint32_t offset = (static_cast<uint32_t>(bytes[pc + 1]) << 24u) | (bytes[pc + 2] << 16u) | (bytes[pc + 3] << 8u) | bytes[pc + 4];
+    return pc + std::bit_cast<int32_t>(offset);
+  }
+  return pc + std::bit_cast<int16_t>(static_cast<uint16_t>((bytes[pc + 1] << 8u) | bytes[pc + 2]));
+}
+
+void geevm::runCompiledCode(CallFrame& frame, void* code)
+{
+  assert(code != nullptr);
+
+  uint64_t state = reinterpret_cast<CompiledCodeEntry>(code)(frame.localVariables(), frame.operandStack());
+  frame.set(static_cast<int64_t>(state >> 16));
+  frame.setStackPointer(static_cast<uint16_t>(state & 0xFFFF));
+}
@@ -0,0 +1,82 @@
+#ifndef GEEVM_VM_COMPILEDCODE_H
+#define GEEVM_VM_COMPILEDCODE_H
+
+#include "class_file/Opcode.h"
+#include "common/JvmTypes.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace geevm
+{
+
+class CallFrame;
+
+/// Execution tiers of a method, ordered by the optimization level of its code.
+enum class CompilationTier : uint8_t
+{
+  Interpreter,
+  // Template code of the `BaselineCompiler`
+  Baseline,
+  // Register-allocated SSA code of the `OptimizingCompiler`
+  Optimized,
+};
+
+/// Signature of compiled code of every tier. Compiled code receives the local variable array and operand stack of the
+/// interpreter's call frame, and returns the exit state, with the bytecode offset to continue from in the upper and
+/// the operand stack depth in the lower 16 bits. Both arrays hold the complete interpreter state at the exit.
+using CompiledCodeEntry = uint64_t (*)(uint64_t* localVariables, uint64_t* operandStack);
+
+inline uint32_t compiledCodeExitState(int64_t pc, int32_t depth)
+{
+  return (static_cast<uint32_t>(pc) << 16) | static_cast<uint32_t>(depth);
+}
+
+/// Compiled code entered at a loop header by on-stack replacement (OSR), while the interpreter is executing the loop.
+/// The code expects the operand stack depth the interpreter has at the loop header.
+struct OsrEntry
+{
+  void* code = nullptr;
+  // The tier that produced `code`
+  CompilationTier tier = CompilationTier::Interpreter;
+  // Tiers that failed to compile an entry for this loop header, one bit per tier
+  uint8_t notCompilableTiers = 0;
+
+  bool isCompilable(CompilationTier compilationTier) const
+  {
+    return (notCompilableTiers & (1u << static_cast<uint8_t>(compilationTier))) == 0;
+  }
+
+  void markNotCompilable(CompilationTier compilationTier)
+  {
+    notCompilableTiers |= static_cast<uint8_t>(1u << static_cast<uint8_t>(compilationTier));
+  }
+};
+
+/// Runs \p code, either the compiled code of the method of \p frame or an OSR entry for the current program counter of
+/// the frame, and updates the program counter and stack pointer of the frame to the instruction the interpreter needs
+/// to continue with.
+void runCompiledCode(CallFrame& frame, void* code);
+
+/// Operand stack effect of an instruction supported by the compilers, in slots.
+struct StackEffect
+{
+  uint8_t length;
+  uint8_t pops;
+  uint8_t pushes;
+};
+
+/// Returns the stack effect of \p opcode if compiled code can execute it: instructions that cannot allocate, call or
+/// throw other than through the runtime checks of array accesses and divisions.
+std::optional<StackEffect> compiledStackEffect(Opcode opcode);
+
+/// Returns true for conditional branches and `goto`.
+bool isJump(Opcode opcode);
+
+/// Returns the target offset of the jump instruction at \p pc.
+int64_t jumpTarget(const std::vector<types::u1>& bytes, int64_t pc);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_COMPILEDCODE_H
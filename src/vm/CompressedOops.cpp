@@ -0,0 +1,81 @@
+#include "vm/CompressedOops.h"
+
+#include "common/JvmError.h"
+#include "common/Memory.h"
+
+#include <cstring>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace geevm;
+
+static_assert(sizeof(HeapPtr<Instance>) == HeapReferenceSize);
+
+void CompressedOops::reserveHeapRange()
+{
+  // The whole range is reserved up front, physical memory is only committed when a page is first touched
+  void* range = ::mmap(nullptr, MaxHeapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (range == MAP_FAILED) {
+    geevm_panic("failed to reserve the compressed heap range");
+  }
+
+  sBase = static_cast<char*>(range);
+  // Offset 0 encodes null, it must never be handed out
+  sUsed = ::sysconf(_SC_PAGESIZE);
+}
+
+char* CompressedOops::allocateHeapMemory(size_t size)
+{
+  if constexpr (!isEnabled()) {
+    auto* memory = static_cast<char*>(::operator new(size));
+    std::memset(memory, 0, size);
+    return memory;
+  }
+
+  if (sBase == nullptr) {
+    reserveHeapRange();
+  }
+
+  size_t pageSize = ::sysconf(_SC_PAGESIZE);
+  size_t adjustedSize = alignTo(size, pageSize);
+  // Reuse a previously released block first, e.g. from the heap of a VM instance that was already destroyed
+  for (auto it = sFreeBlocks.begin(); it != sFreeBlocks.end(); ++it) {
+    auto [block, blockSize] = *it;
+    if (blockSize < adjustedSize) {
+      continue;
+    }
+
+    if (blockSize == adjustedSize) {
+      sFreeBlocks.erase(it);
+    } else {
+      *it = {block + adjustedSize, blockSize - adjustedSize};
+    }
+
+    return block;
+  }
+
+  if (sUsed + adjustedSize > MaxHeapSize) {
+    geevm_panic("compressed heap range exhausted");
+  }
+
+  char* memory = sBase + sUsed;
+  sUsed += adjustedSize;
+
+  return memory;
+}
+
+void CompressedOops::releaseHeapMemory(char* memory, size_t size)
+{
+  if constexpr (!isEnabled()) {
+    ::operator delete(memory);
+    return;
+  }
+
+  // Give the physical pages back to the operating system, they read as zero once they are touched again
+  size_t pageSize = ::sysconf(_SC_PAGESIZE);
+  size_t adjustedSize = alignTo(size, pageSize);
+  ::madvise(memory, adjustedSize, MADV_DONTNEED);
+
+  sFreeBlocks.emplace_back(memory, adjustedSize);
+}
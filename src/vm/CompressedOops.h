@@ -0,0 +1,148 @@
+#ifndef GEEVM_VM_COMPRESSEDOOPS_H
+#define GEEVM_VM_COMPRESSEDOOPS_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace geevm
+{
+
+class Instance;
+
+/// All objects on the heap are aligned to this boundary.
+inline constexpr size_t ObjectAlignment = 8;
+
+/// Support for compressed object references.
+///
+/// When the VM is built with `GEEVM_COMPRESSED_OOPS`, all Java objects live in a single reserved address range and
+/// references stored inside objects are 32-bit offsets from the start of this range, shifted by the object alignment.
+/// This way 32-bit references can address 32 GB of heap. References on the operand stack, in local variables and
+/// in static fields remain full pointers.
+///
+/// Without compressed references, heap memory is allocated from the system allocator and encoding is the identity.
+class CompressedOops
+{
+public:
+  static constexpr size_t Shift = 3;
+  static constexpr size_t MaxHeapSize = (size_t{1} << 32) << Shift;
+
+  static_assert((size_t{1} << Shift) == ObjectAlignment);
+
+  static constexpr bool isEnabled()
+  {
+#ifdef GEEVM_COMPRESSED_OOPS
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  /// Allocates \p size bytes of zeroed memory for storing Java objects. When compressed references are enabled,
+  /// the memory is carved out of the compressed heap range and the VM aborts if the range is exhausted.
+  [[nodiscard]] static char* allocateHeapMemory(size_t size);
+
+  /// Releases memory obtained from `allocateHeapMemory`.
+  static void releaseHeapMemory(char* memory, size_t size);
+
+  static uint32_t encode(const void* ptr)
+  {
+    if (ptr == nullptr) {
+      return 0;
+    }
+
+    auto offset = static_cast<size_t>(static_cast<const char*>(ptr) - sBase);
+    assert(sBase != nullptr && offset < MaxHeapSize && offset % ObjectAlignment == 0);
+
+    return static_cast<uint32_t>(offset >> Shift);
+  }
+
+  static void* decode(uint32_t reference)
+  {
+    if (reference == 0) {
+      return nullptr;
+    }
+
+    return sBase + (static_cast<size_t>(reference) << Shift);
+  }
+
+private:
+  static void reserveHeapRange();
+
+private:
+  // Start of the reserved heap range
+  static inline char* sBase = nullptr;
+  // Number of bytes handed out from the reserved range
+  static inline size_t sUsed = 0;
+  // Released blocks within the reserved range that can be handed out again
+  static inline std::vector<std::pair<char*, size_t>> sFreeBlocks;
+};
+
+/// A reference to a heap object, as stored inside objects (fields and reference array elements).
+///
+/// With compressed references enabled this is a 32-bit encoded reference, otherwise it is a plain pointer. The type
+/// converts implicitly from and to `T*`, so it can be used in place of a pointer in object layouts.
+template<class T>
+class HeapPtr
+{
+public:
+  HeapPtr() = default;
+
+  /*implicit*/ HeapPtr(T* ptr)
+    : mReference(encode(ptr))
+  {
+  }
+
+  HeapPtr& operator=(T* ptr)
+  {
+    mReference = encode(ptr);
+    return *this;
+  }
+
+  /*implicit*/ operator T*() const
+  {
+    return this->get();
+  }
+
+  T* operator->() const
+  {
+    return this->get();
+  }
+
+  T* get() const
+  {
+#ifdef GEEVM_COMPRESSED_OOPS
+    return static_cast<T*>(CompressedOops::decode(mReference));
+#else
+    return mReference;
+#endif
+  }
+
+private:
+#ifdef GEEVM_COMPRESSED_OOPS
+  static uint32_t encode(T* ptr)
+  {
+    return CompressedOops::encode(ptr);
+  }
+
+  uint32_t mReference = 0;
+#else
+  static T* encode(T* ptr)
+  {
+    return ptr;
+  }
+
+  T* mReference = nullptr;
+#endif
+};
+
+/// The representation of a value of type `T` when it is stored inside an object.
+template<class T>
+using HeapRepresentation = std::conditional_t<std::is_same_v<T, Instance*>, HeapPtr<Instance>, T>;
+
+} // namespace geevm
+
+#endif // GEEVM_VM_COMPRESSEDOOPS_H
@@ -0,0 +1,80 @@
+#include "vm/EpsilonCollector.h"
+
+#include "common/JvmError.h"
+#include "common/Memory.h"
+#include "vm/Vm.h"
+
+#include <sys/mman.h>
+
+using namespace geevm;
+
+EpsilonCollector::EpsilonCollector(Vm& vm)
+  : GarbageCollector(vm), mReservedSize(vm.settings().epsilonHeapSize)
+{
+  if constexpr (CompressedOops::isEnabled()) {
+    // The compressed heap range is reserved lazily as well, so the region is only backed by memory once it is touched
+    mRegion = CompressedOops::allocateHeapMemory(mReservedSize);
+    mBumpPtr = mRegion;
+    return;
+  }
+
+  // Anonymous mappings are zero-initialized and only backed by physical memory once they are touched
+  void* region = ::mmap(nullptr, mReservedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (region == MAP_FAILED) {
+    geevm_panic("failed to reserve memory for the epsilon heap");
+  }
+
+  mRegion = static_cast<char*>(region);
+  mBumpPtr = mRegion;
+}
+
+void* EpsilonCollector::allocate(size_t size)
+{
+  size_t adjustedSize = alignTo(size, ObjectAlignment);
+  if (mBumpPtr + adjustedSize > mRegion + mReservedSize) {
+    // The caller throws an OutOfMemoryError
+    return nullptr;
+  }
+
+  void* current = mBumpPtr;
+  mBumpPtr += adjustedSize;
+
+  return current;
+}
+
+bool EpsilonCollector::collect(GcEvent& /*event*/)
+{
+  // The epsilon collector never reclaims memory
+  return false;
+}
+
+std::generator<Instance*> EpsilonCollector::objects()
+{
+  for (Instance* instance : this->immortalObjects()) {
+    co_yield instance;
+  }
+
+  char* ptr = mRegion;
+  while (ptr < mBumpPtr) {
+    auto* instance = reinterpret_cast<Instance*>(ptr);
+    ptr += alignTo(objectSize(instance), ObjectAlignment);
+    co_yield instance;
+  }
+}
+
+void EpsilonCollector::fillStatistics(GcStatistics& statistics) const
+{
+  auto used = static_cast<size_t>(mBumpPtr - mRegion);
+  statistics.totalBytesAllocated = used;
+  statistics.heapUsed = used;
+  statistics.heapCapacity = mReservedSize;
+}
+
+EpsilonCollector::~EpsilonCollector()
+{
+  if constexpr (CompressedOops::isEnabled()) {
+    CompressedOops::releaseHeapMemory(mRegion, mReservedSize);
+  } else {
+    ::munmap(mRegion, mReservedSize);
+  }
+}
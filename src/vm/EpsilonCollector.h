@@ -0,0 +1,38 @@
+#ifndef GEEVM_VM_EPSILONCOLLECTOR_H
+#define GEEVM_VM_EPSILONCOLLECTOR_H
+
+#include "vm/GarbageCollector.h"
+
+namespace geevm
+{
+
+/// A garbage collector that never collects.
+///
+/// All objects are bump-allocated from a single, large reserved address range. Memory is only committed by the
+/// operating system when it is first touched, so reserving a large range is cheap. When the range is exhausted,
+/// allocation fails and the allocating thread throws an OutOfMemoryError. This collector is meant for short batch
+/// runs and for measuring the overhead of other collectors.
+class EpsilonCollector : public GarbageCollector
+{
+public:
+  explicit EpsilonCollector(Vm& vm);
+
+  [[nodiscard]] void* allocate(size_t size) override;
+
+  std::generator<Instance*> objects() override;
+
+  ~EpsilonCollector() override;
+
+protected:
+  bool collect(GcEvent& event) override;
+  void fillStatistics(GcStatistics& statistics) const override;
+
+private:
+  char* mRegion;
+  char* mBumpPtr;
+  size_t mReservedSize;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_EPSILONCOLLECTOR_H
@@ -0,0 +1,83 @@
+#include "vm/ExceptionHandlerTable.h"
+#include "vm/Class.h"
+#include "vm/Runtime.h"
+
+#include <algorithm>
+
+using namespace geevm;
+
+ExceptionHandlerTable::ExceptionHandlerTable(const Code& code, RuntimeConstantPool& runtimeConstantPool)
+{
+  const auto& entries = code.exceptionTable();
+  if (entries.empty()) {
+    return;
+  }
+
+  std::vector<Handler> entryHandlers;
+  entryHandlers.reserve(entries.size());
+  for (const auto& entry : entries) {
+    Handler handler{.catchType = nullptr, .handlerPc = entry.handlerPc, .resolutionError = Resolved};
+    if (entry.catchType != 0) {
+      auto klass = runtimeConstantPool.getClass(entry.catchType);
+      if (klass.has_value()) {
+        handler.catchType = *klass;
+      } else {
+        // Resolution errors are only thrown when the handler is actually consulted
+        handler.resolutionError = static_cast<types::u2>(mResolutionErrors.size());
+        mResolutionErrors.push_back(klass.error());
+      }
+    }
+    entryHandlers.push_back(handler);
+  }
+
+  std::vector<types::u2> boundaries;
+  for (const auto& entry : entries) {
+    boundaries.push_back(entry.startPc);
+    boundaries.push_back(entry.endPc);
+  }
+  std::ranges::sort(boundaries);
+  auto [first, last] = std::ranges::unique(boundaries);
+  boundaries.erase(first, last);
+
+  for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+    types::u2 startPc = boundaries[i];
+    types::u2 endPc = boundaries[i + 1];
+
+    auto firstHandler = static_cast<uint32_t>(mHandlers.size());
+    // Handlers are kept in exception table order, which determines their precedence
+    for (size_t j = 0; j < entries.size(); ++j) {
+      const auto& entry = entries[j];
+      if (entry.startPc > startPc || entry.endPc < endPc) {
+        continue;
+      }
+
+      mHandlers.push_back(entryHandlers[j]);
+    }
+
+    auto numHandlers = static_cast<uint32_t>(mHandlers.size()) - firstHandler;
+    if (numHandlers != 0) {
+      mRanges.push_back(Range{.startPc = startPc, .endPc = endPc, .firstHandler = firstHandler, .numHandlers = numHandlers});
+    }
+  }
+}
+
+JvmExpected<std::optional<types::u2>> ExceptionHandlerTable::findHandler(JClass* exceptionClass, size_t pc) const
+{
+  // The first range ending after pc is the only one that may contain it
+  auto it = std::ranges::upper_bound(mRanges, pc, std::ranges::less{}, &Range::endPc);
+  if (it == mRanges.end() || pc < it->startPc) {
+    return std::nullopt;
+  }
+
+  for (uint32_t i = it->firstHandler; i < it->firstHandler + it->numHandlers; ++i) {
+    const Handler& handler = mHandlers[i];
+    if (handler.resolutionError != Resolved) [[unlikely]] {
+      return std::unexpected(mResolutionErrors[handler.resolutionError]);
+    }
+    if (handler.catchType == nullptr || exceptionClass->isInstanceOf(handler.catchType)) {
+      return handler.handlerPc;
+    }
+  }
+
+  return std::nullopt;
+}
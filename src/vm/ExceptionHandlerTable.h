@@ -0,0 +1,68 @@
+#ifndef GEEVM_VM_EXCEPTIONHANDLERTABLE_H
+#define GEEVM_VM_EXCEPTIONHANDLERTABLE_H
+
+#include "class_file/Attributes.h"
+#include "common/JvmError.h"
+
+#include <optional>
+#include <vector>
+
+namespace geevm
+{
+
+class JClass;
+class RuntimeConstantPool;
+
+/// Precomputed index of the exception handlers of a method.
+///
+/// The bytecode is split into disjoint pc ranges at every start and end offset of the exception table. Each range
+/// lists the handlers active within it in exception table order, with their catch types already resolved. Finding
+/// the handler for an exception thrown at a given pc is a binary search over the ranges followed by an `isInstanceOf`
+/// check of the (usually very few) handlers of that range.
+class ExceptionHandlerTable
+{
+public:
+  struct Handler
+  {
+    // Resolved catch type, nullptr if the handler catches every exception (`finally` blocks) or if its catch type
+    // could not be resolved
+    JClass* catchType;
+    types::u2 handlerPc;
+    // Index of the resolution error of the catch type in mResolutionErrors, or `Resolved`
+    types::u2 resolutionError;
+  };
+
+  static constexpr types::u2 Resolved = 0xFFFF;
+
+  /// Builds the index for \p code. Catch types are resolved through \p runtimeConstantPool; the errors of catch types
+  /// that cannot be resolved are kept and reported by `findHandler` once such a handler is reached.
+  ExceptionHandlerTable(const Code& code, RuntimeConstantPool& runtimeConstantPool);
+
+  bool empty() const
+  {
+    return mRanges.empty();
+  }
+
+  /// Returns the pc of the handler catching an exception of class \p exceptionClass thrown at \p pc. If a handler
+  /// whose catch type could not be resolved is reached before a matching one, the resolution error (usually a
+  /// `NoClassDefFoundError`) is returned instead.
+  JvmExpected<std::optional<types::u2>> findHandler(JClass* exceptionClass, size_t pc) const;
+
+private:
+  struct Range
+  {
+    types::u2 startPc;
+    types::u2 endPc;
+    // Handlers of this range are mHandlers[firstHandler, firstHandler + numHandlers)
+    uint32_t firstHandler;
+    uint32_t numHandlers;
+  };
+
+  std::vector<Range> mRanges;
+  std::vector<Handler> mHandlers;
+  std::vector<VmError> mResolutionErrors;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_EXCEPTIONHANDLERTABLE_H
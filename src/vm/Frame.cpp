@@ -6,7 +6,7 @@ CallFrame::CallFrame(JMethod* method, CallFrame* previous, std::uint64_t* localV
   : mMethod(method), mPrevious(previous), mLocalVariables(localVariables), mOperandStack(operandStack)
 {
   if (!method->isNative()) {
-    mCode = mMethod->getCode().bytes().data();
+    mCode = mMethod->interpreterCode();
 
     uint16_t maxLocals = method->getCode().maxLocals();
     uint16_t maxStack = mMethod->getCode().maxStack();
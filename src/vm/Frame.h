@@ -78,6 +78,31 @@ public:
     return &mLocalVariables[index];
   }
 
+  /// The raw local variable array, for compiled code operating on the frame directly.
+  uint64_t* localVariables()
+  {
+    return mLocalVariables;
+  }
+
+  /// The raw operand stack, for compiled code operating on the frame directly.
+  uint64_t* operandStack()
+  {
+    return mOperandStack;
+  }
+
+  /// The bytecode executed by the interpreter, see `JMethod::interpreterCode`.
+  const types::u1* code() const
+  {
+    return mCode;
+  }
+
+  /// Executes the bytecode of the class file instead of the code with superinstructions. Both have the same
+  /// instruction offsets, so this may be called at any program counter.
+  void useOriginalBytecode()
+  {
+    mCode = mMethod->getCode().bytes().data();
+  }
+
   // Operand stack
   //==--------------------------------------------------------------------==//
   template<JvmType T>
@@ -131,6 +156,12 @@ public:
     return mOperandStackPointer;
   }
 
+  void setStackPointer(uint16_t stackPointer)
+  {
+    assert(stackPointer <= mMethod->getCode().maxStack());
+    mOperandStackPointer = stackPointer;
+  }
+
   void popMultiple(uint16_t count)
   {
     mOperandStackPointer = mOperandStackPointer - count;
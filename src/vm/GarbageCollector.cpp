@@ -4,208 +4,177 @@
 #include "common/JvmError.h"
 #include "common/Memory.h"
 #include "vm/Class.h"
-#include "vm/GcRoots.h"
+#include "vm/EpsilonCollector.h"
+#include "vm/SemiSpaceCollector.h"
 #include "vm/Vm.h"
 
-#include <cstdlib>
-#include <cstring>
+#include <algorithm>
 
 using namespace geevm;
 
-GarbageCollector::GarbageCollector(Vm& vm)
-  : mVm(vm), mHeapSize(vm.settings().maxHeapSize), mRunAfterEveryAllocation(vm.settings().runGcAfterEveryAllocation)
-{
-  mFromRegion = static_cast<char*>(::operator new(mHeapSize / 2));
-  mToRegion = static_cast<char*>(::operator new(mHeapSize / 2));
-  std::memset(mFromRegion, 0, mHeapSize / 2);
-  mBumpPtr = mFromRegion;
-
-  ASAN_POISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
-}
+// The immortal region mostly holds class mirrors and interned strings, a chunk of this size fits a few thousand of them.
+static constexpr size_t ImmortalRegionChunkSize = 256 * 1024;
 
-void GarbageCollector::lockGC()
+ImmortalRegion::ImmortalRegion(size_t chunkSize)
+  : mChunkSize(chunkSize)
 {
-  mIsGcLocked = true;
 }
 
-void GarbageCollector::unlockGC()
+void* ImmortalRegion::allocate(size_t size)
 {
-  mIsGcLocked = false;
-}
+  size_t adjustedSize = alignTo(size, ObjectAlignment);
 
-void* GarbageCollector::allocate(size_t size)
-{
-  const char* end = mFromRegion + mHeapSize / 2;
-  if (mBumpPtr + size > end) {
-    // The 'from' region is full, let's do GC
-    this->performGarbageCollection();
-    const char* end2 = mFromRegion + mHeapSize / 2;
-    if (mBumpPtr + size > end2) {
-      // TODO: Throw OutOfMemoryException
-      geevm_panic("out of heap memory");
-    }
-  } else if (mRunAfterEveryAllocation) {
-    this->performGarbageCollection();
+  if (mChunks.empty() || mChunks.back().top + adjustedSize > mChunks.back().end) {
+    this->newChunk(adjustedSize);
   }
 
-  return this->allocateUnchecked(size);
+  Chunk& chunk = mChunks.back();
+  void* current = chunk.top;
+  chunk.top += adjustedSize;
+
+  return current;
 }
 
-void* GarbageCollector::allocateUnchecked(size_t size)
+ImmortalRegion::Chunk& ImmortalRegion::newChunk(size_t minimumSize)
 {
-  void* current = mBumpPtr;
-
-  size_t adjustedSize = alignTo(size, alignof(std::max_align_t));
-  mBumpPtr += adjustedSize;
+  size_t size = std::max(mChunkSize, minimumSize);
+  char* start = CompressedOops::allocateHeapMemory(size);
 
-  return current;
+  return mChunks.emplace_back(start, start, start + size);
 }
 
-Instance* GarbageCollector::copyObject(Instance* instance, std::unordered_map<Instance*, Instance*>& map)
+ImmortalRegion::~ImmortalRegion()
 {
-  if (instance == nullptr) {
-    // No need to copy null
-    return nullptr;
+  for (Chunk& chunk : mChunks) {
+    CompressedOops::releaseHeapMemory(chunk.start, chunk.end - chunk.start);
   }
+}
 
-  if (auto it = map.find(instance); it != map.end()) {
-    // This has already been copied
-    return it->second;
+GarbageCollector::GarbageCollector(Vm& vm)
+  : mVm(vm), mImmortalRegion(ImmortalRegionChunkSize), mStartTime(std::chrono::steady_clock::now())
+{
+  if (const auto& logSettings = vm.settings().gcLog; logSettings.has_value()) {
+    mLog = std::make_unique<GcLog>(*logSettings);
   }
+}
 
-  auto klass = instance->getClass();
-  std::size_t objectSize = 0;
-  if (auto arrayClass = klass->asArrayClass(); arrayClass) {
-    objectSize = arrayClass->allocationSize(instance->toArrayInstance()->length());
-  } else {
-    objectSize = klass->asInstanceClass()->allocationSize();
+std::unique_ptr<GarbageCollector> geevm::createGarbageCollector(Vm& vm)
+{
+  switch (vm.settings().collector) {
+    case GarbageCollectorKind::SemiSpace: return std::make_unique<SemiSpaceCollector>(vm);
+    case GarbageCollectorKind::Epsilon: return std::make_unique<EpsilonCollector>(vm);
   }
 
-  void* mem = this->allocateUnchecked(objectSize);
-  // Note that the copy here is safe only if the type copied is trivially copiable.
-  // This is the case for Instance and its subclasses (see the static asserts in Instance.h)
-  std::memcpy(mem, instance, objectSize);
-  auto* copy = static_cast<Instance*>(mem);
-  map.insert({instance, copy});
-
-  return copy;
+  GEEVM_UNREACHBLE("Unknown garbage collector kind");
 }
 
-void GarbageCollector::performGarbageCollection()
+void GarbageCollector::performGarbageCollection(GcCause cause)
 {
   if (mIsGcLocked) {
     return;
   }
   this->lockGC();
 
-  ASAN_UNPOISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
-  std::swap(mFromRegion, mToRegion);
-  mBumpPtr = mFromRegion;
-
-  // The actual implementation here follows Cheney's algorithm (https://en.wikipedia.org/wiki/Cheney%27s_algorithm),
-  // The main steps are:
-  //  1. Collect and shallow copy all GC roots to the new region,
-  //  2. For each copied object on the new region, shallow copy their immediately reachable objects (i.e. object fields and
-  //     array elements) until there are no more new objects on the new region.
-  // Already copied objects are iterated using 'scanPtr': after processing an object, the pointer is advanced by the object's size.
-  std::unordered_map<Instance*, Instance*> map;
-  char* scanPtr = mFromRegion;
-
-  // Process manually pinned roots.
-  // Note that this list already contains all Java class mirror instances, interned strings and
-  // JNI references.
-  for (auto& root : mRootList) {
-    Instance* copy = this->copyObject(root, map);
-    root = copy;
-  }
+  GcEvent event{
+      .id = mPauses.count(),
+      .cause = cause,
+      .start = std::chrono::steady_clock::now() - mStartTime,
+      .end = GcEvent::Duration{0},
+      .heapUsedBefore = 0,
+      .heapUsedAfter = 0,
+      .heapCapacity = 0,
+      .objectsCopied = 0,
+      .bytesCopied = 0,
+      .roots = GcRootCounts{},
+  };
+  bool collected = this->collect(event);
+  event.end = std::chrono::steady_clock::now() - mStartTime;
 
-  // Process static fields in classes
-  for (const auto& [_, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
-    for (auto& [_, field] : klass->fields()) {
-      if (field->isStatic() && field->fieldType().isReferenceOrArray()) {
-        auto* instance = klass->getStaticFieldValue<Instance*>(field->offset());
-        auto* copy = this->copyObject(instance, map);
-        klass->setStaticFieldValue<Instance*>(field->offset(), copy);
-      }
-    }
+  this->unlockGC();
+
+  if (!collected) {
+    return;
   }
 
-  // Update local variables and the stack in threads
-  for (JavaThread* thread : mVm.threads()) {
-    for (CallFrame& frame : thread->callStack()) {
-      if (frame.currentMethod()->isNative()) {
-        continue;
-      }
-
-      uint64_t pos = frame.programCounter();
-      FrameRoots roots = FrameRoots::compute(frame.currentMethod(), pos);
-
-      for (auto [i, object] : roots.referencesInLocals(frame)) {
-        auto* copy = this->copyObject(object, map);
-        frame.storeValue(i, copy);
-      }
-
-      for (auto [i, object] : roots.referencesInOperandStack(frame)) {
-        auto* copy = this->copyObject(object, map);
-        frame.replaceStackValue(i, copy);
-      }
-    }
+  mPauses.record(event.pause());
+  mLastCollection = event;
+  if (mLog != nullptr) {
+    mLog->logCollection(event);
   }
+}
 
-  while (scanPtr < mBumpPtr) {
-    auto* instance = reinterpret_cast<Instance*>(scanPtr);
-    size_t objectSize = this->processReferences(instance, map);
+GcStatistics GarbageCollector::statistics() const
+{
+  GcStatistics statistics{
+      .collections = mPauses.count(),
+      .immortalUsed = this->immortalBytesUsed(),
+      .pauses = mPauses,
+      .lastCollection = mLastCollection,
+  };
+  this->fillStatistics(statistics);
+
+  return statistics;
+}
 
-    size_t adjustedSize = alignTo(objectSize, alignof(std::max_align_t));
-    scanPtr += adjustedSize;
+void GarbageCollector::logSummary()
+{
+  if (mLog != nullptr) {
+    mLog->logSummary(this->statistics());
   }
+}
 
-  // Clear up the previous region
-  std::memset(mToRegion, 0, mHeapSize / 2);
-  ASAN_POISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
+void GarbageCollector::lockGC()
+{
+  mIsGcLocked = true;
+}
 
-  this->unlockGC();
+void GarbageCollector::unlockGC()
+{
+  mIsGcLocked = false;
+}
+
+void* GarbageCollector::allocateImmortal(size_t size)
+{
+  return mImmortalRegion.allocate(size);
+}
+
+std::generator<Instance*> GarbageCollector::pinnedObjects()
+{
+  for (Instance* root : mRootList) {
+    if (root != nullptr) {
+      co_yield root;
+    }
+  }
 }
 
-size_t GarbageCollector::processReferences(Instance* instance, std::unordered_map<Instance*, Instance*>& map)
+size_t GarbageCollector::objectSize(Instance* instance)
 {
   auto klass = instance->getClass();
-  std::size_t objectSize = 0;
   if (auto arrayClass = klass->asArrayClass(); arrayClass) {
-    objectSize = arrayClass->allocationSize(instance->toArrayInstance()->length());
-  } else {
-    objectSize = klass->asInstanceClass()->allocationSize();
+    return arrayClass->allocationSize(instance->toArrayInstance()->length());
   }
 
-  if (auto instanceClass = klass->asInstanceClass(); instanceClass) {
-    for (auto& [_, field] : klass->fields()) {
-      if (!field->isStatic() && field->fieldType().isReferenceOrArray()) {
-        auto* fieldValue = instance->getFieldValue<Instance*>(field->offset());
-        Instance* copiedField = this->copyObject(fieldValue, map);
-        instance->setFieldValue<Instance*>(field->offset(), copiedField);
-      }
-    }
-  } else if (auto arrayClass = klass->asArrayClass(); arrayClass) {
-    auto elementType = arrayClass->fieldType().asArrayType()->getElementType();
-
-    if (arrayClass->fieldType().asArrayType()->getElementType().isReferenceOrArray()) {
-      JavaArray<Instance*>* arrayOfObjects = instance->toArray<Instance*>();
-      for (int32_t i = 0; i < arrayOfObjects->length(); i++) {
-        Instance* elem = *arrayOfObjects->getArrayElement(i);
-        Instance* copyOfElem = this->copyObject(elem, map);
+  return klass->asInstanceClass()->allocationSize();
+}
 
-        arrayOfObjects->setArrayElement(i, copyOfElem);
-      }
+std::generator<Instance*> GarbageCollector::immortalObjects()
+{
+  for (const ImmortalRegion::Chunk& chunk : mImmortalRegion.chunks()) {
+    char* ptr = chunk.start;
+    while (ptr < chunk.top) {
+      auto* instance = reinterpret_cast<Instance*>(ptr);
+      ptr += alignTo(objectSize(instance), ObjectAlignment);
+      co_yield instance;
     }
-  } else {
-    GEEVM_UNREACHBLE("A class must be either an instance class or an array")
   }
-
-  return objectSize;
 }
 
-GarbageCollector::~GarbageCollector()
+size_t GarbageCollector::immortalBytesUsed() const
 {
-  ::operator delete(mFromRegion);
-  ::operator delete(mToRegion);
+  size_t used = 0;
+  for (const ImmortalRegion::Chunk& chunk : mImmortalRegion.chunks()) {
+    used += chunk.top - chunk.start;
+  }
+
+  return used;
 }
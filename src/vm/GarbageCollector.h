@@ -1,12 +1,16 @@
 #ifndef GEEVM_VM_GARBAGECOLLECTOR_H
 #define GEEVM_VM_GARBAGECOLLECTOR_H
 
+#include "vm/GcLog.h"
 #include "vm/Instance.h"
 
 #include <cassert>
 #include <cstddef>
+#include <generator>
 #include <list>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace geevm
 {
@@ -227,26 +231,89 @@ private:
   GarbageCollector* mGC;
 };
 
-/// A copying garbage collector.
+/// A non-moving region for objects that live as long as the virtual machine itself, such as class mirrors,
+/// interned strings and thread instances.
 ///
-/// Every time the allocation of a new object is requested, the GC checks the heap state and may decide to
-/// perform garbage collection.
+/// Objects allocated here are never relocated or freed by the garbage collector, but their reference fields are
+/// scanned as roots on every collection. The region grows in fixed-size chunks, objects are bump-allocated within
+/// the current chunk.
+class ImmortalRegion
+{
+public:
+  struct Chunk
+  {
+    char* start;
+    char* top;
+    char* end;
+  };
+
+  explicit ImmortalRegion(size_t chunkSize);
+
+  ImmortalRegion(const ImmortalRegion&) = delete;
+  ImmortalRegion& operator=(const ImmortalRegion&) = delete;
+
+  /// Allocate \p size bytes of zeroed memory in the immortal region.
+  [[nodiscard]] void* allocate(size_t size);
+
+  const std::vector<Chunk>& chunks() const
+  {
+    return mChunks;
+  }
+
+  ~ImmortalRegion();
+
+private:
+  Chunk& newChunk(size_t minimumSize);
+
+private:
+  size_t mChunkSize;
+  std::vector<Chunk> mChunks;
+};
+
+/// Interface of garbage collector implementations.
 ///
-/// The garbage-collected heap is split into two regions: the "from" region and the "to" region. All allocations
-/// take place on the "from" region. When the garbage collector runs, it collects all GC roots (local variables,
-/// values on the operand stack and manually rooted objects) and all objects reachable from GC roots.
-/// These objects are then copied to the "to" region, the "from" region is invalidated, then the two regions
-/// are swapped (so that the "to" region containing the copies becomes the new "from" region).
+/// The collector owns all memory of Java objects. Root management (pinning and releasing objects), locking and the
+/// immortal region are shared by all implementations, while the allocation and collection policy is up to the
+/// concrete collector.
 class GarbageCollector
 {
-public:
+protected:
   explicit GarbageCollector(Vm& vm);
 
-  /// Allocate \p size bytes on the garbage collected heap.
+public:
+  GarbageCollector(const GarbageCollector&) = delete;
+  GarbageCollector& operator=(const GarbageCollector&) = delete;
+
+  /// Allocate \p size bytes of zeroed memory on the garbage collected heap, or return nullptr if the heap is exhausted.
   /// Depending on the heap state and the setup of the garbage collector, this call may trigger GC.
-  [[nodiscard]] void* allocate(size_t size);
+  [[nodiscard]] virtual void* allocate(size_t size) = 0;
+
+  /// Allocate \p size bytes in the immortal region. Objects allocated through this method are never relocated
+  /// or freed, and this call never triggers GC.
+  [[nodiscard]] void* allocateImmortal(size_t size);
+
+  /// Runs a garbage collection cycle, if the collector implementation and the current lock state allows it.
+  /// Finished collections are recorded in the statistics and, if enabled, in the GC log.
+  void performGarbageCollection(GcCause cause = GcCause::Explicit);
+
+  /// Called after a Java program stored a reference to \p value into a field or an element of \p holder
+  /// (`putfield`, `aastore` and `System.arraycopy`).
+  /// Collectors that need to track inter-object references (e.g. generational or concurrent collectors)
+  /// can override this hook; static fields are always scanned as roots and do not go through the barrier.
+  virtual void writeBarrier(Instance* /*holder*/, Instance* /*value*/)
+  {
+  }
 
-  void performGarbageCollection();
+  /// Iterates over all objects currently allocated on the heap, including the immortal region.
+  virtual std::generator<Instance*> objects() = 0;
+
+  /// Iterates over all objects currently pinned as GC roots.
+  std::generator<Instance*> pinnedObjects();
+
+  GcStatistics statistics() const;
+
+  /// Writes the summary of all collections to the GC log, if logging is enabled.
+  void logSummary();
 
   /// Marks the given object as a GC root. The return value of this function is a special reference that
   /// is GC-safe and is not invalidated when the GC relocates the pointed object.
@@ -261,6 +328,19 @@ public:
     return ScopedGcRootRef<T>(root, this);
   }
 
+  /// Returns a GC-safe reference to \p object, which must have been allocated in the immortal region. Immortal objects
+  /// are never relocated and their fields are scanned on every collection, so unlike `pin`, the object is not added
+  /// to the root list. The reference stays valid until the garbage collector is destroyed.
+  template<std::derived_from<Instance> T>
+  GcRootRef<T> immortalRef(T* object)
+  {
+    RootList::Node& node = mImmortalRefs.emplace_back(object, nullptr, nullptr);
+    return GcRootRef<T>(&node);
+  }
+
+  /// Iterates over all objects in the immortal region.
+  std::generator<Instance*> immortalObjects();
+
   /// Releases a given root reference. All other root references are invalidated.
   template<std::derived_from<Instance> T>
   void release(GcRootRef<T> object)
@@ -272,36 +352,47 @@ public:
     mRootList.remove(object.mReference);
   }
 
+  /// Returns the number of bytes occupied by the given object.
+  static size_t objectSize(Instance* instance);
+
   // Locks the garbage collector, preventing it from running.
   void lockGC();
 
   // Unlocks the garbage collector, allowing it to run.
   void unlockGC();
 
-  ~GarbageCollector();
+  virtual ~GarbageCollector() = default;
 
-private:
-  Instance* copyObject(Instance* instance, std::unordered_map<Instance*, Instance*>& map);
-  size_t processReferences(Instance* instance, std::unordered_map<Instance*, Instance*>& map);
+protected:
+  /// Performs the actual collection, filling the collector-specific parts of \p event (heap occupancy, copied objects
+  /// and root counts). Returns false if no collection took place. The garbage collector is locked during this call.
+  virtual bool collect(GcEvent& event) = 0;
 
-  /// Allocate space on the garbage-collected heap _without_ checking for heap boundaries.
-  /// Used inside the garbage collector when it is known that there is enough space available.
-  void* allocateUnchecked(size_t size);
+  /// Fills the heap occupancy and allocation counters of \p statistics.
+  virtual void fillStatistics(GcStatistics& statistics) const = 0;
 
-private:
+  size_t immortalBytesUsed() const;
+
+protected:
   Vm& mVm;
-  char* mFromRegion;
-  char* mToRegion;
-  char* mBumpPtr;
+  // Non-moving region for objects that live until the VM shuts down
+  ImmortalRegion mImmortalRegion;
   // Enabling/disabling GC
   bool mIsGcLocked = false;
   // Root lists
   RootList mRootList;
-  // GC settings
-  size_t mHeapSize = 0;
-  bool mRunAfterEveryAllocation = false;
+  // Stable reference targets handed out by `immortalRef`, never scanned by the collector
+  std::list<RootList::Node> mImmortalRefs;
+  // Statistics and logging
+  std::chrono::steady_clock::time_point mStartTime;
+  PauseHistogram mPauses;
+  std::optional<GcEvent> mLastCollection;
+  std::unique_ptr<GcLog> mLog;
 };
 
+/// Creates the garbage collector implementation selected in the VM settings.
+std::unique_ptr<GarbageCollector> createGarbageCollector(Vm& vm);
+
 template<std::derived_from<Instance> T>
 ScopedGcRootRef<T>::~ScopedGcRootRef()
 {
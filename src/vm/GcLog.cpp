@@ -0,0 +1,190 @@
+#include "vm/GcLog.h"
+
+#include "common/JvmError.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+#include <iostream>
+#include <utility>
+
+using namespace geevm;
+
+const char* geevm::gcCauseToString(GcCause cause)
+{
+  switch (cause) {
+    case GcCause::AllocationFailure: return "Allocation Failure";
+    case GcCause::AllocationStress: return "Allocation Stress";
+    case GcCause::InterpreterStress: return "Interpreter Stress";
+    case GcCause::Explicit: return "Explicit";
+  }
+  std::unreachable();
+}
+
+// Pause histogram
+//==--------------------------------------------------------------------------==//
+
+void PauseHistogram::record(std::chrono::nanoseconds pause)
+{
+  auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(pause).count());
+  // A pause of 'n' microseconds goes into the bucket of the smallest power of two strictly greater than 'n'
+  size_t bucket = std::min<size_t>(std::bit_width(micros), NumBuckets - 1);
+
+  mBuckets[bucket]++;
+  mCount++;
+  mTotal += pause;
+  mMax = std::max(mMax, pause);
+}
+
+std::optional<uint64_t> PauseHistogram::bucketUpperBound(size_t bucket)
+{
+  if (bucket >= NumBuckets - 1) {
+    return std::nullopt;
+  }
+  return uint64_t{1} << bucket;
+}
+
+// Settings
+//==--------------------------------------------------------------------------==//
+
+std::optional<GcLogSettings> GcLogSettings::parse(std::string_view option)
+{
+  // Expected format: gc[:<output>[:<format>]]
+  if (option.ends_with(':')) {
+    return std::nullopt;
+  }
+
+  auto next = [&option]() -> std::optional<std::string_view> {
+    if (option.empty()) {
+      return std::nullopt;
+    }
+    size_t pos = option.find(':');
+    std::string_view part = option.substr(0, pos);
+    option = pos == std::string_view::npos ? std::string_view{} : option.substr(pos + 1);
+    return part;
+  };
+
+  if (next() != "gc") {
+    return std::nullopt;
+  }
+
+  GcLogSettings settings;
+  if (auto output = next(); output.has_value()) {
+    if (output->empty()) {
+      return std::nullopt;
+    }
+    settings.output = *output;
+  }
+
+  if (auto format = next(); format.has_value()) {
+    if (*format == "text") {
+      settings.format = GcLogFormat::Text;
+    } else if (*format == "json") {
+      settings.format = GcLogFormat::Json;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  if (!option.empty()) {
+    return std::nullopt;
+  }
+
+  return settings;
+}
+
+// Log output
+//==--------------------------------------------------------------------------==//
+
+GcLog::GcLog(const GcLogSettings& settings)
+  : mFormat(settings.format)
+{
+  if (settings.output == "stderr") {
+    mStream = &std::cerr;
+  } else if (settings.output == "stdout") {
+    mStream = &std::cout;
+  } else {
+    mFile.open(settings.output, std::ios::out | std::ios::trunc);
+    if (!mFile) {
+      geevm_panic(std::format("could not open GC log file '{}'", settings.output));
+    }
+    mStream = &mFile;
+  }
+}
+
+static double toSeconds(std::chrono::nanoseconds duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+static double toMillis(std::chrono::nanoseconds duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void GcLog::logCollection(const GcEvent& event)
+{
+  if (mFormat == GcLogFormat::Json) {
+    stream() << std::format(R"({{"event":"gc","id":{},"cause":"{}","start_ns":{},"end_ns":{},"pause_ns":{},)"
+                            R"("heap_used_before":{},"heap_used_after":{},"heap_capacity":{},"objects_copied":{},"bytes_copied":{},)"
+                            R"("roots":{{"pinned":{},"immortal":{},"statics":{},"frames":{}}}}})",
+                            event.id, gcCauseToString(event.cause), event.start.count(), event.end.count(), event.pause().count(),
+                            event.heapUsedBefore, event.heapUsedAfter, event.heapCapacity, event.objectsCopied, event.bytesCopied,
+                            event.roots.pinned, event.roots.immortal, event.roots.statics, event.roots.frames)
+             << '\n';
+  } else {
+    stream() << std::format("[{:.3f}s][gc] GC({}) Pause ({}) {}K->{}K({}K) {:.3f}ms, copied {} objects ({}K), roots: pinned={} immortal={} "
+                            "statics={} frames={}",
+                            toSeconds(event.start), event.id, gcCauseToString(event.cause), event.heapUsedBefore / 1024, event.heapUsedAfter / 1024,
+                            event.heapCapacity / 1024, toMillis(event.pause()), event.objectsCopied, event.bytesCopied / 1024, event.roots.pinned,
+                            event.roots.immortal, event.roots.statics, event.roots.frames)
+             << '\n';
+  }
+
+  stream().flush();
+}
+
+void GcLog::logSummary(const GcStatistics& statistics)
+{
+  const PauseHistogram& pauses = statistics.pauses;
+
+  if (mFormat == GcLogFormat::Json) {
+    std::string buckets;
+    for (size_t i = 0; i < PauseHistogram::NumBuckets; i++) {
+      if (pauses.bucketCount(i) == 0) {
+        continue;
+      }
+      if (!buckets.empty()) {
+        buckets += ',';
+      }
+      auto bound = PauseHistogram::bucketUpperBound(i);
+      buckets += std::format(R"({{"lt_us":{},"count":{}}})", bound ? std::to_string(*bound) : "null", pauses.bucketCount(i));
+    }
+
+    stream() << std::format(R"({{"event":"summary","collections":{},"total_bytes_allocated":{},"heap_used":{},"heap_capacity":{},)"
+                            R"("immortal_used":{},"total_pause_ns":{},"max_pause_ns":{},"pause_histogram":[{}]}})",
+                            statistics.collections, statistics.totalBytesAllocated, statistics.heapUsed, statistics.heapCapacity,
+                            statistics.immortalUsed, pauses.total().count(), pauses.max().count(), buckets)
+             << '\n';
+  } else {
+    stream() << std::format("[gc] Summary: {} collections, {}K allocated, heap {}K/{}K, immortal {}K, total pause {:.3f}ms, max pause {:.3f}ms",
+                            statistics.collections, statistics.totalBytesAllocated / 1024, statistics.heapUsed / 1024, statistics.heapCapacity / 1024,
+                            statistics.immortalUsed / 1024, toMillis(pauses.total()), toMillis(pauses.max()))
+             << '\n';
+
+    uint64_t lowerBound = 0;
+    for (size_t i = 0; i < PauseHistogram::NumBuckets; i++) {
+      auto bound = PauseHistogram::bucketUpperBound(i);
+      if (pauses.bucketCount(i) != 0) {
+        if (bound.has_value()) {
+          stream() << std::format("[gc]   [{}us, {}us): {}", lowerBound, *bound, pauses.bucketCount(i)) << '\n';
+        } else {
+          stream() << std::format("[gc]   [{}us, inf): {}", lowerBound, pauses.bucketCount(i)) << '\n';
+        }
+      }
+      lowerBound = bound.value_or(lowerBound);
+    }
+  }
+
+  stream().flush();
+}
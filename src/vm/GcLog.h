@@ -0,0 +1,185 @@
+#ifndef GEEVM_VM_GCLOG_H
+#define GEEVM_VM_GCLOG_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+namespace geevm
+{
+
+/// The reason a garbage collection cycle was started.
+enum class GcCause
+{
+  // The collected heap could not satisfy an allocation request
+  AllocationFailure,
+  // The VM was configured to collect after every allocation (-Xgc-after-every-alloc)
+  AllocationStress,
+  // The interpreter was configured to collect before every call and allocation (-Xgc-stress-interpreter)
+  InterpreterStress,
+  // Explicitly requested, e.g. through `System.gc()`
+  Explicit,
+};
+
+const char* gcCauseToString(GcCause cause);
+
+/// Number of GC roots found during a collection, by category. Null references are not counted.
+struct GcRootCounts
+{
+  // Manually pinned roots: JNI handles and other objects pinned by the VM
+  size_t pinned = 0;
+  // Objects of the immortal region, scanned for references into the collected heap
+  size_t immortal = 0;
+  // Reference-typed static fields
+  size_t statics = 0;
+  // References in local variables and operand stacks of Java frames
+  size_t frames = 0;
+
+  size_t total() const
+  {
+    return pinned + immortal + statics + frames;
+  }
+};
+
+/// Describes a single, finished garbage collection cycle.
+struct GcEvent
+{
+  using Duration = std::chrono::nanoseconds;
+
+  // Sequence number of the collection, starting from zero
+  size_t id = 0;
+  GcCause cause = GcCause::Explicit;
+  // Start and end of the collection, relative to the creation of the garbage collector
+  Duration start{0};
+  Duration end{0};
+  // Heap occupancy before and after the collection
+  size_t heapUsedBefore = 0;
+  size_t heapUsedAfter = 0;
+  size_t heapCapacity = 0;
+  // Live objects moved by the collector
+  size_t objectsCopied = 0;
+  size_t bytesCopied = 0;
+  GcRootCounts roots;
+
+  Duration pause() const
+  {
+    return end - start;
+  }
+};
+
+/// A histogram of GC pause times with power-of-two microsecond buckets.
+///
+/// Bucket `i` holds pauses shorter than `2^i` microseconds (and not shorter than the bound of the previous bucket),
+/// the last bucket collects everything that does not fit anywhere else.
+class PauseHistogram
+{
+public:
+  static constexpr size_t NumBuckets = 24;
+
+  void record(std::chrono::nanoseconds pause);
+
+  /// The exclusive upper bound of the given bucket in microseconds, or an empty optional for the last, unbounded bucket.
+  static std::optional<uint64_t> bucketUpperBound(size_t bucket);
+
+  size_t bucketCount(size_t bucket) const
+  {
+    return mBuckets[bucket];
+  }
+
+  size_t count() const
+  {
+    return mCount;
+  }
+
+  std::chrono::nanoseconds total() const
+  {
+    return mTotal;
+  }
+
+  std::chrono::nanoseconds max() const
+  {
+    return mMax;
+  }
+
+private:
+  std::array<size_t, NumBuckets> mBuckets{};
+  size_t mCount = 0;
+  std::chrono::nanoseconds mTotal{0};
+  std::chrono::nanoseconds mMax{0};
+};
+
+/// Heap statistics reported by a garbage collector.
+struct GcStatistics
+{
+  // Number of completed collections
+  size_t collections = 0;
+  // Total number of bytes allocated on the collected heap since startup
+  size_t totalBytesAllocated = 0;
+  // Bytes currently in use on the collected heap
+  size_t heapUsed = 0;
+  // Number of bytes available for allocations on the collected heap
+  size_t heapCapacity = 0;
+  // Bytes currently in use in the immortal region
+  size_t immortalUsed = 0;
+  // Distribution of pause times over all collections
+  PauseHistogram pauses;
+  // The most recent collection, if there was any
+  std::optional<GcEvent> lastCollection;
+};
+
+enum class GcLogFormat
+{
+  // Human-readable, one line per event
+  Text,
+  // One JSON object per line
+  Json,
+};
+
+/// Configuration of the GC event log, as parsed from `-Xlog:gc[:<output>[:<format>]]`.
+struct GcLogSettings
+{
+  // Path of the log file, or "stdout"/"stderr"
+  std::string output = "stderr";
+  GcLogFormat format = GcLogFormat::Text;
+
+  /// Parses the value of an `-Xlog:gc` option (e.g. "gc", "gc:gc.log", "gc:stdout:json").
+  /// Returns an empty optional if the option is malformed.
+  static std::optional<GcLogSettings> parse(std::string_view option);
+};
+
+/// Writes garbage collection events to a stream.
+class GcLog
+{
+public:
+  explicit GcLog(const GcLogSettings& settings);
+
+  GcLog(const GcLog&) = delete;
+  GcLog& operator=(const GcLog&) = delete;
+
+  void logCollection(const GcEvent& event);
+
+  /// Writes a summary of all collections, including the pause histogram.
+  void logSummary(const GcStatistics& statistics);
+
+private:
+  std::ostream& stream()
+  {
+    return *mStream;
+  }
+
+private:
+  GcLogFormat mFormat;
+  std::ofstream mFile;
+  std::ostream* mStream;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_GCLOG_H
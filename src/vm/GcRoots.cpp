@@ -239,29 +239,32 @@ void AbstractInterpreter::shift(VerificationTypeInfo vti)
 void AbstractInterpreter::invoke(Opcode opcode)
 {
   size_t opcodePos = mCode.pos() - 1;
-  const JMethod* method = nullptr;
+  types::u2 index = 0;
   RuntimeConstantPool& rt = mMethod->getClass()->runtimeConstantPool();
 
+  // Only the descriptor is needed, so the callee is not resolved: frames may be scanned while the call throws its
+  // resolution error
   switch (opcode) {
     case Opcode::INVOKEVIRTUAL:
     case Opcode::INVOKESPECIAL:
-    case Opcode::INVOKESTATIC: method = rt.getMethodRef(mCode.readU2()); break;
+    case Opcode::INVOKESTATIC: index = mCode.readU2(); break;
     case Opcode::INVOKEINTERFACE:
-      method = rt.getMethodRef(mCode.readU2());
+      index = mCode.readU2();
       // Consume 'count' and '0'
       mCode.skip(2);
       break;
     default: GEEVM_UNREACHBLE("Unknown invoke opcode!");
   }
 
-  uint16_t numArgs = method->descriptor().numParameterSlots();
-  if (!method->isStatic()) {
+  MethodDescriptor descriptor = rt.methodRefDescriptor(index);
+  uint16_t numArgs = descriptor.numParameterSlots();
+  if (opcode != Opcode::INVOKESTATIC) {
     numArgs++;
   }
   mStackPointer -= numArgs;
 
-  if (!method->descriptor().returnType().isVoid()) {
-    push(fieldTypeToVerificationTypeInfo(method->descriptor().returnType().getType()));
+  if (!descriptor.returnType().isVoid()) {
+    push(fieldTypeToVerificationTypeInfo(descriptor.returnType().getType()));
   }
 }
 
@@ -759,6 +762,23 @@ void AbstractInterpreter::execute(types::u4 startPos)
       case Opcode::IMPDEP2:
         // No-op
         break;
+      case Opcode::ALOAD_0_GETFIELD:
+      case Opcode::ILOAD_ILOAD_IADD:
+      case Opcode::ILOAD_0_ILOAD_IADD:
+      case Opcode::ILOAD_1_ILOAD_IADD:
+      case Opcode::ILOAD_2_ILOAD_IADD:
+      case Opcode::ILOAD_3_ILOAD_IADD:
+      case Opcode::ILOAD_ICONST_IF_ICMPGE:
+      case Opcode::ILOAD_0_ICONST_IF_ICMPGE:
+      case Opcode::ILOAD_1_ICONST_IF_ICMPGE:
+      case Opcode::ILOAD_2_ICONST_IF_ICMPGE:
+      case Opcode::ILOAD_3_ICONST_IF_ICMPGE:
+      case Opcode::ALOAD_ARRAYLENGTH:
+      case Opcode::ALOAD_0_ARRAYLENGTH:
+      case Opcode::ALOAD_1_ARRAYLENGTH:
+      case Opcode::ALOAD_2_ARRAYLENGTH:
+      case Opcode::ALOAD_3_ARRAYLENGTH:
+      case Opcode::IINC_GOTO: GEEVM_UNREACHBLE("Superinstructions only occur in the interpreter's copy of the bytecode");
     }
   }
 }
@@ -4,10 +4,15 @@
 using namespace geevm;
 
 JavaHeap::JavaHeap(Vm& vm)
-  : mVm(vm), mGC(vm)
+  : mVm(vm), mGC(createGarbageCollector(vm))
 {
 }
 
+JavaHeap::~JavaHeap()
+{
+  mGC->logSummary();
+}
+
 void JavaHeap::initialize(InstanceClass* stringClass, ArrayClass* byteArrayClass)
 {
   assert(stringClass->className() == u"java/lang/String");
@@ -19,7 +24,10 @@ void JavaHeap::initialize(InstanceClass* stringClass, ArrayClass* byteArrayClass
 
 ArrayInstance* JavaHeap::allocateArray(ArrayClass* klass, int32_t length)
 {
-  auto elementType = klass->fieldType().asArrayType()->getElementType();
+  const FieldType& elementType = klass->elementType();
+  if (elementType.isReferenceOrArray()) {
+    return this->allocateArray<Instance*>(klass, length);
+  }
 
   return elementType.map([&]<PrimitiveType Type>() -> ArrayInstance* {
     using Representation = typename PrimitiveTypeTraits<Type>::Representation;
@@ -31,6 +39,15 @@ ArrayInstance* JavaHeap::allocateArray(ArrayClass* klass, int32_t length)
   });
 }
 
+static void copyStringContents(JavaArray<int8_t>& contents, const types::JString& string)
+{
+  for (int32_t i = 0; i < string.size(); ++i) {
+    char16_t c = string[i];
+    contents[2 * i] = std::bit_cast<int8_t>(static_cast<uint8_t>(c & 0xff));
+    contents[2 * i + 1] = std::bit_cast<int8_t>(static_cast<uint8_t>((c >> 8) & 0xff));
+  }
+}
+
 GcRootRef<JavaString> JavaHeap::intern(const types::JString& string)
 {
   if (auto it = mInternedStrings.find(string); it != mInternedStrings.end()) {
@@ -40,15 +57,34 @@ GcRootRef<JavaString> JavaHeap::intern(const types::JString& string)
   assert(mStringClass != nullptr);
   assert(mByteArrayClass != nullptr);
 
-  GcRootRef<JavaString> newInstance = mGC.pin(this->allocate<JavaString>(mStringClass)).release();
-  auto* stringContents = this->allocateArray<int8_t>(mByteArrayClass, string.size() * 2);
-  for (int32_t i = 0; i < string.size(); ++i) {
-    char16_t c = string[i];
-    (*stringContents)[2 * i] = std::bit_cast<int8_t>(static_cast<uint8_t>(c & 0xff));
-    (*stringContents)[2 * i + 1] = std::bit_cast<int8_t>(static_cast<uint8_t>((c >> 8) & 0xff));
-  }
+  GcRootRef<JavaString> newInstance = mGC->immortalRef(this->allocateImmortal<JavaString>(mStringClass));
+  auto* stringContents = this->allocateImmortalArray<int8_t>(mByteArrayClass, string.size() * 2);
+  copyStringContents(*stringContents, string);
   newInstance->setFieldValue<Instance*>(u"value", u"[B", stringContents);
 
   auto [res, _] = mInternedStrings.try_emplace(string, newInstance);
   return res->second;
 }
+
+JavaString* JavaHeap::allocateString(const types::JString& string)
+{
+  assert(mStringClass != nullptr);
+  assert(mByteArrayClass != nullptr);
+
+  auto* allocated = this->allocate<JavaString>(mStringClass);
+  if (allocated == nullptr) {
+    return nullptr;
+  }
+
+  // Allocating the contents may trigger a collection that relocates the string
+  ScopedGcRootRef<JavaString> newInstance = mGC->pin(allocated);
+  auto* stringContents = this->allocateArray<int8_t>(mByteArrayClass, string.size() * 2);
+  if (stringContents == nullptr) {
+    return nullptr;
+  }
+
+  copyStringContents(*stringContents, string);
+  newInstance->setFieldValue<Instance*>(u"value", u"[B", stringContents);
+
+  return newInstance.get();
+}
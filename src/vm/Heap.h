@@ -27,25 +27,33 @@ public:
   /// All calls to 'intern' are invalid before the heap has been initialized.
   void initialize(InstanceClass* stringClass, ArrayClass* byteArrayClass);
 
-  /// Allocates heap memory for and constructs an instance of `klass`.
+  /// Allocates heap memory for and constructs an instance of `klass`. Returns nullptr if the heap is exhausted, in which
+  /// case the caller throws an `OutOfMemoryError` (see `JavaThread::throwOutOfMemoryError`).
   template<std::derived_from<Instance> T, class... Args>
   T* allocate(InstanceClass* klass, Args&&... args)
   {
     size_t size = klass->allocationSize();
-    void* mem = mGC.allocate(size);
+    void* mem = mGC->allocate(size);
+    if (mem == nullptr) [[unlikely]] {
+      return nullptr;
+    }
 
     auto object = new (mem) T(klass, std::forward<Args>(args)...);
     return object;
   }
 
-  /// Allocates heap memory for an array instance of the array class 'klass' of a given length.
+  /// Allocates heap memory for an array instance of the array class 'klass' of a given length. Returns nullptr if the
+  /// heap is exhausted, like `allocate`.
   template<JvmType T>
   JavaArray<T>* allocateArray(ArrayClass* klass, int32_t length)
   {
     assert(length >= 0);
 
     size_t size = klass->allocationSize(length);
-    void* mem = mGC.allocate(size);
+    void* mem = mGC->allocate(size);
+    if (mem == nullptr) [[unlikely]] {
+      return nullptr;
+    }
 
     auto array = new (mem) JavaArray<T>(klass, length);
     return array;
@@ -53,20 +61,58 @@ public:
 
   ArrayInstance* allocateArray(ArrayClass* klass, int32_t length);
 
+  /// Allocates and constructs an instance of `klass` in the immortal region.
+  /// Immortal objects are never relocated or collected, use this only for objects that live as long as the VM
+  /// (class mirrors, interned strings, threads).
+  template<std::derived_from<Instance> T, class... Args>
+  T* allocateImmortal(InstanceClass* klass, Args&&... args)
+  {
+    size_t size = klass->allocationSize();
+    void* mem = mGC->allocateImmortal(size);
+
+    auto object = new (mem) T(klass, std::forward<Args>(args)...);
+    return object;
+  }
+
+  /// Allocates an array instance of the array class 'klass' in the immortal region.
+  template<JvmType T>
+  JavaArray<T>* allocateImmortalArray(ArrayClass* klass, int32_t length)
+  {
+    assert(length >= 0);
+
+    size_t size = klass->allocationSize(length);
+    void* mem = mGC->allocateImmortal(size);
+
+    auto array = new (mem) JavaArray<T>(klass, length);
+    return array;
+  }
+
   /// Interns the given string.
-  /// If this method constructs a new string object, it will be pinned by the garbage collector and kept alive
+  /// If this method constructs a new string object, it is allocated in the immortal region and kept alive
   /// until the heap is destroyed.
   GcRootRef<JavaString> intern(const types::JString& string);
 
+  /// Allocates a new, non-interned string with the given contents on the garbage-collected heap. Returns nullptr if
+  /// the heap is exhausted, like `allocate`.
+  JavaString* allocateString(const types::JString& string);
+
   GarbageCollector& gc()
   {
-    return mGC;
+    return *mGC;
   }
 
+  /// Returns a snapshot of the heap occupancy and collection statistics.
+  GcStatistics statistics() const
+  {
+    return mGC->statistics();
+  }
+
+  ~JavaHeap();
+
 private:
   Vm& mVm;
   // Garbage-collected heap
-  GarbageCollector mGC;
+  std::unique_ptr<GarbageCollector> mGC;
   // Interned strings, including classes that need to present for string interning
   std::unordered_map<types::JString, GcRootRef<JavaString>> mInternedStrings;
   InstanceClass* mStringClass = nullptr;
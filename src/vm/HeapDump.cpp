@@ -0,0 +1,687 @@
+#include "vm/HeapDump.h"
+
+#include "common/Encoding.h"
+#include "vm/Class.h"
+#include "vm/GcRoots.h"
+#include "vm/Vm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace geevm;
+
+namespace
+{
+
+// HPROF record tags
+//==--------------------------------------------------------------------------==//
+namespace tag
+{
+constexpr uint8_t String = 0x01;
+constexpr uint8_t LoadClass = 0x02;
+constexpr uint8_t StackFrame = 0x04;
+constexpr uint8_t StackTrace = 0x05;
+constexpr uint8_t HeapDumpSegment = 0x1C;
+constexpr uint8_t HeapDumpEnd = 0x2C;
+} // namespace tag
+
+namespace subtag
+{
+constexpr uint8_t RootUnknown = 0xFF;
+constexpr uint8_t RootJniLocal = 0x02;
+constexpr uint8_t RootJavaFrame = 0x03;
+constexpr uint8_t RootStickyClass = 0x05;
+constexpr uint8_t RootThreadObject = 0x08;
+constexpr uint8_t ClassDump = 0x20;
+constexpr uint8_t InstanceDump = 0x21;
+constexpr uint8_t ObjectArrayDump = 0x22;
+constexpr uint8_t PrimitiveArrayDump = 0x23;
+} // namespace subtag
+
+enum class BasicType : uint8_t
+{
+  Object = 2,
+  Boolean = 4,
+  Char = 5,
+  Float = 6,
+  Double = 7,
+  Byte = 8,
+  Short = 9,
+  Int = 10,
+  Long = 11,
+};
+
+BasicType basicTypeOf(const FieldType& fieldType)
+{
+  auto primitive = fieldType.asPrimitive();
+  if (!primitive.has_value()) {
+    return BasicType::Object;
+  }
+
+  switch (*primitive) {
+    case PrimitiveType::Byte: return BasicType::Byte;
+    case PrimitiveType::Char: return BasicType::Char;
+    case PrimitiveType::Double: return BasicType::Double;
+    case PrimitiveType::Float: return BasicType::Float;
+    case PrimitiveType::Int: return BasicType::Int;
+    case PrimitiveType::Long: return BasicType::Long;
+    case PrimitiveType::Short: return BasicType::Short;
+    case PrimitiveType::Boolean: return BasicType::Boolean;
+  }
+  GEEVM_UNREACHBLE("Unknown primitive type");
+}
+
+size_t basicTypeSize(BasicType type)
+{
+  switch (type) {
+    case BasicType::Object: return sizeof(uint64_t);
+    case BasicType::Boolean:
+    case BasicType::Byte: return 1;
+    case BasicType::Char:
+    case BasicType::Short: return 2;
+    case BasicType::Float:
+    case BasicType::Int: return 4;
+    case BasicType::Double:
+    case BasicType::Long: return 8;
+  }
+  GEEVM_UNREACHBLE("Unknown basic type");
+}
+
+// Identifiers are pointer-sized
+constexpr uint32_t IdentifierSize = sizeof(uint64_t);
+// Heap dump segments are flushed after they reach this size, so the dump is never held in memory as a whole
+constexpr size_t HeapDumpSegmentLimit = 16 * 1024 * 1024;
+// Serial number of the empty stack trace used for objects with unknown allocation sites
+constexpr uint32_t UnknownStackTraceSerial = 1;
+
+/// A buffer of big-endian encoded HPROF data.
+class Buffer
+{
+public:
+  void u1(uint8_t value)
+  {
+    mData.push_back(value);
+  }
+
+  void u2(uint16_t value)
+  {
+    this->writeBigEndian(value, 2);
+  }
+
+  void u4(uint32_t value)
+  {
+    this->writeBigEndian(value, 4);
+  }
+
+  void u8(uint64_t value)
+  {
+    this->writeBigEndian(value, 8);
+  }
+
+  void id(const void* ptr)
+  {
+    this->u8(reinterpret_cast<uintptr_t>(ptr));
+  }
+
+  void id(uint64_t value)
+  {
+    this->u8(value);
+  }
+
+  /// Writes a value of the given type stored in native byte order at \p ptr.
+  void value(BasicType type, const void* ptr)
+  {
+    size_t size = basicTypeSize(type);
+    uint64_t raw = 0;
+    std::memcpy(&raw, ptr, size);
+    this->writeBigEndian(raw, size);
+  }
+
+  void bytes(const std::string& str)
+  {
+    mData.insert(mData.end(), str.begin(), str.end());
+  }
+
+  size_t size() const
+  {
+    return mData.size();
+  }
+
+  const std::vector<uint8_t>& data() const
+  {
+    return mData;
+  }
+
+  void clear()
+  {
+    mData.clear();
+  }
+
+private:
+  void writeBigEndian(uint64_t value, size_t size)
+  {
+    for (size_t i = size; i > 0; i--) {
+      mData.push_back(static_cast<uint8_t>(value >> ((i - 1) * 8)));
+    }
+  }
+
+private:
+  std::vector<uint8_t> mData;
+};
+
+/// Returns the line number of the instruction executed by \p frame as encoded in STACK FRAME records: 0 means 'no
+/// line information', -3 marks native methods.
+int32_t frameLineNumber(CallFrame& frame)
+{
+  JMethod* method = frame.currentMethod();
+  if (method->isNative()) {
+    return -3;
+  }
+
+  // The program counter of a frame already points past the opcode of the instruction being executed
+  int64_t pc = frame.programCounter();
+  return method->getCode().lineNumberAt(pc > 0 ? pc - 1 : 0).value_or(0);
+}
+
+class HprofWriter
+{
+public:
+  HprofWriter(Vm& vm, std::ostream& out)
+    : mVm(vm), mOut(out)
+  {
+  }
+
+  void write();
+
+private:
+  // Top-level records
+  void writeHeader();
+  void writeRecord(uint8_t tag, const Buffer& body);
+  uint64_t stringId(const std::string& str);
+  uint64_t stringId(types::JStringRef str);
+  void writeLoadClasses();
+  void writeThreadStackTraces();
+
+  // Heap dump
+  void writeRoots();
+  void writeClassDump(JClass* klass);
+  void writeInstanceDump(Instance* instance);
+  void writeArrayDump(ArrayInstance* array);
+  void finishSubRecord();
+
+  uint64_t classId(JClass* klass);
+  const std::vector<JField*>& declaredInstanceFields(JClass* klass);
+  const std::vector<JField*>& instanceFieldLayout(JClass* klass);
+
+private:
+  Vm& mVm;
+  std::ostream& mOut;
+  Buffer mSegment;
+  JClass* mClassClass = nullptr;
+  std::unordered_map<std::string, uint64_t> mStrings;
+  std::unordered_map<JClass*, uint32_t> mClassSerials;
+  std::unordered_map<JavaThread*, uint32_t> mThreadSerials;
+  std::unordered_map<JClass*, std::vector<JField*>> mDeclaredFields;
+  std::unordered_map<JClass*, std::vector<JField*>> mFieldLayouts;
+};
+
+} // namespace
+
+void HprofWriter::write()
+{
+  for (const auto& [name, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
+    if (name == u"java/lang/Class") {
+      mClassClass = klass.get();
+    }
+  }
+
+  this->writeHeader();
+  this->writeLoadClasses();
+  this->writeThreadStackTraces();
+
+  this->writeRoots();
+
+  for (const auto& [_, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
+    this->writeClassDump(klass.get());
+  }
+
+  for (Instance* instance : mVm.heap().gc().objects()) {
+    if (instance->getClass()->isArrayType()) {
+      this->writeArrayDump(instance->toArrayInstance());
+    } else if (instance->getClass() != mClassClass) {
+      // Class mirrors are represented by their class dump records
+      this->writeInstanceDump(instance);
+    }
+  }
+
+  if (mSegment.size() != 0) {
+    this->writeRecord(tag::HeapDumpSegment, mSegment);
+  }
+  this->writeRecord(tag::HeapDumpEnd, Buffer{});
+
+  mOut.flush();
+}
+
+void HprofWriter::writeHeader()
+{
+  static constexpr char Format[] = "JAVA PROFILE 1.0.2";
+  mOut.write(Format, sizeof(Format));
+
+  auto now = std::chrono::system_clock::now().time_since_epoch();
+  Buffer header;
+  header.u4(IdentifierSize);
+  header.u8(std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+  mOut.write(reinterpret_cast<const char*>(header.data().data()), header.size());
+}
+
+void HprofWriter::writeRecord(uint8_t tag, const Buffer& body)
+{
+  Buffer header;
+  header.u1(tag);
+  // Microseconds since the header timestamp
+  header.u4(0);
+  header.u4(body.size());
+
+  mOut.write(reinterpret_cast<const char*>(header.data().data()), header.size());
+  mOut.write(reinterpret_cast<const char*>(body.data().data()), body.size());
+}
+
+uint64_t HprofWriter::stringId(const std::string& str)
+{
+  if (auto it = mStrings.find(str); it != mStrings.end()) {
+    return it->second;
+  }
+
+  uint64_t id = mStrings.size() + 1;
+  mStrings.try_emplace(str, id);
+
+  Buffer record;
+  record.id(id);
+  record.bytes(str);
+  this->writeRecord(tag::String, record);
+
+  return id;
+}
+
+uint64_t HprofWriter::stringId(types::JStringRef str)
+{
+  return this->stringId(utf16ToUtf8(str));
+}
+
+uint64_t HprofWriter::classId(JClass* klass)
+{
+  if (klass == nullptr) {
+    return 0;
+  }
+
+  // The identifier of a class is the address of its mirror, so that references to class objects resolve to the class
+  if (Instance* mirror = klass->classInstance().get(); mirror != nullptr) {
+    return reinterpret_cast<uintptr_t>(mirror);
+  }
+  return reinterpret_cast<uintptr_t>(klass);
+}
+
+void HprofWriter::writeLoadClasses()
+{
+  for (const auto& [name, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
+    uint32_t serial = mClassSerials.size() + 1;
+    mClassSerials.try_emplace(klass.get(), serial);
+
+    Buffer record;
+    record.u4(serial);
+    record.id(this->classId(klass.get()));
+    record.u4(UnknownStackTraceSerial);
+    record.id(this->stringId(name));
+    this->writeRecord(tag::LoadClass, record);
+  }
+}
+
+void HprofWriter::writeThreadStackTraces()
+{
+  Buffer unknownTrace;
+  unknownTrace.u4(UnknownStackTraceSerial);
+  unknownTrace.u4(0);
+  unknownTrace.u4(0);
+  this->writeRecord(tag::StackTrace, unknownTrace);
+
+  uint64_t frameId = 1;
+  for (JavaThread* thread : mVm.threads()) {
+    uint32_t threadSerial = mThreadSerials.size() + 1;
+    mThreadSerials.try_emplace(thread, threadSerial);
+
+    std::vector<uint64_t> frameIds;
+    for (CallFrame& frame : thread->callStack()) {
+      JMethod* method = frame.currentMethod();
+      InstanceClass* klass = frame.currentClass();
+
+      Buffer record;
+      record.id(frameId);
+      record.id(this->stringId(method->name()));
+      record.id(this->stringId(method->rawDescriptor()));
+      record.id(this->stringId(klass->sourceFile().value_or(u"")));
+      record.u4(mClassSerials[klass]);
+      record.u4(static_cast<uint32_t>(frameLineNumber(frame)));
+      this->writeRecord(tag::StackFrame, record);
+
+      frameIds.push_back(frameId++);
+    }
+
+    Buffer trace;
+    trace.u4(UnknownStackTraceSerial + threadSerial);
+    trace.u4(threadSerial);
+    trace.u4(frameIds.size());
+    for (uint64_t id : frameIds) {
+      trace.id(id);
+    }
+    this->writeRecord(tag::StackTrace, trace);
+  }
+}
+
+void HprofWriter::finishSubRecord()
+{
+  if (mSegment.size() >= HeapDumpSegmentLimit) {
+    this->writeRecord(tag::HeapDumpSegment, mSegment);
+    mSegment.clear();
+  }
+}
+
+void HprofWriter::writeRoots()
+{
+  // Loaded classes are always reachable
+  for (const auto& [_, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
+    mSegment.u1(subtag::RootStickyClass);
+    mSegment.id(this->classId(klass.get()));
+    this->finishSubRecord();
+  }
+
+  std::unordered_set<Instance*> threadRoots;
+  for (JavaThread* thread : mVm.threads()) {
+    uint32_t threadSerial = mThreadSerials.at(thread);
+
+    if (Instance* threadObject = thread->instance().get(); threadObject != nullptr) {
+      mSegment.u1(subtag::RootThreadObject);
+      mSegment.id(threadObject);
+      mSegment.u4(threadSerial);
+      mSegment.u4(UnknownStackTraceSerial + threadSerial);
+      this->finishSubRecord();
+      threadRoots.insert(threadObject);
+    }
+
+    for (const auto& frameHandles : thread->jniHandles()) {
+      for (const GcRootRef<>& handle : frameHandles) {
+        if (handle.get() == nullptr) {
+          continue;
+        }
+        mSegment.u1(subtag::RootJniLocal);
+        mSegment.id(handle.get());
+        mSegment.u4(threadSerial);
+        // The mapping between JNI frames and Java frames is not tracked
+        mSegment.u4(static_cast<uint32_t>(-1));
+        this->finishSubRecord();
+        threadRoots.insert(handle.get());
+      }
+    }
+
+    uint32_t frameNumber = 0;
+    for (CallFrame& frame : thread->callStack()) {
+      if (!frame.currentMethod()->isNative()) {
+        FrameRoots roots = FrameRoots::compute(frame.currentMethod(), frame.programCounter());
+        auto writeFrameRoot = [&](Instance* object) {
+          if (object == nullptr) {
+            return;
+          }
+          mSegment.u1(subtag::RootJavaFrame);
+          mSegment.id(object);
+          mSegment.u4(threadSerial);
+          mSegment.u4(frameNumber);
+          this->finishSubRecord();
+        };
+
+        for (auto [_, object] : roots.referencesInLocals(frame)) {
+          writeFrameRoot(object);
+        }
+        for (auto [_, object] : roots.referencesInOperandStack(frame)) {
+          writeFrameRoot(object);
+        }
+      }
+      frameNumber++;
+    }
+  }
+
+  // Remaining pinned and immortal objects (interned strings, preallocated exceptions, VM-internal references). Class
+  // mirrors are covered by the sticky class roots, JNI handles and thread objects by the per-thread roots above.
+  auto writeUnknownRoot = [&](Instance* object) {
+    if (object->getClass() == mClassClass || threadRoots.contains(object)) {
+      return;
+    }
+    mSegment.u1(subtag::RootUnknown);
+    mSegment.id(object);
+    this->finishSubRecord();
+  };
+  for (Instance* pinned : mVm.heap().gc().pinnedObjects()) {
+    writeUnknownRoot(pinned);
+  }
+  for (Instance* immortal : mVm.heap().gc().immortalObjects()) {
+    writeUnknownRoot(immortal);
+  }
+}
+
+const std::vector<JField*>& HprofWriter::declaredInstanceFields(JClass* klass)
+{
+  if (auto it = mDeclaredFields.find(klass); it != mDeclaredFields.end()) {
+    return it->second;
+  }
+
+  // Inherited fields are copied into the field table of subclasses, so the fields declared by this class
+  // are the instance fields that do not appear in the superclass.
+  std::vector<JField*> declared;
+  for (const auto& [key, field] : klass->fields()) {
+    if (field->isStatic()) {
+      continue;
+    }
+    if (klass->superClass() != nullptr) {
+      if (auto it = klass->superClass()->fields().find(key); it != klass->superClass()->fields().end() && !it->second->isStatic()) {
+        continue;
+      }
+    }
+    declared.push_back(field.get());
+  }
+
+  std::ranges::sort(declared, {}, &JField::offset);
+
+  return mDeclaredFields.try_emplace(klass, std::move(declared)).first->second;
+}
+
+const std::vector<JField*>& HprofWriter::instanceFieldLayout(JClass* klass)
+{
+  if (auto it = mFieldLayouts.find(klass); it != mFieldLayouts.end()) {
+    return it->second;
+  }
+
+  // Instance dumps list the values of the fields declared by the class itself first, followed by the fields of
+  // each superclass. Offsets are always taken from the field table of the concrete class.
+  std::vector<JField*> layout;
+  for (JClass* current = klass; current != nullptr; current = current->superClass()) {
+    for (JField* declared : this->declaredInstanceFields(current)) {
+      layout.push_back(klass->fields().at({declared->name(), declared->descriptor()}).get());
+    }
+  }
+
+  return mFieldLayouts.try_emplace(klass, std::move(layout)).first->second;
+}
+
+void HprofWriter::writeClassDump(JClass* klass)
+{
+  mSegment.u1(subtag::ClassDump);
+  mSegment.id(this->classId(klass));
+  mSegment.u4(UnknownStackTraceSerial);
+  mSegment.id(this->classId(klass->superClass()));
+  // Class loader, signers, protection domain and two reserved identifiers
+  for (int i = 0; i < 5; i++) {
+    mSegment.id(uint64_t{0});
+  }
+
+  uint32_t instanceSize = 0;
+  for (JField* field : this->instanceFieldLayout(klass)) {
+    instanceSize += basicTypeSize(basicTypeOf(field->fieldType()));
+  }
+  mSegment.u4(instanceSize);
+
+  // Constant pool
+  mSegment.u2(0);
+
+  std::vector<JField*> staticFields;
+  for (const auto& [_, field] : klass->fields()) {
+    if (field->isStatic()) {
+      staticFields.push_back(field.get());
+    }
+  }
+  std::ranges::sort(staticFields, {}, &JField::offset);
+
+  mSegment.u2(staticFields.size());
+  for (JField* field : staticFields) {
+    BasicType type = basicTypeOf(field->fieldType());
+    auto [raw, _] = klass->getStaticFieldValue(field->offset()).toRaw();
+
+    mSegment.id(this->stringId(field->name()));
+    mSegment.u1(static_cast<uint8_t>(type));
+    // Static field values are stored zero-extended in a 64-bit slot
+    if (type == BasicType::Object) {
+      mSegment.id(raw);
+    } else {
+      mSegment.value(type, &raw);
+    }
+  }
+
+  const std::vector<JField*>& declared = this->declaredInstanceFields(klass);
+  mSegment.u2(declared.size());
+  for (JField* field : declared) {
+    mSegment.id(this->stringId(field->name()));
+    mSegment.u1(static_cast<uint8_t>(basicTypeOf(field->fieldType())));
+  }
+
+  this->finishSubRecord();
+}
+
+void HprofWriter::writeInstanceDump(Instance* instance)
+{
+  JClass* klass = instance->getClass();
+  const std::vector<JField*>& layout = this->instanceFieldLayout(klass);
+
+  uint32_t valuesSize = 0;
+  for (JField* field : layout) {
+    valuesSize += basicTypeSize(basicTypeOf(field->fieldType()));
+  }
+
+  mSegment.u1(subtag::InstanceDump);
+  mSegment.id(instance);
+  mSegment.u4(UnknownStackTraceSerial);
+  mSegment.id(this->classId(klass));
+  mSegment.u4(valuesSize);
+  for (JField* field : layout) {
+    BasicType type = basicTypeOf(field->fieldType());
+    if (type == BasicType::Object) {
+      // Reference fields may be stored compressed, so they must be decoded
+      mSegment.id(instance->getFieldValue<Instance*>(field->offset()));
+    } else {
+      const char* ptr = reinterpret_cast<const char*>(instance) + field->offset();
+      mSegment.value(type, ptr);
+    }
+  }
+
+  this->finishSubRecord();
+}
+
+void HprofWriter::writeArrayDump(ArrayInstance* array)
+{
+  ArrayClass* klass = array->getClass()->asArrayClass();
+  BasicType elementType = basicTypeOf(klass->fieldType().asArrayType()->getElementType());
+
+  if (elementType == BasicType::Object) {
+    mSegment.u1(subtag::ObjectArrayDump);
+    mSegment.id(array);
+    mSegment.u4(UnknownStackTraceSerial);
+    mSegment.u4(array->length());
+    mSegment.id(this->classId(klass));
+    for (Instance* element : *array->toArray<Instance*>()) {
+      mSegment.id(element);
+    }
+  } else {
+    mSegment.u1(subtag::PrimitiveArrayDump);
+    mSegment.id(array);
+    mSegment.u4(UnknownStackTraceSerial);
+    mSegment.u4(array->length());
+    mSegment.u1(static_cast<uint8_t>(elementType));
+
+    size_t elementSize = basicTypeSize(elementType);
+    const char* elements = static_cast<const char*>(array->elementsStart());
+    for (int32_t i = 0; i < array->length(); i++) {
+      mSegment.value(elementType, elements + i * elementSize);
+    }
+  }
+
+  this->finishSubRecord();
+}
+
+void geevm::writeHeapDump(Vm& vm, std::ostream& out)
+{
+  GarbageCollector& gc = vm.heap().gc();
+  gc.lockGC();
+
+  HprofWriter writer{vm, out};
+  writer.write();
+
+  gc.unlockGC();
+}
+
+// Class histogram
+//==--------------------------------------------------------------------------==//
+
+std::vector<ClassHistogramEntry> geevm::computeClassHistogram(Vm& vm)
+{
+  std::unordered_map<JClass*, ClassHistogramEntry> entries;
+  for (Instance* instance : vm.heap().gc().objects()) {
+    JClass* klass = instance->getClass();
+    auto& entry = entries.try_emplace(klass, ClassHistogramEntry{.klass = klass}).first->second;
+    entry.instances++;
+    entry.bytes += GarbageCollector::objectSize(instance);
+  }
+
+  std::vector<ClassHistogramEntry> result;
+  result.reserve(entries.size());
+  for (const auto& [_, entry] : entries) {
+    result.push_back(entry);
+  }
+
+  std::ranges::sort(result, [](const ClassHistogramEntry& left, const ClassHistogramEntry& right) {
+    if (left.bytes != right.bytes) {
+      return left.bytes > right.bytes;
+    }
+    return left.klass->className() < right.klass->className();
+  });
+
+  return result;
+}
+
+void geevm::printClassHistogram(Vm& vm, std::ostream& out)
+{
+  std::vector<ClassHistogramEntry> histogram = computeClassHistogram(vm);
+
+  out << std::format("{:>5} {:>14} {:>14}  {}\n", "num", "#instances", "#bytes", "class name");
+  out << std::string(60, '-') << '\n';
+
+  size_t totalInstances = 0;
+  size_t totalBytes = 0;
+  for (size_t i = 0; i < histogram.size(); i++) {
+    const ClassHistogramEntry& entry = histogram[i];
+    out << std::format("{:>4}: {:>14} {:>14}  {}\n", i + 1, entry.instances, entry.bytes, utf16ToUtf8(entry.klass->javaClassName()));
+    totalInstances += entry.instances;
+    totalBytes += entry.bytes;
+  }
+
+  out << std::format("Total {:>14} {:>14}\n", totalInstances, totalBytes);
+}
@@ -0,0 +1,40 @@
+#ifndef GEEVM_VM_HEAPDUMP_H
+#define GEEVM_VM_HEAPDUMP_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+namespace geevm
+{
+
+class Vm;
+class JClass;
+
+/// Writes a snapshot of the Java heap to \p out in the HPROF binary format (version 1.0.2), as understood by
+/// common memory analysis tools.
+///
+/// The dump contains all loaded classes with their static field values, every object on the heap (including the
+/// immortal region) and GC root records for pinned objects, JNI references, thread objects and references in Java
+/// frames. Class mirrors are represented by class records only. The garbage collector is locked while the dump
+/// is written.
+void writeHeapDump(Vm& vm, std::ostream& out);
+
+/// Number of instances and occupied bytes of a single class on the heap.
+struct ClassHistogramEntry
+{
+  JClass* klass;
+  size_t instances = 0;
+  size_t bytes = 0;
+};
+
+/// Computes the number of live instances and bytes occupied per class, sorted by the number of bytes in descending
+/// order. Unreachable objects that were not collected yet are also counted.
+std::vector<ClassHistogramEntry> computeClassHistogram(Vm& vm);
+
+/// Prints the class histogram of the heap in a tabular format.
+void printClassHistogram(Vm& vm, std::ostream& out);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_HEAPDUMP_H
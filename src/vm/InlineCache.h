@@ -0,0 +1,100 @@
+#ifndef GEEVM_VM_INLINECACHE_H
+#define GEEVM_VM_INLINECACHE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace geevm
+{
+
+class JClass;
+class JMethod;
+
+/// Polymorphic inline cache of a single `invokevirtual` or `invokeinterface` call site.
+///
+/// The cache maps receiver classes to the method selected for them, for up to `MaxEntries` different receiver
+/// classes. A site that sees more receiver classes is marked megamorphic and always uses the full method lookup from
+/// then on. The entries double as a receiver type profile of the call site.
+class InlineCache
+{
+public:
+  static constexpr size_t MaxEntries = 4;
+
+  struct Entry
+  {
+    JClass* receiverClass;
+    JMethod* target;
+    // Number of calls dispatched through this entry
+    uint64_t count;
+  };
+
+  /// Returns the cached target for \p receiverClass, or nullptr on a miss. Megamorphic sites always miss.
+  JMethod* lookup(JClass* receiverClass)
+  {
+    if (mIsMegamorphic) {
+      mMisses++;
+      return nullptr;
+    }
+
+    for (size_t i = 0; i < mSize; ++i) {
+      Entry& entry = mEntries[i];
+      if (entry.receiverClass == receiverClass) {
+        entry.count++;
+        mHits++;
+        return entry.target;
+      }
+    }
+
+    mMisses++;
+    return nullptr;
+  }
+
+  /// Records the target selected by a full method lookup after a miss. Marks the site megamorphic if there is no room
+  /// for another receiver class.
+  void add(JClass* receiverClass, JMethod* target)
+  {
+    if (mIsMegamorphic) {
+      return;
+    }
+
+    if (mSize == MaxEntries) {
+      mIsMegamorphic = true;
+      return;
+    }
+
+    mEntries[mSize++] = Entry{.receiverClass = receiverClass, .target = target, .count = 1};
+  }
+
+  bool isMegamorphic() const
+  {
+    return mIsMegamorphic;
+  }
+
+  std::span<const Entry> entries() const
+  {
+    return std::span(mEntries.data(), mSize);
+  }
+
+  uint64_t hits() const
+  {
+    return mHits;
+  }
+
+  uint64_t misses() const
+  {
+    return mMisses;
+  }
+
+private:
+  std::array<Entry, MaxEntries> mEntries{};
+  size_t mSize = 0;
+  bool mIsMegamorphic = false;
+  uint64_t mHits = 0;
+  uint64_t mMisses = 0;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_INLINECACHE_H
@@ -5,21 +5,35 @@
 
 using namespace geevm;
 
-ObjectInstance::ObjectInstance(InstanceClass* klass)
-  : mHeader(klass, 0)
-{
-  for (const auto& [key, field] : klass->fields()) {
-    if (!field->isStatic()) {
-      auto& fieldType = field->fieldType();
-      fieldType.map([&]<PrimitiveType Type>() {
-        this->setFieldValue<typename PrimitiveTypeTraits<Type>::Representation>(field->offset(), 0);
-      }, [&](types::JStringRef) {
-        this->setFieldValue<Instance*>(field->offset(), nullptr);
-      }, [&](const ArrayType&) {
-        this->setFieldValue<Instance*>(field->offset(), nullptr);
-      });
-    }
+uint32_t ClassTable::add(JClass* klass)
+{
+  if (!sFreeIds.empty()) {
+    uint32_t id = sFreeIds.back();
+    sFreeIds.pop_back();
+    sClasses[id] = klass;
+    return id;
   }
+
+  sClasses.push_back(klass);
+  return static_cast<uint32_t>(sClasses.size() - 1);
+}
+
+void ClassTable::remove(uint32_t id)
+{
+  assert(id != 0 && id < sClasses.size());
+  sClasses[id] = nullptr;
+  sFreeIds.push_back(id);
+}
+
+InstanceHeader::InstanceHeader(JClass* klass)
+  : mClassId(klass->classId())
+{
+}
+
+ObjectInstance::ObjectInstance(InstanceClass* klass)
+  : mHeader(klass)
+{
+  // Fields are not initialized here: heap memory is always zeroed, which is the default value of every field type
 }
 
 size_t Instance::getFieldOffset(types::JStringRef fieldName, types::JStringRef descriptor) const
@@ -34,15 +48,20 @@ size_t Instance::getFieldOffset(types::JStringRef fieldName, types::JStringRef d
 int32_t Instance::hashCode()
 {
   InstanceHeader& header = getHeader();
-  if (header.mHashCode == 0) {
-    header.mHashCode = static_cast<int32_t>(std::hash<const Instance*>{}(this));
+  if (header.hashCode() == 0) {
+    // The identity hash must fit into the header bits and it can never be 0, which marks an uncomputed hash.
+    // Masking the address directly would drop its varying high bits and keep the alignment bits, which are always
+    // zero, so the address is scrambled by a multiplicative (Fibonacci) hash and its highest bits are used instead.
+    uint64_t scrambled = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this)) * 0x9E3779B97F4A7C15ull;
+    auto hash = static_cast<int32_t>(scrambled >> (64 - InstanceHeader::HashBits));
+    header.setHashCode(hash != 0 ? hash : 1);
   }
 
-  return header.mHashCode;
+  return header.hashCode();
 }
 
 ArrayInstance::ArrayInstance(ArrayClass* arrayClass, int32_t length)
-  : mHeader(arrayClass, 0), mLength(length)
+  : mHeader(arrayClass), mLength(length)
 {
 }
 
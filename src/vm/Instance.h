@@ -2,9 +2,12 @@
 #define GEEVM_VM_INSTANCE_H
 
 #include "common/JvmError.h"
+#include "vm/CompressedOops.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace geevm
 {
@@ -21,15 +24,84 @@ class ClassInstance;
 template<JvmType T>
 class JavaArray;
 
+/// Maps the compressed class IDs stored in object headers to classes.
+///
+/// Every class receives an ID when it is created, which stays valid until the class is destroyed. The ID 0 is never
+/// assigned to a class.
+class ClassTable
+{
+public:
+  static uint32_t add(JClass* klass);
+  static void remove(uint32_t id);
+
+  static JClass* get(uint32_t id)
+  {
+    assert(id < sClasses.size());
+    return sClasses[id];
+  }
+
+private:
+  static inline std::vector<JClass*> sClasses{nullptr};
+  static inline std::vector<uint32_t> sFreeIds;
+};
+
 /// Instance and its subclasses cannot use inheritance as they need to be standard layout types in order to make
 /// field offset calculations and assumptions about object layouts safe. This instance corresponds to the information
 /// all instances of `java.lang.Object` needs.
-struct InstanceHeader
+///
+/// The header occupies a single 64-bit word: the lower half holds the ID of the object's class in the `ClassTable`,
+/// the upper half packs the identity hash code (25 bits, 0 if not computed yet), the GC age (4 bits) and the lock
+/// state (3 bits). The header is aligned to the object alignment, so that array elements following the array header
+/// are always naturally aligned.
+struct alignas(ObjectAlignment) InstanceHeader
 {
-  JClass* mClass = nullptr;
-  int32_t mHashCode = 0;
+  static constexpr uint32_t HashBits = 25;
+  static constexpr uint32_t AgeBits = 4;
+  static constexpr uint32_t LockBits = 3;
+
+  static constexpr uint32_t HashMask = (1u << HashBits) - 1;
+  static constexpr uint32_t AgeShift = HashBits;
+  static constexpr uint32_t AgeMask = (1u << AgeBits) - 1;
+  static constexpr uint32_t LockShift = HashBits + AgeBits;
+  static constexpr uint32_t LockMask = (1u << LockBits) - 1;
+
+  explicit InstanceHeader(JClass* klass);
+
+  int32_t hashCode() const
+  {
+    return static_cast<int32_t>(mBits & HashMask);
+  }
+
+  void setHashCode(int32_t hash)
+  {
+    mBits = (mBits & ~HashMask) | (static_cast<uint32_t>(hash) & HashMask);
+  }
+
+  uint32_t age() const
+  {
+    return (mBits >> AgeShift) & AgeMask;
+  }
+
+  /// Increments the GC age of the object, saturating at the maximum representable age.
+  void incrementAge()
+  {
+    if (age() < AgeMask) {
+      mBits += 1u << AgeShift;
+    }
+  }
+
+  uint32_t lockBits() const
+  {
+    return (mBits >> LockShift) & LockMask;
+  }
+
+  uint32_t mClassId;
+  uint32_t mBits = 0;
 };
 
+static_assert(sizeof(InstanceHeader) == 8);
+static_assert(alignof(InstanceHeader) == ObjectAlignment);
+
 /// Instance of a java object.
 ///
 /// This class stores all necessary information contained within an object, including the object's class, hash code,
@@ -39,6 +111,7 @@ class Instance
 {
   friend class JavaHeap;
   friend class GarbageCollector;
+  friend class SemiSpaceCollector;
 
 protected:
   Instance() = default;
@@ -46,7 +119,7 @@ protected:
 public:
   JClass* getClass() const
   {
-    return reinterpret_cast<const InstanceHeader*>(this)->mClass;
+    return ClassTable::get(reinterpret_cast<const InstanceHeader*>(this)->mClassId);
   }
 
   ArrayInstance* toArrayInstance();
@@ -78,10 +151,17 @@ public:
   template<JvmType T>
   T getFieldValue(size_t offset)
   {
-    auto* ptr = reinterpret_cast<T*>(reinterpret_cast<char*>(this) + offset);
+    auto* ptr = reinterpret_cast<HeapRepresentation<T>*>(reinterpret_cast<char*>(this) + offset);
     return *ptr;
   }
 
+  template<JvmType T>
+  void setFieldValue(size_t offset, const T& value)
+  {
+    auto* ptr = reinterpret_cast<HeapRepresentation<T>*>(reinterpret_cast<char*>(this) + offset);
+    *ptr = value;
+  }
+
 protected:
   InstanceHeader& getHeader()
   {
@@ -89,13 +169,6 @@ protected:
   }
 
   size_t getFieldOffset(types::JStringRef fieldName, types::JStringRef descriptor) const;
-
-  template<JvmType T>
-  void setFieldValue(size_t offset, const T& value)
-  {
-    auto* ptr = reinterpret_cast<T*>(reinterpret_cast<char*>(this) + offset);
-    *ptr = value;
-  }
 };
 
 /// Standard Java object instance (as opposed to an array instance).
@@ -139,22 +212,37 @@ public:
     return reinterpret_cast<const char*>(this) + sizeof(ArrayInstance);
   }
 
+  /// Byte offset of the length field, for machine code accessing arrays directly.
+  static constexpr size_t lengthOffset()
+  {
+    return offsetof(ArrayInstance, mLength);
+  }
+
+  /// Byte offset of the first array element, for machine code accessing arrays directly.
+  static constexpr size_t elementsOffset()
+  {
+    return sizeof(ArrayInstance);
+  }
+
 private:
   InstanceHeader mHeader;
   int32_t mLength;
 };
 
 /// Strongly-typed handle for Java arrays.
+///
+/// Elements are stored in their heap representation: reference arrays hold `HeapPtr<Instance>` elements, which
+/// convert implicitly from and to `Instance*`.
 template<JvmType T>
 class JavaArray : public ArrayInstance
 {
 public:
+  using Element = HeapRepresentation<T>;
+
+  // Elements are not initialized, heap memory is always zeroed
   JavaArray(ArrayClass* arrayClass, size_t length)
     : ArrayInstance(arrayClass, length)
   {
-    for (int32_t i = 0; i < length; i++) {
-      this->setArrayElement(i, static_cast<T>(0));
-    }
   }
 
   JvmExpected<T> getArrayElement(int32_t index)
@@ -178,32 +266,37 @@ public:
     return JvmExpected<void>{};
   }
 
-  T& operator[](int32_t index)
+  Element& operator[](int32_t index)
   {
     assert(index >= 0 && index < length());
     return *this->atIndex(index);
   }
 
-  const T& operator[](int32_t index) const
+  const Element& operator[](int32_t index) const
   {
     assert(index >= 0 && index < length());
     return *this->atIndex(index);
   }
 
-  using const_iterator = const T*;
+  using const_iterator = const Element*;
   const_iterator begin() const
   {
-    return reinterpret_cast<const T*>(this->elementsStart());
+    return reinterpret_cast<const Element*>(this->elementsStart());
   }
   const_iterator end() const
   {
-    return reinterpret_cast<const T*>(this->elementsStart()) + length();
+    return reinterpret_cast<const Element*>(this->elementsStart()) + length();
   }
 
 private:
-  T* atIndex(size_t i)
+  Element* atIndex(size_t i)
   {
-    return reinterpret_cast<T*>(this->elementsStart()) + i;
+    return reinterpret_cast<Element*>(this->elementsStart()) + i;
+  }
+
+  const Element* atIndex(size_t i) const
+  {
+    return reinterpret_cast<const Element*>(this->elementsStart()) + i;
   }
 };
 
@@ -234,15 +327,15 @@ private:
 struct JavaString : Instance
 {
   explicit JavaString(JClass* klass, JavaArray<int8_t>* value = nullptr, int8_t coder = 1)
-    : mHeader(klass, 0), mValue(value), mCoder(coder)
+    : mHeader(klass), mValue(value), mCoder(coder)
   {
   }
 
   InstanceHeader mHeader;
-  // java.lang.String layout as defined in the JDK
-  JavaArray<int8_t>* mValue;
-  int8_t mCoder = 1;
+  // java.lang.String fields as laid out by InstanceClass::linkFields (largest first)
+  HeapPtr<JavaArray<int8_t>> mValue;
   int32_t mHash = 0;
+  int8_t mCoder = 1;
   bool mHashIsZero = false;
 };
 
@@ -255,12 +348,12 @@ struct JavaThrowable : Instance
   }
 
   InstanceHeader mHeader;
-  Instance* mBacktrace = nullptr;
-  JavaString* mDetailMessage = nullptr;
-  JavaThrowable* mCause = nullptr;
-  JavaArray<Instance*>* mStackTrace = nullptr;
+  HeapPtr<Instance> mBacktrace = nullptr;
+  HeapPtr<JavaString> mDetailMessage = nullptr;
+  HeapPtr<JavaThrowable> mCause = nullptr;
+  HeapPtr<JavaArray<Instance*>> mStackTrace = nullptr;
+  HeapPtr<Instance> mSuppressedExceptions = nullptr;
   int32_t mDepth = 0;
-  Instance* mSuppressedExceptions = nullptr;
 };
 
 // Use static asserts to check that all object types are conforming to the assumptions we make about them.
@@ -1,33 +1,157 @@
 #include "vm/Interpreter.h"
 #include "class_file/Opcode.h"
+#include "common/Encoding.h"
+#include "vm/AotMethods.h"
+#include "vm/BaselineCompiler.h"
+#include "vm/ClassHierarchy.h"
+#include "vm/CompiledCode.h"
 #include "vm/Frame.h"
 #include "vm/Instance.h"
+#include "vm/OptimizingCompiler.h"
 #include "vm/Vm.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <format>
+#include <iostream>
 
 using namespace geevm;
 
 namespace
 {
 
+/// Number of topmost operand stack values held in registers instead of the operand stack of the frame while the
+/// interpreter executes with a cached stack (`-XX:+UseTopOfStackCaching`).
+enum class CachedValues
+{
+  Zero,
+  One,
+  Two
+};
+
+/// The interpreter state held in registers while executing with a cached stack. The program counter points to the
+/// opcode of the next instruction and the stack pointer only counts the values stored in the operand stack of the frame.
+struct RegisterState
+{
+  JMethod* method;
+  const types::u1* code;
+  uint64_t* locals;
+  uint64_t* stack;
+  int64_t pc;
+  uint16_t stackPointer;
+  // The topmost value if at least one value is cached, and the one below it if two values are cached
+  uint64_t top;
+  uint64_t second;
+  // Backward jumps may enter compiled loops, they are left to the generic interpreter if there is a code cache
+  bool leaveBackwardJumps;
+};
+
+constexpr CachedValues afterPush(CachedValues state)
+{
+  return state == CachedValues::Zero ? CachedValues::One : CachedValues::Two;
+}
+
+constexpr CachedValues afterPop(CachedValues state)
+{
+  return state == CachedValues::Two ? CachedValues::One : CachedValues::Zero;
+}
+
+template<JvmType T>
+constexpr CachedValues afterPushOf(CachedValues state)
+{
+  if constexpr (CategoryTwoJvmType<T>) {
+    return afterPush(afterPush(state));
+  } else {
+    return afterPush(state);
+  }
+}
+
+template<JvmType T>
+constexpr CachedValues afterPopOf(CachedValues state)
+{
+  if constexpr (CategoryTwoJvmType<T>) {
+    return afterPop(afterPop(state));
+  } else {
+    return afterPop(state);
+  }
+}
+
+template<CachedValues State>
+void pushRaw(RegisterState& r, uint64_t value)
+{
+  if constexpr (State == CachedValues::Two) {
+    // The bottom cached value is spilled to make room for the new one
+    r.stack[r.stackPointer++] = r.second;
+  }
+  if constexpr (State != CachedValues::Zero) {
+    r.second = r.top;
+  }
+  r.top = value;
+}
+
+template<CachedValues State>
+uint64_t popRaw(RegisterState& r)
+{
+  if constexpr (State == CachedValues::Zero) {
+    return r.stack[--r.stackPointer];
+  } else {
+    uint64_t value = r.top;
+    if constexpr (State == CachedValues::Two) {
+      r.top = r.second;
+    }
+    return value;
+  }
+}
+
+/// Pushes \p value with the same representation as `CallFrame::pushOperand`, so that the values are the same once they
+/// are spilled to the frame. Returns the new cache state.
+template<CachedValues State, JvmType T>
+CachedValues pushCached(RegisterState& r, T value)
+{
+  using U = typename unsigned_type_of_length<sizeof(T) * CHAR_BIT>::type;
+  pushRaw<State>(r, static_cast<uint64_t>(std::bit_cast<U>(value)));
+  if constexpr (CategoryTwoJvmType<T>) {
+    // The second slot of a category two value is unused
+    pushRaw<afterPush(State)>(r, 0);
+  }
+  return afterPushOf<T>(State);
+}
+
+template<CachedValues State, JvmType T>
+T popCached(RegisterState& r)
+{
+  using U = typename unsigned_type_of_length<sizeof(T) * CHAR_BIT>::type;
+  if constexpr (CategoryTwoJvmType<T>) {
+    popRaw<State>(r);
+    return std::bit_cast<T>(static_cast<U>(popRaw<afterPop(State)>(r)));
+  } else {
+    return std::bit_cast<T>(static_cast<U>(popRaw<State>(r)));
+  }
+}
+
+types::u2 readCachedU2(const RegisterState& r, int64_t pos)
+{
+  return static_cast<types::u2>((r.code[pos] << 8u) | r.code[pos + 1]);
+}
+
+/// The instruction handlers shared by all variants of the interpreter, see `InterpreterVariant`.
 class DefaultInterpreter : public Interpreter
 {
 public:
   explicit DefaultInterpreter(JavaThread& thread)
-    : mThread(thread)
+    : mThread(thread), mCacheStack(thread.vm().settings().useStackCaching)
   {
   }
 
-  std::optional<Value> execute() override;
-
-private:
+protected:
+  void enterCompiledCode();
+  void jumpBackward(int64_t target);
+  void enterOsrCode();
   void invoke(JMethod* method);
+  void invokeTrivial(JMethod* method);
   void handleErrorAsException(const VmError& error);
 
-  std::optional<types::u2> tryHandleException(GcRootRef<> exception, RuntimeConstantPool& rt, const Code& code, size_t pc);
-
   CallFrame& currentFrame()
   {
     assert(mCurrentFrame != nullptr);
@@ -81,11 +205,58 @@ private:
   template<JvmType T, int32_t NotEqualValue>
   void compare();
 
-  template<JvmType T, class Func>
-  void binaryJumpIf();
+  // Superinstructions, see `fuseSuperinstructions`. The fused load is `?load <index>` if `Index` is `OperandIndex`,
+  // and `?load_<Index>` otherwise.
+  static constexpr int32_t OperandIndex = -1;
 
-  template<JvmType T, auto CheckedValue, class Func>
-  void unaryJumpIf();
+  template<int32_t Index>
+  size_t fusedLoadIndex()
+  {
+    if constexpr (Index == OperandIndex) {
+      return currentFrame().readU1();
+    } else {
+      return Index;
+    }
+  }
+
+  size_t readLoadIndex(Opcode genericLoad, Opcode firstShortLoad);
+  int32_t readIntConstant();
+
+  template<int32_t Index>
+  void iloadIloadIadd();
+
+  template<int32_t Index>
+  void aloadArraylength();
+
+  void iincGoto();
+
+  // Handlers for execution with a cached stack, see `InterpreterVariant::executeWithCachedStack`. The handlers are
+  // instantiated for every cache state and return the cache state after the instruction, or an empty optional for
+  // instructions they leave to the generic interpreter.
+  template<CachedValues State, JvmType T>
+  CachedValues cachedLoad(RegisterState& r, size_t index, int64_t length);
+
+  template<CachedValues State, JvmType T>
+  CachedValues cachedStore(RegisterState& r, size_t index, int64_t length);
+
+  template<CachedValues State, JvmType T, class F>
+  CachedValues cachedBinaryOp(RegisterState& r);
+
+  template<CachedValues State, JavaIntegerType T, class ShiftType, uint32_t OffsetMask, bool IsLeft>
+  CachedValues cachedShift(RegisterState& r);
+
+  template<CachedValues State, JvmType TargetTy>
+  CachedValues cachedIntCast(RegisterState& r);
+
+  template<CachedValues State>
+  std::optional<CachedValues> cachedGoto(RegisterState& r);
+
+  void cachedIinc(RegisterState& r, int64_t opcodePos);
+
+  template<CachedValues State, int32_t Index>
+  CachedValues cachedIloadIloadIadd(RegisterState& r);
+
+  bool cachedIincGoto(RegisterState& r);
 
   void newArray();
   void newReferenceArray();
@@ -104,11 +275,15 @@ private:
   };
 
   void invokeVirtual(RuntimeConstantPool& runtimeConstantPool);
+  void invokeInterface(RuntimeConstantPool& runtimeConstantPool);
+  JMethod* selectTarget(const JMethod* baseMethod, JClass* receiverClass, int64_t callSite);
 
   void getStatic(RuntimeConstantPool& runtimeConstantPool);
   void putStatic(RuntimeConstantPool& runtimeConstantPool);
   void getField(RuntimeConstantPool& runtimeConstantPool);
   void putField(RuntimeConstantPool& runtimeConstantPool);
+  void pushFieldValue(Instance* objectRef, const JField* field);
+  void storeFieldValue(Instance* objectRef, const JField* field, Value value);
 
   void swap();
   void dup();
@@ -120,22 +295,206 @@ private:
 
   void ldc(types::u2 index);
   void ldc2_w(types::u2 index);
-  void lookupSwitch();
-  void tableSwitch();
+  void switchJump();
   void wide(Opcode modifiedOpcode);
 
-  bool checkException(RuntimeConstantPool& runtimeConstantPool);
+  bool checkException();
 
-private:
+protected:
   JavaThread& mThread;
   CallFrame* mCurrentFrame = nullptr;
+  bool mCacheStack;
+};
+
+/// Interpreter policies select the diagnostics compiled into a variant of the interpreter. `onInstruction` is called for
+/// every executed instruction, and branch profiles are only recorded if `RecordsBranchProfiles` is set. The release
+/// policy does neither, so its variant has no diagnostics on the hot path. Policies that report the executed opcodes
+/// clear `ExecutesSuperinstructions`, so that their variant runs the original bytecode and observes every JVM
+/// instruction instead of the fused superinstructions.
+class ReleasePolicy
+{
+public:
+  static constexpr bool RecordsBranchProfiles = false;
+  static constexpr bool ExecutesSuperinstructions = true;
+
+  explicit ReleasePolicy(JavaThread&)
+  {
+  }
+
+  void onInstruction(JMethod*, int64_t, Opcode)
+  {
+  }
+};
+
+/// Counts the executed instructions per opcode (`-XX:+CountBytecodes`) and records the branch profiles of the persisted
+/// profile (`-XX:ProfileFile`).
+class ProfilingPolicy
+{
+public:
+  static constexpr bool RecordsBranchProfiles = true;
+  static constexpr bool ExecutesSuperinstructions = false;
+
+  explicit ProfilingPolicy(JavaThread& thread)
+    : mCounts(thread.bytecodeCounts())
+  {
+  }
+
+  void onInstruction(JMethod*, int64_t, Opcode opcode)
+  {
+    mCounts[static_cast<size_t>(opcode)]++;
+  }
+
+private:
+  std::array<uint64_t, 256>& mCounts;
+};
+
+/// Logs every executed instruction to stderr (`-XX:+TraceBytecodes`).
+class TracingPolicy
+{
+public:
+  static constexpr bool RecordsBranchProfiles = true;
+  static constexpr bool ExecutesSuperinstructions = false;
+
+  explicit TracingPolicy(JavaThread&)
+  {
+  }
+
+  void onInstruction(JMethod* method, int64_t pc, Opcode opcode)
+  {
+    std::clog << std::format("{}.{}{} @{} {}\n", utf16ToUtf8(method->getClass()->className()), utf16ToUtf8(method->name()),
+                             utf16ToUtf8(method->rawDescriptor()), pc, opcodeToString(opcode));
+  }
+};
+
+/// Collects garbage before every instruction that calls a method or allocates (`-Xgc-stress-interpreter`), which checks
+/// the local variables and operand stacks of all frames against their stack maps wherever a collection may happen.
+class GcStressPolicy
+{
+public:
+  static constexpr bool RecordsBranchProfiles = true;
+  static constexpr bool ExecutesSuperinstructions = true;
+
+  explicit GcStressPolicy(JavaThread& thread)
+    : mGc(thread.vm().heap().gc())
+  {
+  }
+
+  void onInstruction(JMethod*, int64_t, Opcode opcode)
+  {
+    switch (opcode) {
+      using enum Opcode;
+      case INVOKEVIRTUAL:
+      case INVOKESPECIAL:
+      case INVOKESTATIC:
+      case INVOKEINTERFACE:
+      case INVOKEDYNAMIC:
+      case NEW:
+      case NEWARRAY:
+      case ANEWARRAY:
+      case MULTIANEWARRAY: mGc.performGarbageCollection(GcCause::InterpreterStress); break;
+      default: break;
+    }
+  }
+
+private:
+  GarbageCollector& mGc;
+};
+
+/// The interpreter loop, compiled once per policy. Only the dispatch loops and the instructions that record branch
+/// profiles depend on the policy, all other instructions are handled by `DefaultInterpreter`.
+template<class Policy>
+class InterpreterVariant final : public DefaultInterpreter
+{
+public:
+  explicit InterpreterVariant(JavaThread& thread)
+    : DefaultInterpreter(thread), mPolicy(thread)
+  {
+  }
+
+  std::optional<Value> execute() override;
+
+private:
+  template<JvmType T, class Func>
+  void binaryJumpIf();
+
+  template<JvmType T, auto CheckedValue, class Func>
+  void unaryJumpIf();
+
+  void conditionalJump(int64_t opcodePos, int32_t offset, bool taken);
+
+  template<int32_t Index>
+  void iloadIconstIfIcmpge();
+
+  /// Executes instructions that cannot call, allocate or throw with the interpreter state and the topmost operand stack
+  /// values held in registers (`-XX:+UseTopOfStackCaching`), until the first instruction it leaves to the generic
+  /// interpreter. The state is written back to the frame before returning.
+  void executeWithCachedStack();
+
+  template<CachedValues State>
+  std::optional<CachedValues> stepWithCachedStack(RegisterState& r);
+
+  template<CachedValues State, JvmType T, class Func>
+  std::optional<CachedValues> cachedBinaryJumpIf(RegisterState& r);
+
+  template<CachedValues State, JvmType T, auto CheckedValue, class Func>
+  std::optional<CachedValues> cachedUnaryJumpIf(RegisterState& r);
+
+  void cachedConditionalJump(RegisterState& r, int64_t opcodePos, int32_t offset, bool taken);
+
+  template<int32_t Index>
+  bool cachedIloadIconstIfIcmpge(RegisterState& r);
+
+private:
+  [[no_unique_address]] Policy mPolicy;
 };
 
+template<class Policy>
+std::unique_ptr<Interpreter> createInterpreter(JavaThread& thread)
+{
+  return std::make_unique<InterpreterVariant<Policy>>(thread);
+}
+
 } // namespace
 
-std::unique_ptr<Interpreter> geevm::createDefaultInterpreter(JavaThread& thread)
+InterpreterFactory geevm::selectInterpreter(const VmSettings& settings)
+{
+  if (settings.stressGcInInterpreter) {
+    return &createInterpreter<GcStressPolicy>;
+  }
+  if (settings.traceBytecodes) {
+    return &createInterpreter<TracingPolicy>;
+  }
+  if (settings.countBytecodes || settings.profileFile.has_value()) {
+    return &createInterpreter<ProfilingPolicy>;
+  }
+  return &createInterpreter<ReleasePolicy>;
+}
+
+void geevm::printBytecodeCounts(Vm& vm, std::ostream& out)
 {
-  return std::make_unique<DefaultInterpreter>(thread);
+  std::array<uint64_t, 256> merged{};
+  for (JavaThread* thread : vm.threads()) {
+    for (size_t opcode = 0; opcode < merged.size(); opcode++) {
+      merged[opcode] += thread->bytecodeCounts()[opcode];
+    }
+  }
+
+  std::vector<std::pair<Opcode, uint64_t>> counts;
+  for (size_t opcode = 0; opcode < merged.size(); opcode++) {
+    if (merged[opcode] != 0) {
+      counts.emplace_back(static_cast<Opcode>(opcode), merged[opcode]);
+    }
+  }
+  std::ranges::sort(counts, std::greater{}, &std::pair<Opcode, uint64_t>::second);
+
+  uint64_t total = 0;
+  out << std::format("{:>5} {:>16}  {}\n", "num", "#executions", "opcode");
+  out << std::string(60, '-') << '\n';
+  for (size_t i = 0; i < counts.size(); i++) {
+    out << std::format("{:>4}: {:>16}  {}\n", i + 1, counts[i].second, opcodeToString(counts[i].first));
+    total += counts[i].second;
+  }
+  out << std::format("Total {:>16}\n", total);
 }
 
 static void notImplemented(Opcode opcode)
@@ -143,22 +502,23 @@ static void notImplemented(Opcode opcode)
   geevm_panic(std::format("using unsupported opcode '{}'", opcodeToString(opcode)));
 }
 
-bool DefaultInterpreter::checkException(RuntimeConstantPool& runtimeConstantPool)
+bool DefaultInterpreter::checkException()
 {
-  const Code& code = mCurrentFrame->currentMethod()->getCode();
-  auto exception = mThread.currentException();
-  assert(exception != nullptr);
-  size_t pc = mCurrentFrame->programCounter() - 1;
-
-  auto newPc = this->tryHandleException(exception, runtimeConstantPool, code, pc);
-
-  if (newPc.has_value()) {
-    mCurrentFrame->set(newPc.value());
-    mThread.clearException();
-  } else {
+  const JavaThread::UnwindTarget& target = mThread.unwindTarget();
+  if (target.frame != mCurrentFrame) {
+    // The exception is handled further up the call stack (or not at all), return to the caller right away
     return true;
   }
 
+  assert(target.handlerPc.has_value());
+  types::u2 handlerPc = *target.handlerPc;
+  Instance* exception = mThread.currentException().get();
+  mThread.clearException();
+
+  mCurrentFrame->clearOperandStack();
+  mCurrentFrame->pushOperand<Instance*>(exception);
+  mCurrentFrame->set(handlerPc);
+
   return false;
 }
 
@@ -166,20 +526,34 @@ bool DefaultInterpreter::checkException(RuntimeConstantPool& runtimeConstantPool
   {                                                                       \
     INSTRUCTION;                                                          \
     if (mThread.currentException() != nullptr) [[unlikely]] {             \
-      bool uncaughtException = this->checkException(runtimeConstantPool); \
+      bool uncaughtException = this->checkException();                    \
       if (uncaughtException) {                                            \
         return std::nullopt;                                              \
       }                                                                   \
     }                                                                     \
   }
 
-std::optional<Value> DefaultInterpreter::execute()
+template<class Policy>
+std::optional<Value> InterpreterVariant<Policy>::execute()
 {
   mCurrentFrame = &mThread.currentFrame();
   RuntimeConstantPool& runtimeConstantPool = mCurrentFrame->currentClass()->runtimeConstantPool();
+  if constexpr (!Policy::ExecutesSuperinstructions) {
+    mCurrentFrame->useOriginalBytecode();
+  }
+
+  mCurrentFrame->currentMethod()->countInvocation();
+  if (mThread.vm().codeCache() != nullptr || mThread.vm().aotMethods() != nullptr) {
+    this->enterCompiledCode();
+  }
 
   while (true) {
+    if (mCacheStack) {
+      this->executeWithCachedStack();
+    }
+
     Opcode opcode = mCurrentFrame->next();
+    mPolicy.onInstruction(mCurrentFrame->currentMethod(), mCurrentFrame->programCounter() - 1, opcode);
 
     switch (opcode) {
       using enum Opcode;
@@ -405,15 +779,18 @@ std::optional<Value> DefaultInterpreter::execute()
       case GOTO: {
         int64_t opcodePos = mCurrentFrame->programCounter() - 1;
         auto offset = std::bit_cast<int16_t>(mCurrentFrame->readU2());
-
-        mCurrentFrame->set(opcodePos + offset);
+        if (offset <= 0) {
+          this->jumpBackward(opcodePos + offset);
+        } else {
+          mCurrentFrame->set(opcodePos + offset);
+        }
         break;
       }
       // The `jsr` and `ret` instructions are deprecated, we're not going to support them
       case JSR: notImplemented(opcode); break;
       case RET: notImplemented(opcode); break;
-      case TABLESWITCH: tableSwitch(); break;
-      case LOOKUPSWITCH: lookupSwitch(); break;
+      case TABLESWITCH:
+      case LOOKUPSWITCH: switchJump(); break;
       //==--------------------------------------------------------------------==
       // Returns
       //==--------------------------------------------------------------------==
@@ -438,9 +815,12 @@ std::optional<Value> DefaultInterpreter::execute()
       case INVOKESPECIAL:
         WITH_EXCEPTION_CHECK({
           auto index = mCurrentFrame->readU2();
-          JMethod* method = runtimeConstantPool.getMethodRef(index);
-
-          this->invoke(method);
+          auto method = runtimeConstantPool.resolveMethodRef(index);
+          if (!method) {
+            this->handleErrorAsException(method.error());
+          } else {
+            this->invoke(*method);
+          }
         })
         break;
       case INVOKESTATIC:
@@ -456,23 +836,7 @@ std::optional<Value> DefaultInterpreter::execute()
           }
         })
         break;
-      case INVOKEINTERFACE:
-        WITH_EXCEPTION_CHECK({
-          auto index = mCurrentFrame->readU2();
-          const JMethod* methodRef = runtimeConstantPool.getMethodRef(index);
-
-          // Consume 'count'
-          mCurrentFrame->readU1();
-          // Consume '0'
-          mCurrentFrame->readU1();
-
-          int numArgs = methodRef->descriptor().parameters().size();
-          JClass* target = mCurrentFrame->peek<Instance*>(numArgs)->getClass();
-          auto method = target->getVirtualMethod(methodRef->name(), methodRef->rawDescriptor());
-
-          this->invoke(*method);
-        })
-        break;
+      case INVOKEINTERFACE: WITH_EXCEPTION_CHECK(invokeInterface(runtimeConstantPool)) break;
       case INVOKEDYNAMIC: notImplemented(opcode); break;
       //==--------------------------------------------------------------------==
       // OOP
@@ -480,9 +844,8 @@ std::optional<Value> DefaultInterpreter::execute()
       case NEW:
         WITH_EXCEPTION_CHECK({
           auto index = mCurrentFrame->readU2();
-          auto className = mCurrentFrame->currentClass()->constantPool().getClassName(index);
 
-          auto klass = mThread.resolveClass(types::JString{className});
+          auto klass = mCurrentFrame->currentClass()->runtimeConstantPool().getClass(index);
           if (!klass) {
             this->handleErrorAsException(klass.error());
             break;
@@ -492,7 +855,11 @@ std::optional<Value> DefaultInterpreter::execute()
 
           if (auto instanceClass = (*klass)->asInstanceClass(); instanceClass != nullptr) {
             Instance* instance = mThread.heap().allocate<ObjectInstance>(instanceClass);
-            mCurrentFrame->pushOperand<Instance*>(instance);
+            if (instance == nullptr) [[unlikely]] {
+              mThread.throwOutOfMemoryError();
+            } else {
+              mCurrentFrame->pushOperand<Instance*>(instance);
+            }
           } else {
             // TODO: New with array class
             geevm_panic("new called with array class");
@@ -503,14 +870,22 @@ std::optional<Value> DefaultInterpreter::execute()
       case ANEWARRAY: WITH_EXCEPTION_CHECK(newReferenceArray()); break;
       case ARRAYLENGTH:
         WITH_EXCEPTION_CHECK({
-          ArrayInstance* arrayRef = mCurrentFrame->popOperand<Instance*>()->toArrayInstance();
-          mCurrentFrame->pushOperand<int32_t>(arrayRef->length());
+          Instance* arrayRef = mCurrentFrame->popOperand<Instance*>();
+          if (arrayRef == nullptr) [[unlikely]] {
+            mThread.throwImplicitException(ImplicitException::NullPointer);
+          } else {
+            mCurrentFrame->pushOperand<int32_t>(arrayRef->toArrayInstance()->length());
+          }
         })
         break;
       case ATHROW:
         WITH_EXCEPTION_CHECK({
           auto exception = mCurrentFrame->popOperand<Instance*>();
-          mThread.throwException(exception);
+          if (exception == nullptr) [[unlikely]] {
+            mThread.throwImplicitException(ImplicitException::NullPointer);
+          } else {
+            mThread.throwException(exception);
+          }
         })
         break;
       case CHECKCAST:
@@ -575,8 +950,11 @@ std::optional<Value> DefaultInterpreter::execute()
       case GOTO_W: {
         int64_t opcodePos = mCurrentFrame->programCounter() - 1;
         auto offset = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-
-        mCurrentFrame->set(opcodePos + offset);
+        if (offset <= 0) {
+          this->jumpBackward(opcodePos + offset);
+        } else {
+          mCurrentFrame->set(opcodePos + offset);
+        }
         break;
       }
       case JSR_W:
@@ -588,6 +966,30 @@ std::optional<Value> DefaultInterpreter::execute()
       case IMPDEP2:
         // Reserved opcodes
         break;
+      //==--------------------------------------------------------------------==
+      // Superinstructions
+      //==--------------------------------------------------------------------==
+      case ALOAD_0_GETFIELD:
+        loadAndPush<Instance*>(0);
+        mCurrentFrame->next();
+        WITH_EXCEPTION_CHECK(getField(runtimeConstantPool))
+        break;
+      case ILOAD_ILOAD_IADD: iloadIloadIadd<OperandIndex>(); break;
+      case ILOAD_0_ILOAD_IADD: iloadIloadIadd<0>(); break;
+      case ILOAD_1_ILOAD_IADD: iloadIloadIadd<1>(); break;
+      case ILOAD_2_ILOAD_IADD: iloadIloadIadd<2>(); break;
+      case ILOAD_3_ILOAD_IADD: iloadIloadIadd<3>(); break;
+      case ILOAD_ICONST_IF_ICMPGE: iloadIconstIfIcmpge<OperandIndex>(); break;
+      case ILOAD_0_ICONST_IF_ICMPGE: iloadIconstIfIcmpge<0>(); break;
+      case ILOAD_1_ICONST_IF_ICMPGE: iloadIconstIfIcmpge<1>(); break;
+      case ILOAD_2_ICONST_IF_ICMPGE: iloadIconstIfIcmpge<2>(); break;
+      case ILOAD_3_ICONST_IF_ICMPGE: iloadIconstIfIcmpge<3>(); break;
+      case ALOAD_ARRAYLENGTH: WITH_EXCEPTION_CHECK(aloadArraylength<OperandIndex>()) break;
+      case ALOAD_0_ARRAYLENGTH: WITH_EXCEPTION_CHECK(aloadArraylength<0>()) break;
+      case ALOAD_1_ARRAYLENGTH: WITH_EXCEPTION_CHECK(aloadArraylength<1>()) break;
+      case ALOAD_2_ARRAYLENGTH: WITH_EXCEPTION_CHECK(aloadArraylength<2>()) break;
+      case ALOAD_3_ARRAYLENGTH: WITH_EXCEPTION_CHECK(aloadArraylength<3>()) break;
+      case IINC_GOTO: iincGoto(); break;
       default: GEEVM_UNREACHBLE("Unknown opcode");
     }
   }
@@ -595,34 +997,6 @@ std::optional<Value> DefaultInterpreter::execute()
   GEEVM_UNREACHBLE("Interpreter unexepectedly broke execution loop");
 }
 
-std::optional<types::u2> DefaultInterpreter::tryHandleException(GcRootRef<> exception, RuntimeConstantPool& rt, const Code& code, size_t pc)
-{
-  for (auto& entry : code.exceptionTable()) {
-    if (pc < entry.startPc || pc >= entry.endPc) {
-      // The exception handler is not active
-      continue;
-    }
-
-    bool caught = false;
-    if (entry.catchType != 0) {
-      auto exceptionClass = rt.getClass(entry.catchType);
-
-      assert(exceptionClass.has_value());
-      if (exception->getClass()->isInstanceOf(*exceptionClass)) {
-        caught = true;
-      }
-    } else {
-      caught = true;
-    }
-
-    if (caught) {
-      return entry.handlerPc;
-    }
-  }
-
-  return std::nullopt;
-}
-
 void DefaultInterpreter::ldc(types::u2 index)
 {
   auto& runtimeConstantPool = currentFrame().currentClass()->runtimeConstantPool();
@@ -655,47 +1029,190 @@ void DefaultInterpreter::ldc2_w(types::u2 index)
   mCurrentFrame->advanceStackPointer(2);
 }
 
-void DefaultInterpreter::invoke(JMethod* method)
+void DefaultInterpreter::enterCompiledCode()
 {
-  auto returnValue = mThread.invoke(method);
-  assert((method->isVoid() || mThread.currentException() != nullptr) || returnValue.has_value());
-
-  if (returnValue.has_value()) {
-    if (!method->isVoid()) {
-      mThread.currentFrame().pushGenericOperand(returnValue->toRaw().first);
-      if (method->descriptor().returnType().getType().isCategoryTwo()) {
-        mThread.currentFrame().pushGenericOperand(0);
-      }
+  Vm& vm = mThread.vm();
+  JMethod* method = mCurrentFrame->currentMethod();
+  uint32_t count = method->invocationCount() + method->backedgeCount();
+
+  // Precompiled code is looked up once, on the first invocation, and takes the place of baseline code
+  AotMethodRegistry* aotMethods = vm.aotMethods();
+  if (aotMethods != nullptr && !method->isAotLookupDone()) {
+    method->markAotLookupDone();
+    if (void* code = aotMethods->getCompiledCode(method); code != nullptr && method->compiledCode() == nullptr) {
+      method->setCompiledCode(code, CompilationTier::Baseline);
     }
   }
+
+  OptimizingCompiler* optimizingCompiler = vm.optimizingCompiler();
+  if (optimizingCompiler != nullptr && method->compiledTier() < CompilationTier::Optimized && count >= vm.settings().optimizeThreshold &&
+      method->isCompilable(CompilationTier::Optimized)) {
+    optimizingCompiler->compile(*method);
+  }
+
+  BaselineCompiler* baselineCompiler = vm.baselineCompiler();
+  if (baselineCompiler != nullptr && method->compiledCode() == nullptr && count >= vm.settings().compileThreshold &&
+      method->isCompilable(CompilationTier::Baseline)) {
+    baselineCompiler->compile(*method);
+  }
+
+  if (method->compiledCode() == nullptr) {
+    return;
+  }
+
+  // Compiled code returns at the first instruction it does not handle, the interpreter continues from there
+  runCompiledCode(*mCurrentFrame, method->compiledCode());
 }
 
-void DefaultInterpreter::handleErrorAsException(const VmError& error)
+void DefaultInterpreter::jumpBackward(int64_t target)
 {
-  mThread.throwException(error.exception(), error.message());
+  mCurrentFrame->currentMethod()->countBackedge();
+  mCurrentFrame->set(target);
+  if (mThread.vm().codeCache() != nullptr) {
+    this->enterOsrCode();
+  }
 }
 
-template<JvmType T>
-void DefaultInterpreter::arrayLoad()
+void DefaultInterpreter::enterOsrCode()
 {
-  auto index = currentFrame().popOperand<int32_t>();
+  Vm& vm = mThread.vm();
+  JMethod* method = mCurrentFrame->currentMethod();
+  int64_t pc = mCurrentFrame->programCounter();
+  int32_t depth = mCurrentFrame->stackPointer();
+  uint32_t count = method->invocationCount() + method->backedgeCount();
+
+  // Entries are compiled for the loop header the backward branch jumps to, with the current frame as its state
+  OsrEntry& entry = method->osrEntry(pc);
+
+  OptimizingCompiler* optimizingCompiler = vm.optimizingCompiler();
+  if (optimizingCompiler != nullptr && entry.tier < CompilationTier::Optimized && count >= vm.settings().optimizeThreshold &&
+      entry.isCompilable(CompilationTier::Optimized)) {
+    optimizingCompiler->compileOsr(*method, pc, depth);
+  }
 
-  uint64_t* target = mCurrentFrame->topOfStack() - 1;
-  // auto arrayRef = currentFrame().popOperand<Instance*>();
+  BaselineCompiler* baselineCompiler = vm.baselineCompiler();
+  if (baselineCompiler != nullptr && entry.code == nullptr && count >= vm.settings().compileThreshold &&
+      entry.isCompilable(CompilationTier::Baseline)) {
+    baselineCompiler->compileOsr(*method, pc, depth);
+  }
 
-  auto arrayRef = *reinterpret_cast<Instance**>(target);
-  if (arrayRef == nullptr) [[unlikely]] {
-    mThread.throwException(u"java/lang/NullPointerException");
+  if (entry.code == nullptr) {
     return;
   }
 
-  JavaArray<T>* array = arrayRef->toArray<T>();
-  if (index < 0 || index >= array->length()) [[unlikely]] {
-    mThread.throwException(u"java/lang/ArrayIndexOutOfBoundsException");
+  // The locals and operand stack of the frame become the state of the compiled loop
+  runCompiledCode(*mCurrentFrame, entry.code);
+}
+
+void DefaultInterpreter::invoke(JMethod* method)
+{
+  // Intrinsics and trivial methods are executed on the operand stack of the caller, without a call frame
+  if (IntrinsicHandler intrinsic = method->intrinsic(); intrinsic != nullptr) {
+    // 'invokespecial' does not check the receiver, and intrinsics cannot throw
+    if (!method->isStatic() && mCurrentFrame->peek<Instance*>(static_cast<int32_t>(method->descriptor().numParameterSlots())) == nullptr)
+        [[unlikely]] {
+      mThread.throwImplicitException(ImplicitException::NullPointer);
+      return;
+    }
+    intrinsic(*mCurrentFrame);
     return;
   }
 
-  auto element = (*array)[index];
+  if (method->trivialKind() != TrivialMethodKind::None) {
+    this->invokeTrivial(method);
+    return;
+  }
+
+  auto returnValue = mThread.invoke(method);
+  assert((method->isVoid() || mThread.currentException() != nullptr) || returnValue.has_value());
+
+  if (returnValue.has_value()) {
+    if (!method->isVoid()) {
+      mThread.currentFrame().pushGenericOperand(returnValue->toRaw().first);
+      if (method->descriptor().returnType().getType().isCategoryTwo()) {
+        mThread.currentFrame().pushGenericOperand(0);
+      }
+    }
+  }
+}
+
+void DefaultInterpreter::invokeTrivial(JMethod* method)
+{
+  // The method body is executed directly on the operand stack of the caller, without creating a call frame.
+  // Exceptions are thrown from the call site, as the callee has no exception handlers that could catch them.
+  switch (method->trivialKind()) {
+    case TrivialMethodKind::Getter: {
+      auto objectRef = mCurrentFrame->popOperand<Instance*>();
+      if (objectRef == nullptr) [[unlikely]] {
+        mThread.throwImplicitException(ImplicitException::NullPointer);
+        return;
+      }
+      this->pushFieldValue(objectRef, method->trivialField());
+      break;
+    }
+    case TrivialMethodKind::Setter: {
+      const JField* field = method->trivialField();
+      if (field->fieldType().isCategoryTwo()) {
+        mCurrentFrame->popGenericOperand();
+      }
+      Value value = mCurrentFrame->popGenericOperand();
+      auto objectRef = mCurrentFrame->popOperand<Instance*>();
+      if (objectRef == nullptr) [[unlikely]] {
+        mThread.throwImplicitException(ImplicitException::NullPointer);
+        return;
+      }
+      this->storeFieldValue(objectRef, field, value);
+      break;
+    }
+    case TrivialMethodKind::Empty:
+    case TrivialMethodKind::Constant: {
+      mCurrentFrame->popMultiple(method->descriptor().numParameterSlots());
+      if (!method->isStatic()) {
+        auto objectRef = mCurrentFrame->popOperand<Instance*>();
+        if (objectRef == nullptr) [[unlikely]] {
+          mThread.throwImplicitException(ImplicitException::NullPointer);
+          return;
+        }
+      }
+
+      if (method->trivialKind() == TrivialMethodKind::Constant) {
+        mCurrentFrame->pushGenericOperand(method->trivialConstant());
+        if (method->descriptor().returnType().getType().isCategoryTwo()) {
+          mCurrentFrame->pushGenericOperand(0);
+        }
+      }
+      break;
+    }
+    case TrivialMethodKind::None: GEEVM_UNREACHBLE("Method is not trivial");
+  }
+}
+
+void DefaultInterpreter::handleErrorAsException(const VmError& error)
+{
+  mThread.throwException(error.exception(), error.message());
+}
+
+template<JvmType T>
+void DefaultInterpreter::arrayLoad()
+{
+  auto index = currentFrame().popOperand<int32_t>();
+
+  uint64_t* target = mCurrentFrame->topOfStack() - 1;
+  // auto arrayRef = currentFrame().popOperand<Instance*>();
+
+  auto arrayRef = *reinterpret_cast<Instance**>(target);
+  if (arrayRef == nullptr) [[unlikely]] {
+    mThread.throwImplicitException(ImplicitException::NullPointer);
+    return;
+  }
+
+  JavaArray<T>* array = arrayRef->toArray<T>();
+  if (index < 0 || index >= array->length()) [[unlikely]] {
+    mThread.throwImplicitException(ImplicitException::ArrayIndexOutOfBounds);
+    return;
+  }
+
+  T element = (*array)[index];
 
   if constexpr (StoredAsInt<T>) {
     *target = static_cast<uint64_t>(std::bit_cast<uint32_t>(static_cast<int32_t>(element)));
@@ -724,12 +1241,16 @@ void DefaultInterpreter::arrayStore()
   auto index = currentFrame().popOperand<int32_t>();
   auto arrayRef = currentFrame().popOperand<Instance*>();
 
-  if (arrayRef == nullptr) {
-    mThread.throwException(u"java/lang/NullPointerException");
+  if (arrayRef == nullptr) [[unlikely]] {
+    mThread.throwImplicitException(ImplicitException::NullPointer);
     return;
   }
 
   JavaArray<T>* array = arrayRef->toArray<T>();
+  if (index < 0 || index >= array->length()) [[unlikely]] {
+    mThread.throwImplicitException(ImplicitException::ArrayIndexOutOfBounds);
+    return;
+  }
 
   if constexpr (std::is_same_v<std::remove_const_t<T>, Instance*>) {
     if (value != nullptr) {
@@ -744,9 +1265,10 @@ void DefaultInterpreter::arrayStore()
     }
   }
 
-  JvmExpected<void> result = array->setArrayElement(index, value);
-  if (!result) {
-    this->handleErrorAsException(result.error());
+  (*array)[index] = value;
+
+  if constexpr (std::is_same_v<std::remove_const_t<T>, Instance*>) {
+    mThread.heap().gc().writeBarrier(array, value);
   }
 }
 
@@ -757,8 +1279,9 @@ void DefaultInterpreter::div()
   T value1 = currentFrame().popOperand<T>();
 
   if constexpr (JavaIntegerType<T>) {
-    if (value2 == 0) {
-      mThread.throwException(u"java/lang/ArithmeticException", u"Divison by zero");
+    if (value2 == 0) [[unlikely]] {
+      mThread.throwImplicitException(ImplicitException::Arithmetic, u"/ by zero");
+      return;
     }
   }
 
@@ -773,6 +1296,10 @@ void DefaultInterpreter::rem()
   T value1 = currentFrame().popOperand<T>();
 
   if constexpr (JavaIntegerType<T>) {
+    if (value2 == 0) [[unlikely]] {
+      mThread.throwImplicitException(ImplicitException::Arithmetic, u"/ by zero");
+      return;
+    }
     T result = value1 - (value1 / value2) * value2;
     currentFrame().pushOperand<T>(result);
   } else {
@@ -831,8 +1358,9 @@ void DefaultInterpreter::shift()
   currentFrame().pushOperand<T>(result);
 }
 
+template<class Policy>
 template<JvmType T, class Func>
-void DefaultInterpreter::binaryJumpIf()
+void InterpreterVariant<Policy>::binaryJumpIf()
 {
   auto opcodePos = currentFrame().programCounter() - 1;
 
@@ -841,24 +1369,557 @@ void DefaultInterpreter::binaryJumpIf()
 
   auto offset = std::bit_cast<int16_t>(currentFrame().readU2());
 
-  if (Func{}(val1, val2)) {
-    currentFrame().set(opcodePos + offset);
-  }
+  this->conditionalJump(opcodePos, offset, Func{}(val1, val2));
 }
 
+template<class Policy>
 template<JvmType T, auto CheckedValue, class Func>
-void DefaultInterpreter::unaryJumpIf()
+void InterpreterVariant<Policy>::unaryJumpIf()
 {
   auto opcodePos = currentFrame().programCounter() - 1;
   auto value = currentFrame().popOperand<T>();
 
   auto offset = std::bit_cast<int16_t>(currentFrame().readU2());
 
-  if (Func{}(value, static_cast<T>(CheckedValue))) {
+  this->conditionalJump(opcodePos, offset, Func{}(value, static_cast<T>(CheckedValue)));
+}
+
+template<class Policy>
+void InterpreterVariant<Policy>::conditionalJump(int64_t opcodePos, int32_t offset, bool taken)
+{
+  if constexpr (Policy::RecordsBranchProfiles) {
+    currentFrame().currentMethod()->branchProfile(opcodePos).record(taken);
+  }
+
+  if (taken) {
+    if (offset <= 0) {
+      this->jumpBackward(opcodePos + offset);
+    } else {
+      currentFrame().set(opcodePos + offset);
+    }
+  }
+}
+
+size_t DefaultInterpreter::readLoadIndex(Opcode genericLoad, Opcode firstShortLoad)
+{
+  Opcode opcode = currentFrame().next();
+  if (opcode == genericLoad) {
+    return currentFrame().readU1();
+  }
+  return static_cast<size_t>(opcode) - static_cast<size_t>(firstShortLoad);
+}
+
+int32_t DefaultInterpreter::readIntConstant()
+{
+  Opcode opcode = currentFrame().next();
+  switch (opcode) {
+    case Opcode::BIPUSH: return std::bit_cast<int8_t>(currentFrame().readU1());
+    case Opcode::SIPUSH: return std::bit_cast<int16_t>(currentFrame().readU2());
+    default: return static_cast<int32_t>(opcode) - static_cast<int32_t>(Opcode::ICONST_0);
+  }
+}
+
+template<int32_t Index>
+void DefaultInterpreter::iloadIloadIadd()
+{
+  auto lhs = currentFrame().loadValue<int32_t>(this->fusedLoadIndex<Index>());
+  auto rhs = currentFrame().loadValue<int32_t>(this->readLoadIndex(Opcode::ILOAD, Opcode::ILOAD_0));
+  // iadd
+  currentFrame().next();
+
+  currentFrame().pushOperand<int32_t>(WrapSignedArithmetic<int32_t, std::plus<>>{}(lhs, rhs));
+}
+
+template<class Policy>
+template<int32_t Index>
+void InterpreterVariant<Policy>::iloadIconstIfIcmpge()
+{
+  auto value = currentFrame().loadValue<int32_t>(this->fusedLoadIndex<Index>());
+  int32_t constant = this->readIntConstant();
+
+  auto opcodePos = currentFrame().programCounter();
+  currentFrame().next();
+  auto offset = std::bit_cast<int16_t>(currentFrame().readU2());
+
+  this->conditionalJump(opcodePos, offset, value >= constant);
+}
+
+template<int32_t Index>
+void DefaultInterpreter::aloadArraylength()
+{
+  auto arrayRef = currentFrame().loadValue<Instance*>(this->fusedLoadIndex<Index>());
+  // arraylength
+  currentFrame().next();
+
+  if (arrayRef == nullptr) [[unlikely]] {
+    mThread.throwImplicitException(ImplicitException::NullPointer);
+  } else {
+    currentFrame().pushOperand<int32_t>(arrayRef->toArrayInstance()->length());
+  }
+}
+
+void DefaultInterpreter::iincGoto()
+{
+  types::u1 index = currentFrame().readU1();
+  auto constValue = static_cast<int32_t>(std::bit_cast<int8_t>(currentFrame().readU1()));
+  currentFrame().storeValue<int32_t>(index, WrapSignedArithmetic<int32_t, std::plus<>>{}(currentFrame().loadValue<int32_t>(index), constValue));
+
+  auto opcodePos = currentFrame().programCounter();
+  currentFrame().next();
+  auto offset = std::bit_cast<int16_t>(currentFrame().readU2());
+  if (offset <= 0) {
+    this->jumpBackward(opcodePos + offset);
+  } else {
     currentFrame().set(opcodePos + offset);
   }
 }
 
+template<class Policy>
+void InterpreterVariant<Policy>::executeWithCachedStack()
+{
+  CallFrame& frame = currentFrame();
+  RegisterState r{
+      .method = frame.currentMethod(),
+      .code = frame.code(),
+      .locals = frame.localVariables(),
+      .stack = frame.operandStack(),
+      .pc = frame.programCounter(),
+      .stackPointer = frame.stackPointer(),
+      .top = 0,
+      .second = 0,
+      .leaveBackwardJumps = mThread.vm().codeCache() != nullptr,
+  };
+
+  CachedValues state = CachedValues::Zero;
+  while (true) {
+    int64_t opcodePos = r.pc;
+    std::optional<CachedValues> next;
+    switch (state) {
+      case CachedValues::Zero: next = this->stepWithCachedStack<CachedValues::Zero>(r); break;
+      case CachedValues::One: next = this->stepWithCachedStack<CachedValues::One>(r); break;
+      case CachedValues::Two: next = this->stepWithCachedStack<CachedValues::Two>(r); break;
+    }
+
+    if (!next.has_value()) {
+      break;
+    }
+    state = *next;
+
+    // Instructions left to the generic interpreter are passed to the policy there
+    mPolicy.onInstruction(r.method, opcodePos, static_cast<Opcode>(r.code[opcodePos]));
+  }
+
+  // The generic interpreter, callees and the garbage collector only see the operand stack of the frame
+  if (state == CachedValues::Two) {
+    r.stack[r.stackPointer++] = r.second;
+  }
+  if (state != CachedValues::Zero) {
+    r.stack[r.stackPointer++] = r.top;
+  }
+  frame.setStackPointer(r.stackPointer);
+  frame.set(r.pc);
+}
+
+template<class Policy>
+template<CachedValues State>
+std::optional<CachedValues> InterpreterVariant<Policy>::stepWithCachedStack(RegisterState& r)
+{
+  // Only instructions that cannot call, allocate or throw are executed here, so the values held in registers never
+  // have to be visible to anything but this function
+  switch (static_cast<Opcode>(r.code[r.pc])) {
+    using enum Opcode;
+    case NOP: r.pc += 1; return State;
+    //==--------------------------------------------------------------------==
+    // Constant push
+    //==--------------------------------------------------------------------==
+    case ACONST_NULL: r.pc += 1; return pushCached<State, Instance*>(r, nullptr);
+    case ICONST_M1: r.pc += 1; return pushCached<State, int32_t>(r, -1);
+    case ICONST_0: r.pc += 1; return pushCached<State, int32_t>(r, 0);
+    case ICONST_1: r.pc += 1; return pushCached<State, int32_t>(r, 1);
+    case ICONST_2: r.pc += 1; return pushCached<State, int32_t>(r, 2);
+    case ICONST_3: r.pc += 1; return pushCached<State, int32_t>(r, 3);
+    case ICONST_4: r.pc += 1; return pushCached<State, int32_t>(r, 4);
+    case ICONST_5: r.pc += 1; return pushCached<State, int32_t>(r, 5);
+    case LCONST_0: r.pc += 1; return pushCached<State, int64_t>(r, 0);
+    case LCONST_1: r.pc += 1; return pushCached<State, int64_t>(r, 1);
+    case FCONST_0: r.pc += 1; return pushCached<State, float>(r, 0.0f);
+    case FCONST_1: r.pc += 1; return pushCached<State, float>(r, 1.0f);
+    case FCONST_2: r.pc += 1; return pushCached<State, float>(r, 2.0f);
+    case DCONST_0: r.pc += 1; return pushCached<State, double>(r, 0.0);
+    case DCONST_1: r.pc += 1; return pushCached<State, double>(r, 1.0);
+    case BIPUSH: {
+      auto value = std::bit_cast<int8_t>(r.code[r.pc + 1]);
+      r.pc += 2;
+      return pushCached<State, int32_t>(r, value);
+    }
+    case SIPUSH: {
+      auto value = std::bit_cast<int16_t>(readCachedU2(r, r.pc + 1));
+      r.pc += 3;
+      return pushCached<State, int32_t>(r, value);
+    }
+    //==--------------------------------------------------------------------==
+    // Local variable load and push
+    //==--------------------------------------------------------------------==
+    case ILOAD: return cachedLoad<State, int32_t>(r, r.code[r.pc + 1], 2);
+    case LLOAD: return cachedLoad<State, int64_t>(r, r.code[r.pc + 1], 2);
+    case FLOAD: return cachedLoad<State, float>(r, r.code[r.pc + 1], 2);
+    case DLOAD: return cachedLoad<State, double>(r, r.code[r.pc + 1], 2);
+    case ALOAD: return cachedLoad<State, Instance*>(r, r.code[r.pc + 1], 2);
+    case ILOAD_0: return cachedLoad<State, int32_t>(r, 0, 1);
+    case ILOAD_1: return cachedLoad<State, int32_t>(r, 1, 1);
+    case ILOAD_2: return cachedLoad<State, int32_t>(r, 2, 1);
+    case ILOAD_3: return cachedLoad<State, int32_t>(r, 3, 1);
+    case LLOAD_0: return cachedLoad<State, int64_t>(r, 0, 1);
+    case LLOAD_1: return cachedLoad<State, int64_t>(r, 1, 1);
+    case LLOAD_2: return cachedLoad<State, int64_t>(r, 2, 1);
+    case LLOAD_3: return cachedLoad<State, int64_t>(r, 3, 1);
+    case FLOAD_0: return cachedLoad<State, float>(r, 0, 1);
+    case FLOAD_1: return cachedLoad<State, float>(r, 1, 1);
+    case FLOAD_2: return cachedLoad<State, float>(r, 2, 1);
+    case FLOAD_3: return cachedLoad<State, float>(r, 3, 1);
+    case DLOAD_0: return cachedLoad<State, double>(r, 0, 1);
+    case DLOAD_1: return cachedLoad<State, double>(r, 1, 1);
+    case DLOAD_2: return cachedLoad<State, double>(r, 2, 1);
+    case DLOAD_3: return cachedLoad<State, double>(r, 3, 1);
+    case ALOAD_0: return cachedLoad<State, Instance*>(r, 0, 1);
+    case ALOAD_1: return cachedLoad<State, Instance*>(r, 1, 1);
+    case ALOAD_2: return cachedLoad<State, Instance*>(r, 2, 1);
+    case ALOAD_3: return cachedLoad<State, Instance*>(r, 3, 1);
+    //==--------------------------------------------------------------------==
+    // Local variable store
+    //==--------------------------------------------------------------------==
+    case ISTORE: return cachedStore<State, int32_t>(r, r.code[r.pc + 1], 2);
+    case LSTORE: return cachedStore<State, int64_t>(r, r.code[r.pc + 1], 2);
+    case FSTORE: return cachedStore<State, float>(r, r.code[r.pc + 1], 2);
+    case DSTORE: return cachedStore<State, double>(r, r.code[r.pc + 1], 2);
+    case ASTORE: return cachedStore<State, Instance*>(r, r.code[r.pc + 1], 2);
+    case ISTORE_0: return cachedStore<State, int32_t>(r, 0, 1);
+    case ISTORE_1: return cachedStore<State, int32_t>(r, 1, 1);
+    case ISTORE_2: return cachedStore<State, int32_t>(r, 2, 1);
+    case ISTORE_3: return cachedStore<State, int32_t>(r, 3, 1);
+    case LSTORE_0: return cachedStore<State, int64_t>(r, 0, 1);
+    case LSTORE_1: return cachedStore<State, int64_t>(r, 1, 1);
+    case LSTORE_2: return cachedStore<State, int64_t>(r, 2, 1);
+    case LSTORE_3: return cachedStore<State, int64_t>(r, 3, 1);
+    case FSTORE_0: return cachedStore<State, float>(r, 0, 1);
+    case FSTORE_1: return cachedStore<State, float>(r, 1, 1);
+    case FSTORE_2: return cachedStore<State, float>(r, 2, 1);
+    case FSTORE_3: return cachedStore<State, float>(r, 3, 1);
+    case DSTORE_0: return cachedStore<State, double>(r, 0, 1);
+    case DSTORE_1: return cachedStore<State, double>(r, 1, 1);
+    case DSTORE_2: return cachedStore<State, double>(r, 2, 1);
+    case DSTORE_3: return cachedStore<State, double>(r, 3, 1);
+    case ASTORE_0: return cachedStore<State, Instance*>(r, 0, 1);
+    case ASTORE_1: return cachedStore<State, Instance*>(r, 1, 1);
+    case ASTORE_2: return cachedStore<State, Instance*>(r, 2, 1);
+    case ASTORE_3: return cachedStore<State, Instance*>(r, 3, 1);
+    //==--------------------------------------------------------------------==
+    // Stack manipulation
+    //==--------------------------------------------------------------------==
+    case POP: {
+      r.pc += 1;
+      popRaw<State>(r);
+      return afterPop(State);
+    }
+    case DUP: {
+      r.pc += 1;
+      uint64_t value = popRaw<State>(r);
+      pushRaw<afterPop(State)>(r, value);
+      pushRaw<afterPush(afterPop(State))>(r, value);
+      return afterPush(afterPush(afterPop(State)));
+    }
+    case SWAP: {
+      r.pc += 1;
+      constexpr CachedValues Popped = afterPop(afterPop(State));
+      uint64_t value1 = popRaw<State>(r);
+      uint64_t value2 = popRaw<afterPop(State)>(r);
+      pushRaw<Popped>(r, value1);
+      pushRaw<afterPush(Popped)>(r, value2);
+      return afterPush(afterPush(Popped));
+    }
+    //==--------------------------------------------------------------------==
+    // Arithmetic and bit logic operators
+    //==--------------------------------------------------------------------==
+    case IADD: return cachedBinaryOp<State, int32_t, WrapSignedArithmetic<int32_t, std::plus<>>>(r);
+    case LADD: return cachedBinaryOp<State, int64_t, WrapSignedArithmetic<int64_t, std::plus<>>>(r);
+    case FADD: return cachedBinaryOp<State, float, std::plus<float>>(r);
+    case DADD: return cachedBinaryOp<State, double, std::plus<double>>(r);
+    case ISUB: return cachedBinaryOp<State, int32_t, WrapSignedArithmetic<int32_t, std::minus<>>>(r);
+    case LSUB: return cachedBinaryOp<State, int64_t, WrapSignedArithmetic<int64_t, std::minus<>>>(r);
+    case FSUB: return cachedBinaryOp<State, float, std::minus<float>>(r);
+    case DSUB: return cachedBinaryOp<State, double, std::minus<double>>(r);
+    case IMUL: return cachedBinaryOp<State, int32_t, WrapSignedArithmetic<int32_t, std::multiplies<>>>(r);
+    case LMUL: return cachedBinaryOp<State, int64_t, WrapSignedArithmetic<int64_t, std::multiplies<>>>(r);
+    case FMUL: return cachedBinaryOp<State, float, std::multiplies<float>>(r);
+    case DMUL: return cachedBinaryOp<State, double, std::multiplies<double>>(r);
+    case ISHL: return cachedShift<State, int32_t, int32_t, 0x1F, true>(r);
+    case LSHL: return cachedShift<State, int64_t, int64_t, 0x3F, true>(r);
+    case ISHR: return cachedShift<State, int32_t, int32_t, 0x1F, false>(r);
+    case LSHR: return cachedShift<State, int64_t, int64_t, 0x3F, false>(r);
+    case IUSHR: return cachedShift<State, int32_t, uint32_t, 0x1F, false>(r);
+    case LUSHR: return cachedShift<State, int64_t, uint64_t, 0x3F, false>(r);
+    case IAND: return cachedBinaryOp<State, int32_t, std::bit_and<int32_t>>(r);
+    case LAND: return cachedBinaryOp<State, int64_t, std::bit_and<int64_t>>(r);
+    case IOR: return cachedBinaryOp<State, int32_t, std::bit_or<int32_t>>(r);
+    case LOR: return cachedBinaryOp<State, int64_t, std::bit_or<int64_t>>(r);
+    case IXOR: return cachedBinaryOp<State, int32_t, std::bit_xor<int32_t>>(r);
+    case LXOR: return cachedBinaryOp<State, int64_t, std::bit_xor<int64_t>>(r);
+    case IINC: {
+      this->cachedIinc(r, r.pc);
+      r.pc += 3;
+      return State;
+    }
+    case I2B: return cachedIntCast<State, int8_t>(r);
+    case I2C: return cachedIntCast<State, char16_t>(r);
+    case I2S: return cachedIntCast<State, int16_t>(r);
+    //==--------------------------------------------------------------------==
+    // Jumps
+    //==--------------------------------------------------------------------==
+    case IFEQ: return cachedUnaryJumpIf<State, int32_t, 0, std::equal_to<int32_t>>(r);
+    case IFNE: return cachedUnaryJumpIf<State, int32_t, 0, std::not_equal_to<int32_t>>(r);
+    case IFLT: return cachedUnaryJumpIf<State, int32_t, 0, std::less<int32_t>>(r);
+    case IFGE: return cachedUnaryJumpIf<State, int32_t, 0, std::greater_equal<int32_t>>(r);
+    case IFGT: return cachedUnaryJumpIf<State, int32_t, 0, std::greater<int32_t>>(r);
+    case IFLE: return cachedUnaryJumpIf<State, int32_t, 0, std::less_equal<int32_t>>(r);
+    case IF_ICMPEQ: return cachedBinaryJumpIf<State, int32_t, std::equal_to<int32_t>>(r);
+    case IF_ICMPNE: return cachedBinaryJumpIf<State, int32_t, std::not_equal_to<int32_t>>(r);
+    case IF_ICMPLT: return cachedBinaryJumpIf<State, int32_t, std::less<int32_t>>(r);
+    case IF_ICMPGE: return cachedBinaryJumpIf<State, int32_t, std::greater_equal<int32_t>>(r);
+    case IF_ICMPGT: return cachedBinaryJumpIf<State, int32_t, std::greater<int32_t>>(r);
+    case IF_ICMPLE: return cachedBinaryJumpIf<State, int32_t, std::less_equal<int32_t>>(r);
+    case IF_ACMPEQ: return cachedBinaryJumpIf<State, Instance*, std::equal_to<Instance*>>(r);
+    case IF_ACMPNE: return cachedBinaryJumpIf<State, Instance*, std::not_equal_to<Instance*>>(r);
+    case IFNULL: return cachedUnaryJumpIf<State, Instance*, nullptr, std::equal_to<Instance*>>(r);
+    case IFNONNULL: return cachedUnaryJumpIf<State, Instance*, nullptr, std::not_equal_to<Instance*>>(r);
+    case GOTO: return cachedGoto<State>(r);
+    //==--------------------------------------------------------------------==
+    // Superinstructions
+    //==--------------------------------------------------------------------==
+    case ILOAD_ILOAD_IADD: return cachedIloadIloadIadd<State, OperandIndex>(r);
+    case ILOAD_0_ILOAD_IADD: return cachedIloadIloadIadd<State, 0>(r);
+    case ILOAD_1_ILOAD_IADD: return cachedIloadIloadIadd<State, 1>(r);
+    case ILOAD_2_ILOAD_IADD: return cachedIloadIloadIadd<State, 2>(r);
+    case ILOAD_3_ILOAD_IADD: return cachedIloadIloadIadd<State, 3>(r);
+    case ILOAD_ICONST_IF_ICMPGE: return cachedIloadIconstIfIcmpge<OperandIndex>(r) ? std::optional(State) : std::nullopt;
+    case ILOAD_0_ICONST_IF_ICMPGE: return cachedIloadIconstIfIcmpge<0>(r) ? std::optional(State) : std::nullopt;
+    case ILOAD_1_ICONST_IF_ICMPGE: return cachedIloadIconstIfIcmpge<1>(r) ? std::optional(State) : std::nullopt;
+    case ILOAD_2_ICONST_IF_ICMPGE: return cachedIloadIconstIfIcmpge<2>(r) ? std::optional(State) : std::nullopt;
+    case ILOAD_3_ICONST_IF_ICMPGE: return cachedIloadIconstIfIcmpge<3>(r) ? std::optional(State) : std::nullopt;
+    case IINC_GOTO: return this->cachedIincGoto(r) ? std::optional(State) : std::nullopt;
+    default: return std::nullopt;
+  }
+}
+
+template<CachedValues State, JvmType T>
+CachedValues DefaultInterpreter::cachedLoad(RegisterState& r, size_t index, int64_t length)
+{
+  using U = typename unsigned_type_of_length<sizeof(T) * CHAR_BIT>::type;
+  r.pc += length;
+  return pushCached<State, T>(r, std::bit_cast<T>(static_cast<U>(r.locals[index])));
+}
+
+template<CachedValues State, JvmType T>
+CachedValues DefaultInterpreter::cachedStore(RegisterState& r, size_t index, int64_t length)
+{
+  using U = typename unsigned_type_of_length<sizeof(T) * CHAR_BIT>::type;
+  r.pc += length;
+  r.locals[index] = static_cast<uint64_t>(std::bit_cast<U>(popCached<State, T>(r)));
+  return afterPopOf<T>(State);
+}
+
+template<CachedValues State, JvmType T, class F>
+CachedValues DefaultInterpreter::cachedBinaryOp(RegisterState& r)
+{
+  constexpr CachedValues AfterValue2 = afterPopOf<T>(State);
+  T value2 = popCached<State, T>(r);
+  T value1 = popCached<AfterValue2, T>(r);
+
+  r.pc += 1;
+  return pushCached<afterPopOf<T>(AfterValue2), T>(r, F{}(value1, value2));
+}
+
+template<CachedValues State, JavaIntegerType T, class ShiftType, uint32_t OffsetMask, bool IsLeft>
+CachedValues DefaultInterpreter::cachedShift(RegisterState& r)
+{
+  constexpr CachedValues AfterValue2 = afterPop(State);
+  auto value2 = popCached<State, int32_t>(r);
+  auto value1 = popCached<AfterValue2, T>(r);
+
+  auto target = std::bit_cast<ShiftType>(value1);
+  auto offset = std::bit_cast<uint32_t>(value2) & OffsetMask;
+
+  T result;
+  if constexpr (IsLeft) {
+    result = static_cast<T>(target << offset);
+  } else {
+    result = static_cast<T>(target >> offset);
+  }
+
+  r.pc += 1;
+  return pushCached<afterPopOf<T>(AfterValue2), T>(r, result);
+}
+
+template<CachedValues State, JvmType TargetTy>
+CachedValues DefaultInterpreter::cachedIntCast(RegisterState& r)
+{
+  auto value = popCached<State, int32_t>(r);
+  r.pc += 1;
+  return pushCached<afterPop(State), int32_t>(r, static_cast<TargetTy>(value));
+}
+
+template<class Policy>
+template<CachedValues State, JvmType T, class Func>
+std::optional<CachedValues> InterpreterVariant<Policy>::cachedBinaryJumpIf(RegisterState& r)
+{
+  int64_t opcodePos = r.pc;
+  auto offset = std::bit_cast<int16_t>(readCachedU2(r, opcodePos + 1));
+  if (offset <= 0 && r.leaveBackwardJumps) {
+    return std::nullopt;
+  }
+
+  constexpr CachedValues AfterValue2 = afterPopOf<T>(State);
+  T value2 = popCached<State, T>(r);
+  T value1 = popCached<AfterValue2, T>(r);
+
+  this->cachedConditionalJump(r, opcodePos, offset, Func{}(value1, value2));
+  return afterPopOf<T>(AfterValue2);
+}
+
+template<class Policy>
+template<CachedValues State, JvmType T, auto CheckedValue, class Func>
+std::optional<CachedValues> InterpreterVariant<Policy>::cachedUnaryJumpIf(RegisterState& r)
+{
+  int64_t opcodePos = r.pc;
+  auto offset = std::bit_cast<int16_t>(readCachedU2(r, opcodePos + 1));
+  if (offset <= 0 && r.leaveBackwardJumps) {
+    return std::nullopt;
+  }
+
+  T value = popCached<State, T>(r);
+
+  this->cachedConditionalJump(r, opcodePos, offset, Func{}(value, static_cast<T>(CheckedValue)));
+  return afterPopOf<T>(State);
+}
+
+template<CachedValues State>
+std::optional<CachedValues> DefaultInterpreter::cachedGoto(RegisterState& r)
+{
+  auto offset = std::bit_cast<int16_t>(readCachedU2(r, r.pc + 1));
+  if (offset <= 0) {
+    if (r.leaveBackwardJumps) {
+      return std::nullopt;
+    }
+    r.method->countBackedge();
+  }
+
+  r.pc += offset;
+  return State;
+}
+
+template<class Policy>
+void InterpreterVariant<Policy>::cachedConditionalJump(RegisterState& r, int64_t opcodePos, int32_t offset, bool taken)
+{
+  if constexpr (Policy::RecordsBranchProfiles) {
+    r.method->branchProfile(opcodePos).record(taken);
+  }
+
+  if (!taken) {
+    r.pc = opcodePos + 3;
+    return;
+  }
+
+  if (offset <= 0) {
+    r.method->countBackedge();
+  }
+  r.pc = opcodePos + offset;
+}
+
+void DefaultInterpreter::cachedIinc(RegisterState& r, int64_t opcodePos)
+{
+  types::u1 index = r.code[opcodePos + 1];
+  auto constValue = static_cast<int32_t>(std::bit_cast<int8_t>(r.code[opcodePos + 2]));
+  auto value = std::bit_cast<int32_t>(static_cast<uint32_t>(r.locals[index]));
+  r.locals[index] = static_cast<uint64_t>(std::bit_cast<uint32_t>(WrapSignedArithmetic<int32_t, std::plus<>>{}(value, constValue)));
+}
+
+template<CachedValues State, int32_t Index>
+CachedValues DefaultInterpreter::cachedIloadIloadIadd(RegisterState& r)
+{
+  int64_t pos = r.pc + 1;
+  size_t lhsIndex = static_cast<size_t>(Index);
+  if constexpr (Index == OperandIndex) {
+    lhsIndex = r.code[pos++];
+  }
+
+  size_t rhsIndex;
+  if (static_cast<Opcode>(r.code[pos]) == Opcode::ILOAD) {
+    rhsIndex = r.code[pos + 1];
+    pos += 2;
+  } else {
+    rhsIndex = static_cast<size_t>(r.code[pos]) - static_cast<size_t>(Opcode::ILOAD_0);
+    pos += 1;
+  }
+
+  auto lhs = std::bit_cast<int32_t>(static_cast<uint32_t>(r.locals[lhsIndex]));
+  auto rhs = std::bit_cast<int32_t>(static_cast<uint32_t>(r.locals[rhsIndex]));
+
+  // iadd
+  r.pc = pos + 1;
+  return pushCached<State, int32_t>(r, WrapSignedArithmetic<int32_t, std::plus<>>{}(lhs, rhs));
+}
+
+template<class Policy>
+template<int32_t Index>
+bool InterpreterVariant<Policy>::cachedIloadIconstIfIcmpge(RegisterState& r)
+{
+  int64_t pos = r.pc + 1;
+  size_t index = static_cast<size_t>(Index);
+  if constexpr (Index == OperandIndex) {
+    index = r.code[pos++];
+  }
+
+  int32_t constant;
+  switch (static_cast<Opcode>(r.code[pos])) {
+    case Opcode::BIPUSH:
+      constant = std::bit_cast<int8_t>(r.code[pos + 1]);
+      pos += 2;
+      break;
+    case Opcode::SIPUSH:
+      constant = std::bit_cast<int16_t>(readCachedU2(r, pos + 1));
+      pos += 3;
+      break;
+    default:
+      constant = static_cast<int32_t>(r.code[pos]) - static_cast<int32_t>(Opcode::ICONST_0);
+      pos += 1;
+      break;
+  }
+
+  auto offset = std::bit_cast<int16_t>(readCachedU2(r, pos + 1));
+  if (offset <= 0 && r.leaveBackwardJumps) {
+    return false;
+  }
+
+  auto value = std::bit_cast<int32_t>(static_cast<uint32_t>(r.locals[index]));
+  this->cachedConditionalJump(r, pos, offset, value >= constant);
+  return true;
+}
+
+bool DefaultInterpreter::cachedIincGoto(RegisterState& r)
+{
+  int64_t gotoPos = r.pc + 3;
+  auto offset = std::bit_cast<int16_t>(readCachedU2(r, gotoPos + 1));
+  if (offset <= 0) {
+    if (r.leaveBackwardJumps) {
+      return false;
+    }
+    r.method->countBackedge();
+  }
+
+  this->cachedIinc(r, r.pc);
+  r.pc = gotoPos + offset;
+  return true;
+}
+
 template<JavaFloatType SourceTy, JvmType TargetTy>
 void DefaultInterpreter::castFloatToInt()
 {
@@ -913,21 +1974,55 @@ void DefaultInterpreter::compare()
 
 void DefaultInterpreter::invokeVirtual(RuntimeConstantPool& runtimeConstantPool)
 {
+  auto callSite = mCurrentFrame->programCounter() - 1;
   auto index = mCurrentFrame->readU2();
-  const JMethod* baseMethod = runtimeConstantPool.getMethodRef(index);
+  JMethod* baseMethod = runtimeConstantPool.getMethodRef(index);
 
   int numArgs = baseMethod->descriptor().numParameterSlots();
   auto objectRef = mCurrentFrame->peek<Instance*>(numArgs);
   if (objectRef == nullptr) {
-    mThread.throwException(u"java/lang/NullPointerException");
+    mThread.throwImplicitException(ImplicitException::NullPointer);
+  } else if (JMethod* uniqueTarget = ClassHierarchy::uniqueTarget(baseMethod); uniqueTarget != nullptr) {
+    // No loaded class overrides the method, dispatch as cheaply as 'invokespecial'
+    this->invoke(uniqueTarget);
   } else {
-    JClass* target = objectRef->getClass();
-    auto targetMethod = target->getVirtualMethod(baseMethod->name(), baseMethod->rawDescriptor());
+    this->invoke(this->selectTarget(baseMethod, objectRef->getClass(), callSite));
+  }
+}
+
+void DefaultInterpreter::invokeInterface(RuntimeConstantPool& runtimeConstantPool)
+{
+  auto callSite = mCurrentFrame->programCounter() - 1;
+  auto index = mCurrentFrame->readU2();
+  const JMethod* baseMethod = runtimeConstantPool.getMethodRef(index);
 
-    assert(targetMethod.has_value());
+  // Consume 'count'
+  mCurrentFrame->readU1();
+  // Consume '0'
+  mCurrentFrame->readU1();
+
+  int numArgs = baseMethod->descriptor().numParameterSlots();
+  auto objectRef = mCurrentFrame->peek<Instance*>(numArgs);
+  if (objectRef == nullptr) {
+    mThread.throwImplicitException(ImplicitException::NullPointer);
+  } else {
+    this->invoke(this->selectTarget(baseMethod, objectRef->getClass(), callSite));
+  }
+}
 
-    this->invoke(*targetMethod);
+JMethod* DefaultInterpreter::selectTarget(const JMethod* baseMethod, JClass* receiverClass, int64_t callSite)
+{
+  InlineCache& cache = mCurrentFrame->currentMethod()->inlineCache(callSite);
+  if (JMethod* target = cache.lookup(receiverClass); target != nullptr) {
+    return target;
   }
+
+  auto targetMethod = receiverClass->getVirtualMethod(baseMethod->name(), baseMethod->rawDescriptor());
+  assert(targetMethod.has_value());
+
+  cache.add(receiverClass, *targetMethod);
+
+  return *targetMethod;
 }
 
 void DefaultInterpreter::getStatic(RuntimeConstantPool& runtimeConstantPool)
@@ -968,22 +2063,9 @@ void DefaultInterpreter::getField(RuntimeConstantPool& runtimeConstantPool)
   auto objectRef = mCurrentFrame->popOperand<Instance*>();
 
   if (objectRef == nullptr) {
-    mThread.throwException(u"java/lang/NullPointerException");
+    mThread.throwImplicitException(ImplicitException::NullPointer);
   } else {
-    assert(objectRef->getClass()->isInstanceOf(field->getClass()));
-
-    auto& fieldType = field->fieldType();
-    fieldType.map([&]<PrimitiveType Type>() {
-      using T = typename PrimitiveTypeTraits<Type>::Representation;
-      auto result = objectRef->getFieldValue<T>(field->name(), field->descriptor());
-      mCurrentFrame->pushOperand<T>(result);
-    }, [&](types::JStringRef) {
-      auto result = objectRef->getFieldValue<Instance*>(field->name(), field->descriptor());
-      mCurrentFrame->pushOperand(result);
-    }, [&](const ArrayType&) {
-      auto result = objectRef->getFieldValue<Instance*>(field->name(), field->descriptor());
-      mCurrentFrame->pushOperand(result);
-    });
+    this->pushFieldValue(objectRef, field);
   }
 }
 
@@ -999,23 +2081,45 @@ void DefaultInterpreter::putField(RuntimeConstantPool& runtimeConstantPool)
   auto objectRef = mCurrentFrame->popOperand<Instance*>();
 
   if (objectRef == nullptr) {
-    mThread.throwException(u"java/lang/NullPointerException");
+    mThread.throwImplicitException(ImplicitException::NullPointer);
     return;
   }
 
+  this->storeFieldValue(objectRef, field, value);
+}
+
+void DefaultInterpreter::pushFieldValue(Instance* objectRef, const JField* field)
+{
+  assert(objectRef->getClass()->isInstanceOf(field->getClass()));
+
+  // Inherited fields have the same offset in all subclasses, so the offset of the resolved field can be used directly
+  field->fieldType().map([&]<PrimitiveType Type>() {
+    using T = typename PrimitiveTypeTraits<Type>::Representation;
+    mCurrentFrame->pushOperand<T>(objectRef->getFieldValue<T>(field->offset()));
+  }, [&](types::JStringRef) {
+    mCurrentFrame->pushOperand(objectRef->getFieldValue<Instance*>(field->offset()));
+  }, [&](const ArrayType&) {
+    mCurrentFrame->pushOperand(objectRef->getFieldValue<Instance*>(field->offset()));
+  });
+}
+
+void DefaultInterpreter::storeFieldValue(Instance* objectRef, const JField* field, Value value)
+{
   assert(objectRef->getClass()->isInstanceOf(field->getClass()));
 
   field->fieldType().map([&]<PrimitiveType Type>() {
     using T = typename PrimitiveTypeTraits<Type>::Representation;
     if constexpr (StoredAsInt<T>) {
-      objectRef->setFieldValue<T>(field->name(), field->descriptor(), static_cast<T>(value.get<int32_t>()));
+      objectRef->setFieldValue<T>(field->offset(), static_cast<T>(value.get<int32_t>()));
     } else {
-      objectRef->setFieldValue<T>(field->name(), field->descriptor(), value.get<T>());
+      objectRef->setFieldValue<T>(field->offset(), value.get<T>());
     }
   }, [&](types::JStringRef) {
-    objectRef->setFieldValue<Instance*>(field->name(), field->descriptor(), value.get<Instance*>());
+    objectRef->setFieldValue<Instance*>(field->offset(), value.get<Instance*>());
+    mThread.heap().gc().writeBarrier(objectRef, value.get<Instance*>());
   }, [&](const ArrayType&) {
-    objectRef->setFieldValue<Instance*>(field->name(), field->descriptor(), value.get<Instance*>());
+    objectRef->setFieldValue<Instance*>(field->offset(), value.get<Instance*>());
+    mThread.heap().gc().writeBarrier(objectRef, value.get<Instance*>());
   });
 }
 
@@ -1109,32 +2213,31 @@ void DefaultInterpreter::newArray()
   auto arrayType = static_cast<ArrayType>(currentFrame().readU1());
   auto count = currentFrame().popOperand<int32_t>();
 
-  types::JString arrayClsName;
+  PrimitiveType elementType;
 
   switch (arrayType) {
-    case ArrayType::T_BOOLEAN: arrayClsName = u"[Z"; break;
-    case ArrayType::T_CHAR: arrayClsName = u"[C"; break;
-    case ArrayType::T_FLOAT: arrayClsName = u"[F"; break;
-    case ArrayType::T_DOUBLE: arrayClsName = u"[D"; break;
-    case ArrayType::T_BYTE: arrayClsName = u"[B"; break;
-    case ArrayType::T_SHORT: arrayClsName = u"[S"; break;
-    case ArrayType::T_INT: arrayClsName = u"[I"; break;
-    case ArrayType::T_LONG: arrayClsName = u"[J"; break;
+    case ArrayType::T_BOOLEAN: elementType = PrimitiveType::Boolean; break;
+    case ArrayType::T_CHAR: elementType = PrimitiveType::Char; break;
+    case ArrayType::T_FLOAT: elementType = PrimitiveType::Float; break;
+    case ArrayType::T_DOUBLE: elementType = PrimitiveType::Double; break;
+    case ArrayType::T_BYTE: elementType = PrimitiveType::Byte; break;
+    case ArrayType::T_SHORT: elementType = PrimitiveType::Short; break;
+    case ArrayType::T_INT: elementType = PrimitiveType::Int; break;
+    case ArrayType::T_LONG: elementType = PrimitiveType::Long; break;
     default: GEEVM_UNREACHBLE("Unknown array type");
   }
 
-  auto arrayClass = mThread.resolveClass(arrayClsName);
-  if (!arrayClass) {
-    this->handleErrorAsException(arrayClass.error());
-    return;
-  }
-
   if (count < 0) {
     mThread.throwException(u"java/lang/NegativeArraySizeException", u"");
     return;
   }
 
-  ArrayInstance* newInstance = mThread.heap().allocateArray((*arrayClass)->asArrayClass(), count);
+  ArrayClass* arrayClass = mThread.vm().primitiveArrayClass(elementType);
+  ArrayInstance* newInstance = mThread.heap().allocateArray(arrayClass, count);
+  if (newInstance == nullptr) [[unlikely]] {
+    mThread.throwOutOfMemoryError();
+    return;
+  }
   currentFrame().pushOperand<Instance*>(newInstance);
 }
 
@@ -1143,20 +2246,7 @@ void DefaultInterpreter::newReferenceArray()
   auto index = currentFrame().readU2();
   int32_t count = currentFrame().popOperand<int32_t>();
 
-  auto klass = currentFrame().currentClass()->runtimeConstantPool().getClass(index);
-  if (!klass) {
-    this->handleErrorAsException(klass.error());
-    return;
-  }
-
-  types::JString elementClassName;
-  if ((*klass)->isArrayType()) {
-    elementClassName = u"[" + (*klass)->className();
-  } else {
-    elementClassName = u"[L" + (*klass)->className() + u";";
-  }
-
-  auto arrayClass = mThread.resolveClass(elementClassName);
+  auto arrayClass = currentFrame().currentClass()->runtimeConstantPool().getArrayClass(index);
   if (!arrayClass) {
     this->handleErrorAsException(arrayClass.error());
     return;
@@ -1167,7 +2257,11 @@ void DefaultInterpreter::newReferenceArray()
     return;
   }
 
-  ArrayInstance* array = mThread.heap().allocateArray<Instance*>((*arrayClass)->asArrayClass(), count);
+  ArrayInstance* array = mThread.heap().allocateArray<Instance*>(*arrayClass, count);
+  if (array == nullptr) [[unlikely]] {
+    mThread.throwOutOfMemoryError();
+    return;
+  }
   currentFrame().pushOperand<Instance*>(array);
 }
 
@@ -1182,105 +2276,79 @@ void DefaultInterpreter::newMultiArray()
     return;
   }
 
-  std::vector<int32_t> dimensionCounts;
-  for (uint8_t dim = 0; dim < dimensions; dim++) {
-    dimensionCounts.push_back(currentFrame().popOperand<int32_t>());
+  // Dimensions are popped innermost first, store them outermost first along with the array class of each level
+  std::vector<int32_t> counts(dimensions);
+  std::vector<ArrayClass*> levelClasses(dimensions);
+  for (int dim = dimensions - 1; dim >= 0; dim--) {
+    counts[dim] = currentFrame().popOperand<int32_t>();
   }
 
-  std::optional<JClass*> elementClass = (*klass)->asArrayClass()->elementClass();
-  assert(elementClass.has_value());
-
-  auto makeInnerArray = [this](auto& self, std::vector<int32_t> dimensionCounts, ArrayClass* arrayClass) -> GcRootRef<ArrayInstance> {
-    auto count = dimensionCounts.back();
-    dimensionCounts.pop_back();
-
-    GcRootRef<ArrayInstance> newArray = nullptr;
-    if (!dimensionCounts.empty()) {
-      auto outerArray = mThread.heap().gc().pin(mThread.heap().allocateArray<Instance*>(arrayClass, count)).release();
-      ArrayClass* innerArrayClass = (*arrayClass->elementClass())->asArrayClass();
-      for (int32_t i = 0; i < count; i++) {
-        auto innerArray = self(self, dimensionCounts, innerArrayClass);
-        outerArray->setArrayElement(i, innerArray.get());
-        mThread.heap().gc().release(innerArray);
-      }
-      newArray = outerArray;
-    } else {
-      newArray = mThread.heap().gc().pin(mThread.heap().allocateArray(arrayClass, count)).release();
+  ArrayClass* levelClass = (*klass)->asArrayClass();
+  for (uint8_t dim = 0; dim < dimensions; dim++) {
+    if (counts[dim] < 0) {
+      mThread.throwException(u"java/lang/NegativeArraySizeException", u"");
+      return;
+    }
+    levelClasses[dim] = levelClass;
+    if (dim + 1 < dimensions) {
+      levelClass = (*levelClass->elementClass())->asArrayClass();
     }
-
-    return newArray;
-  };
-
-  GcRootRef<ArrayInstance> result = makeInnerArray(makeInnerArray, dimensionCounts, (*klass)->asArrayClass());
-  currentFrame().pushOperand<Instance*>(result.get());
-  mThread.heap().gc().release(result);
-}
-
-void DefaultInterpreter::lookupSwitch()
-{
-  CallFrame& frame = currentFrame();
-
-  auto opcodePos = mCurrentFrame->programCounter() - 1;
-  while (mCurrentFrame->programCounter() % 4 != 0) {
-    mCurrentFrame->next();
   }
 
-  int32_t defaultOffset = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-  int32_t numPairs = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-
-  std::vector<std::pair<int32_t, int32_t>> pairs;
-  for (int32_t i = 0; i < numPairs; i++) {
-    auto matchValue = mCurrentFrame->readU4();
-    auto offset = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-    pairs.emplace_back(matchValue, offset);
+  // Arrays are allocated depth-first. Any allocation may relocate objects, so the arrays on the path from the
+  // outermost array to the array currently being filled are pinned (at most one per dimension), which keeps the parent
+  // of each new array at hand.
+  ArrayInstance* outermost = mThread.heap().allocateArray(levelClasses[0], counts[0]);
+  if (outermost == nullptr) [[unlikely]] {
+    mThread.throwOutOfMemoryError();
+    return;
   }
+  GcRootRef<ArrayInstance> root = mThread.heap().gc().pin(outermost).release();
+
+  std::vector<GcRootRef<ArrayInstance>> path;
+  path.reserve(dimensions);
+  path.push_back(root);
+  // Number of elements already filled in the array of each level on the path
+  std::vector<int32_t> filled(dimensions);
+  while (!path.empty()) {
+    size_t level = path.size() - 1;
+    if (level + 1 == dimensions || filled[level] == counts[level]) {
+      // The array is complete, the outermost array stays pinned until it was pushed
+      if (level != 0) {
+        mThread.heap().gc().release(path.back());
+      }
+      path.pop_back();
+      continue;
+    }
 
-  auto key = currentFrame().popOperand<int32_t>();
-  bool matched = false;
-
-  for (int32_t i = 0; i < numPairs; i++) {
-    if (pairs[i].first == key) {
-      mCurrentFrame->set(opcodePos + pairs[i].second);
-      matched = true;
-      break;
+    ArrayInstance* child = mThread.heap().allocateArray(levelClasses[level + 1], counts[level + 1]);
+    if (child == nullptr) [[unlikely]] {
+      for (GcRootRef<ArrayInstance> array : path) {
+        mThread.heap().gc().release(array);
+      }
+      mThread.throwOutOfMemoryError();
+      return;
     }
-  }
 
-  if (!matched) {
-    mCurrentFrame->set(opcodePos + defaultOffset);
+    ArrayInstance* parent = path.back().get();
+    (*parent->toArray<Instance*>())[filled[level]++] = child;
+    mThread.heap().gc().writeBarrier(parent, child);
+
+    filled[level + 1] = 0;
+    path.push_back(mThread.heap().gc().pin(child).release());
   }
+
+  currentFrame().pushOperand<Instance*>(root.get());
+  mThread.heap().gc().release(root);
 }
 
-void DefaultInterpreter::tableSwitch()
+void DefaultInterpreter::switchJump()
 {
-  CallFrame& frame = currentFrame();
   auto opcodePos = mCurrentFrame->programCounter() - 1;
-  while (mCurrentFrame->programCounter() % 4 != 0) {
-    mCurrentFrame->next();
-  }
-
-  auto defaultOffset = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-  auto low = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-  auto high = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-  assert(low <= high);
-
-  int32_t count = high - low + 1;
+  const SwitchTable& table = mCurrentFrame->currentMethod()->switchTable(opcodePos);
 
-  std::vector<int32_t> table;
-  table.reserve(count);
-
-  for (int32_t i = 0; i < count; i++) {
-    int32_t offset = std::bit_cast<int32_t>(mCurrentFrame->readU4());
-    table.push_back(offset);
-  }
-
-  auto index = currentFrame().popOperand<int32_t>();
-  if (index < low || index > high) {
-    mCurrentFrame->set(opcodePos + defaultOffset);
-  } else {
-    int32_t targetOffset = table.at(index - low);
-    mCurrentFrame->set(opcodePos + targetOffset);
-  }
+  auto key = mCurrentFrame->popOperand<int32_t>();
+  mCurrentFrame->set(table.target(key));
 }
 
 void DefaultInterpreter::wide(Opcode modifiedOpcode)
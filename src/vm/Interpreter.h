@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <optional>
+#include <ostream>
 
 namespace geevm
 {
@@ -15,6 +16,7 @@ namespace geevm
 {
 
 class Vm;
+struct VmSettings;
 
 class Interpreter
 {
@@ -23,7 +25,15 @@ public:
   virtual ~Interpreter() = default;
 };
 
-std::unique_ptr<Interpreter> createDefaultInterpreter(JavaThread& thread);
+using InterpreterFactory = std::unique_ptr<Interpreter> (*)(JavaThread& thread);
+
+/// Selects the variant of the interpreter for the diagnostics enabled in \p settings: bytecode tracing, bytecode
+/// counting and branch profiling, or collecting garbage before every call and allocation. Each variant is compiled
+/// separately, so the interpreter without diagnostics does not check for them on every instruction.
+InterpreterFactory selectInterpreter(const VmSettings& settings);
+
+/// Prints the number of executed instructions per opcode, as counted with `-XX:+CountBytecodes`.
+void printBytecodeCounts(Vm& vm, std::ostream& out);
 
 } // namespace geevm
 
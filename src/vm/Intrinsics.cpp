@@ -0,0 +1,194 @@
+#include "vm/Intrinsics.h"
+#include "vm/Frame.h"
+#include "vm/Instance.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+
+using namespace geevm;
+
+namespace
+{
+
+/// Adapts a C++ function to an `IntrinsicHandler` by passing it the arguments from the operand stack and pushing its
+/// result.
+template<auto Function, class Signature = decltype(Function)>
+struct OnOperandStack;
+
+template<auto Function, JvmType R, JvmType A>
+struct OnOperandStack<Function, R (*)(A)>
+{
+  static void call(CallFrame& caller)
+  {
+    auto a = caller.popOperand<A>();
+    caller.pushOperand<R>(Function(a));
+  }
+};
+
+template<auto Function, JvmType R, JvmType A, JvmType B>
+struct OnOperandStack<Function, R (*)(A, B)>
+{
+  static void call(CallFrame& caller)
+  {
+    auto b = caller.popOperand<B>();
+    auto a = caller.popOperand<A>();
+    caller.pushOperand<R>(Function(a, b));
+  }
+};
+
+// Java semantics of the operations whose C++ counterparts differ: integer `abs` wraps around for the minimum value,
+// and floating-point `min` and `max` return a NaN operand and order -0.0 before 0.0.
+template<std::signed_integral T>
+T javaAbs(T value)
+{
+  using U = std::make_unsigned_t<T>;
+  return value < 0 ? static_cast<T>(U{0} - static_cast<U>(value)) : value;
+}
+
+template<std::floating_point T>
+T javaMin(T a, T b)
+{
+  if (std::isnan(a)) {
+    return a;
+  }
+  if (std::isnan(b)) {
+    return b;
+  }
+  if (a == 0 && b == 0) {
+    return std::signbit(a) ? a : b;
+  }
+  return a < b ? a : b;
+}
+
+template<std::floating_point T>
+T javaMax(T a, T b)
+{
+  if (std::isnan(a)) {
+    return a;
+  }
+  if (std::isnan(b)) {
+    return b;
+  }
+  if (a == 0 && b == 0) {
+    return std::signbit(a) ? b : a;
+  }
+  return a > b ? a : b;
+}
+
+template<std::unsigned_integral U>
+U highestOneBit(U value)
+{
+  return value == 0 ? 0 : static_cast<U>(U{1} << (std::numeric_limits<U>::digits - 1 - std::countl_zero(value)));
+}
+
+template<std::unsigned_integral U>
+U lowestOneBit(U value)
+{
+  return value & (U{0} - value);
+}
+
+struct Intrinsic
+{
+  types::JStringRef className;
+  types::JStringRef name;
+  types::JStringRef descriptor;
+  IntrinsicHandler handler;
+};
+
+template<auto Function>
+constexpr IntrinsicHandler handler = &OnOperandStack<Function>::call;
+
+// `Math.sin`, `cos`, `tan`, `log`, `log10` and `exp` may differ from the exact result by one ulp, which the C library
+// satisfies. `StrictMath` requires the results of fdlibm for these functions, so only its exact functions and `log`,
+// whose native implementation uses the C library as well, are intrinsics.
+const Intrinsic intrinsics[] = {
+    // clang-format off
+    {u"java/lang/Math", u"sqrt", u"(D)D", handler<+[](double a) { return std::sqrt(a); }>},
+    {u"java/lang/Math", u"abs", u"(I)I", handler<+[](int32_t a) { return javaAbs(a); }>},
+    {u"java/lang/Math", u"abs", u"(J)J", handler<+[](int64_t a) { return javaAbs(a); }>},
+    {u"java/lang/Math", u"abs", u"(F)F", handler<+[](float a) { return std::fabs(a); }>},
+    {u"java/lang/Math", u"abs", u"(D)D", handler<+[](double a) { return std::fabs(a); }>},
+    {u"java/lang/Math", u"min", u"(II)I", handler<+[](int32_t a, int32_t b) { return std::min(a, b); }>},
+    {u"java/lang/Math", u"min", u"(JJ)J", handler<+[](int64_t a, int64_t b) { return std::min(a, b); }>},
+    {u"java/lang/Math", u"min", u"(FF)F", handler<+[](float a, float b) { return javaMin(a, b); }>},
+    {u"java/lang/Math", u"min", u"(DD)D", handler<+[](double a, double b) { return javaMin(a, b); }>},
+    {u"java/lang/Math", u"max", u"(II)I", handler<+[](int32_t a, int32_t b) { return std::max(a, b); }>},
+    {u"java/lang/Math", u"max", u"(JJ)J", handler<+[](int64_t a, int64_t b) { return std::max(a, b); }>},
+    {u"java/lang/Math", u"max", u"(FF)F", handler<+[](float a, float b) { return javaMax(a, b); }>},
+    {u"java/lang/Math", u"max", u"(DD)D", handler<+[](double a, double b) { return javaMax(a, b); }>},
+    {u"java/lang/Math", u"floor", u"(D)D", handler<+[](double a) { return std::floor(a); }>},
+    {u"java/lang/Math", u"ceil", u"(D)D", handler<+[](double a) { return std::ceil(a); }>},
+    {u"java/lang/Math", u"rint", u"(D)D", handler<+[](double a) { return std::nearbyint(a); }>},
+    {u"java/lang/Math", u"sin", u"(D)D", handler<+[](double a) { return std::sin(a); }>},
+    {u"java/lang/Math", u"cos", u"(D)D", handler<+[](double a) { return std::cos(a); }>},
+    {u"java/lang/Math", u"tan", u"(D)D", handler<+[](double a) { return std::tan(a); }>},
+    {u"java/lang/Math", u"log", u"(D)D", handler<+[](double a) { return std::log(a); }>},
+    {u"java/lang/Math", u"log10", u"(D)D", handler<+[](double a) { return std::log10(a); }>},
+    {u"java/lang/Math", u"exp", u"(D)D", handler<+[](double a) { return std::exp(a); }>},
+
+    {u"java/lang/StrictMath", u"sqrt", u"(D)D", handler<+[](double a) { return std::sqrt(a); }>},
+    {u"java/lang/StrictMath", u"abs", u"(D)D", handler<+[](double a) { return std::fabs(a); }>},
+    {u"java/lang/StrictMath", u"floor", u"(D)D", handler<+[](double a) { return std::floor(a); }>},
+    {u"java/lang/StrictMath", u"ceil", u"(D)D", handler<+[](double a) { return std::ceil(a); }>},
+    {u"java/lang/StrictMath", u"rint", u"(D)D", handler<+[](double a) { return std::nearbyint(a); }>},
+    {u"java/lang/StrictMath", u"log", u"(D)D", handler<+[](double a) { return std::log(a); }>},
+
+    {u"java/lang/Float", u"floatToRawIntBits", u"(F)I", handler<+[](float a) { return std::bit_cast<int32_t>(a); }>},
+    {u"java/lang/Float", u"floatToIntBits", u"(F)I", handler<+[](float a) { return std::isnan(a) ? int32_t{0x7fc00000} : std::bit_cast<int32_t>(a); }>},
+    {u"java/lang/Float", u"intBitsToFloat", u"(I)F", handler<+[](int32_t a) { return std::bit_cast<float>(a); }>},
+    {u"java/lang/Double", u"doubleToRawLongBits", u"(D)J", handler<+[](double a) { return std::bit_cast<int64_t>(a); }>},
+    {u"java/lang/Double", u"doubleToLongBits", u"(D)J", handler<+[](double a) { return std::isnan(a) ? int64_t{0x7ff8000000000000} : std::bit_cast<int64_t>(a); }>},
+    {u"java/lang/Double", u"longBitsToDouble", u"(J)D", handler<+[](int64_t a) { return std::bit_cast<double>(a); }>},
+
+    {u"java/lang/Integer", u"bitCount", u"(I)I", handler<+[](int32_t a) { return std::popcount(static_cast<uint32_t>(a)); }>},
+    {u"java/lang/Integer", u"numberOfLeadingZeros", u"(I)I", handler<+[](int32_t a) { return std::countl_zero(static_cast<uint32_t>(a)); }>},
+    {u"java/lang/Integer", u"numberOfTrailingZeros", u"(I)I", handler<+[](int32_t a) { return std::countr_zero(static_cast<uint32_t>(a)); }>},
+    {u"java/lang/Integer", u"rotateLeft", u"(II)I", handler<+[](int32_t a, int32_t distance) { return static_cast<int32_t>(std::rotl(static_cast<uint32_t>(a), distance)); }>},
+    {u"java/lang/Integer", u"rotateRight", u"(II)I", handler<+[](int32_t a, int32_t distance) { return static_cast<int32_t>(std::rotr(static_cast<uint32_t>(a), distance)); }>},
+    {u"java/lang/Integer", u"reverseBytes", u"(I)I", handler<+[](int32_t a) { return std::byteswap(a); }>},
+    {u"java/lang/Integer", u"highestOneBit", u"(I)I", handler<+[](int32_t a) { return static_cast<int32_t>(highestOneBit(static_cast<uint32_t>(a))); }>},
+    {u"java/lang/Integer", u"lowestOneBit", u"(I)I", handler<+[](int32_t a) { return static_cast<int32_t>(lowestOneBit(static_cast<uint32_t>(a))); }>},
+
+    {u"java/lang/Long", u"bitCount", u"(J)I", handler<+[](int64_t a) { return std::popcount(static_cast<uint64_t>(a)); }>},
+    {u"java/lang/Long", u"numberOfLeadingZeros", u"(J)I", handler<+[](int64_t a) { return std::countl_zero(static_cast<uint64_t>(a)); }>},
+    {u"java/lang/Long", u"numberOfTrailingZeros", u"(J)I", handler<+[](int64_t a) { return std::countr_zero(static_cast<uint64_t>(a)); }>},
+    {u"java/lang/Long", u"rotateLeft", u"(JI)J", handler<+[](int64_t a, int32_t distance) { return static_cast<int64_t>(std::rotl(static_cast<uint64_t>(a), distance)); }>},
+    {u"java/lang/Long", u"rotateRight", u"(JI)J", handler<+[](int64_t a, int32_t distance) { return static_cast<int64_t>(std::rotr(static_cast<uint64_t>(a), distance)); }>},
+    {u"java/lang/Long", u"reverseBytes", u"(J)J", handler<+[](int64_t a) { return std::byteswap(a); }>},
+    {u"java/lang/Long", u"highestOneBit", u"(J)J", handler<+[](int64_t a) { return static_cast<int64_t>(highestOneBit(static_cast<uint64_t>(a))); }>},
+    {u"java/lang/Long", u"lowestOneBit", u"(J)J", handler<+[](int64_t a) { return static_cast<int64_t>(lowestOneBit(static_cast<uint64_t>(a))); }>},
+
+    // The receiver of `Object.hashCode` is checked for null by the interpreter before calling the intrinsic
+    {u"java/lang/Object", u"hashCode", u"()I", handler<+[](Instance* object) { return object->hashCode(); }>},
+    {u"java/lang/System", u"identityHashCode", u"(Ljava/lang/Object;)I", handler<+[](Instance* object) { return object != nullptr ? object->hashCode() : 0; }>},
+    // clang-format on
+};
+
+bool hasIntrinsics(types::JStringRef className)
+{
+  return className == u"java/lang/Math" || className == u"java/lang/StrictMath" || className == u"java/lang/Float" ||
+         className == u"java/lang/Double" || className == u"java/lang/Integer" || className == u"java/lang/Long" ||
+         className == u"java/lang/Object" || className == u"java/lang/System";
+}
+
+} // namespace
+
+IntrinsicHandler geevm::findIntrinsic(types::JStringRef className, types::JStringRef name, types::JStringRef descriptor)
+{
+  // Most classes have no intrinsics, so they are not compared against every entry
+  if (!hasIntrinsics(className)) {
+    return nullptr;
+  }
+
+  for (const Intrinsic& intrinsic : intrinsics) {
+    if (intrinsic.className == className && intrinsic.name == name && intrinsic.descriptor == descriptor) {
+      return intrinsic.handler;
+    }
+  }
+
+  return nullptr;
+}
@@ -0,0 +1,26 @@
+#ifndef GEEVM_VM_INTRINSICS_H
+#define GEEVM_VM_INTRINSICS_H
+
+#include "common/JvmTypes.h"
+
+namespace geevm
+{
+
+class CallFrame;
+
+/// Executes an intrinsic method on the operand stack of the calling frame: pops the arguments pushed for the call and
+/// pushes the return value. Intrinsics cannot throw, call other methods or allocate, so no call frame is needed.
+using IntrinsicHandler = void (*)(CallFrame& caller);
+
+/// Returns the C++ implementation of the method \p name with \p descriptor in \p className, or nullptr if the method
+/// is not an intrinsic. Intrinsics are looked up once when the class of the method is prepared.
+///
+/// The intrinsic methods are the numeric methods of `java/lang/Math` and `java/lang/StrictMath` whose C++ counterparts
+/// have the same results, the bit conversions of `java/lang/Float` and `java/lang/Double`, the bit manipulation
+/// methods of `java/lang/Integer` and `java/lang/Long`, and the identity hash code of `java/lang/Object` and
+/// `java/lang/System`.
+IntrinsicHandler findIntrinsic(types::JStringRef className, types::JStringRef name, types::JStringRef descriptor);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_INTRINSICS_H
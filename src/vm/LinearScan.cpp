@@ -0,0 +1,251 @@
+#include "vm/LinearScan.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <ranges>
+
+using namespace geevm;
+
+namespace
+{
+
+// Caller-saved registers come first, so that small methods do not need to save any registers
+constexpr std::array AllocatableRegisters{
+    Reg::R8, Reg::R9, Reg::R10, Reg::R11, Reg::RBX, Reg::RBP, Reg::R12, Reg::R13, Reg::R14, Reg::R15,
+};
+
+bool isCalleeSaved(Reg reg)
+{
+  return reg == Reg::RBX || reg == Reg::RBP || reg == Reg::R12 || reg == Reg::R13 || reg == Reg::R14 || reg == Reg::R15;
+}
+
+} // namespace
+
+bool LinearScan::isAllocated(const SsaValue* value)
+{
+  switch (value->opcode) {
+    using enum SsaOpcode;
+    case Constant:
+    case Undefined:
+    case ArrayStore:
+    case NullCheck:
+    case BoundsCheck:
+    case ZeroCheck:
+    case Goto:
+    case Branch:
+    case Exit: return false;
+    default: return true;
+  }
+}
+
+LinearScan::LinearScan(const SsaGraph& graph)
+  : mGraph(graph), mLocations(graph.valueCount())
+{
+  this->computeIntervals();
+  this->allocate();
+}
+
+void LinearScan::computeIntervals()
+{
+  const auto& blocks = mGraph.blocks();
+  uint32_t valueCount = mGraph.valueCount();
+
+  // Number the instructions, leaving a position for the phis at the start of every block
+  std::vector<uint32_t> blockStart(mGraph.blockCount());
+  std::vector<uint32_t> blockEnd(mGraph.blockCount());
+  std::vector<uint32_t> position(valueCount, 0);
+  uint32_t next = 0;
+  for (SsaBlock* block : blocks) {
+    blockStart[block->id] = next;
+    for (SsaValue* phi : block->phis) {
+      position[phi->id] = next;
+    }
+    next += 2;
+    for (SsaValue* value : block->instructions) {
+      position[value->id] = next;
+      next += 2;
+    }
+    blockEnd[block->id] = next - 2;
+  }
+
+  // Exits do not write parameters that are still in their own local variable slot
+  auto forEachUse = [](SsaValue* value, auto&& function) {
+    std::ranges::for_each(value->inputs, function);
+    if (value->frameState != nullptr) {
+      const auto& locals = value->frameState->locals;
+      for (size_t i = 0; i < locals.size(); ++i) {
+        if (locals[i]->opcode != SsaOpcode::Parameter || locals[i]->immediate != i) {
+          function(locals[i]);
+        }
+      }
+      std::ranges::for_each(value->frameState->stack, function);
+    }
+  };
+
+  // Live variable analysis, iterated to a fixed point over loops. Phi inputs are live out of their predecessor.
+  std::vector<std::vector<bool>> liveIn(mGraph.blockCount(), std::vector<bool>(valueCount, false));
+  std::vector<std::vector<bool>> liveOut(mGraph.blockCount(), std::vector<bool>(valueCount, false));
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (SsaBlock* block : blocks | std::views::reverse) {
+      std::vector<bool> live(valueCount, false);
+      for (SsaBlock* successor : block->successors) {
+        const std::vector<bool>& successorLive = liveIn[successor->id];
+        for (uint32_t id = 0; id < valueCount; ++id) {
+          if (successorLive[id]) {
+            live[id] = true;
+          }
+        }
+        size_t index = successor->predecessorIndex(block);
+        for (SsaValue* phi : successor->phis) {
+          if (isAllocated(phi->inputs[index])) {
+            live[phi->inputs[index]->id] = true;
+          }
+        }
+      }
+      if (live != liveOut[block->id]) {
+        liveOut[block->id] = live;
+        changed = true;
+      }
+
+      for (SsaValue* value : block->instructions | std::views::reverse) {
+        live[value->id] = false;
+        forEachUse(value, [&](SsaValue* input) {
+          if (isAllocated(input)) {
+            live[input->id] = true;
+          }
+        });
+      }
+      for (SsaValue* phi : block->phis) {
+        live[phi->id] = false;
+      }
+      if (live != liveIn[block->id]) {
+        liveIn[block->id] = std::move(live);
+        changed = true;
+      }
+    }
+  }
+
+  // Build the interval hulls
+  std::vector<bool> isDefined(valueCount, false);
+  std::vector<Interval> intervals(valueCount);
+  auto cover = [&](SsaValue* value, uint32_t at) {
+    Interval& interval = intervals[value->id];
+    if (!isDefined[value->id]) {
+      isDefined[value->id] = true;
+      interval = Interval{.value = value, .start = at, .end = at};
+    } else {
+      interval.start = std::min(interval.start, at);
+      interval.end = std::max(interval.end, at);
+    }
+  };
+
+  for (SsaBlock* block : blocks) {
+    for (SsaValue* phi : block->phis) {
+      cover(phi, blockStart[block->id]);
+      for (size_t i = 0; i < block->predecessors.size(); ++i) {
+        uint32_t predecessorEnd = blockEnd[block->predecessors[i]->id];
+        cover(phi, predecessorEnd);
+        if (isAllocated(phi->inputs[i])) {
+          cover(phi->inputs[i], predecessorEnd);
+        }
+      }
+    }
+    for (SsaValue* value : block->instructions) {
+      if (isAllocated(value)) {
+        cover(value, position[value->id]);
+      }
+      forEachUse(value, [&](SsaValue* input) {
+        if (isAllocated(input)) {
+          cover(input, position[value->id]);
+        }
+      });
+    }
+  }
+  for (SsaBlock* block : blocks) {
+    for (uint32_t id = 0; id < valueCount; ++id) {
+      if (liveIn[block->id][id]) {
+        cover(intervals[id].value, blockStart[block->id]);
+      }
+      if (liveOut[block->id][id]) {
+        cover(intervals[id].value, blockEnd[block->id]);
+      }
+    }
+  }
+
+  for (uint32_t id = 0; id < valueCount; ++id) {
+    if (isDefined[id]) {
+      // Used parameters are loaded from the interpreter frame before the entry block
+      if (intervals[id].value->opcode == SsaOpcode::Parameter) {
+        intervals[id].start = 0;
+      }
+      mIntervals.push_back(intervals[id]);
+    }
+  }
+}
+
+void LinearScan::allocate()
+{
+  std::ranges::sort(mIntervals, [](const Interval& lhs, const Interval& rhs) {
+    return lhs.start != rhs.start ? lhs.start < rhs.start : lhs.value->id < rhs.value->id;
+  });
+
+  std::vector<const Interval*> active;
+  std::vector<bool> isFree(16, false);
+  for (Reg reg : AllocatableRegisters) {
+    isFree[static_cast<uint8_t>(reg)] = true;
+  }
+
+  auto spill = [&](const Interval& interval) {
+    ValueLocation& location = mLocations[interval.value->id];
+    location.kind = ValueLocation::Kind::Spilled;
+    location.spillSlot = mSpillSlotCount++;
+  };
+
+  for (const Interval& current : mIntervals) {
+    // An interval that ends at the start of the current one is still active, so results never share a register with
+    // their operands
+    std::erase_if(active, [&](const Interval* interval) {
+      if (interval->end < current.start) {
+        isFree[static_cast<uint8_t>(mLocations[interval->value->id].reg)] = true;
+        return true;
+      }
+      return false;
+    });
+
+    ValueLocation& location = mLocations[current.value->id];
+    auto freeRegister = std::ranges::find_if(AllocatableRegisters, [&](Reg reg) {
+      return isFree[static_cast<uint8_t>(reg)];
+    });
+    if (freeRegister != AllocatableRegisters.end()) {
+      location.kind = ValueLocation::Kind::Register;
+      location.reg = *freeRegister;
+      isFree[static_cast<uint8_t>(*freeRegister)] = false;
+      active.push_back(&current);
+      continue;
+    }
+
+    auto longest = std::ranges::max_element(active, {}, &Interval::end);
+    assert(longest != active.end());
+    if ((*longest)->end > current.end) {
+      ValueLocation& spilled = mLocations[(*longest)->value->id];
+      location.kind = ValueLocation::Kind::Register;
+      location.reg = spilled.reg;
+      spill(**longest);
+      *longest = &current;
+    } else {
+      spill(current);
+    }
+  }
+
+  for (Reg reg : AllocatableRegisters) {
+    bool isUsed = std::ranges::any_of(mLocations, [&](const ValueLocation& location) {
+      return location.kind == ValueLocation::Kind::Register && location.reg == reg;
+    });
+    if (isUsed && isCalleeSaved(reg)) {
+      mUsedCalleeSavedRegisters.push_back(reg);
+    }
+  }
+}
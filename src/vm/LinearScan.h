@@ -0,0 +1,85 @@
+#ifndef GEEVM_VM_LINEARSCAN_H
+#define GEEVM_VM_LINEARSCAN_H
+
+#include "vm/SsaGraph.h"
+#include "vm/X86Assembler.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace geevm
+{
+
+/// Where compiled code keeps an SSA value.
+struct ValueLocation
+{
+  enum class Kind : uint8_t
+  {
+    // Constants, the undefined value, and values without a result are materialized where they are used
+    None,
+    Register,
+    // The value lives in its stack slot for its whole lifetime
+    Spilled,
+  };
+
+  Kind kind = Kind::None;
+  Reg reg = Reg::RAX;
+  uint32_t spillSlot = 0;
+};
+
+/// Linear scan register allocation of Poletto and Sarkar, "Linear Scan Register Allocation".
+///
+/// Blocks are numbered in reverse postorder and every value gets a single live interval from its definition to its
+/// last use, including uses in frame states of exits. Intervals cover the ends of all blocks the value is live out of,
+/// so values that are used within a loop stay allocated until its back edge. Phis are defined at the start of their
+/// block and their intervals cover the ends of their predecessors, where the moves into the phis are emitted. When no
+/// register is free, the interval that ends last is spilled for its whole lifetime.
+///
+/// RAX, RCX and RDX are never allocated, so code generation can use them as scratch registers, and neither are RSI and
+/// RDI which hold the interpreter frame.
+class LinearScan
+{
+public:
+  explicit LinearScan(const SsaGraph& graph);
+
+  const ValueLocation& location(const SsaValue* value) const
+  {
+    return mLocations[value->id];
+  }
+
+  uint32_t spillSlotCount() const
+  {
+    return mSpillSlotCount;
+  }
+
+  /// Allocated registers that are callee-saved in the System V calling convention, which compiled code has to preserve.
+  const std::vector<Reg>& usedCalleeSavedRegisters() const
+  {
+    return mUsedCalleeSavedRegisters;
+  }
+
+  /// Returns true if \p value has a result that is kept in a register or stack slot.
+  static bool isAllocated(const SsaValue* value);
+
+private:
+  struct Interval
+  {
+    SsaValue* value;
+    uint32_t start;
+    uint32_t end;
+  };
+
+  void computeIntervals();
+  void allocate();
+
+private:
+  const SsaGraph& mGraph;
+  std::vector<Interval> mIntervals;
+  std::vector<ValueLocation> mLocations;
+  uint32_t mSpillSlotCount = 0;
+  std::vector<Reg> mUsedCalleeSavedRegisters;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_LINEARSCAN_H
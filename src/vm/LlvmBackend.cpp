@@ -0,0 +1,443 @@
+#include "vm/LlvmBackend.h"
+#include "common/Debug.h"
+#include "vm/CompiledCode.h"
+#include "vm/Instance.h"
+#include "vm/SsaGraph.h"
+
+#include <llvm/Config/llvm-config.h>
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include <string>
+#include <unordered_map>
+
+using namespace geevm;
+
+namespace
+{
+
+llvm::CmpInst::Predicate predicate(SsaCondition condition)
+{
+  switch (condition) {
+    case SsaCondition::Equal: return llvm::CmpInst::ICMP_EQ;
+    case SsaCondition::NotEqual: return llvm::CmpInst::ICMP_NE;
+    case SsaCondition::Less: return llvm::CmpInst::ICMP_SLT;
+    case SsaCondition::GreaterEqual: return llvm::CmpInst::ICMP_SGE;
+    case SsaCondition::Greater: return llvm::CmpInst::ICMP_SGT;
+    case SsaCondition::LessEqual: return llvm::CmpInst::ICMP_SLE;
+  }
+  GEEVM_UNREACHBLE("Unknown condition");
+}
+
+/// Lowers an optimized graph into a function `i64 (ptr locals, ptr stack)` of the module.
+///
+/// Every SSA value becomes an i64 with the representation of an interpreter frame slot, int operations truncate their
+/// operands and zero-extend their results, which LLVM removes again where they cancel out. Runtime checks split their
+/// block and branch to an exit block of their own, which stores the frame state and returns the exit state.
+class IrGenerator
+{
+public:
+  IrGenerator(const SsaGraph& graph, llvm::Module& module, const std::string& name)
+    : mGraph(graph),
+      mContext(module.getContext()),
+      mBuilder(mContext),
+      mValues(graph.valueCount(), nullptr),
+      mBlocks(graph.blockCount(), nullptr),
+      mEndBlocks(graph.blockCount(), nullptr)
+  {
+    auto* i64 = mBuilder.getInt64Ty();
+    auto* functionType = llvm::FunctionType::get(i64, {llvm::PointerType::getUnqual(i64), llvm::PointerType::getUnqual(i64)}, false);
+    mFunction = llvm::Function::Create(functionType, llvm::Function::ExternalLinkage, name, module);
+    // The interpreter frame is never accessed as a Java object
+    mFunction->addParamAttr(0, llvm::Attribute::NoAlias);
+    mFunction->addParamAttr(1, llvm::Attribute::NoAlias);
+    mFunction->addFnAttr(llvm::Attribute::NoUnwind);
+  }
+
+  void generate();
+
+private:
+  llvm::Value* value(SsaValue* value);
+  // The int in the low half of \p value
+  llvm::Value* intValue(SsaValue* value);
+  llvm::Value* fromInt(llvm::Value* value);
+
+  llvm::Value* slotAddress(llvm::Value* base, size_t index);
+  llvm::Value* elementAddress(SsaValue* array, SsaValue* index, llvm::Type* elementType);
+
+  void emitInstruction(SsaBlock* block, SsaValue* value);
+  llvm::Value* emitDivision(SsaValue* value);
+  llvm::Value* emitArrayLoad(SsaValue* value);
+  void emitArrayStore(SsaValue* value);
+  // Continues in a new block if \p failed is false, and leaves at \p frameState otherwise
+  void emitCheck(llvm::Value* failed, const FrameState* frameState);
+  void emitExit(const FrameState& frameState);
+
+private:
+  const SsaGraph& mGraph;
+  llvm::LLVMContext& mContext;
+  llvm::IRBuilder<> mBuilder;
+  llvm::Function* mFunction = nullptr;
+  llvm::Value* mLocals = nullptr;
+  llvm::Value* mStack = nullptr;
+  std::vector<llvm::Value*> mValues;
+  std::vector<llvm::BasicBlock*> mBlocks;
+  // The LLVM block that ends each SSA block after checks split it, which is the incoming block of its phi inputs
+  std::vector<llvm::BasicBlock*> mEndBlocks;
+};
+
+void IrGenerator::generate()
+{
+  auto* i64 = mBuilder.getInt64Ty();
+  mLocals = mFunction->getArg(0);
+  mStack = mFunction->getArg(1);
+
+  auto* prologue = llvm::BasicBlock::Create(mContext, "prologue", mFunction);
+  for (SsaBlock* block : mGraph.blocks()) {
+    mBlocks[block->id] = llvm::BasicBlock::Create(mContext, "b" + std::to_string(block->id), mFunction);
+  }
+
+  mBuilder.SetInsertPoint(prologue);
+  for (const auto& [index, parameter] : mGraph.parameters()) {
+    mValues[parameter->id] = mBuilder.CreateLoad(i64, this->slotAddress(mLocals, index));
+  }
+  mBuilder.CreateBr(mBlocks[mGraph.entry()->id]);
+
+  // Phis are created up front, as inputs on back edges are defined after their use
+  for (SsaBlock* block : mGraph.blocks()) {
+    mBuilder.SetInsertPoint(mBlocks[block->id]);
+    for (SsaValue* phi : block->phis) {
+      mValues[phi->id] = mBuilder.CreatePHI(i64, static_cast<unsigned>(block->predecessors.size()));
+    }
+  }
+
+  for (SsaBlock* block : mGraph.blocks()) {
+    mBuilder.SetInsertPoint(mBlocks[block->id]);
+    for (SsaValue* value : block->instructions) {
+      this->emitInstruction(block, value);
+    }
+  }
+
+  for (SsaBlock* block : mGraph.blocks()) {
+    for (SsaValue* phi : block->phis) {
+      auto* node = llvm::cast<llvm::PHINode>(mValues[phi->id]);
+      for (size_t i = 0; i < block->predecessors.size(); ++i) {
+        node->addIncoming(this->value(phi->inputs[i]), mEndBlocks[block->predecessors[i]->id]);
+      }
+    }
+  }
+}
+
+llvm::Value* IrGenerator::value(SsaValue* value)
+{
+  switch (value->opcode) {
+    case SsaOpcode::Constant: return mBuilder.getInt64(value->immediate);
+    case SsaOpcode::Undefined: return llvm::UndefValue::get(mBuilder.getInt64Ty());
+    default: assert(mValues[value->id] != nullptr); return mValues[value->id];
+  }
+}
+
+llvm::Value* IrGenerator::intValue(SsaValue* value)
+{
+  return mBuilder.CreateTrunc(this->value(value), mBuilder.getInt32Ty());
+}
+
+llvm::Value* IrGenerator::fromInt(llvm::Value* value)
+{
+  return mBuilder.CreateZExt(value, mBuilder.getInt64Ty());
+}
+
+llvm::Value* IrGenerator::slotAddress(llvm::Value* base, size_t index)
+{
+  return mBuilder.CreateConstInBoundsGEP1_64(mBuilder.getInt64Ty(), base, index);
+}
+
+llvm::Value* IrGenerator::elementAddress(SsaValue* array, SsaValue* index, llvm::Type* elementType)
+{
+  // Checked indices are never negative
+  auto* i64 = mBuilder.getInt64Ty();
+  llvm::Value* offset = mBuilder.CreateMul(mBuilder.CreateSExt(this->intValue(index), i64),
+                                           llvm::ConstantInt::get(i64, elementType->getPrimitiveSizeInBits() / 8));
+  offset = mBuilder.CreateAdd(offset, llvm::ConstantInt::get(i64, ArrayInstance::elementsOffset()));
+  llvm::Value* base = mBuilder.CreateIntToPtr(this->value(array), llvm::PointerType::getUnqual(mBuilder.getInt8Ty()));
+  llvm::Value* address = mBuilder.CreateInBoundsGEP(mBuilder.getInt8Ty(), base, offset);
+  return mBuilder.CreatePointerCast(address, llvm::PointerType::getUnqual(elementType));
+}
+
+void IrGenerator::emitInstruction(SsaBlock* block, SsaValue* value)
+{
+  auto* i32 = mBuilder.getInt32Ty();
+  auto* i64 = mBuilder.getInt64Ty();
+
+  auto intBinary = [&](llvm::Instruction::BinaryOps op) {
+    return this->fromInt(mBuilder.CreateBinOp(op, this->intValue(value->inputs[0]), this->intValue(value->inputs[1])));
+  };
+  auto longBinary = [&](llvm::Instruction::BinaryOps op) {
+    return mBuilder.CreateBinOp(op, this->value(value->inputs[0]), this->value(value->inputs[1]));
+  };
+  // Shift counts are masked like in Java, shifting by the width or more is poison in LLVM
+  auto intShift = [&](llvm::Instruction::BinaryOps op) {
+    llvm::Value* count = mBuilder.CreateAnd(this->intValue(value->inputs[1]), 31);
+    return this->fromInt(mBuilder.CreateBinOp(op, this->intValue(value->inputs[0]), count));
+  };
+  auto longShift = [&](llvm::Instruction::BinaryOps op) {
+    llvm::Value* count = mBuilder.CreateZExt(mBuilder.CreateAnd(this->intValue(value->inputs[1]), 63), i64);
+    return mBuilder.CreateBinOp(op, this->value(value->inputs[0]), count);
+  };
+  auto narrow = [&](llvm::Type* type, bool isSigned) {
+    llvm::Value* narrowed = mBuilder.CreateTrunc(this->value(value->inputs[0]), type);
+    return this->fromInt(isSigned ? mBuilder.CreateSExt(narrowed, i32) : mBuilder.CreateZExt(narrowed, i32));
+  };
+
+  llvm::Value* result = nullptr;
+  switch (value->opcode) {
+    using enum SsaOpcode;
+    case IAdd: result = intBinary(llvm::Instruction::Add); break;
+    case ISub: result = intBinary(llvm::Instruction::Sub); break;
+    case IMul: result = intBinary(llvm::Instruction::Mul); break;
+    case IAnd: result = intBinary(llvm::Instruction::And); break;
+    case IOr: result = intBinary(llvm::Instruction::Or); break;
+    case IXor: result = intBinary(llvm::Instruction::Xor); break;
+    case IShl: result = intShift(llvm::Instruction::Shl); break;
+    case IShr: result = intShift(llvm::Instruction::AShr); break;
+    case IUShr: result = intShift(llvm::Instruction::LShr); break;
+    case INeg: result = this->fromInt(mBuilder.CreateNeg(this->intValue(value->inputs[0]))); break;
+    case LAdd: result = longBinary(llvm::Instruction::Add); break;
+    case LSub: result = longBinary(llvm::Instruction::Sub); break;
+    case LMul: result = longBinary(llvm::Instruction::Mul); break;
+    case LAnd: result = longBinary(llvm::Instruction::And); break;
+    case LOr: result = longBinary(llvm::Instruction::Or); break;
+    case LXor: result = longBinary(llvm::Instruction::Xor); break;
+    case LShl: result = longShift(llvm::Instruction::Shl); break;
+    case LShr: result = longShift(llvm::Instruction::AShr); break;
+    case LUShr: result = longShift(llvm::Instruction::LShr); break;
+    case LNeg: result = mBuilder.CreateNeg(this->value(value->inputs[0])); break;
+    case IDiv:
+    case IRem:
+    case LDiv:
+    case LRem: result = this->emitDivision(value); break;
+    case I2L: result = mBuilder.CreateSExt(this->intValue(value->inputs[0]), i64); break;
+    case L2I: result = this->fromInt(this->intValue(value->inputs[0])); break;
+    case I2B: result = narrow(mBuilder.getInt8Ty(), true); break;
+    case I2C: result = narrow(mBuilder.getInt16Ty(), false); break;
+    case I2S: result = narrow(mBuilder.getInt16Ty(), true); break;
+    case LCmp: {
+      llvm::Value* lhs = this->value(value->inputs[0]);
+      llvm::Value* rhs = this->value(value->inputs[1]);
+      llvm::Value* greater = mBuilder.CreateZExt(mBuilder.CreateICmpSGT(lhs, rhs), i32);
+      llvm::Value* less = mBuilder.CreateZExt(mBuilder.CreateICmpSLT(lhs, rhs), i32);
+      result = this->fromInt(mBuilder.CreateSub(greater, less));
+      break;
+    }
+    case ArrayLength: {
+      llvm::Value* base = mBuilder.CreateIntToPtr(this->value(value->inputs[0]), llvm::PointerType::getUnqual(mBuilder.getInt8Ty()));
+      llvm::Value* address = mBuilder.CreateConstInBoundsGEP1_64(mBuilder.getInt8Ty(), base, ArrayInstance::lengthOffset());
+      result = this->fromInt(mBuilder.CreateLoad(i32, mBuilder.CreatePointerCast(address, llvm::PointerType::getUnqual(i32))));
+      break;
+    }
+    case ArrayLoad: result = this->emitArrayLoad(value); break;
+    case ArrayStore: this->emitArrayStore(value); break;
+    case NullCheck: this->emitCheck(mBuilder.CreateICmpEQ(this->value(value->inputs[0]), mBuilder.getInt64(0)), value->frameState); break;
+    case BoundsCheck:
+      // Negative indices are above the length as unsigned ints
+      this->emitCheck(mBuilder.CreateICmpUGE(this->intValue(value->inputs[0]), this->intValue(value->inputs[1])), value->frameState);
+      break;
+    case ZeroCheck: {
+      llvm::Value* divisor = value->immediate != 0 ? this->value(value->inputs[0]) : this->intValue(value->inputs[0]);
+      this->emitCheck(mBuilder.CreateIsNull(divisor), value->frameState);
+      break;
+    }
+    case Goto:
+      mEndBlocks[block->id] = mBuilder.GetInsertBlock();
+      mBuilder.CreateBr(mBlocks[block->successors[0]->id]);
+      break;
+    case Branch: {
+      llvm::Value* lhs = value->isWideComparison() ? this->value(value->inputs[0]) : this->intValue(value->inputs[0]);
+      llvm::Value* rhs = value->isWideComparison() ? this->value(value->inputs[1]) : this->intValue(value->inputs[1]);
+      mEndBlocks[block->id] = mBuilder.GetInsertBlock();
+      mBuilder.CreateCondBr(mBuilder.CreateICmp(predicate(value->condition()), lhs, rhs), mBlocks[block->successors[0]->id],
+                            mBlocks[block->successors[1]->id]);
+      break;
+    }
+    case Exit:
+      mEndBlocks[block->id] = mBuilder.GetInsertBlock();
+      this->emitExit(*value->frameState);
+      break;
+    default: GEEVM_UNREACHBLE("Value is not an instruction");
+  }
+
+  mValues[value->id] = result;
+}
+
+llvm::Value* IrGenerator::emitDivision(SsaValue* value)
+{
+  bool isLong = value->opcode == SsaOpcode::LDiv || value->opcode == SsaOpcode::LRem;
+  bool isRemainder = value->opcode == SsaOpcode::IRem || value->opcode == SsaOpcode::LRem;
+
+  // The divisor was checked against zero before. Dividing the minimum value by -1 overflows, which is undefined in
+  // LLVM but wraps around in Java, so -1 divides by 1 and negates instead. The remainder is 0 either way.
+  llvm::Value* dividend = isLong ? this->value(value->inputs[0]) : this->intValue(value->inputs[0]);
+  llvm::Value* divisor = isLong ? this->value(value->inputs[1]) : this->intValue(value->inputs[1]);
+  llvm::Value* isMinusOne = mBuilder.CreateICmpEQ(divisor, llvm::ConstantInt::getSigned(divisor->getType(), -1));
+  llvm::Value* safeDivisor = mBuilder.CreateSelect(isMinusOne, llvm::ConstantInt::get(divisor->getType(), 1), divisor);
+
+  llvm::Value* result = nullptr;
+  if (isRemainder) {
+    result = mBuilder.CreateSRem(dividend, safeDivisor);
+  } else {
+    result = mBuilder.CreateSelect(isMinusOne, mBuilder.CreateNeg(dividend), mBuilder.CreateSDiv(dividend, safeDivisor));
+  }
+  return isLong ? result : this->fromInt(result);
+}
+
+llvm::Value* IrGenerator::emitArrayLoad(SsaValue* value)
+{
+  auto* i32 = mBuilder.getInt32Ty();
+  auto load = [&](llvm::Type* type) {
+    return mBuilder.CreateLoad(type, this->elementAddress(value->inputs[0], value->inputs[1], type));
+  };
+
+  switch (static_cast<ArrayElementKind>(value->immediate)) {
+    case ArrayElementKind::Int: return this->fromInt(load(i32));
+    case ArrayElementKind::Long: return load(mBuilder.getInt64Ty());
+    case ArrayElementKind::Byte: return this->fromInt(mBuilder.CreateSExt(load(mBuilder.getInt8Ty()), i32));
+    case ArrayElementKind::Char: return this->fromInt(mBuilder.CreateZExt(load(mBuilder.getInt16Ty()), i32));
+    case ArrayElementKind::Short: return this->fromInt(mBuilder.CreateSExt(load(mBuilder.getInt16Ty()), i32));
+  }
+  GEEVM_UNREACHBLE("Unknown array element kind");
+}
+
+void IrGenerator::emitArrayStore(SsaValue* value)
+{
+  llvm::Type* type = nullptr;
+  switch (static_cast<ArrayElementKind>(value->immediate)) {
+    case ArrayElementKind::Int: type = mBuilder.getInt32Ty(); break;
+    case ArrayElementKind::Long: type = mBuilder.getInt64Ty(); break;
+    case ArrayElementKind::Byte: type = mBuilder.getInt8Ty(); break;
+    case ArrayElementKind::Char:
+    case ArrayElementKind::Short: type = mBuilder.getInt16Ty(); break;
+  }
+
+  llvm::Value* stored = mBuilder.CreateTrunc(this->value(value->inputs[2]), type);
+  mBuilder.CreateStore(stored, this->elementAddress(value->inputs[0], value->inputs[1], type));
+}
+
+void IrGenerator::emitCheck(llvm::Value* failed, const FrameState* frameState)
+{
+  auto* exit = llvm::BasicBlock::Create(mContext, "exit", mFunction);
+  auto* passed = llvm::BasicBlock::Create(mContext, "", mFunction);
+  llvm::MDBuilder weights(mContext);
+  mBuilder.CreateCondBr(failed, exit, passed, weights.createBranchWeights(1, 1000));
+
+  mBuilder.SetInsertPoint(exit);
+  this->emitExit(*frameState);
+  mBuilder.SetInsertPoint(passed);
+}
+
+void IrGenerator::emitExit(const FrameState& frameState)
+{
+  // Compiled code never writes the interpreter frame before an exit, so parameters are still in their own slot
+  auto isUnchanged = [](const SsaValue* value, size_t localIndex) {
+    return value->opcode == SsaOpcode::Undefined || (value->opcode == SsaOpcode::Parameter && value->immediate == localIndex);
+  };
+
+  for (size_t i = 0; i < frameState.locals.size(); ++i) {
+    SsaValue* value = frameState.locals[i];
+    if (!isUnchanged(value, i)) {
+      mBuilder.CreateStore(this->value(value), this->slotAddress(mLocals, i));
+    }
+  }
+  for (size_t i = 0; i < frameState.stack.size(); ++i) {
+    SsaValue* value = frameState.stack[i];
+    if (value->opcode != SsaOpcode::Undefined) {
+      mBuilder.CreateStore(this->value(value), this->slotAddress(mStack, i));
+    }
+  }
+
+  mBuilder.CreateRet(mBuilder.getInt64(compiledCodeExitState(frameState.pc, static_cast<int32_t>(frameState.stack.size()))));
+}
+
+} // namespace
+
+std::unique_ptr<LlvmBackend> LlvmBackend::create()
+{
+  if (llvm::InitializeNativeTarget() || llvm::InitializeNativeTargetAsmPrinter()) {
+    return nullptr;
+  }
+
+  auto targetMachineBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!targetMachineBuilder) {
+    llvm::consumeError(targetMachineBuilder.takeError());
+    return nullptr;
+  }
+  auto targetMachine = targetMachineBuilder->createTargetMachine();
+  if (!targetMachine) {
+    llvm::consumeError(targetMachine.takeError());
+    return nullptr;
+  }
+  auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*targetMachineBuilder)).create();
+  if (!jit) {
+    llvm::consumeError(jit.takeError());
+    return nullptr;
+  }
+
+  return std::unique_ptr<LlvmBackend>(new LlvmBackend(std::move(*jit), std::move(*targetMachine)));
+}
+
+LlvmBackend::LlvmBackend(std::unique_ptr<llvm::orc::LLJIT> jit, std::unique_ptr<llvm::TargetMachine> targetMachine)
+  : mJit(std::move(jit)), mTargetMachine(std::move(targetMachine))
+{
+}
+
+LlvmBackend::~LlvmBackend() = default;
+
+void* LlvmBackend::compile(const SsaGraph& graph)
+{
+  std::string name = "geevm_compiled_" + std::to_string(mFunctionCount++);
+  auto context = std::make_unique<llvm::LLVMContext>();
+  auto module = std::make_unique<llvm::Module>(name, *context);
+  module->setDataLayout(mJit->getDataLayout());
+  module->setTargetTriple(mJit->getTargetTriple().str());
+
+  IrGenerator generator(graph, *module, name);
+  generator.generate();
+  if (llvm::verifyModule(*module, &llvm::errs())) {
+    return nullptr;
+  }
+
+  llvm::LoopAnalysisManager loopAnalyses;
+  llvm::FunctionAnalysisManager functionAnalyses;
+  llvm::CGSCCAnalysisManager cgsccAnalyses;
+  llvm::ModuleAnalysisManager moduleAnalyses;
+  llvm::PassBuilder passBuilder(mTargetMachine.get());
+  passBuilder.registerModuleAnalyses(moduleAnalyses);
+  passBuilder.registerCGSCCAnalyses(cgsccAnalyses);
+  passBuilder.registerFunctionAnalyses(functionAnalyses);
+  passBuilder.registerLoopAnalyses(loopAnalyses);
+  passBuilder.crossRegisterProxies(loopAnalyses, functionAnalyses, cgsccAnalyses, moduleAnalyses);
+  passBuilder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2).run(*module, moduleAnalyses);
+
+  if (auto error = mJit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context)))) {
+    llvm::consumeError(std::move(error));
+    return nullptr;
+  }
+
+  auto symbol = mJit->lookup(name);
+  if (!symbol) {
+    llvm::consumeError(symbol.takeError());
+    return nullptr;
+  }
+#if LLVM_VERSION_MAJOR >= 15
+  return symbol->toPtr<void*>();
+#else
+  return reinterpret_cast<void*>(symbol->getAddress());
+#endif
+}
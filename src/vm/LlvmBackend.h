@@ -0,0 +1,57 @@
+#ifndef GEEVM_VM_LLVMBACKEND_H
+#define GEEVM_VM_LLVMBACKEND_H
+
+#include <cstdint>
+#include <memory>
+
+namespace llvm
+{
+class TargetMachine;
+namespace orc
+{
+class LLJIT;
+} // namespace orc
+} // namespace llvm
+
+namespace geevm
+{
+
+class SsaGraph;
+
+/// Alternative code generator of the optimizing compiler, only available in builds with `GEEVM_ENABLE_LLVM`.
+///
+/// Optimized SSA graphs are lowered to LLVM IR, optimized once more by LLVM's default pipeline and compiled with ORC
+/// LLJIT. The generated functions follow the same contract as the code of the other tiers: they take the local
+/// variables and the operand stack of the interpreter frame, never call, allocate or throw, and leave to the interpreter
+/// by writing the frame state of an exit back into the frame. As the garbage collector can never run during compiled
+/// code, no statepoints or stack maps are needed.
+///
+/// Compiled functions live in memory owned by LLJIT instead of the code cache and are never freed.
+class LlvmBackend
+{
+public:
+  /// Returns nullptr if LLVM cannot generate code for the host.
+  static std::unique_ptr<LlvmBackend> create();
+
+  LlvmBackend(const LlvmBackend&) = delete;
+  LlvmBackend& operator=(const LlvmBackend&) = delete;
+
+  ~LlvmBackend();
+
+  /// Compiles \p graph and returns its entry point, or nullptr if LLVM failed to compile it.
+  void* compile(const SsaGraph& graph);
+
+private:
+  LlvmBackend(std::unique_ptr<llvm::orc::LLJIT> jit, std::unique_ptr<llvm::TargetMachine> targetMachine);
+
+private:
+  std::unique_ptr<llvm::orc::LLJIT> mJit;
+  // Host target of the optimization pipeline, for its cost models
+  std::unique_ptr<llvm::TargetMachine> mTargetMachine;
+  // Every graph is compiled into a module and function of its own
+  uint64_t mFunctionCount = 0;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_LLVMBACKEND_H
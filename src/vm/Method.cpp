@@ -1,9 +1,173 @@
 #include "vm/Method.h"
+#include "class_file/Opcode.h"
 #include "vm/Class.h"
+#include "vm/Superinstructions.h"
+
+#include <bit>
+#include <cassert>
 
 using namespace geevm;
 
 JMethod::JMethod(const MethodInfo& methodInfo, InstanceClass* klass, types::JString name, types::JString rawDescriptor, MethodDescriptor descriptor)
   : mMethodInfo(methodInfo), mClass(klass), mName(std::move(name)), mRawDescriptor(std::move(rawDescriptor)), mDescriptor(std::move(descriptor))
 {
+  this->classifyTrivialShape();
+}
+
+void JMethod::fuseInterpreterCode()
+{
+  assert(!this->isNative() && !this->isAbstract());
+  if (auto fused = fuseSuperinstructions(this->getCode().bytes()); fused.has_value()) {
+    mFusedCode = std::move(*fused);
+    mInterpreterCode = mFusedCode.data();
+  } else {
+    mInterpreterCode = this->getCode().bytes().data();
+  }
+}
+
+const ExceptionHandlerTable& JMethod::exceptionHandlers()
+{
+  assert(!this->isNative() && !this->isAbstract());
+  if (!mExceptionHandlers.has_value()) {
+    mExceptionHandlers.emplace(this->getCode(), mClass->runtimeConstantPool());
+  }
+
+  return *mExceptionHandlers;
+}
+
+const SwitchTable& JMethod::switchTable(int64_t opcodePos)
+{
+  auto it = mSwitchTables.find(opcodePos);
+  if (it == mSwitchTables.end()) {
+    it = mSwitchTables.try_emplace(opcodePos, this->getCode().bytes(), opcodePos).first;
+  }
+
+  return it->second;
+}
+
+static types::u2 readU2(const std::vector<types::u1>& bytes, size_t pos)
+{
+  return (bytes[pos] << 8u) | bytes[pos + 1];
+}
+
+/// Returns the raw operand stack value of the constant pushed by \p bytes, if they consist of a single constant push
+/// followed by one more instruction.
+static std::optional<uint64_t> pushedConstant(const std::vector<types::u1>& bytes)
+{
+  auto rawInt = [](int32_t value) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(value));
+  };
+
+  uint64_t value;
+  size_t length = 1;
+  auto opcode = static_cast<Opcode>(bytes[0]);
+  switch (opcode) {
+    using enum Opcode;
+    case ACONST_NULL: value = 0; break;
+    case ICONST_M1:
+    case ICONST_0:
+    case ICONST_1:
+    case ICONST_2:
+    case ICONST_3:
+    case ICONST_4:
+    case ICONST_5: value = rawInt(bytes[0] - static_cast<int32_t>(ICONST_0)); break;
+    case LCONST_0:
+    case LCONST_1: value = std::bit_cast<uint64_t>(int64_t{bytes[0] - static_cast<int32_t>(LCONST_0)}); break;
+    case FCONST_0:
+    case FCONST_1:
+    case FCONST_2: value = std::bit_cast<uint32_t>(static_cast<float>(bytes[0] - static_cast<int32_t>(FCONST_0))); break;
+    case DCONST_0:
+    case DCONST_1: value = std::bit_cast<uint64_t>(static_cast<double>(bytes[0] - static_cast<int32_t>(DCONST_0))); break;
+    case BIPUSH:
+      if (bytes.size() != 3) {
+        return std::nullopt;
+      }
+      value = rawInt(static_cast<int8_t>(bytes[1]));
+      length = 2;
+      break;
+    case SIPUSH:
+      if (bytes.size() != 4) {
+        return std::nullopt;
+      }
+      value = rawInt(static_cast<int16_t>(readU2(bytes, 1)));
+      length = 3;
+      break;
+    default: return std::nullopt;
+  }
+
+  if (bytes.size() != length + 1) {
+    return std::nullopt;
+  }
+
+  return value;
+}
+
+void JMethod::classifyTrivialShape()
+{
+  if (!mMethodInfo.hasCode() || hasAccessFlag(this->accessFlags(), MethodAccessFlags::ACC_SYNCHRONIZED)) {
+    return;
+  }
+
+  const std::vector<types::u1>& bytes = this->getCode().bytes();
+  auto opcodeAt = [&](size_t pos) {
+    return static_cast<Opcode>(bytes[pos]);
+  };
+  auto isValueReturn = [](Opcode opcode) {
+    return opcode >= Opcode::IRETURN && opcode <= Opcode::ARETURN;
+  };
+
+  using enum Opcode;
+  if (bytes.size() == 1 && opcodeAt(0) == RETURN) {
+    mTrivialKind = TrivialMethodKind::Empty;
+    return;
+  }
+
+  if (!this->isStatic() && opcodeAt(0) == ALOAD_0) {
+    if (bytes.size() == 5 && mName == u"<init>" && opcodeAt(1) == INVOKESPECIAL && opcodeAt(4) == RETURN) {
+      mTrivialKind = TrivialMethodKind::Empty;
+      mTrivialReference = readU2(bytes, 2);
+      mTrivialNeedsResolution = true;
+    } else if (bytes.size() == 5 && mDescriptor.parameters().empty() && opcodeAt(1) == GETFIELD && isValueReturn(opcodeAt(4))) {
+      mTrivialKind = TrivialMethodKind::Getter;
+      mTrivialReference = readU2(bytes, 2);
+      mTrivialNeedsResolution = true;
+    } else if (bytes.size() == 6 && mDescriptor.parameters().size() == 1 && (opcodeAt(1) == ILOAD_1 || opcodeAt(1) == LLOAD_1 || opcodeAt(1) == FLOAD_1 || opcodeAt(1) == DLOAD_1 || opcodeAt(1) == ALOAD_1) &&
+               opcodeAt(2) == PUTFIELD && opcodeAt(5) == RETURN) {
+      mTrivialKind = TrivialMethodKind::Setter;
+      mTrivialReference = readU2(bytes, 3);
+      mTrivialNeedsResolution = true;
+    }
+    return;
+  }
+
+  if (isValueReturn(opcodeAt(bytes.size() - 1))) {
+    if (auto constant = pushedConstant(bytes); constant.has_value()) {
+      mTrivialKind = TrivialMethodKind::Constant;
+      mTrivialConstant = *constant;
+    }
+  }
+}
+
+void JMethod::resolveTrivialShape()
+{
+  mTrivialNeedsResolution = false;
+
+  RuntimeConstantPool& runtimeConstantPool = mClass->runtimeConstantPool();
+  if (mTrivialKind == TrivialMethodKind::Empty) {
+    // A constructor calling its superclass constructor is only empty if the superclass constructor is
+    // If it cannot be resolved, the constructor is called normally and its 'invokespecial' throws the resolution error
+    auto superConstructor = runtimeConstantPool.resolveMethodRef(mTrivialReference);
+    if (!superConstructor || *superConstructor == this || (*superConstructor)->trivialKind() != TrivialMethodKind::Empty) {
+      mTrivialKind = TrivialMethodKind::None;
+    }
+    return;
+  }
+
+  JField* field = runtimeConstantPool.getFieldRef(mTrivialReference);
+  if (field == nullptr || field->isStatic()) {
+    mTrivialKind = TrivialMethodKind::None;
+    return;
+  }
+
+  mTrivialField = field;
 }
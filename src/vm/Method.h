@@ -3,14 +3,54 @@
 
 #include "class_file/ClassFile.h"
 #include "class_file/Descriptor.h"
+#include "vm/CompiledCode.h"
+#include "vm/ExceptionHandlerTable.h"
+#include "vm/InlineCache.h"
+#include "vm/Intrinsics.h"
+#include "vm/SwitchTable.h"
 #include "vm/StackMap.h"
 
+#include <cassert>
+#include <optional>
+#include <unordered_map>
 #include <utility>
 
 namespace geevm
 {
 class InstanceClass;
 class JClass;
+class JField;
+
+/// Bytecode shapes of methods that are simple enough to be executed at the call site, without creating a call frame.
+enum class TrivialMethodKind : uint8_t
+{
+  // An ordinary method
+  None,
+  // `return`, or a constructor only calling an empty superclass constructor (`aload_0; invokespecial; return`)
+  Empty,
+  // `aload_0; getfield; ?return`
+  Getter,
+  // `aload_0; ?load_1; putfield; return`
+  Setter,
+  // A single constant push (`?const_?`, `bipush` or `sipush`) followed by `?return`
+  Constant,
+};
+
+/// Number of times a conditional branch was taken and not taken.
+struct BranchProfile
+{
+  uint64_t taken = 0;
+  uint64_t notTaken = 0;
+
+  void record(bool isTaken)
+  {
+    if (isTaken) {
+      taken++;
+    } else {
+      notTaken++;
+    }
+  }
+};
 
 class JMethod
 {
@@ -27,6 +67,16 @@ public:
     return hasAccessFlag(mMethodInfo.accessFlags(), MethodAccessFlags::ACC_STATIC);
   }
 
+  bool isPrivate() const
+  {
+    return hasAccessFlag(mMethodInfo.accessFlags(), MethodAccessFlags::ACC_PRIVATE);
+  }
+
+  bool isFinal() const
+  {
+    return hasAccessFlag(mMethodInfo.accessFlags(), MethodAccessFlags::ACC_FINAL);
+  }
+
   bool isNative() const
   {
     return hasAccessFlag(mMethodInfo.accessFlags(), MethodAccessFlags::ACC_NATIVE);
@@ -52,6 +102,16 @@ public:
     return mMethodInfo.code();
   }
 
+  /// Returns the bytecode executed by the interpreter, in which frequent instruction sequences are fused into
+  /// superinstructions (see `fuseSuperinstructions`). The code is built when the method is first executed.
+  const types::u1* interpreterCode()
+  {
+    if (mInterpreterCode == nullptr) [[unlikely]] {
+      this->fuseInterpreterCode();
+    }
+    return mInterpreterCode;
+  }
+
   const types::JString& name() const
   {
     return mName;
@@ -72,12 +132,209 @@ public:
     return mClass;
   }
 
+  /// Returns the trivial bytecode shape of this method. The shape is classified when the method is created, the field
+  /// or superclass constructor it refers to is resolved on first use.
+  TrivialMethodKind trivialKind()
+  {
+    if (mTrivialNeedsResolution) [[unlikely]] {
+      this->resolveTrivialShape();
+    }
+    return mTrivialKind;
+  }
+
+  /// The field accessed by a getter or setter.
+  JField* trivialField() const
+  {
+    assert(mTrivialKind == TrivialMethodKind::Getter || mTrivialKind == TrivialMethodKind::Setter);
+    return mTrivialField;
+  }
+
+  /// The raw operand stack value pushed by a constant method.
+  uint64_t trivialConstant() const
+  {
+    assert(mTrivialKind == TrivialMethodKind::Constant);
+    return mTrivialConstant;
+  }
+
+  /// The C++ implementation that the interpreter executes instead of this method, nullptr if the method is not an
+  /// intrinsic. Intrinsics are attached when the class is prepared, see `findIntrinsic`.
+  IntrinsicHandler intrinsic() const
+  {
+    return mIntrinsic;
+  }
+
+  void setIntrinsic(IntrinsicHandler intrinsic)
+  {
+    mIntrinsic = intrinsic;
+  }
+
+  /// Returns true if a loaded subclass overrides this method, as recorded by `ClassHierarchy`.
+  bool isOverridden() const
+  {
+    return mIsOverridden;
+  }
+
+  void markOverridden()
+  {
+    mIsOverridden = true;
+  }
+
+  /// Execution counters used to find hot methods. Backward branches are counted as well, so that methods spending
+  /// their time in a few long-running loops are considered hot too.
+  uint32_t invocationCount() const
+  {
+    return mInvocationCount;
+  }
+
+  void countInvocation()
+  {
+    mInvocationCount++;
+  }
+
+  uint32_t backedgeCount() const
+  {
+    return mBackedgeCount;
+  }
+
+  void countBackedge()
+  {
+    mBackedgeCount++;
+  }
+
+  /// Address of the backward branch counter, which compiled code increments directly.
+  uint32_t* backedgeCounter()
+  {
+    return &mBackedgeCount;
+  }
+
+  /// Sets the execution counters to the values recorded by a previous run, so that the method is compiled as soon as
+  /// it is executed if it was hot.
+  void restoreCounters(uint32_t invocationCount, uint32_t backedgeCount)
+  {
+    mInvocationCount = invocationCount;
+    mBackedgeCount = backedgeCount;
+  }
+
+  /// Entry point of the machine code compiled for this method, nullptr if not compiled.
+  void* compiledCode() const
+  {
+    return mCompiledCode;
+  }
+
+  /// The tier that produced `compiledCode()`, `CompilationTier::Interpreter` if the method is not compiled.
+  CompilationTier compiledTier() const
+  {
+    return mCompiledTier;
+  }
+
+  void setCompiledCode(void* code, CompilationTier tier)
+  {
+    mCompiledCode = code;
+    mCompiledTier = tier;
+  }
+
+  /// Returns false if compiling this method with \p tier failed before, so that it is not attempted again.
+  bool isCompilable(CompilationTier tier) const
+  {
+    return (mNotCompilableTiers & tierBit(tier)) == 0;
+  }
+
+  void markNotCompilable(CompilationTier tier)
+  {
+    mNotCompilableTiers |= tierBit(tier);
+  }
+
+  /// Returns true if the code of this method was looked up in the AOT library already.
+  bool isAotLookupDone() const
+  {
+    return mIsAotLookupDone;
+  }
+
+  void markAotLookupDone()
+  {
+    mIsAotLookupDone = true;
+  }
+
+  /// Returns the on-stack replacement entry for the loop header at \p pc, creating an empty one on first use.
+  OsrEntry& osrEntry(int64_t pc)
+  {
+    return mOsrEntries[pc];
+  }
+
+  /// Returns the precomputed exception handler index of this method, building it on first use. Building the index
+  /// resolves the catch types of all handlers.
+  const ExceptionHandlerTable& exceptionHandlers();
+
+  /// Returns the decoded payload of the `tableswitch` or `lookupswitch` instruction at \p opcodePos, decoding it on
+  /// first use.
+  const SwitchTable& switchTable(int64_t opcodePos);
+
+  /// Returns the inline cache of the virtual or interface call site at \p opcodePos, creating an empty one on first
+  /// use.
+  InlineCache& inlineCache(int64_t opcodePos)
+  {
+    return mInlineCaches[opcodePos];
+  }
+
+  /// Inline caches of all call sites executed so far, indexed by bytecode offset.
+  const std::unordered_map<int64_t, InlineCache>& inlineCaches() const
+  {
+    return mInlineCaches;
+  }
+
+  /// Returns the profile of the conditional branch at \p opcodePos, creating an empty one on first use. Branches are
+  /// only profiled if profiles are persisted.
+  BranchProfile& branchProfile(int64_t opcodePos)
+  {
+    return mBranchProfiles[opcodePos];
+  }
+
+  /// Profiles of all conditional branches recorded so far, indexed by bytecode offset.
+  const std::unordered_map<int64_t, BranchProfile>& branchProfiles() const
+  {
+    return mBranchProfiles;
+  }
+
+private:
+  static uint8_t tierBit(CompilationTier tier)
+  {
+    return 1u << static_cast<uint8_t>(tier);
+  }
+
+  void classifyTrivialShape();
+  void resolveTrivialShape();
+  void fuseInterpreterCode();
+
 private:
   const MethodInfo& mMethodInfo;
   InstanceClass* mClass;
   types::JString mName;
   types::JString mRawDescriptor;
   MethodDescriptor mDescriptor;
+  bool mIsOverridden = false;
+  IntrinsicHandler mIntrinsic = nullptr;
+  // Trivial method shape
+  TrivialMethodKind mTrivialKind = TrivialMethodKind::None;
+  bool mTrivialNeedsResolution = false;
+  // Constant pool index of the accessed field or the called superclass constructor, until resolved
+  types::u2 mTrivialReference = 0;
+  JField* mTrivialField = nullptr;
+  uint64_t mTrivialConstant = 0;
+  // Interpreter code, pointing either into the original bytecode or to the copy with superinstructions
+  const types::u1* mInterpreterCode = nullptr;
+  std::vector<types::u1> mFusedCode;
+  // Profiling and compilation state
+  uint32_t mInvocationCount = 0;
+  uint32_t mBackedgeCount = 0;
+  void* mCompiledCode = nullptr;
+  CompilationTier mCompiledTier = CompilationTier::Interpreter;
+  uint8_t mNotCompilableTiers = 0;
+  bool mIsAotLookupDone = false;
+  std::unordered_map<int64_t, OsrEntry> mOsrEntries;
+  std::optional<ExceptionHandlerTable> mExceptionHandlers;
+  std::unordered_map<int64_t, SwitchTable> mSwitchTables;
+  std::unordered_map<int64_t, InlineCache> mInlineCaches;
+  std::unordered_map<int64_t, BranchProfile> mBranchProfiles;
 };
 
 } // namespace geevm
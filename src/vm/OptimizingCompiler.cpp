@@ -0,0 +1,664 @@
+#include "vm/OptimizingCompiler.h"
+#include "common/Debug.h"
+#include "vm/CompiledCode.h"
+#include "vm/Instance.h"
+#include "vm/LinearScan.h"
+#include "vm/Method.h"
+#include "vm/SsaBuilder.h"
+#include "vm/SsaGraph.h"
+#include "vm/SsaOptimizer.h"
+#include "vm/X86Assembler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <ranges>
+#include <unordered_map>
+
+using namespace geevm;
+
+namespace
+{
+
+// Same frame registers as baseline code, RAX, RCX and RDX are scratch registers that are never allocated
+constexpr Reg LocalsReg = Reg::RDI;
+constexpr Reg StackReg = Reg::RSI;
+
+constexpr int32_t SlotSize = sizeof(uint64_t);
+
+// Registers are numbered by their encoding in parallel moves, spill slots follow. RAX is never allocated, so it doubles
+// as the temporary that breaks cycles.
+constexpr int32_t SpillSlotKeys = 16;
+constexpr int32_t TemporaryKey = static_cast<int32_t>(Reg::RAX);
+
+Cond conditionCode(SsaCondition condition)
+{
+  switch (condition) {
+    case SsaCondition::Equal: return Cond::Equal;
+    case SsaCondition::NotEqual: return Cond::NotEqual;
+    case SsaCondition::Less: return Cond::Less;
+    case SsaCondition::GreaterEqual: return Cond::GreaterEqual;
+    case SsaCondition::Greater: return Cond::Greater;
+    case SsaCondition::LessEqual: return Cond::LessEqual;
+  }
+  GEEVM_UNREACHBLE("Unknown condition");
+}
+
+/// Emits machine code for an optimized and register-allocated graph.
+///
+/// Blocks are laid out in reverse postorder, so that most branches fall through to the next block. Failing checks and
+/// exits jump to out-of-line stubs that write their frame state back into the interpreter frame, and branches into
+/// blocks with phis jump to stubs that perform the phi moves of their edge.
+class CodeGenerator
+{
+public:
+  CodeGenerator(const SsaGraph& graph, const LinearScan& allocation)
+    : mGraph(graph), mAllocation(allocation), mBlockLabels(graph.blockCount())
+  {
+  }
+
+  void generate();
+
+  const std::vector<types::u1>& code() const
+  {
+    return mAssembler.code();
+  }
+
+private:
+  static Mem local(size_t index)
+  {
+    return Mem{.base = LocalsReg, .displacement = static_cast<int32_t>(index) * SlotSize};
+  }
+
+  static Mem slot(size_t index)
+  {
+    return Mem{.base = StackReg, .displacement = static_cast<int32_t>(index) * SlotSize};
+  }
+
+  static Mem spillSlot(uint32_t index)
+  {
+    return Mem{.base = Reg::RSP, .displacement = static_cast<int32_t>(index) * SlotSize};
+  }
+
+  int32_t frameSize() const
+  {
+    return static_cast<int32_t>(mAllocation.spillSlotCount()) * SlotSize;
+  }
+
+  void emitPrologue();
+  void emitEpilogue();
+
+  // Materializes \p value in \p dst
+  void load(Reg dst, SsaValue* value);
+  // Returns the register holding \p value, loading it into \p scratch if it is not kept in a register
+  Reg use(SsaValue* value, Reg scratch);
+  // Returns the register to compute \p value in, its own register or RAX if it is spilled
+  Reg resultRegister(const SsaValue* value) const;
+  // Moves the result of \p value computed in \p reg into its location
+  void commit(const SsaValue* value, Reg reg);
+
+  void emitInstruction(SsaBlock* block, SsaValue* value, const SsaBlock* next);
+  void emitDivision(SsaValue* value);
+  void emitArrayLoad(SsaValue* value);
+  void emitArrayStore(SsaValue* value);
+  void emitBranch(SsaBlock* block, SsaValue* branch, const SsaBlock* next);
+
+  int32_t locationKey(const SsaValue* value) const;
+  void emitMove(int32_t dst, int32_t src);
+  void emitPhiMoves(SsaBlock* from, SsaBlock* to);
+
+  X86Assembler::Label& exitLabel(const FrameState* frameState);
+  X86Assembler::Label& edgeLabel(SsaBlock* from, SsaBlock* to);
+  void emitExitStub(const FrameState& frameState);
+
+private:
+  struct ExitStub
+  {
+    X86Assembler::Label label;
+    const FrameState* frameState;
+  };
+
+  struct EdgeStub
+  {
+    X86Assembler::Label label;
+    SsaBlock* from;
+    SsaBlock* to;
+  };
+
+  const SsaGraph& mGraph;
+  const LinearScan& mAllocation;
+  X86Assembler mAssembler;
+  std::vector<X86Assembler::Label> mBlockLabels;
+  // Out-of-line code emitted after all blocks. Deques keep labels in place while jumps refer to them.
+  std::deque<ExitStub> mExitStubs;
+  std::unordered_map<const FrameState*, X86Assembler::Label*> mExitLabels;
+  std::deque<EdgeStub> mEdgeStubs;
+};
+
+void CodeGenerator::generate()
+{
+  this->emitPrologue();
+
+  const auto& blocks = mGraph.blocks();
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    SsaBlock* block = blocks[i];
+    const SsaBlock* next = i + 1 < blocks.size() ? blocks[i + 1] : nullptr;
+    mAssembler.bind(mBlockLabels[block->id]);
+    for (SsaValue* value : block->instructions) {
+      this->emitInstruction(block, value, next);
+    }
+  }
+
+  for (EdgeStub& stub : mEdgeStubs) {
+    mAssembler.bind(stub.label);
+    this->emitPhiMoves(stub.from, stub.to);
+    mAssembler.jmp(mBlockLabels[stub.to->id]);
+  }
+
+  for (ExitStub& stub : mExitStubs) {
+    mAssembler.bind(stub.label);
+    this->emitExitStub(*stub.frameState);
+  }
+}
+
+void CodeGenerator::emitPrologue()
+{
+  for (Reg reg : mAllocation.usedCalleeSavedRegisters()) {
+    mAssembler.push(reg);
+  }
+  if (this->frameSize() != 0) {
+    mAssembler.subImm64(Reg::RSP, this->frameSize());
+  }
+
+  for (const auto& [index, parameter] : mGraph.parameters()) {
+    const ValueLocation& location = mAllocation.location(parameter);
+    if (location.kind == ValueLocation::Kind::Register) {
+      mAssembler.mov64(location.reg, local(index));
+    } else if (location.kind == ValueLocation::Kind::Spilled) {
+      mAssembler.mov64(Reg::RAX, local(index));
+      mAssembler.mov64(spillSlot(location.spillSlot), Reg::RAX);
+    }
+  }
+}
+
+void CodeGenerator::emitEpilogue()
+{
+  if (this->frameSize() != 0) {
+    mAssembler.addImm64(Reg::RSP, this->frameSize());
+  }
+  for (Reg reg : mAllocation.usedCalleeSavedRegisters() | std::views::reverse) {
+    mAssembler.pop(reg);
+  }
+}
+
+void CodeGenerator::load(Reg dst, SsaValue* value)
+{
+  const ValueLocation& location = mAllocation.location(value);
+  switch (location.kind) {
+    case ValueLocation::Kind::Register:
+      if (location.reg != dst) {
+        mAssembler.mov64(dst, location.reg);
+      }
+      break;
+    case ValueLocation::Kind::Spilled: mAssembler.mov64(dst, spillSlot(location.spillSlot)); break;
+    case ValueLocation::Kind::None:
+      assert(value->isRematerializable());
+      if (value->immediate <= UINT32_MAX) {
+        mAssembler.movImm32(dst, static_cast<uint32_t>(value->immediate));
+      } else {
+        mAssembler.movImm64(dst, value->immediate);
+      }
+      break;
+  }
+}
+
+Reg CodeGenerator::use(SsaValue* value, Reg scratch)
+{
+  const ValueLocation& location = mAllocation.location(value);
+  if (location.kind == ValueLocation::Kind::Register) {
+    return location.reg;
+  }
+  this->load(scratch, value);
+  return scratch;
+}
+
+Reg CodeGenerator::resultRegister(const SsaValue* value) const
+{
+  const ValueLocation& location = mAllocation.location(value);
+  return location.kind == ValueLocation::Kind::Register ? location.reg : Reg::RAX;
+}
+
+void CodeGenerator::commit(const SsaValue* value, Reg reg)
+{
+  const ValueLocation& location = mAllocation.location(value);
+  if (location.kind == ValueLocation::Kind::Register && location.reg != reg) {
+    mAssembler.mov64(location.reg, reg);
+  } else if (location.kind == ValueLocation::Kind::Spilled) {
+    mAssembler.mov64(spillSlot(location.spillSlot), reg);
+  }
+}
+
+void CodeGenerator::emitInstruction(SsaBlock* block, SsaValue* value, const SsaBlock* next)
+{
+  using BinaryOp = void (X86Assembler::*)(Reg, Reg);
+  using UnaryOp = void (X86Assembler::*)(Reg);
+
+  auto binary = [&](BinaryOp op) {
+    Reg rhs = this->use(value->inputs[1], Reg::RCX);
+    Reg dst = this->resultRegister(value);
+    this->load(dst, value->inputs[0]);
+    (mAssembler.*op)(dst, rhs);
+    this->commit(value, dst);
+  };
+  auto shift = [&](UnaryOp op) {
+    this->load(Reg::RCX, value->inputs[1]);
+    Reg dst = this->resultRegister(value);
+    this->load(dst, value->inputs[0]);
+    (mAssembler.*op)(dst);
+    this->commit(value, dst);
+  };
+  auto unary = [&](UnaryOp op) {
+    Reg dst = this->resultRegister(value);
+    this->load(dst, value->inputs[0]);
+    (mAssembler.*op)(dst);
+    this->commit(value, dst);
+  };
+  auto convert = [&](BinaryOp op) {
+    Reg src = this->use(value->inputs[0], Reg::RCX);
+    Reg dst = this->resultRegister(value);
+    (mAssembler.*op)(dst, src);
+    this->commit(value, dst);
+  };
+
+  switch (value->opcode) {
+    using enum SsaOpcode;
+    case IAdd: binary(&X86Assembler::add32); break;
+    case ISub: binary(&X86Assembler::sub32); break;
+    case IMul: binary(&X86Assembler::imul32); break;
+    case IAnd: binary(&X86Assembler::and32); break;
+    case IOr: binary(&X86Assembler::or32); break;
+    case IXor: binary(&X86Assembler::xor32); break;
+    case IShl: shift(&X86Assembler::shl32); break;
+    case IShr: shift(&X86Assembler::sar32); break;
+    case IUShr: shift(&X86Assembler::shr32); break;
+    case INeg: unary(&X86Assembler::neg32); break;
+    case LAdd: binary(&X86Assembler::add64); break;
+    case LSub: binary(&X86Assembler::sub64); break;
+    case LMul: binary(&X86Assembler::imul64); break;
+    case LAnd: binary(&X86Assembler::and64); break;
+    case LOr: binary(&X86Assembler::or64); break;
+    case LXor: binary(&X86Assembler::xor64); break;
+    case LShl: shift(&X86Assembler::shl64); break;
+    case LShr: shift(&X86Assembler::sar64); break;
+    case LUShr: shift(&X86Assembler::shr64); break;
+    case LNeg: unary(&X86Assembler::neg64); break;
+    case IDiv:
+    case IRem:
+    case LDiv:
+    case LRem: this->emitDivision(value); break;
+    case I2L: convert(static_cast<BinaryOp>(&X86Assembler::movsxd)); break;
+    case L2I: convert(static_cast<BinaryOp>(&X86Assembler::mov32)); break;
+    case I2B: convert(static_cast<BinaryOp>(&X86Assembler::movsx8)); break;
+    case I2C: convert(static_cast<BinaryOp>(&X86Assembler::movzx16)); break;
+    case I2S: convert(static_cast<BinaryOp>(&X86Assembler::movsx16)); break;
+    case LCmp: {
+      Reg lhs = this->use(value->inputs[0], Reg::RCX);
+      Reg rhs = this->use(value->inputs[1], Reg::RDX);
+      mAssembler.cmp64(lhs, rhs);
+      mAssembler.setcc(Cond::Greater, Reg::RAX);
+      mAssembler.setcc(Cond::Less, Reg::RCX);
+      mAssembler.movzx8(Reg::RAX, Reg::RAX);
+      mAssembler.movzx8(Reg::RCX, Reg::RCX);
+      mAssembler.sub32(Reg::RAX, Reg::RCX);
+      this->commit(value, Reg::RAX);
+      break;
+    }
+    case ArrayLength: {
+      Reg array = this->use(value->inputs[0], Reg::RCX);
+      Reg dst = this->resultRegister(value);
+      mAssembler.mov32(dst, Mem{.base = array, .displacement = static_cast<int32_t>(ArrayInstance::lengthOffset())});
+      this->commit(value, dst);
+      break;
+    }
+    case ArrayLoad: this->emitArrayLoad(value); break;
+    case ArrayStore: this->emitArrayStore(value); break;
+    case NullCheck: {
+      Reg reg = this->use(value->inputs[0], Reg::RCX);
+      mAssembler.test64(reg, reg);
+      mAssembler.jcc(Cond::Equal, this->exitLabel(value->frameState));
+      break;
+    }
+    case BoundsCheck: {
+      // Negative indices are above the length as unsigned ints
+      Reg index = this->use(value->inputs[0], Reg::RCX);
+      Reg length = this->use(value->inputs[1], Reg::RDX);
+      mAssembler.cmp32(index, length);
+      mAssembler.jcc(Cond::AboveEqual, this->exitLabel(value->frameState));
+      break;
+    }
+    case ZeroCheck: {
+      Reg reg = this->use(value->inputs[0], Reg::RCX);
+      if (value->immediate != 0) {
+        mAssembler.test64(reg, reg);
+      } else {
+        mAssembler.test32(reg, reg);
+      }
+      mAssembler.jcc(Cond::Equal, this->exitLabel(value->frameState));
+      break;
+    }
+    case Goto: {
+      SsaBlock* target = block->successors[0];
+      this->emitPhiMoves(block, target);
+      if (target != next) {
+        mAssembler.jmp(mBlockLabels[target->id]);
+      }
+      break;
+    }
+    case Branch: this->emitBranch(block, value, next); break;
+    case Exit: mAssembler.jmp(this->exitLabel(value->frameState)); break;
+    default: GEEVM_UNREACHBLE("Value is not an instruction");
+  }
+}
+
+void CodeGenerator::emitDivision(SsaValue* value)
+{
+  bool isLong = value->opcode == SsaOpcode::LDiv || value->opcode == SsaOpcode::LRem;
+  bool isRemainder = value->opcode == SsaOpcode::IRem || value->opcode == SsaOpcode::LRem;
+
+  // The divisor was checked against zero before
+  this->load(Reg::RAX, value->inputs[0]);
+  Reg divisor = this->use(value->inputs[1], Reg::RCX);
+
+  X86Assembler::Label minusOne;
+  X86Assembler::Label done;
+
+  // Dividing the minimum value by -1 overflows, which traps on x86 but wraps around in Java
+  if (isLong) {
+    mAssembler.cmpImm64(divisor, -1);
+  } else {
+    mAssembler.cmpImm32(divisor, -1);
+  }
+  mAssembler.jcc(Cond::Equal, minusOne);
+
+  if (isLong) {
+    mAssembler.cqo();
+    mAssembler.idiv64(divisor);
+  } else {
+    mAssembler.cdq();
+    mAssembler.idiv32(divisor);
+  }
+  if (isRemainder) {
+    mAssembler.mov64(Reg::RAX, Reg::RDX);
+  }
+  mAssembler.jmp(done);
+
+  mAssembler.bind(minusOne);
+  if (isRemainder) {
+    mAssembler.xor32(Reg::RAX, Reg::RAX);
+  } else if (isLong) {
+    mAssembler.neg64(Reg::RAX);
+  } else {
+    mAssembler.neg32(Reg::RAX);
+  }
+
+  mAssembler.bind(done);
+  this->commit(value, Reg::RAX);
+}
+
+void CodeGenerator::emitArrayLoad(SsaValue* value)
+{
+  Reg array = this->use(value->inputs[0], Reg::RCX);
+  Reg index = this->use(value->inputs[1], Reg::RDX);
+  Reg dst = this->resultRegister(value);
+  auto element = [&](uint8_t size) {
+    return Mem{.base = array, .index = index, .scale = size, .displacement = static_cast<int32_t>(ArrayInstance::elementsOffset())};
+  };
+
+  switch (static_cast<ArrayElementKind>(value->immediate)) {
+    case ArrayElementKind::Int: mAssembler.mov32(dst, element(4)); break;
+    case ArrayElementKind::Long: mAssembler.mov64(dst, element(8)); break;
+    case ArrayElementKind::Byte: mAssembler.movsx8(dst, element(1)); break;
+    case ArrayElementKind::Char: mAssembler.movzx16(dst, element(2)); break;
+    case ArrayElementKind::Short: mAssembler.movsx16(dst, element(2)); break;
+  }
+  this->commit(value, dst);
+}
+
+void CodeGenerator::emitArrayStore(SsaValue* value)
+{
+  Reg array = this->use(value->inputs[0], Reg::RCX);
+  Reg index = this->use(value->inputs[1], Reg::RDX);
+  Reg stored = this->use(value->inputs[2], Reg::RAX);
+  auto element = [&](uint8_t size) {
+    return Mem{.base = array, .index = index, .scale = size, .displacement = static_cast<int32_t>(ArrayInstance::elementsOffset())};
+  };
+
+  switch (static_cast<ArrayElementKind>(value->immediate)) {
+    case ArrayElementKind::Int: mAssembler.mov32(element(4), stored); break;
+    case ArrayElementKind::Long: mAssembler.mov64(element(8), stored); break;
+    case ArrayElementKind::Byte: mAssembler.mov8(element(1), stored); break;
+    case ArrayElementKind::Char:
+    case ArrayElementKind::Short: mAssembler.mov16(element(2), stored); break;
+  }
+}
+
+void CodeGenerator::emitBranch(SsaBlock* block, SsaValue* branch, const SsaBlock* next)
+{
+  bool isWide = branch->isWideComparison();
+  SsaValue* rhs = branch->inputs[1];
+  Reg lhs = this->use(branch->inputs[0], Reg::RCX);
+
+  // Compare against small constants directly
+  auto immediate = static_cast<int64_t>(isWide ? rhs->immediate : static_cast<int32_t>(rhs->immediate));
+  if (rhs->opcode == SsaOpcode::Constant && immediate >= INT32_MIN && immediate <= INT32_MAX) {
+    if (isWide) {
+      mAssembler.cmpImm64(lhs, static_cast<int32_t>(immediate));
+    } else {
+      mAssembler.cmpImm32(lhs, static_cast<int32_t>(immediate));
+    }
+  } else {
+    Reg rhsReg = this->use(rhs, Reg::RDX);
+    if (isWide) {
+      mAssembler.cmp64(lhs, rhsReg);
+    } else {
+      mAssembler.cmp32(lhs, rhsReg);
+    }
+  }
+
+  Cond cond = conditionCode(branch->condition());
+  SsaBlock* taken = block->successors[0];
+  SsaBlock* notTaken = block->successors[1];
+  if (taken == next && taken->phis.empty() && notTaken->phis.empty()) {
+    mAssembler.jcc(negate(cond), mBlockLabels[notTaken->id]);
+    return;
+  }
+
+  mAssembler.jcc(cond, taken->phis.empty() ? mBlockLabels[taken->id] : this->edgeLabel(block, taken));
+  this->emitPhiMoves(block, notTaken);
+  if (notTaken != next) {
+    mAssembler.jmp(mBlockLabels[notTaken->id]);
+  }
+}
+
+int32_t CodeGenerator::locationKey(const SsaValue* value) const
+{
+  const ValueLocation& location = mAllocation.location(value);
+  assert(location.kind != ValueLocation::Kind::None);
+  if (location.kind == ValueLocation::Kind::Register) {
+    return static_cast<int32_t>(location.reg);
+  }
+  return SpillSlotKeys + static_cast<int32_t>(location.spillSlot);
+}
+
+void CodeGenerator::emitMove(int32_t dst, int32_t src)
+{
+  bool isDstRegister = dst < SpillSlotKeys;
+  bool isSrcRegister = src < SpillSlotKeys;
+  auto dstReg = static_cast<Reg>(dst);
+  auto srcReg = static_cast<Reg>(src);
+  Mem dstSlot = spillSlot(dst - SpillSlotKeys);
+  Mem srcSlot = spillSlot(src - SpillSlotKeys);
+
+  if (isDstRegister && isSrcRegister) {
+    mAssembler.mov64(dstReg, srcReg);
+  } else if (isDstRegister) {
+    mAssembler.mov64(dstReg, srcSlot);
+  } else if (isSrcRegister) {
+    mAssembler.mov64(dstSlot, srcReg);
+  } else {
+    mAssembler.mov64(Reg::RCX, srcSlot);
+    mAssembler.mov64(dstSlot, Reg::RCX);
+  }
+}
+
+void CodeGenerator::emitPhiMoves(SsaBlock* from, SsaBlock* to)
+{
+  struct Move
+  {
+    int32_t dst;
+    int32_t src;
+  };
+
+  // The moves into all phis of the edge happen at the same time, as phis may read each other's old values
+  size_t index = to->predecessorIndex(from);
+  std::vector<Move> pending;
+  std::vector<SsaValue*> rematerialized;
+  for (SsaValue* phi : to->phis) {
+    SsaValue* input = phi->inputs[index];
+    if (input->isRematerializable()) {
+      rematerialized.push_back(phi);
+    } else if (this->locationKey(phi) != this->locationKey(input)) {
+      pending.push_back(Move{.dst = this->locationKey(phi), .src = this->locationKey(input)});
+    }
+  }
+
+  while (!pending.empty()) {
+    auto ready = std::ranges::find_if(pending, [&](const Move& move) {
+      return std::ranges::none_of(pending, [&](const Move& other) {
+        return other.src == move.dst;
+      });
+    });
+    if (ready != pending.end()) {
+      this->emitMove(ready->dst, ready->src);
+      pending.erase(ready);
+      continue;
+    }
+
+    // The remaining moves form cycles, one is broken by saving a destination in the temporary
+    int32_t saved = pending.front().dst;
+    this->emitMove(TemporaryKey, saved);
+    for (Move& move : pending) {
+      if (move.src == saved) {
+        move.src = TemporaryKey;
+      }
+    }
+  }
+
+  // Constants do not occupy a location, so they can be written last
+  for (SsaValue* phi : rematerialized) {
+    Reg dst = this->resultRegister(phi);
+    this->load(dst, phi->inputs[index]);
+    this->commit(phi, dst);
+  }
+}
+
+X86Assembler::Label& CodeGenerator::exitLabel(const FrameState* frameState)
+{
+  auto [it, inserted] = mExitLabels.try_emplace(frameState, nullptr);
+  if (inserted) {
+    it->second = &mExitStubs.emplace_back(ExitStub{.label = {}, .frameState = frameState}).label;
+  }
+  return *it->second;
+}
+
+X86Assembler::Label& CodeGenerator::edgeLabel(SsaBlock* from, SsaBlock* to)
+{
+  return mEdgeStubs.emplace_back(EdgeStub{.label = {}, .from = from, .to = to}).label;
+}
+
+void CodeGenerator::emitExitStub(const FrameState& frameState)
+{
+  // Compiled code never writes the interpreter frame before an exit, so parameters are still in their own slot
+  auto isUnchanged = [](const SsaValue* value, size_t localIndex) {
+    return value->opcode == SsaOpcode::Undefined || (value->opcode == SsaOpcode::Parameter && value->immediate == localIndex);
+  };
+
+  for (size_t i = 0; i < frameState.locals.size(); ++i) {
+    SsaValue* value = frameState.locals[i];
+    if (!isUnchanged(value, i)) {
+      mAssembler.mov64(local(i), this->use(value, Reg::RAX));
+    }
+  }
+  for (size_t i = 0; i < frameState.stack.size(); ++i) {
+    SsaValue* value = frameState.stack[i];
+    if (value->opcode != SsaOpcode::Undefined) {
+      mAssembler.mov64(slot(i), this->use(value, Reg::RAX));
+    }
+  }
+
+  mAssembler.movImm32(Reg::RAX, compiledCodeExitState(frameState.pc, static_cast<int32_t>(frameState.stack.size())));
+  this->emitEpilogue();
+  mAssembler.ret();
+}
+
+} // namespace
+
+OptimizingCompiler::OptimizingCompiler(CodeCache& codeCache, [[maybe_unused]] bool useLlvm)
+  : mCodeCache(codeCache)
+{
+#ifdef GEEVM_ENABLE_LLVM
+  if (useLlvm) {
+    mLlvmBackend = LlvmBackend::create();
+  }
+#endif
+}
+
+void* OptimizingCompiler::generate(JMethod& method, int64_t entryPc)
+{
+  assert(!method.isNative() && !method.isAbstract());
+
+  SsaGraph graph;
+  if (!buildSsaGraph(method, graph, entryPc)) {
+    return nullptr;
+  }
+
+  optimizeSsaGraph(graph);
+#ifdef GEEVM_ENABLE_LLVM
+  if (mLlvmBackend != nullptr) {
+    return mLlvmBackend->compile(graph);
+  }
+#endif
+
+  LinearScan allocation(graph);
+  CodeGenerator generator(graph, allocation);
+  generator.generate();
+  return mCodeCache.install(generator.code());
+}
+
+void* OptimizingCompiler::compile(JMethod& method)
+{
+  void* code = this->generate(method, 0);
+  if (code == nullptr) {
+    method.markNotCompilable(CompilationTier::Optimized);
+  } else {
+    method.setCompiledCode(code, CompilationTier::Optimized);
+  }
+
+  return code;
+}
+
+void* OptimizingCompiler::compileOsr(JMethod& method, int64_t pc, int32_t depth)
+{
+  // Values on the operand stack would need parameters of their own
+  void* code = depth == 0 ? this->generate(method, pc) : nullptr;
+
+  OsrEntry& entry = method.osrEntry(pc);
+  if (code == nullptr) {
+    entry.markNotCompilable(CompilationTier::Optimized);
+  } else {
+    entry.code = code;
+    entry.tier = CompilationTier::Optimized;
+  }
+
+  return code;
+}
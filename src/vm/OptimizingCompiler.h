@@ -0,0 +1,61 @@
+#ifndef GEEVM_VM_OPTIMIZINGCOMPILER_H
+#define GEEVM_VM_OPTIMIZINGCOMPILER_H
+
+#include "vm/CodeCache.h"
+
+#include <cstdint>
+
+#ifdef GEEVM_ENABLE_LLVM
+#include "vm/LlvmBackend.h"
+
+#include <memory>
+#endif
+
+namespace geevm
+{
+
+class JMethod;
+
+/// Second-tier compiler for methods that stay hot after baseline compilation.
+///
+/// The bytecode is translated into an SSA graph (see `buildSsaGraph`), which inlines small static callees, and then
+/// optimized with constant folding, global value numbering, null and bounds check elimination and loop-invariant code
+/// motion (see `optimizeSsaGraph`). Values are kept in registers assigned by linear scan allocation instead of the
+/// interpreter frame.
+///
+/// Optimized code follows the same contract as baseline code: it covers the same instructions, and leaves to the
+/// interpreter at unsupported instructions, returns and failing runtime checks. Every exit first writes the values of
+/// its frame state back into the local variables and operand stack of the interpreter frame, so the interpreter can
+/// continue as if it had executed the method up to that point itself.
+///
+/// In builds with `GEEVM_ENABLE_LLVM`, the optimized graph can be compiled by LLVM instead (see `LlvmBackend`).
+class OptimizingCompiler
+{
+public:
+  /// Generates code with LLVM if \p useLlvm is set and LLVM is available, and by linear scan allocation otherwise.
+  OptimizingCompiler(CodeCache& codeCache, bool useLlvm);
+
+  /// Compiles \p method and installs the code into the method, replacing its baseline code. If the method cannot be
+  /// compiled, or the code cache is full, the method is marked as not compilable by this tier and nullptr is returned.
+  void* compile(JMethod& method);
+
+  /// Compiles an OSR entry of \p method for the loop header at \p pc, where the interpreter has \p depth values on
+  /// the operand stack, and installs it into the OSR entries of the method. Only loop headers with an empty operand
+  /// stack are supported. If the entry cannot be compiled, the loop header is marked as not compilable by this tier
+  /// and nullptr is returned.
+  void* compileOsr(JMethod& method, int64_t pc, int32_t depth);
+
+private:
+  // Returns the installed code entered at \p entryPc, or nullptr on failure
+  void* generate(JMethod& method, int64_t entryPc);
+
+private:
+  CodeCache& mCodeCache;
+#ifdef GEEVM_ENABLE_LLVM
+  std::unique_ptr<LlvmBackend> mLlvmBackend;
+#endif
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_OPTIMIZINGCOMPILER_H
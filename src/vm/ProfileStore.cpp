@@ -0,0 +1,156 @@
+#include "vm/ProfileStore.h"
+#include "common/Encoding.h"
+#include "vm/Class.h"
+#include "vm/Method.h"
+#include "vm/Vm.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <sstream>
+
+using namespace geevm;
+
+namespace
+{
+
+constexpr std::string_view ProfileHeader = "geevm-profile 1";
+
+// Counters restored from a profile are capped, so that the counts added by further runs cannot overflow them
+constexpr uint32_t MaxRestoredCount = 1u << 30;
+
+} // namespace
+
+ProfileStore ProfileStore::load(const std::string& path)
+{
+  ProfileStore store;
+
+  std::ifstream in(path);
+  std::string line;
+  if (!in || !std::getline(in, line) || line != ProfileHeader) {
+    return store;
+  }
+
+  ClassProfile* currentClass = nullptr;
+  MethodProfile* currentMethod = nullptr;
+  while (std::getline(in, line)) {
+    std::istringstream record(line);
+    std::string kind;
+    record >> kind;
+
+    if (kind == "class") {
+      std::string name;
+      uint64_t hash;
+      if (!(record >> name >> std::hex >> hash)) {
+        return ProfileStore{};
+      }
+      currentClass = &store.mClasses[utf8ToUtf16(name)];
+      currentClass->classFileHash = hash;
+      currentMethod = nullptr;
+    } else if (kind == "method" && currentClass != nullptr) {
+      std::string name;
+      std::string descriptor;
+      MethodProfile profile;
+      if (!(record >> name >> descriptor >> profile.invocationCount >> profile.backedgeCount)) {
+        return ProfileStore{};
+      }
+      currentMethod = &currentClass->methods[NameAndDescriptor{utf8ToUtf16(name), utf8ToUtf16(descriptor)}];
+      *currentMethod = std::move(profile);
+    } else if (kind == "branch" && currentMethod != nullptr) {
+      BranchRecord branch;
+      if (!(record >> branch.opcodePos >> branch.taken >> branch.notTaken)) {
+        return ProfileStore{};
+      }
+      currentMethod->branches.push_back(branch);
+    } else if (kind == "receiver" && currentMethod != nullptr) {
+      int64_t callSite;
+      std::string className;
+      uint64_t count;
+      if (!(record >> callSite >> className >> count)) {
+        return ProfileStore{};
+      }
+      currentMethod->receivers.push_back(ReceiverRecord{.callSite = callSite, .className = utf8ToUtf16(className), .count = count});
+    } else {
+      return ProfileStore{};
+    }
+  }
+
+  return store;
+}
+
+bool ProfileStore::save(Vm& vm, const std::string& path)
+{
+  std::ofstream out(path, std::ios::trunc);
+  if (!out) {
+    return false;
+  }
+
+  out << ProfileHeader << "\n";
+  for (const auto& [className, klass] : vm.bootstrapClassLoader().loadedClasses()) {
+    InstanceClass* instanceClass = klass->asInstanceClass();
+    if (instanceClass == nullptr) {
+      continue;
+    }
+
+    bool hasClassRecord = false;
+    for (const auto& [nameAndDescriptor, method] : instanceClass->methods()) {
+      if (method->invocationCount() == 0 && method->backedgeCount() == 0) {
+        continue;
+      }
+
+      if (!hasClassRecord) {
+        out << std::format("class {} {:x}\n", utf16ToUtf8(className), instanceClass->classFileHash());
+        hasClassRecord = true;
+      }
+
+      out << std::format("method {} {} {} {}\n", utf16ToUtf8(nameAndDescriptor.first), utf16ToUtf8(nameAndDescriptor.second), method->invocationCount(),
+                         method->backedgeCount());
+      for (const auto& [opcodePos, branch] : method->branchProfiles()) {
+        out << std::format("branch {} {} {}\n", opcodePos, branch.taken, branch.notTaken);
+      }
+      for (const auto& [callSite, cache] : method->inlineCaches()) {
+        for (const InlineCache::Entry& entry : cache.entries()) {
+          out << std::format("receiver {} {} {}\n", callSite, utf16ToUtf8(entry.receiverClass->className()), entry.count);
+        }
+      }
+    }
+  }
+
+  out.flush();
+  return static_cast<bool>(out);
+}
+
+void ProfileStore::apply(InstanceClass& klass) const
+{
+  auto it = mClasses.find(klass.className());
+  if (it == mClasses.end() || it->second.classFileHash != klass.classFileHash()) {
+    return;
+  }
+
+  for (const auto& [nameAndDescriptor, profile] : it->second.methods) {
+    auto method = klass.methods().find(nameAndDescriptor);
+    if (method == klass.methods().end()) {
+      continue;
+    }
+
+    method->second->restoreCounters(std::min(profile.invocationCount, MaxRestoredCount), std::min(profile.backedgeCount, MaxRestoredCount));
+    for (const BranchRecord& branch : profile.branches) {
+      BranchProfile& branchProfile = method->second->branchProfile(branch.opcodePos);
+      branchProfile.taken = branch.taken;
+      branchProfile.notTaken = branch.notTaken;
+    }
+  }
+}
+
+void ProfileStore::preloadClasses(Vm& vm) const
+{
+  // Load failures are ignored here, the program reports them once it actually uses the class
+  for (const auto& [className, profile] : mClasses) {
+    static_cast<void>(vm.resolveClass(className));
+    for (const auto& [_, method] : profile.methods) {
+      for (const ReceiverRecord& receiver : method.receivers) {
+        static_cast<void>(vm.resolveClass(receiver.className));
+      }
+    }
+  }
+}
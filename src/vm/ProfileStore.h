@@ -0,0 +1,94 @@
+#ifndef GEEVM_VM_PROFILESTORE_H
+#define GEEVM_VM_PROFILESTORE_H
+
+#include "common/Hash.h"
+#include "common/JvmTypes.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace geevm
+{
+
+class InstanceClass;
+class Vm;
+
+/// Execution profiles of methods, persisted across runs of the VM (`-XX:ProfileFile`).
+///
+/// At exit, the invocation and backward branch counters, the branch profiles and the receiver classes seen by the
+/// inline caches of all executed methods are written to a text file. The next run reads the file and restores the
+/// counters and branch profiles whenever a class is loaded, so methods that were hot are compiled on their first
+/// execution instead of after warming up in the interpreter. Profiles are keyed by the class name, the method name and
+/// descriptor and a hash of the class file, and are discarded for classes whose class file changed.
+///
+/// The file consists of one record per line:
+///
+///   geevm-profile <version>
+///   class <class name> <class file hash>
+///   method <name> <descriptor> <invocations> <backedges>
+///   branch <bytecode offset> <taken> <not taken>
+///   receiver <bytecode offset> <class name> <count>
+///
+/// `method` records belong to the preceding `class` record, `branch` and `receiver` records to the preceding `method`
+/// record. Names are written in UTF-8.
+class ProfileStore
+{
+public:
+  struct BranchRecord
+  {
+    int64_t opcodePos;
+    uint64_t taken;
+    uint64_t notTaken;
+  };
+
+  struct ReceiverRecord
+  {
+    int64_t callSite;
+    types::JString className;
+    uint64_t count;
+  };
+
+  struct MethodProfile
+  {
+    uint32_t invocationCount = 0;
+    uint32_t backedgeCount = 0;
+    std::vector<BranchRecord> branches;
+    std::vector<ReceiverRecord> receivers;
+  };
+
+  struct ClassProfile
+  {
+    uint64_t classFileHash = 0;
+    std::unordered_map<NameAndDescriptor, MethodProfile, PairHash> methods;
+  };
+
+  /// Reads the profiles written by a previous run from \p path. A missing or malformed file results in an empty store,
+  /// as the profile is only a hint.
+  static ProfileStore load(const std::string& path);
+
+  /// Writes the profiles of all executed methods of the classes loaded by \p vm to \p path. Returns false if the file
+  /// cannot be written.
+  static bool save(Vm& vm, const std::string& path);
+
+  /// Restores the recorded counters and branch profiles of the methods of \p klass, if its class file did not change
+  /// since the profile was recorded.
+  void apply(InstanceClass& klass) const;
+
+  /// Loads the classes of all profiled methods and their receiver classes ahead of time, so that loading and parsing
+  /// them does not interrupt the program once it is running. Classes that cannot be loaded are skipped.
+  void preloadClasses(Vm& vm) const;
+
+  size_t size() const
+  {
+    return mClasses.size();
+  }
+
+private:
+  std::unordered_map<types::JString, ClassProfile> mClasses;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_PROFILESTORE_H
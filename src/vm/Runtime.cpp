@@ -7,6 +7,16 @@
 using namespace geevm;
 
 JMethod* RuntimeConstantPool::getMethodRef(types::u2 index)
+{
+  auto method = this->resolveMethodRef(index);
+  if (!method) {
+    geevm_panic("getMethodRef: method resolution failure");
+  }
+
+  return *method;
+}
+
+JvmExpected<JMethod*> RuntimeConstantPool::resolveMethodRef(types::u2 index)
 {
   if (auto it = mMethodRefs.find(index); it != mMethodRefs.end()) {
     return it->second;
@@ -21,20 +31,34 @@ JMethod* RuntimeConstantPool::getMethodRef(types::u2 index)
 
   auto klass = mBootstrapClassLoader.loadClass(className);
   if (!klass) {
-    // TODO: class resolution failure in getMethodRef
-    geevm_panic("getMethodRef: class resolution failure");
+    return std::unexpected(klass.error());
   }
 
   auto method = (*klass)->getVirtualMethod(types::JString{methodName}, types::JString{descriptor});
   if (!method.has_value()) {
-    // TODO: method not found in getMethodRef
-    geevm_panic("getMethodRef: method resolution failure");
+    return makeError<JMethod*>(u"java/lang/NoSuchMethodError", className + u"." + types::JString{methodName} + types::JString{descriptor});
   }
 
   auto [it, _] = mMethodRefs.try_emplace(index, *method);
   return it->second;
 }
 
+MethodDescriptor RuntimeConstantPool::methodRefDescriptor(types::u2 index) const
+{
+  auto& entry = mConstantPool.getEntry(index);
+  auto [_, descriptor] = mConstantPool.getNameAndType(entry.data.classAndNameRef.nameAndTypeIndex);
+  auto parsed = MethodDescriptor::parse(descriptor);
+  assert(parsed.has_value() && "Method descriptors are checked when the class is loaded");
+
+  return std::move(*parsed);
+}
+
+JMethod* RuntimeConstantPool::resolvedMethodRef(types::u2 index) const
+{
+  auto it = mMethodRefs.find(index);
+  return it != mMethodRefs.end() ? it->second : nullptr;
+}
+
 JField* RuntimeConstantPool::getFieldRef(types::u2 index)
 {
   if (auto it = mFieldRefs.find(index); it != mFieldRefs.end()) {
@@ -85,3 +109,30 @@ JvmExpected<JClass*> RuntimeConstantPool::getClass(types::u2 index)
   auto [res, _] = mClasses.try_emplace(index, *klass);
   return res->second;
 }
+
+JvmExpected<ArrayClass*> RuntimeConstantPool::getArrayClass(types::u2 index)
+{
+  if (auto it = mArrayClasses.find(index); it != mArrayClasses.end()) {
+    return it->second;
+  }
+
+  auto componentClass = this->getClass(index);
+  if (!componentClass) {
+    return std::unexpected(componentClass.error());
+  }
+
+  types::JString arrayClassName;
+  if ((*componentClass)->isArrayType()) {
+    arrayClassName = u"[" + (*componentClass)->className();
+  } else {
+    arrayClassName = u"[L" + (*componentClass)->className() + u";";
+  }
+
+  auto arrayClass = mBootstrapClassLoader.loadClass(arrayClassName);
+  if (!arrayClass) {
+    return std::unexpected(arrayClass.error());
+  }
+
+  auto [res, _] = mArrayClasses.try_emplace(index, (*arrayClass)->asArrayClass());
+  return res->second;
+}
@@ -2,6 +2,7 @@
 #define GEEVM_RUNTIME_H
 
 #include "class_file/ConstantPool.h"
+#include "class_file/Descriptor.h"
 #include "vm/GarbageCollector.h"
 
 #include <common/JvmError.h>
@@ -16,6 +17,7 @@ class FieldRef;
 class JField;
 class Instance;
 class JClass;
+class ArrayClass;
 class JavaHeap;
 class BootstrapClassLoader;
 
@@ -29,10 +31,27 @@ public:
 
   GcRootRef<Instance> getString(types::u2 index);
 
+  /// Resolves the method at \p index. Aborts the VM if the method cannot be resolved, use `resolveMethodRef` where
+  /// resolution may fail.
   JMethod* getMethodRef(types::u2 index);
+
+  /// Resolves the method at \p index, returning a `NoClassDefFoundError` or `NoSuchMethodError` if its class cannot be
+  /// loaded or has no such method.
+  JvmExpected<JMethod*> resolveMethodRef(types::u2 index);
+
+  /// Returns the descriptor of the method referenced at \p index. Never loads classes, so that code analyses can look
+  /// at calls whose target does not resolve.
+  MethodDescriptor methodRefDescriptor(types::u2 index) const;
+
+  /// Returns the method at \p index if it was resolved before, nullptr otherwise. Never loads classes.
+  JMethod* resolvedMethodRef(types::u2 index) const;
+
   JField* getFieldRef(types::u2 index);
   JvmExpected<JClass*> getClass(types::u2 index);
 
+  /// Returns the array class whose component type is the class at \p index, as used by `anewarray`.
+  JvmExpected<ArrayClass*> getArrayClass(types::u2 index);
+
   types::JStringRef getUtf8(types::u2 index);
 
 private:
@@ -40,6 +59,7 @@ private:
   std::unordered_map<types::u2, JField*> mFieldRefs;
   std::unordered_map<types::u2, GcRootRef<>> mStrings;
   std::unordered_map<types::u2, JClass*> mClasses;
+  std::unordered_map<types::u2, ArrayClass*> mArrayClasses;
 
   const ConstantPool& mConstantPool;
   JavaHeap& mHeap;
@@ -0,0 +1,237 @@
+#include "vm/SemiSpaceCollector.h"
+
+#include "common/Debug.h"
+#include "common/JvmError.h"
+#include "common/Memory.h"
+#include "vm/Class.h"
+#include "vm/GcRoots.h"
+#include "vm/Vm.h"
+
+#include <cstring>
+
+using namespace geevm;
+
+SemiSpaceCollector::SemiSpaceCollector(Vm& vm)
+  : GarbageCollector(vm), mHeapSize(vm.settings().maxHeapSize), mRunAfterEveryAllocation(vm.settings().runGcAfterEveryAllocation)
+{
+  mFromRegion = CompressedOops::allocateHeapMemory(mHeapSize / 2);
+  mToRegion = CompressedOops::allocateHeapMemory(mHeapSize / 2);
+  mBumpPtr = mFromRegion;
+
+  ASAN_POISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
+}
+
+void* SemiSpaceCollector::allocate(size_t size)
+{
+  size_t adjustedSize = alignTo(size, ObjectAlignment);
+
+  const char* end = mFromRegion + mHeapSize / 2;
+  if (mBumpPtr + adjustedSize > end) {
+    // The 'from' region is full, let's do GC
+    this->performGarbageCollection(GcCause::AllocationFailure);
+    const char* end2 = mFromRegion + mHeapSize / 2;
+    if (mBumpPtr + adjustedSize > end2) {
+      // The caller throws an OutOfMemoryError
+      return nullptr;
+    }
+  } else if (mRunAfterEveryAllocation) {
+    this->performGarbageCollection(GcCause::AllocationStress);
+  }
+
+  mTotalBytesAllocated += adjustedSize;
+  return this->allocateUnchecked(size);
+}
+
+void* SemiSpaceCollector::allocateUnchecked(size_t size)
+{
+  void* current = mBumpPtr;
+
+  size_t adjustedSize = alignTo(size, ObjectAlignment);
+  mBumpPtr += adjustedSize;
+
+  return current;
+}
+
+Instance* SemiSpaceCollector::copyObject(Instance* instance, std::unordered_map<Instance*, Instance*>& map)
+{
+  if (instance == nullptr) {
+    // No need to copy null
+    return nullptr;
+  }
+
+  if (!this->isInEvacuatedRegion(instance)) {
+    // Objects outside the collected region (e.g. in the immortal region) are never moved
+    return instance;
+  }
+
+  if (auto it = map.find(instance); it != map.end()) {
+    // This has already been copied
+    return it->second;
+  }
+
+  std::size_t size = objectSize(instance);
+
+  void* mem = this->allocateUnchecked(size);
+  // Note that the copy here is safe only if the type copied is trivially copiable.
+  // This is the case for Instance and its subclasses (see the static asserts in Instance.h)
+  std::memcpy(mem, instance, size);
+  auto* copy = static_cast<Instance*>(mem);
+  copy->getHeader().incrementAge();
+  map.insert({instance, copy});
+
+  return copy;
+}
+
+bool SemiSpaceCollector::collect(GcEvent& event)
+{
+  event.heapUsedBefore = mBumpPtr - mFromRegion;
+  event.heapCapacity = mHeapSize / 2;
+
+  ASAN_UNPOISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
+  std::swap(mFromRegion, mToRegion);
+  mBumpPtr = mFromRegion;
+
+  // The actual implementation here follows Cheney's algorithm (https://en.wikipedia.org/wiki/Cheney%27s_algorithm),
+  // The main steps are:
+  //  1. Collect and shallow copy all GC roots to the new region,
+  //  2. For each copied object on the new region, shallow copy their immediately reachable objects (i.e. object fields and
+  //     array elements) until there are no more new objects on the new region.
+  // Already copied objects are iterated using 'scanPtr': after processing an object, the pointer is advanced by the object's size.
+  std::unordered_map<Instance*, Instance*> map;
+  char* scanPtr = mFromRegion;
+
+  // Process manually pinned roots.
+  // Note that this list contains JNI references, but not class mirrors, interned strings and thread instances,
+  // which live in the immortal region.
+  for (auto& root : mRootList) {
+    Instance* copy = this->copyObject(root, map);
+    root = copy;
+    event.roots.pinned += root != nullptr;
+  }
+
+  // Objects in the immortal region are not relocated, but they may refer to objects in the collected region.
+  for (Instance* instance : this->immortalObjects()) {
+    this->processReferences(instance, map);
+    event.roots.immortal++;
+  }
+
+  // Process static fields in classes
+  for (const auto& [_, klass] : mVm.bootstrapClassLoader().loadedClasses()) {
+    for (auto& [_, field] : klass->fields()) {
+      if (field->isStatic() && field->fieldType().isReferenceOrArray()) {
+        auto* instance = klass->getStaticFieldValue<Instance*>(field->offset());
+        auto* copy = this->copyObject(instance, map);
+        klass->setStaticFieldValue<Instance*>(field->offset(), copy);
+        event.roots.statics += copy != nullptr;
+      }
+    }
+  }
+
+  // Update local variables and the stack in threads
+  for (JavaThread* thread : mVm.threads()) {
+    for (CallFrame& frame : thread->callStack()) {
+      if (frame.currentMethod()->isNative()) {
+        continue;
+      }
+
+      uint64_t pos = frame.programCounter();
+      FrameRoots roots = FrameRoots::compute(frame.currentMethod(), pos);
+
+      for (auto [i, object] : roots.referencesInLocals(frame)) {
+        auto* copy = this->copyObject(object, map);
+        frame.storeValue(i, copy);
+        event.roots.frames += copy != nullptr;
+      }
+
+      for (auto [i, object] : roots.referencesInOperandStack(frame)) {
+        auto* copy = this->copyObject(object, map);
+        frame.replaceStackValue(i, copy);
+        event.roots.frames += copy != nullptr;
+      }
+    }
+  }
+
+  while (scanPtr < mBumpPtr) {
+    auto* instance = reinterpret_cast<Instance*>(scanPtr);
+    size_t objectSize = this->processReferences(instance, map);
+
+    size_t adjustedSize = alignTo(objectSize, ObjectAlignment);
+    scanPtr += adjustedSize;
+  }
+
+  // Clear up the previous region
+  std::memset(mToRegion, 0, mHeapSize / 2);
+  ASAN_POISON_MEMORY_REGION(mToRegion, mHeapSize / 2);
+
+  event.heapUsedAfter = mBumpPtr - mFromRegion;
+  event.objectsCopied = map.size();
+  event.bytesCopied = event.heapUsedAfter;
+
+  return true;
+}
+
+bool SemiSpaceCollector::isInEvacuatedRegion(const Instance* instance) const
+{
+  // The regions are already swapped during collection, so objects to evacuate live in the 'to' region.
+  auto* ptr = reinterpret_cast<const char*>(instance);
+  return ptr >= mToRegion && ptr < mToRegion + mHeapSize / 2;
+}
+
+size_t SemiSpaceCollector::processReferences(Instance* instance, std::unordered_map<Instance*, Instance*>& map)
+{
+  auto klass = instance->getClass();
+  std::size_t size = objectSize(instance);
+
+  if (auto instanceClass = klass->asInstanceClass(); instanceClass) {
+    for (JField* field : instanceClass->instanceFields()) {
+      if (field->fieldType().isReferenceOrArray()) {
+        auto* fieldValue = instance->getFieldValue<Instance*>(field->offset());
+        Instance* copiedField = this->copyObject(fieldValue, map);
+        instance->setFieldValue<Instance*>(field->offset(), copiedField);
+      }
+    }
+  } else if (auto arrayClass = klass->asArrayClass(); arrayClass) {
+    auto elementType = arrayClass->fieldType().asArrayType()->getElementType();
+
+    if (arrayClass->fieldType().asArrayType()->getElementType().isReferenceOrArray()) {
+      JavaArray<Instance*>* arrayOfObjects = instance->toArray<Instance*>();
+      for (int32_t i = 0; i < arrayOfObjects->length(); i++) {
+        Instance* elem = *arrayOfObjects->getArrayElement(i);
+        Instance* copyOfElem = this->copyObject(elem, map);
+
+        arrayOfObjects->setArrayElement(i, copyOfElem);
+      }
+    }
+  } else {
+    GEEVM_UNREACHBLE("A class must be either an instance class or an array")
+  }
+
+  return size;
+}
+
+std::generator<Instance*> SemiSpaceCollector::objects()
+{
+  for (Instance* instance : this->immortalObjects()) {
+    co_yield instance;
+  }
+
+  char* ptr = mFromRegion;
+  while (ptr < mBumpPtr) {
+    auto* instance = reinterpret_cast<Instance*>(ptr);
+    ptr += alignTo(objectSize(instance), ObjectAlignment);
+    co_yield instance;
+  }
+}
+
+void SemiSpaceCollector::fillStatistics(GcStatistics& statistics) const
+{
+  statistics.totalBytesAllocated = mTotalBytesAllocated;
+  statistics.heapUsed = mBumpPtr - mFromRegion;
+  statistics.heapCapacity = mHeapSize / 2;
+}
+
+SemiSpaceCollector::~SemiSpaceCollector()
+{
+  CompressedOops::releaseHeapMemory(mFromRegion, mHeapSize / 2);
+  CompressedOops::releaseHeapMemory(mToRegion, mHeapSize / 2);
+}
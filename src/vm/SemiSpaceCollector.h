@@ -0,0 +1,58 @@
+#ifndef GEEVM_VM_SEMISPACECOLLECTOR_H
+#define GEEVM_VM_SEMISPACECOLLECTOR_H
+
+#include "vm/GarbageCollector.h"
+
+namespace geevm
+{
+
+/// A copying garbage collector.
+///
+/// Every time the allocation of a new object is requested, the GC checks the heap state and may decide to
+/// perform garbage collection.
+///
+/// The garbage-collected heap is split into two regions: the "from" region and the "to" region. All allocations
+/// take place on the "from" region. When the garbage collector runs, it collects all GC roots (local variables,
+/// values on the operand stack and manually rooted objects) and all objects reachable from GC roots.
+/// These objects are then copied to the "to" region, the "from" region is invalidated, then the two regions
+/// are swapped (so that the "to" region containing the copies becomes the new "from" region).
+class SemiSpaceCollector : public GarbageCollector
+{
+public:
+  explicit SemiSpaceCollector(Vm& vm);
+
+  [[nodiscard]] void* allocate(size_t size) override;
+
+  std::generator<Instance*> objects() override;
+
+  ~SemiSpaceCollector() override;
+
+protected:
+  bool collect(GcEvent& event) override;
+  void fillStatistics(GcStatistics& statistics) const override;
+
+private:
+  Instance* copyObject(Instance* instance, std::unordered_map<Instance*, Instance*>& map);
+  size_t processReferences(Instance* instance, std::unordered_map<Instance*, Instance*>& map);
+
+  /// Returns true if the given object resides in the region that is being evacuated by the current collection.
+  bool isInEvacuatedRegion(const Instance* instance) const;
+
+  /// Allocate space on the garbage-collected heap _without_ checking for heap boundaries.
+  /// Used inside the garbage collector when it is known that there is enough space available.
+  void* allocateUnchecked(size_t size);
+
+private:
+  char* mFromRegion;
+  char* mToRegion;
+  char* mBumpPtr;
+  // GC settings
+  size_t mHeapSize = 0;
+  bool mRunAfterEveryAllocation = false;
+  // Statistics
+  size_t mTotalBytesAllocated = 0;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SEMISPACECOLLECTOR_H
@@ -0,0 +1,845 @@
+#include "vm/SsaBuilder.h"
+#include "class_file/Opcode.h"
+#include "common/Debug.h"
+#include "vm/Class.h"
+#include "vm/CompiledCode.h"
+#include "vm/Method.h"
+#include "vm/Runtime.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <memory>
+#include <unordered_map>
+
+using namespace geevm;
+
+namespace
+{
+
+// Callees with more bytecode are not inlined
+constexpr size_t MaxInlineSize = 35;
+// Maximum nesting of inlined calls
+constexpr int MaxInlineDepth = 3;
+
+constexpr int32_t Unreached = -1;
+
+bool isReturn(Opcode opcode)
+{
+  return opcode >= Opcode::IRETURN && opcode <= Opcode::RETURN;
+}
+
+bool isArrayStore(Opcode opcode)
+{
+  return opcode >= Opcode::IASTORE && opcode <= Opcode::SASTORE;
+}
+
+uint8_t returnSlots(const JMethod& method)
+{
+  const ReturnType& returnType = method.descriptor().returnType();
+  if (returnType.isVoid()) {
+    return 0;
+  }
+  return returnType.getType().isCategoryTwo() ? 2 : 1;
+}
+
+/// The compiled method or an inlined callee. Every context has its own SSA variables for its local variables and
+/// operand stack slots.
+struct MethodContext
+{
+  JMethod* method = nullptr;
+  const std::vector<types::u1>* bytes = nullptr;
+  MethodContext* caller = nullptr;
+  int inlineDepth = 0;
+  uint32_t varBase = 0;
+  types::u2 maxLocals = 0;
+  // Operand stack depth before every instruction, Unreached for instructions compiled code does not execute
+  std::vector<int32_t> depths;
+  // Block starting at every offset, nullptr for offsets that do not start a block
+  std::vector<SsaBlock*> blocks;
+  // Inlined callees by offset of their invoke instruction
+  std::unordered_map<int64_t, std::unique_ptr<MethodContext>> callees;
+  // Inlined methods only: the caller's block after the call, the caller variable receiving the return value, and the
+  // instruction of the compiled method that exits continue from
+  SsaBlock* continuation = nullptr;
+  uint32_t returnVar = 0;
+  uint8_t returnSlots = 0;
+  int64_t exitPc = 0;
+  int32_t exitDepth = 0;
+
+  uint32_t local(size_t index) const
+  {
+    return varBase + static_cast<uint32_t>(index);
+  }
+
+  uint32_t stack(int32_t index) const
+  {
+    return varBase + maxLocals + static_cast<uint32_t>(index);
+  }
+
+  int64_t size() const
+  {
+    return static_cast<int64_t>(bytes->size());
+  }
+
+  Opcode opcodeAt(int64_t pc) const
+  {
+    return static_cast<Opcode>((*bytes)[pc]);
+  }
+
+  types::u1 u1At(int64_t pc) const
+  {
+    return (*bytes)[pc];
+  }
+
+  types::u2 u2At(int64_t pc) const
+  {
+    return ((*bytes)[pc] << 8u) | (*bytes)[pc + 1];
+  }
+};
+
+struct BlockState
+{
+  // nullptr for the entry block preceding the first instruction
+  MethodContext* context = nullptr;
+  int64_t startPc = 0;
+  bool isFilled = false;
+  bool isSealed = false;
+  // Current value of the variables defined in the block
+  std::unordered_map<uint32_t, SsaValue*> definitions{};
+  // Phis of variables read before all predecessors were filled
+  std::vector<std::pair<uint32_t, SsaValue*>> incompletePhis{};
+};
+
+class SsaBuilder
+{
+public:
+  SsaBuilder(SsaGraph& graph, int64_t entryPc)
+    : mGraph(graph), mEntryPc(entryPc)
+  {
+  }
+
+  bool build(JMethod& method);
+
+private:
+  std::unique_ptr<MethodContext> analyze(JMethod* method, MethodContext* caller, int64_t callPc);
+  std::unique_ptr<MethodContext> analyzeCallee(MethodContext& context, int64_t pc);
+  bool computeStackDepths(MethodContext& context);
+  SsaBlock* createBlock(MethodContext* context, int64_t startPc);
+  void connect(MethodContext& context);
+
+  void fill(SsaBlock* block);
+  void seal(SsaBlock* block);
+  bool predecessorsFilled(SsaBlock* block);
+
+  void write(SsaBlock* block, uint32_t var, SsaValue* value);
+  SsaValue* read(SsaBlock* block, uint32_t var);
+  SsaValue* readRecursive(SsaBlock* block, uint32_t var);
+  SsaValue* addPhiOperands(uint32_t var, SsaValue* phi);
+  SsaValue* tryRemoveTrivialPhi(SsaValue* phi);
+
+  FrameState* frameState(SsaBlock* block, const MethodContext& context, int64_t pc, int32_t depth);
+
+  BlockState& state(SsaBlock* block)
+  {
+    return mBlockStates[block->id];
+  }
+
+private:
+  SsaGraph& mGraph;
+  // First instruction of the compiled method, a loop header for OSR entries
+  int64_t mEntryPc;
+  std::unique_ptr<MethodContext> mRoot;
+  uint32_t mVariableCount = 0;
+  // Indexed by block id
+  std::vector<BlockState> mBlockStates;
+};
+
+bool SsaBuilder::build(JMethod& method)
+{
+  mRoot = this->analyze(&method, nullptr, 0);
+  if (mRoot == nullptr || (!compiledStackEffect(mRoot->opcodeAt(mEntryPc)).has_value() && !mRoot->callees.contains(mEntryPc))) {
+    // Code immediately exiting to the interpreter is not worth compiling
+    return false;
+  }
+
+  // A separate entry block defines the parameters, as the first instruction may be a loop header. Local variables of
+  // OSR entries are parameters as well, as they are in the interpreter frame just like at the method start.
+  SsaBlock* entry = this->createBlock(nullptr, 0);
+  mGraph.setEntry(entry);
+  mGraph.addEdge(entry, mRoot->blocks[mEntryPc]);
+  this->connect(*mRoot);
+  mGraph.computeDominators();
+
+  // Blocks are filled in reverse postorder, so that only loop headers have predecessors that are not filled yet
+  for (SsaBlock* block : mGraph.blocks()) {
+    if (!state(block).isSealed && this->predecessorsFilled(block)) {
+      this->seal(block);
+    }
+
+    if (block == entry) {
+      mGraph.append(block, SsaOpcode::Goto, {});
+    } else {
+      this->fill(block);
+    }
+    state(block).isFilled = true;
+
+    for (SsaBlock* successor : block->successors) {
+      if (!state(successor).isSealed && this->predecessorsFilled(successor)) {
+        this->seal(successor);
+      }
+    }
+  }
+
+  mGraph.resolveReplacements();
+  return true;
+}
+
+std::unique_ptr<MethodContext> SsaBuilder::analyze(JMethod* method, MethodContext* caller, int64_t callPc)
+{
+  auto context = std::make_unique<MethodContext>();
+  context->method = method;
+  context->bytes = &method->getCode().bytes();
+  context->caller = caller;
+  context->maxLocals = method->getCode().maxLocals();
+  context->varBase = mVariableCount;
+  mVariableCount += method->getCode().maxLocals() + method->getCode().maxStack();
+
+  if (caller != nullptr) {
+    int32_t callDepth = caller->depths[callPc];
+    context->inlineDepth = caller->inlineDepth + 1;
+    context->returnSlots = returnSlots(*method);
+    context->returnVar = caller->stack(callDepth - static_cast<int32_t>(method->descriptor().numParameterSlots()));
+    context->exitPc = caller->caller != nullptr ? caller->exitPc : callPc;
+    context->exitDepth = caller->caller != nullptr ? caller->exitDepth : callDepth;
+  }
+
+  if (!this->computeStackDepths(*context)) {
+    return nullptr;
+  }
+
+  context->blocks.assign(context->bytes->size(), nullptr);
+  auto startBlock = [&](int64_t pc) {
+    if (pc < context->size() && context->depths[pc] != Unreached && context->blocks[pc] == nullptr) {
+      context->blocks[pc] = this->createBlock(context.get(), pc);
+    }
+  };
+
+  startBlock(caller == nullptr ? mEntryPc : 0);
+  for (int64_t pc = 0; pc < context->size(); ++pc) {
+    if (context->depths[pc] == Unreached) {
+      continue;
+    }
+
+    Opcode opcode = context->opcodeAt(pc);
+    if (context->callees.contains(pc)) {
+      startBlock(pc + 3);
+    } else if (isJump(opcode)) {
+      startBlock(jumpTarget(*context->bytes, pc));
+      startBlock(pc + compiledStackEffect(opcode)->length);
+    }
+  }
+
+  return context;
+}
+
+std::unique_ptr<MethodContext> SsaBuilder::analyzeCallee(MethodContext& context, int64_t pc)
+{
+  if (context.inlineDepth >= MaxInlineDepth) {
+    return nullptr;
+  }
+
+  JMethod* callee = context.method->getClass()->runtimeConstantPool().resolvedMethodRef(context.u2At(pc + 1));
+  if (callee == nullptr || !callee->isStatic() || callee->isNative() || callee->isAbstract() ||
+      hasAccessFlag(callee->accessFlags(), MethodAccessFlags::ACC_SYNCHRONIZED) || !callee->getClass()->isInitialized() ||
+      callee->getCode().bytes().size() > MaxInlineSize) {
+    return nullptr;
+  }
+
+  for (MethodContext* current = &context; current != nullptr; current = current->caller) {
+    if (current->method == callee) {
+      // Recursive call
+      return nullptr;
+    }
+  }
+
+  return this->analyze(callee, &context, pc);
+}
+
+bool SsaBuilder::computeStackDepths(MethodContext& context)
+{
+  context.depths.assign(context.bytes->size(), Unreached);
+
+  std::vector<int64_t> worklist;
+  auto reach = [&](int64_t pc, int32_t depth) {
+    if (pc < 0 || pc >= context.size()) {
+      return false;
+    }
+    if (context.depths[pc] == Unreached) {
+      context.depths[pc] = depth;
+      worklist.push_back(pc);
+      return true;
+    }
+    return context.depths[pc] == depth;
+  };
+
+  int64_t entryPc = context.caller == nullptr ? mEntryPc : 0;
+  if (context.bytes->empty() || !reach(entryPc, 0)) {
+    return false;
+  }
+
+  bool returns = false;
+  types::u2 maxStack = context.method->getCode().maxStack();
+  while (!worklist.empty()) {
+    int64_t pc = worklist.back();
+    worklist.pop_back();
+
+    Opcode opcode = context.opcodeAt(pc);
+    if (isReturn(opcode)) {
+      returns = true;
+      continue;
+    }
+
+    // An inlined method must not have side effects, as its exits execute the whole call again
+    if (context.caller != nullptr && isArrayStore(opcode)) {
+      return false;
+    }
+
+    std::optional<StackEffect> effect = compiledStackEffect(opcode);
+    if (opcode == Opcode::INVOKESTATIC && pc + 3 <= context.size()) {
+      if (auto callee = this->analyzeCallee(context, pc); callee != nullptr) {
+        effect = StackEffect{3, static_cast<uint8_t>(callee->method->descriptor().numParameterSlots()), callee->returnSlots};
+        context.callees[pc] = std::move(callee);
+      }
+    }
+    if (!effect.has_value()) {
+      // Compiled code exits to the interpreter here
+      continue;
+    }
+
+    int32_t depth = context.depths[pc];
+    int32_t nextDepth = depth - effect->pops + effect->pushes;
+    if (depth < effect->pops || nextDepth > maxStack || pc + effect->length > context.size()) {
+      return false;
+    }
+
+    if (isJump(opcode) && !reach(jumpTarget(*context.bytes, pc), nextDepth)) {
+      return false;
+    }
+
+    bool fallsThrough = opcode != Opcode::GOTO && opcode != Opcode::GOTO_W;
+    if (fallsThrough && !reach(pc + effect->length, nextDepth)) {
+      return false;
+    }
+  }
+
+  // Inlining a method that never returns is pointless
+  return context.caller == nullptr || returns;
+}
+
+SsaBlock* SsaBuilder::createBlock(MethodContext* context, int64_t startPc)
+{
+  SsaBlock* block = mGraph.createBlock();
+  assert(block->id == mBlockStates.size());
+  mBlockStates.emplace_back(BlockState{.context = context, .startPc = startPc});
+  return block;
+}
+
+void SsaBuilder::connect(MethodContext& context)
+{
+  for (int64_t start = 0; start < context.size(); ++start) {
+    SsaBlock* block = context.blocks[start];
+    if (block == nullptr) {
+      continue;
+    }
+
+    int64_t pc = start;
+    while (true) {
+      if (pc != start && context.blocks[pc] != nullptr) {
+        mGraph.addEdge(block, context.blocks[pc]);
+        break;
+      }
+
+      Opcode opcode = context.opcodeAt(pc);
+      if (auto it = context.callees.find(pc); it != context.callees.end()) {
+        it->second->continuation = context.blocks[pc + 3];
+        mGraph.addEdge(block, it->second->blocks[0]);
+        break;
+      }
+      if (isReturn(opcode)) {
+        if (context.caller != nullptr) {
+          mGraph.addEdge(block, context.continuation);
+        }
+        break;
+      }
+
+      auto effect = compiledStackEffect(opcode);
+      if (!effect.has_value()) {
+        break;
+      }
+      if (isJump(opcode)) {
+        int64_t target = jumpTarget(*context.bytes, pc);
+        int64_t next = pc + effect->length;
+        mGraph.addEdge(block, context.blocks[target]);
+        if (opcode != Opcode::GOTO && opcode != Opcode::GOTO_W && target != next) {
+          mGraph.addEdge(block, context.blocks[next]);
+        }
+        break;
+      }
+
+      pc += effect->length;
+    }
+  }
+
+  for (auto& [pc, callee] : context.callees) {
+    this->connect(*callee);
+  }
+}
+
+bool SsaBuilder::predecessorsFilled(SsaBlock* block)
+{
+  return std::ranges::all_of(block->predecessors, [this](SsaBlock* predecessor) {
+    return state(predecessor).isFilled;
+  });
+}
+
+void SsaBuilder::seal(SsaBlock* block)
+{
+  // Indices stay valid if reading the predecessors adds phis
+  auto& incompletePhis = state(block).incompletePhis;
+  for (size_t i = 0; i < incompletePhis.size(); ++i) {
+    auto [var, phi] = incompletePhis[i];
+    this->addPhiOperands(var, phi);
+  }
+  incompletePhis.clear();
+  state(block).isSealed = true;
+}
+
+void SsaBuilder::write(SsaBlock* block, uint32_t var, SsaValue* value)
+{
+  state(block).definitions[var] = value;
+}
+
+SsaValue* SsaBuilder::read(SsaBlock* block, uint32_t var)
+{
+  auto& definitions = state(block).definitions;
+  if (auto it = definitions.find(var); it != definitions.end()) {
+    return it->second->resolve();
+  }
+  return this->readRecursive(block, var);
+}
+
+SsaValue* SsaBuilder::readRecursive(SsaBlock* block, uint32_t var)
+{
+  SsaValue* value;
+  if (!state(block).isSealed) {
+    value = mGraph.create(SsaOpcode::Phi, {});
+    value->block = block;
+    block->phis.push_back(value);
+    state(block).incompletePhis.emplace_back(var, value);
+  } else if (block->predecessors.empty()) {
+    value = var < mRoot->maxLocals ? mGraph.parameter(static_cast<uint16_t>(var)) : mGraph.undefined();
+  } else if (block->predecessors.size() == 1) {
+    value = this->read(block->predecessors[0], var);
+  } else {
+    // The phi is defined before its operands are read to break cycles through loops
+    value = mGraph.create(SsaOpcode::Phi, {});
+    value->block = block;
+    block->phis.push_back(value);
+    this->write(block, var, value);
+    value = this->addPhiOperands(var, value);
+  }
+
+  this->write(block, var, value);
+  return value;
+}
+
+SsaValue* SsaBuilder::addPhiOperands(uint32_t var, SsaValue* phi)
+{
+  for (SsaBlock* predecessor : phi->block->predecessors) {
+    SsaValue* input = this->read(predecessor, var);
+    phi->inputs.push_back(input);
+  }
+  return this->tryRemoveTrivialPhi(phi);
+}
+
+SsaValue* SsaBuilder::tryRemoveTrivialPhi(SsaValue* phi)
+{
+  SsaValue* same = nullptr;
+  for (SsaValue* input : phi->inputs) {
+    input = input->resolve();
+    if (input == same || input == phi) {
+      continue;
+    }
+    if (same != nullptr) {
+      return phi;
+    }
+    same = input;
+  }
+
+  if (same == nullptr) {
+    same = mGraph.undefined();
+  }
+  phi->replacement = same;
+  return same;
+}
+
+FrameState* SsaBuilder::frameState(SsaBlock* block, const MethodContext& context, int64_t pc, int32_t depth)
+{
+  if (context.caller != nullptr) {
+    pc = context.exitPc;
+    depth = context.exitDepth;
+  }
+
+  FrameState state{.pc = pc, .locals = {}, .stack = {}};
+  for (size_t i = 0; i < mRoot->maxLocals; ++i) {
+    state.locals.push_back(this->read(block, mRoot->local(i)));
+  }
+  for (int32_t i = 0; i < depth; ++i) {
+    state.stack.push_back(this->read(block, mRoot->stack(i)));
+  }
+  return mGraph.createFrameState(std::move(state));
+}
+
+void SsaBuilder::fill(SsaBlock* block)
+{
+  MethodContext& context = *state(block).context;
+  int64_t start = state(block).startPc;
+  int64_t pc = start;
+  int32_t depth = context.depths[pc];
+
+  auto append = [&](SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate = 0) {
+    return mGraph.append(block, opcode, std::move(inputs), immediate);
+  };
+  auto check = [&](SsaOpcode opcode, std::vector<SsaValue*> inputs, FrameState* frameState, uint64_t immediate = 0) {
+    append(opcode, std::move(inputs), immediate)->frameState = frameState;
+  };
+  auto intConstant = [&](int32_t value) {
+    return mGraph.constant(std::bit_cast<uint32_t>(value));
+  };
+
+  // Category two values occupy two variables like they occupy two slots, the second one is undefined
+  auto push = [&](SsaValue* value) {
+    this->write(block, context.stack(depth), value);
+    depth += 1;
+  };
+  auto pushWide = [&](SsaValue* value) {
+    this->write(block, context.stack(depth), value);
+    this->write(block, context.stack(depth + 1), mGraph.undefined());
+    depth += 2;
+  };
+  auto pop = [&] {
+    depth -= 1;
+    return this->read(block, context.stack(depth));
+  };
+  auto popWide = [&] {
+    depth -= 2;
+    return this->read(block, context.stack(depth));
+  };
+  auto load = [&](size_t index) {
+    push(this->read(block, context.local(index)));
+  };
+  auto loadWide = [&](size_t index) {
+    pushWide(this->read(block, context.local(index)));
+  };
+  auto store = [&](size_t index) {
+    this->write(block, context.local(index), pop());
+  };
+  auto storeWide = [&](size_t index) {
+    this->write(block, context.local(index), popWide());
+    this->write(block, context.local(index + 1), mGraph.undefined());
+  };
+  auto binary = [&](SsaOpcode opcode) {
+    SsaValue* rhs = pop();
+    SsaValue* lhs = pop();
+    push(append(opcode, {lhs, rhs}));
+  };
+  auto binaryWide = [&](SsaOpcode opcode) {
+    SsaValue* rhs = popWide();
+    SsaValue* lhs = popWide();
+    pushWide(append(opcode, {lhs, rhs}));
+  };
+  auto shiftWide = [&](SsaOpcode opcode) {
+    SsaValue* count = pop();
+    SsaValue* value = popWide();
+    pushWide(append(opcode, {value, count}));
+  };
+  auto division = [&](SsaOpcode opcode, bool isWide) {
+    FrameState* frameState = this->frameState(block, context, pc, depth);
+    SsaValue* rhs = isWide ? popWide() : pop();
+    SsaValue* lhs = isWide ? popWide() : pop();
+    check(SsaOpcode::ZeroCheck, {rhs}, frameState, isWide ? 1 : 0);
+    SsaValue* result = append(opcode, {lhs, rhs});
+    isWide ? pushWide(result) : push(result);
+  };
+  auto arrayLoad = [&](ArrayElementKind kind) {
+    FrameState* frameState = this->frameState(block, context, pc, depth);
+    SsaValue* index = pop();
+    SsaValue* array = pop();
+    check(SsaOpcode::NullCheck, {array}, frameState);
+    SsaValue* length = append(SsaOpcode::ArrayLength, {array});
+    check(SsaOpcode::BoundsCheck, {index, length}, frameState);
+    SsaValue* value = append(SsaOpcode::ArrayLoad, {array, index}, static_cast<uint64_t>(kind));
+    kind == ArrayElementKind::Long ? pushWide(value) : push(value);
+  };
+  auto arrayStore = [&](ArrayElementKind kind) {
+    FrameState* frameState = this->frameState(block, context, pc, depth);
+    SsaValue* value = kind == ArrayElementKind::Long ? popWide() : pop();
+    SsaValue* index = pop();
+    SsaValue* array = pop();
+    check(SsaOpcode::NullCheck, {array}, frameState);
+    SsaValue* length = append(SsaOpcode::ArrayLength, {array});
+    check(SsaOpcode::BoundsCheck, {index, length}, frameState);
+    append(SsaOpcode::ArrayStore, {array, index, value}, static_cast<uint64_t>(kind));
+  };
+  auto branch = [&](SsaCondition condition, SsaValue* lhs, SsaValue* rhs, bool isWide) {
+    if (jumpTarget(*context.bytes, pc) == pc + 3) {
+      append(SsaOpcode::Goto, {});
+    } else {
+      append(SsaOpcode::Branch, {lhs, rhs}, static_cast<uint64_t>(condition) | (isWide ? 0x100 : 0));
+    }
+  };
+  auto exit = [&] {
+    FrameState* frameState = this->frameState(block, context, pc, depth);
+    check(SsaOpcode::Exit, {}, frameState);
+  };
+
+  while (true) {
+    if (pc != start && context.blocks[pc] != nullptr) {
+      append(SsaOpcode::Goto, {});
+      return;
+    }
+
+    Opcode opcode = context.opcodeAt(pc);
+    if (auto it = context.callees.find(pc); it != context.callees.end()) {
+      // Arguments are passed by defining the callee's parameter variables
+      MethodContext& callee = *it->second;
+      auto argumentSlots = static_cast<int32_t>(callee.method->descriptor().numParameterSlots());
+      for (int32_t i = 0; i < argumentSlots; ++i) {
+        this->write(block, callee.local(i), this->read(block, context.stack(depth - argumentSlots + i)));
+      }
+      append(SsaOpcode::Goto, {});
+      return;
+    }
+
+    if (isReturn(opcode)) {
+      if (context.caller == nullptr) {
+        exit();
+        return;
+      }
+      if (context.returnSlots == 1) {
+        this->write(block, context.returnVar, pop());
+      } else if (context.returnSlots == 2) {
+        this->write(block, context.returnVar, popWide());
+        this->write(block, context.returnVar + 1, mGraph.undefined());
+      }
+      append(SsaOpcode::Goto, {});
+      return;
+    }
+
+    auto effect = compiledStackEffect(opcode);
+    if (!effect.has_value()) {
+      exit();
+      return;
+    }
+
+    switch (opcode) {
+      using enum Opcode;
+      case NOP: break;
+      case ACONST_NULL: push(mGraph.constant(0)); break;
+      case ICONST_M1:
+      case ICONST_0:
+      case ICONST_1:
+      case ICONST_2:
+      case ICONST_3:
+      case ICONST_4:
+      case ICONST_5: push(intConstant(static_cast<int32_t>(opcode) - static_cast<int32_t>(ICONST_0))); break;
+      case LCONST_0:
+      case LCONST_1: pushWide(mGraph.constant(static_cast<uint64_t>(opcode) - static_cast<uint64_t>(LCONST_0))); break;
+      case FCONST_0:
+      case FCONST_1:
+      case FCONST_2:
+        push(mGraph.constant(std::bit_cast<uint32_t>(static_cast<float>(static_cast<int32_t>(opcode) - static_cast<int32_t>(FCONST_0)))));
+        break;
+      case DCONST_0:
+      case DCONST_1:
+        pushWide(mGraph.constant(std::bit_cast<uint64_t>(static_cast<double>(static_cast<int32_t>(opcode) - static_cast<int32_t>(DCONST_0)))));
+        break;
+      case BIPUSH: push(intConstant(std::bit_cast<int8_t>(context.u1At(pc + 1)))); break;
+      case SIPUSH: push(intConstant(std::bit_cast<int16_t>(context.u2At(pc + 1)))); break;
+      case ILOAD:
+      case FLOAD:
+      case ALOAD: load(context.u1At(pc + 1)); break;
+      case LLOAD:
+      case DLOAD: loadWide(context.u1At(pc + 1)); break;
+      case ILOAD_0:
+      case ILOAD_1:
+      case ILOAD_2:
+      case ILOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(ILOAD_0)); break;
+      case LLOAD_0:
+      case LLOAD_1:
+      case LLOAD_2:
+      case LLOAD_3: loadWide(static_cast<size_t>(opcode) - static_cast<size_t>(LLOAD_0)); break;
+      case FLOAD_0:
+      case FLOAD_1:
+      case FLOAD_2:
+      case FLOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(FLOAD_0)); break;
+      case DLOAD_0:
+      case DLOAD_1:
+      case DLOAD_2:
+      case DLOAD_3: loadWide(static_cast<size_t>(opcode) - static_cast<size_t>(DLOAD_0)); break;
+      case ALOAD_0:
+      case ALOAD_1:
+      case ALOAD_2:
+      case ALOAD_3: load(static_cast<size_t>(opcode) - static_cast<size_t>(ALOAD_0)); break;
+      case ISTORE:
+      case FSTORE:
+      case ASTORE: store(context.u1At(pc + 1)); break;
+      case LSTORE:
+      case DSTORE: storeWide(context.u1At(pc + 1)); break;
+      case ISTORE_0:
+      case ISTORE_1:
+      case ISTORE_2:
+      case ISTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(ISTORE_0)); break;
+      case LSTORE_0:
+      case LSTORE_1:
+      case LSTORE_2:
+      case LSTORE_3: storeWide(static_cast<size_t>(opcode) - static_cast<size_t>(LSTORE_0)); break;
+      case FSTORE_0:
+      case FSTORE_1:
+      case FSTORE_2:
+      case FSTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(FSTORE_0)); break;
+      case DSTORE_0:
+      case DSTORE_1:
+      case DSTORE_2:
+      case DSTORE_3: storeWide(static_cast<size_t>(opcode) - static_cast<size_t>(DSTORE_0)); break;
+      case ASTORE_0:
+      case ASTORE_1:
+      case ASTORE_2:
+      case ASTORE_3: store(static_cast<size_t>(opcode) - static_cast<size_t>(ASTORE_0)); break;
+      case IALOAD:
+      case FALOAD: arrayLoad(ArrayElementKind::Int); break;
+      case LALOAD:
+      case DALOAD: arrayLoad(ArrayElementKind::Long); break;
+      case BALOAD: arrayLoad(ArrayElementKind::Byte); break;
+      case CALOAD: arrayLoad(ArrayElementKind::Char); break;
+      case SALOAD: arrayLoad(ArrayElementKind::Short); break;
+      case IASTORE:
+      case FASTORE: arrayStore(ArrayElementKind::Int); break;
+      case LASTORE:
+      case DASTORE: arrayStore(ArrayElementKind::Long); break;
+      case BASTORE: arrayStore(ArrayElementKind::Byte); break;
+      case CASTORE: arrayStore(ArrayElementKind::Char); break;
+      case SASTORE: arrayStore(ArrayElementKind::Short); break;
+      case POP: depth -= 1; break;
+      case POP2: depth -= 2; break;
+      case DUP: push(this->read(block, context.stack(depth - 1))); break;
+      case DUP_X1: {
+        SsaValue* top = pop();
+        SsaValue* second = pop();
+        push(top);
+        push(second);
+        push(top);
+        break;
+      }
+      case DUP2: {
+        SsaValue* second = this->read(block, context.stack(depth - 2));
+        SsaValue* top = this->read(block, context.stack(depth - 1));
+        push(second);
+        push(top);
+        break;
+      }
+      case SWAP: {
+        SsaValue* top = pop();
+        SsaValue* second = pop();
+        push(top);
+        push(second);
+        break;
+      }
+      case IADD: binary(SsaOpcode::IAdd); break;
+      case ISUB: binary(SsaOpcode::ISub); break;
+      case IMUL: binary(SsaOpcode::IMul); break;
+      case IAND: binary(SsaOpcode::IAnd); break;
+      case IOR: binary(SsaOpcode::IOr); break;
+      case IXOR: binary(SsaOpcode::IXor); break;
+      case ISHL: binary(SsaOpcode::IShl); break;
+      case ISHR: binary(SsaOpcode::IShr); break;
+      case IUSHR: binary(SsaOpcode::IUShr); break;
+      case IDIV: division(SsaOpcode::IDiv, false); break;
+      case IREM: division(SsaOpcode::IRem, false); break;
+      case LADD: binaryWide(SsaOpcode::LAdd); break;
+      case LSUB: binaryWide(SsaOpcode::LSub); break;
+      case LMUL: binaryWide(SsaOpcode::LMul); break;
+      case LAND: binaryWide(SsaOpcode::LAnd); break;
+      case LOR: binaryWide(SsaOpcode::LOr); break;
+      case LXOR: binaryWide(SsaOpcode::LXor); break;
+      case LSHL: shiftWide(SsaOpcode::LShl); break;
+      case LSHR: shiftWide(SsaOpcode::LShr); break;
+      case LUSHR: shiftWide(SsaOpcode::LUShr); break;
+      case LDIV: division(SsaOpcode::LDiv, true); break;
+      case LREM: division(SsaOpcode::LRem, true); break;
+      case INEG: push(append(SsaOpcode::INeg, {pop()})); break;
+      case LNEG: pushWide(append(SsaOpcode::LNeg, {popWide()})); break;
+      case IINC: {
+        size_t index = context.u1At(pc + 1);
+        SsaValue* increment = intConstant(std::bit_cast<int8_t>(context.u1At(pc + 2)));
+        this->write(block, context.local(index), append(SsaOpcode::IAdd, {this->read(block, context.local(index)), increment}));
+        break;
+      }
+      case I2L: pushWide(append(SsaOpcode::I2L, {pop()})); break;
+      case L2I: push(append(SsaOpcode::L2I, {popWide()})); break;
+      case I2B: push(append(SsaOpcode::I2B, {pop()})); break;
+      case I2C: push(append(SsaOpcode::I2C, {pop()})); break;
+      case I2S: push(append(SsaOpcode::I2S, {pop()})); break;
+      case LCMP: {
+        SsaValue* rhs = popWide();
+        SsaValue* lhs = popWide();
+        push(append(SsaOpcode::LCmp, {lhs, rhs}));
+        break;
+      }
+      case IFEQ: branch(SsaCondition::Equal, pop(), intConstant(0), false); return;
+      case IFNE: branch(SsaCondition::NotEqual, pop(), intConstant(0), false); return;
+      case IFLT: branch(SsaCondition::Less, pop(), intConstant(0), false); return;
+      case IFGE: branch(SsaCondition::GreaterEqual, pop(), intConstant(0), false); return;
+      case IFGT: branch(SsaCondition::Greater, pop(), intConstant(0), false); return;
+      case IFLE: branch(SsaCondition::LessEqual, pop(), intConstant(0), false); return;
+      case IFNULL: branch(SsaCondition::Equal, pop(), mGraph.constant(0), true); return;
+      case IFNONNULL: branch(SsaCondition::NotEqual, pop(), mGraph.constant(0), true); return;
+      case IF_ICMPEQ:
+      case IF_ICMPNE:
+      case IF_ICMPLT:
+      case IF_ICMPGE:
+      case IF_ICMPGT:
+      case IF_ICMPLE:
+      case IF_ACMPEQ:
+      case IF_ACMPNE: {
+        static constexpr SsaCondition conditions[] = {SsaCondition::Equal,   SsaCondition::NotEqual,  SsaCondition::Less,  SsaCondition::GreaterEqual,
+                                                      SsaCondition::Greater, SsaCondition::LessEqual, SsaCondition::Equal, SsaCondition::NotEqual};
+        SsaValue* rhs = pop();
+        SsaValue* lhs = pop();
+        branch(conditions[static_cast<int>(opcode) - static_cast<int>(IF_ICMPEQ)], lhs, rhs, opcode >= IF_ACMPEQ);
+        return;
+      }
+      case GOTO:
+      case GOTO_W: append(SsaOpcode::Goto, {}); return;
+      case ARRAYLENGTH: {
+        FrameState* frameState = this->frameState(block, context, pc, depth);
+        SsaValue* array = pop();
+        check(SsaOpcode::NullCheck, {array}, frameState);
+        push(append(SsaOpcode::ArrayLength, {array}));
+        break;
+      }
+      default: GEEVM_UNREACHBLE("Instruction without a translation");
+    }
+
+    pc += effect->length;
+  }
+}
+
+} // namespace
+
+bool geevm::buildSsaGraph(JMethod& method, SsaGraph& graph, int64_t entryPc)
+{
+  SsaBuilder builder(graph, entryPc);
+  return builder.build(method);
+}
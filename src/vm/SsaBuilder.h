@@ -0,0 +1,30 @@
+#ifndef GEEVM_VM_SSABUILDER_H
+#define GEEVM_VM_SSABUILDER_H
+
+#include "vm/SsaGraph.h"
+
+#include <cstdint>
+
+namespace geevm
+{
+
+class JMethod;
+
+/// Translates the bytecode of \p method into \p graph, returns false if the method cannot be compiled.
+///
+/// The graph covers the same instructions as baseline code. Local variables and operand stack slots are treated as
+/// variables and converted to SSA form while the blocks are translated, using the algorithm of Braun et al., "Simple
+/// and Efficient Construction of Static Single Assignment Form". Unsupported instructions and returns become exits to
+/// the interpreter.
+///
+/// Small static methods that are already resolved and initialized are inlined, as long as they do not store into
+/// arrays. Such callees have no side effects that are visible to the caller, so exits within them continue in the
+/// interpreter at the call instruction, which then executes the call again from the start.
+///
+/// The graph is entered at \p entryPc, which is either the method start or the loop header of an OSR entry. The
+/// operand stack must be empty at an OSR entry.
+bool buildSsaGraph(JMethod& method, SsaGraph& graph, int64_t entryPc = 0);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SSABUILDER_H
@@ -0,0 +1,276 @@
+#include "vm/SsaGraph.h"
+#include "common/Debug.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace geevm;
+
+SsaCondition geevm::negate(SsaCondition condition)
+{
+  switch (condition) {
+    using enum SsaCondition;
+    case Equal: return NotEqual;
+    case NotEqual: return Equal;
+    case Less: return GreaterEqual;
+    case GreaterEqual: return Less;
+    case Greater: return LessEqual;
+    case LessEqual: return Greater;
+  }
+  GEEVM_UNREACHBLE("Unknown condition");
+}
+
+SsaCondition geevm::swapOperands(SsaCondition condition)
+{
+  switch (condition) {
+    using enum SsaCondition;
+    case Equal: return Equal;
+    case NotEqual: return NotEqual;
+    case Less: return Greater;
+    case GreaterEqual: return LessEqual;
+    case Greater: return Less;
+    case LessEqual: return GreaterEqual;
+  }
+  GEEVM_UNREACHBLE("Unknown condition");
+}
+
+bool SsaValue::isPure() const
+{
+  switch (opcode) {
+    using enum SsaOpcode;
+    case Parameter:
+    case Constant:
+    case Undefined:
+    case IAdd:
+    case ISub:
+    case IMul:
+    case IAnd:
+    case IOr:
+    case IXor:
+    case IShl:
+    case IShr:
+    case IUShr:
+    case INeg:
+    case LAdd:
+    case LSub:
+    case LMul:
+    case LAnd:
+    case LOr:
+    case LXor:
+    case LShl:
+    case LShr:
+    case LUShr:
+    case LNeg:
+    case I2L:
+    case L2I:
+    case I2B:
+    case I2C:
+    case I2S:
+    case LCmp: return true;
+    default: return false;
+  }
+}
+
+SsaValue* SsaValue::resolve()
+{
+  SsaValue* value = this;
+  while (value->replacement != nullptr) {
+    value = value->replacement;
+  }
+  return value;
+}
+
+size_t SsaBlock::predecessorIndex(const SsaBlock* predecessor) const
+{
+  auto it = std::ranges::find(predecessors, predecessor);
+  assert(it != predecessors.end());
+  return it - predecessors.begin();
+}
+
+SsaBlock* SsaGraph::createBlock()
+{
+  return mBlocks.emplace_back(std::make_unique<SsaBlock>(static_cast<uint32_t>(mBlocks.size()))).get();
+}
+
+SsaValue* SsaGraph::create(SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate)
+{
+  return mValues.emplace_back(std::make_unique<SsaValue>(static_cast<uint32_t>(mValues.size()), opcode, std::move(inputs), immediate)).get();
+}
+
+SsaValue* SsaGraph::append(SsaBlock* block, SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate)
+{
+  SsaValue* value = this->create(opcode, std::move(inputs), immediate);
+  value->block = block;
+  block->instructions.push_back(value);
+  return value;
+}
+
+SsaValue* SsaGraph::constant(uint64_t rawValue)
+{
+  auto [it, inserted] = mConstants.try_emplace(rawValue, nullptr);
+  if (inserted) {
+    it->second = this->create(SsaOpcode::Constant, {}, rawValue);
+  }
+  return it->second;
+}
+
+SsaValue* SsaGraph::parameter(uint16_t slot)
+{
+  auto [it, inserted] = mParameters.try_emplace(slot, nullptr);
+  if (inserted) {
+    it->second = this->create(SsaOpcode::Parameter, {}, slot);
+  }
+  return it->second;
+}
+
+SsaValue* SsaGraph::undefined()
+{
+  if (mUndefined == nullptr) {
+    mUndefined = this->create(SsaOpcode::Undefined, {});
+  }
+  return mUndefined;
+}
+
+FrameState* SsaGraph::createFrameState(FrameState state)
+{
+  return mFrameStates.emplace_back(std::make_unique<FrameState>(std::move(state))).get();
+}
+
+void SsaGraph::addEdge(SsaBlock* from, SsaBlock* to)
+{
+  assert(to->phis.empty() && "Phi inputs must be added together with the edge");
+  from->successors.push_back(to);
+  to->predecessors.push_back(from);
+}
+
+void SsaGraph::removeEdge(SsaBlock* from, SsaBlock* to)
+{
+  size_t index = to->predecessorIndex(from);
+  to->predecessors.erase(to->predecessors.begin() + index);
+  for (SsaValue* phi : to->phis) {
+    phi->inputs.erase(phi->inputs.begin() + index);
+  }
+
+  auto it = std::ranges::find(from->successors, to);
+  assert(it != from->successors.end());
+  from->successors.erase(it);
+}
+
+SsaBlock* SsaGraph::splitEdge(SsaBlock* from, SsaBlock* to)
+{
+  SsaBlock* block = this->createBlock();
+  *std::ranges::find(from->successors, to) = block;
+  to->predecessors[to->predecessorIndex(from)] = block;
+  block->predecessors.push_back(from);
+  block->successors.push_back(to);
+  this->append(block, SsaOpcode::Goto, {});
+  return block;
+}
+
+void SsaGraph::resolveReplacements()
+{
+  auto isReplaced = [](SsaValue* value) {
+    return value->replacement != nullptr;
+  };
+  auto resolveAll = [](std::vector<SsaValue*>& values) {
+    for (SsaValue*& value : values) {
+      value = value->resolve();
+    }
+  };
+
+  for (auto& block : mBlocks) {
+    std::erase_if(block->phis, isReplaced);
+    std::erase_if(block->instructions, isReplaced);
+    for (auto* values : {&block->phis, &block->instructions}) {
+      for (SsaValue* value : *values) {
+        resolveAll(value->inputs);
+        if (value->frameState != nullptr) {
+          resolveAll(value->frameState->locals);
+          resolveAll(value->frameState->stack);
+        }
+      }
+    }
+  }
+}
+
+void SsaGraph::computeDominators()
+{
+  // Iterative depth-first search for the postorder
+  std::vector<SsaBlock*> postorder;
+  std::vector<bool> visited(mBlocks.size(), false);
+  std::vector<std::pair<SsaBlock*, size_t>> stack;
+  stack.emplace_back(mEntry, 0);
+  visited[mEntry->id] = true;
+  while (!stack.empty()) {
+    auto& [block, next] = stack.back();
+    if (next < block->successors.size()) {
+      SsaBlock* successor = block->successors[next++];
+      if (!visited[successor->id]) {
+        visited[successor->id] = true;
+        stack.emplace_back(successor, 0);
+      }
+    } else {
+      postorder.push_back(block);
+      stack.pop_back();
+    }
+  }
+
+  for (auto& block : mBlocks) {
+    if (!visited[block->id]) {
+      while (!block->successors.empty()) {
+        this->removeEdge(block.get(), block->successors.back());
+      }
+    }
+  }
+
+  mOrder.assign(postorder.rbegin(), postorder.rend());
+  for (uint32_t i = 0; i < mOrder.size(); ++i) {
+    mOrder[i]->order = i;
+    mOrder[i]->dominator = nullptr;
+  }
+
+  // Cooper, Harvey and Kennedy: "A Simple, Fast Dominance Algorithm"
+  auto intersect = [](SsaBlock* a, SsaBlock* b) {
+    while (a != b) {
+      while (a->order > b->order) {
+        a = a->dominator;
+      }
+      while (b->order > a->order) {
+        b = b->dominator;
+      }
+    }
+    return a;
+  };
+
+  mEntry->dominator = mEntry;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (SsaBlock* block : mOrder) {
+      if (block == mEntry) {
+        continue;
+      }
+      SsaBlock* dominator = nullptr;
+      for (SsaBlock* predecessor : block->predecessors) {
+        if (predecessor->dominator != nullptr) {
+          dominator = dominator == nullptr ? predecessor : intersect(predecessor, dominator);
+        }
+      }
+      if (dominator != block->dominator) {
+        block->dominator = dominator;
+        changed = true;
+      }
+    }
+  }
+}
+
+bool SsaGraph::dominates(const SsaBlock* dominator, const SsaBlock* block)
+{
+  while (block != dominator) {
+    if (block->dominator == block) {
+      return false;
+    }
+    block = block->dominator;
+  }
+  return true;
+}
@@ -0,0 +1,277 @@
+#ifndef GEEVM_VM_SSAGRAPH_H
+#define GEEVM_VM_SSAGRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace geevm
+{
+
+class SsaBlock;
+struct FrameState;
+
+/// Operations of the optimizing compiler's intermediate representation.
+///
+/// Values are untyped 64-bit words with the representation of interpreter frame slots: ints are zero-extended, longs,
+/// references, floats and doubles are stored as their raw bits. The operation itself determines the width it works
+/// on, so no type information is needed to build the graph.
+enum class SsaOpcode : uint8_t
+{
+  // Value of a local variable at method entry, the immediate is the slot index
+  Parameter,
+  // The immediate is the raw value
+  Constant,
+  // Contents of a slot that is never read, e.g. the second half of a long
+  Undefined,
+  Phi,
+  // Int arithmetic, results are zero-extended
+  IAdd,
+  ISub,
+  IMul,
+  IDiv,
+  IRem,
+  IAnd,
+  IOr,
+  IXor,
+  IShl,
+  IShr,
+  IUShr,
+  INeg,
+  // Long arithmetic, shift counts are ints
+  LAdd,
+  LSub,
+  LMul,
+  LDiv,
+  LRem,
+  LAnd,
+  LOr,
+  LXor,
+  LShl,
+  LShr,
+  LUShr,
+  LNeg,
+  I2L,
+  L2I,
+  I2B,
+  I2C,
+  I2S,
+  LCmp,
+  // Length of an array that is known to be non-null
+  ArrayLength,
+  // Accesses of an array that is known to be non-null at a checked index, the immediate is the `ArrayElementKind`
+  ArrayLoad,
+  ArrayStore,
+  // Runtime checks, which exit to the interpreter at their frame state if they fail
+  NullCheck,
+  BoundsCheck,
+  // Division by zero check, the immediate is 1 for long divisors
+  ZeroCheck,
+  // Block terminators
+  Goto,
+  // Compares its two inputs, the immediate is the `SsaCondition` and 0x100 for 64-bit comparisons. The first successor
+  // is taken if the condition holds.
+  Branch,
+  // Continues execution in the interpreter at the frame state
+  Exit,
+};
+
+/// Element types of array accesses, by their size and extension. Floats and doubles are accessed as their raw bits.
+enum class ArrayElementKind : uint8_t
+{
+  Int,
+  Long,
+  Byte,
+  Char,
+  Short,
+};
+
+/// Signed comparisons of branches.
+enum class SsaCondition : uint8_t
+{
+  Equal,
+  NotEqual,
+  Less,
+  GreaterEqual,
+  Greater,
+  LessEqual,
+};
+
+/// Returns the condition that holds exactly if \p condition does not.
+SsaCondition negate(SsaCondition condition);
+
+/// Returns the condition that holds for swapped operands.
+SsaCondition swapOperands(SsaCondition condition);
+
+/// A value or effect in the graph. Constants, parameters and the undefined value do not belong to a block, all other
+/// values are placed in the phis or instructions of exactly one block.
+class SsaValue
+{
+public:
+  SsaValue(uint32_t id, SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate)
+    : id(id), opcode(opcode), inputs(std::move(inputs)), immediate(immediate)
+  {
+  }
+
+  /// Returns true for operations without side effects that cannot fail, which can be moved, merged or removed.
+  bool isPure() const;
+
+  /// Returns true if the value is materialized where it is used instead of being kept in a register.
+  bool isRematerializable() const
+  {
+    return opcode == SsaOpcode::Constant || opcode == SsaOpcode::Undefined;
+  }
+
+  bool isTerminator() const
+  {
+    return opcode == SsaOpcode::Goto || opcode == SsaOpcode::Branch || opcode == SsaOpcode::Exit;
+  }
+
+  SsaCondition condition() const
+  {
+    return static_cast<SsaCondition>(immediate & 0xFF);
+  }
+
+  bool isWideComparison() const
+  {
+    return (immediate & 0x100) != 0;
+  }
+
+  /// Follows replacements of merged and removed values to the value that is used in their place.
+  SsaValue* resolve();
+
+public:
+  uint32_t id;
+  SsaOpcode opcode;
+  std::vector<SsaValue*> inputs;
+  uint64_t immediate;
+  SsaBlock* block = nullptr;
+  // Interpreter state to continue from if a check fails, and at exits
+  FrameState* frameState = nullptr;
+  // Set if the value was replaced by another one, e.g. a trivial phi
+  SsaValue* replacement = nullptr;
+};
+
+/// The interpreter frame at a bytecode instruction, for exits from compiled code. Slots that are never read hold the
+/// undefined value.
+struct FrameState
+{
+  int64_t pc;
+  std::vector<SsaValue*> locals;
+  std::vector<SsaValue*> stack;
+};
+
+class SsaBlock
+{
+public:
+  explicit SsaBlock(uint32_t id)
+    : id(id)
+  {
+  }
+
+  SsaValue* terminator() const
+  {
+    return instructions.back();
+  }
+
+  /// Index of \p predecessor, which is also the index of its input in all phis.
+  size_t predecessorIndex(const SsaBlock* predecessor) const;
+
+public:
+  uint32_t id;
+  std::vector<SsaBlock*> predecessors;
+  // Branches list the taken successor first
+  std::vector<SsaBlock*> successors;
+  std::vector<SsaValue*> phis;
+  // The last instruction is the terminator
+  std::vector<SsaValue*> instructions;
+  // Immediate dominator and position in reverse postorder, set by `SsaGraph::computeDominators`
+  SsaBlock* dominator = nullptr;
+  uint32_t order = 0;
+};
+
+/// Control flow graph of SSA values of a method and its inlined callees.
+class SsaGraph
+{
+public:
+  SsaBlock* createBlock();
+
+  /// Creates a value that is not yet placed in a block.
+  SsaValue* create(SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate = 0);
+
+  /// Creates \p opcode and appends it to the instructions of \p block.
+  SsaValue* append(SsaBlock* block, SsaOpcode opcode, std::vector<SsaValue*> inputs, uint64_t immediate = 0);
+
+  SsaValue* constant(uint64_t rawValue);
+  SsaValue* parameter(uint16_t slot);
+  SsaValue* undefined();
+
+  FrameState* createFrameState(FrameState state);
+
+  SsaBlock* entry() const
+  {
+    return mEntry;
+  }
+
+  void setEntry(SsaBlock* entry)
+  {
+    mEntry = entry;
+  }
+
+  void addEdge(SsaBlock* from, SsaBlock* to);
+
+  /// Removes the edge between \p from and \p to together with the inputs of the phis of \p to that belong to it.
+  void removeEdge(SsaBlock* from, SsaBlock* to);
+
+  /// Inserts an empty block on the edge between \p from and \p to. The new block takes the place of the edge in the
+  /// successors of \p from and the predecessors of \p to, so the phis of \p to stay valid.
+  SsaBlock* splitEdge(SsaBlock* from, SsaBlock* to);
+
+  /// Removes values that were replaced from their blocks and redirects all uses to their replacements.
+  void resolveReplacements();
+
+  /// Recomputes the reverse postorder of the blocks reachable from the entry and their immediate dominators.
+  /// Unreachable blocks are disconnected from the graph.
+  void computeDominators();
+
+  /// Blocks reachable from the entry in reverse postorder, as of the last `computeDominators`.
+  const std::vector<SsaBlock*>& blocks() const
+  {
+    return mOrder;
+  }
+
+  static bool dominates(const SsaBlock* dominator, const SsaBlock* block);
+
+  /// Highest block id plus one, for tables indexed by block.
+  uint32_t blockCount() const
+  {
+    return static_cast<uint32_t>(mBlocks.size());
+  }
+
+  /// Highest value id plus one, for tables indexed by value.
+  uint32_t valueCount() const
+  {
+    return static_cast<uint32_t>(mValues.size());
+  }
+
+  /// Parameters that were requested, by slot.
+  const std::unordered_map<uint16_t, SsaValue*>& parameters() const
+  {
+    return mParameters;
+  }
+
+private:
+  std::vector<std::unique_ptr<SsaBlock>> mBlocks;
+  std::vector<std::unique_ptr<SsaValue>> mValues;
+  std::vector<std::unique_ptr<FrameState>> mFrameStates;
+  std::unordered_map<uint64_t, SsaValue*> mConstants;
+  std::unordered_map<uint16_t, SsaValue*> mParameters;
+  SsaValue* mUndefined = nullptr;
+  SsaBlock* mEntry = nullptr;
+  std::vector<SsaBlock*> mOrder;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SSAGRAPH_H
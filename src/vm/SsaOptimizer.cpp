@@ -0,0 +1,622 @@
+#include "vm/SsaOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace geevm;
+
+namespace
+{
+
+// Trivial phis
+//==--------------------------------------------------------------------==//
+
+/// Replaces phis that only merge a single value besides themselves by that value, until no such phi is left.
+bool removeTrivialPhis(SsaGraph& graph)
+{
+  bool removedAny = false;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (SsaBlock* block : graph.blocks()) {
+      for (SsaValue* phi : block->phis) {
+        if (phi->replacement != nullptr) {
+          continue;
+        }
+
+        SsaValue* same = nullptr;
+        bool isTrivial = true;
+        for (SsaValue* input : phi->inputs) {
+          input = input->resolve();
+          if (input == phi || input == same) {
+            continue;
+          }
+          if (same != nullptr) {
+            isTrivial = false;
+            break;
+          }
+          same = input;
+        }
+
+        if (isTrivial) {
+          phi->replacement = same != nullptr ? same : graph.undefined();
+          changed = true;
+          removedAny = true;
+        }
+      }
+    }
+  }
+
+  graph.resolveReplacements();
+  return removedAny;
+}
+
+// Constant folding
+//==--------------------------------------------------------------------==//
+
+std::optional<uint64_t> evaluate(SsaOpcode opcode, uint64_t lhs, uint64_t rhs)
+{
+  // Int operations only look at the lower halves and produce zero-extended results
+  auto x = static_cast<uint32_t>(lhs);
+  auto y = static_cast<uint32_t>(rhs);
+  auto signedX = static_cast<int32_t>(x);
+  auto signedY = static_cast<int32_t>(y);
+  auto signedLhs = static_cast<int64_t>(lhs);
+  auto signedRhs = static_cast<int64_t>(rhs);
+
+  switch (opcode) {
+    using enum SsaOpcode;
+    case IAdd: return static_cast<uint32_t>(x + y);
+    case ISub: return static_cast<uint32_t>(x - y);
+    case IMul: return static_cast<uint32_t>(x * y);
+    case IAnd: return x & y;
+    case IOr: return x | y;
+    case IXor: return x ^ y;
+    case IShl: return static_cast<uint32_t>(x << (y & 0x1F));
+    case IShr: return static_cast<uint32_t>(signedX >> (y & 0x1F));
+    case IUShr: return x >> (y & 0x1F);
+    case INeg: return static_cast<uint32_t>(0u - x);
+    case IDiv:
+      if (y == 0) {
+        return std::nullopt;
+      }
+      return signedY == -1 ? static_cast<uint32_t>(0u - x) : static_cast<uint32_t>(signedX / signedY);
+    case IRem:
+      if (y == 0) {
+        return std::nullopt;
+      }
+      return signedY == -1 ? 0 : static_cast<uint32_t>(signedX % signedY);
+    case LAdd: return lhs + rhs;
+    case LSub: return lhs - rhs;
+    case LMul: return lhs * rhs;
+    case LAnd: return lhs & rhs;
+    case LOr: return lhs | rhs;
+    case LXor: return lhs ^ rhs;
+    case LShl: return lhs << (y & 0x3F);
+    case LShr: return static_cast<uint64_t>(signedLhs >> (y & 0x3F));
+    case LUShr: return lhs >> (y & 0x3F);
+    case LNeg: return 0u - lhs;
+    case LDiv:
+      if (rhs == 0) {
+        return std::nullopt;
+      }
+      return signedRhs == -1 ? 0u - lhs : static_cast<uint64_t>(signedLhs / signedRhs);
+    case LRem:
+      if (rhs == 0) {
+        return std::nullopt;
+      }
+      return signedRhs == -1 ? 0 : static_cast<uint64_t>(signedLhs % signedRhs);
+    case I2L: return static_cast<uint64_t>(static_cast<int64_t>(signedX));
+    case L2I: return x;
+    case I2B: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(x)));
+    case I2C: return x & 0xFFFF;
+    case I2S: return static_cast<uint32_t>(static_cast<int32_t>(static_cast<int16_t>(x)));
+    case LCmp: return static_cast<uint32_t>(static_cast<int32_t>(signedLhs > signedRhs) - static_cast<int32_t>(signedLhs < signedRhs));
+    default: return std::nullopt;
+  }
+}
+
+bool evaluateCondition(SsaCondition condition, bool isWide, uint64_t lhs, uint64_t rhs)
+{
+  int64_t x = isWide ? static_cast<int64_t>(lhs) : static_cast<int32_t>(lhs);
+  int64_t y = isWide ? static_cast<int64_t>(rhs) : static_cast<int32_t>(rhs);
+  switch (condition) {
+    using enum SsaCondition;
+    case Equal: return x == y;
+    case NotEqual: return x != y;
+    case Less: return x < y;
+    case GreaterEqual: return x >= y;
+    case Greater: return x > y;
+    case LessEqual: return x <= y;
+  }
+  return false;
+}
+
+/// Folds operations and branches on constants, and removes division checks of constant non-zero divisors. Returns
+/// true if anything changed.
+bool foldConstants(SsaGraph& graph)
+{
+  bool changed = false;
+  bool foldedBranch = false;
+  for (SsaBlock* block : graph.blocks()) {
+    for (SsaValue* value : block->instructions) {
+      for (SsaValue*& input : value->inputs) {
+        input = input->resolve();
+      }
+
+      bool hasConstantInputs = !value->inputs.empty() && std::ranges::all_of(value->inputs, [](SsaValue* input) {
+        return input->opcode == SsaOpcode::Constant;
+      });
+      if (!hasConstantInputs) {
+        continue;
+      }
+
+      uint64_t lhs = value->inputs[0]->immediate;
+      uint64_t rhs = value->inputs.size() > 1 ? value->inputs[1]->immediate : 0;
+      if (value->opcode == SsaOpcode::ZeroCheck) {
+        if (lhs != 0) {
+          value->replacement = graph.undefined();
+          changed = true;
+        }
+      } else if (value->opcode == SsaOpcode::Branch) {
+        bool isTaken = evaluateCondition(value->condition(), value->isWideComparison(), lhs, rhs);
+        SsaBlock* skipped = block->successors[isTaken ? 1 : 0];
+        value->opcode = SsaOpcode::Goto;
+        value->inputs.clear();
+        value->immediate = 0;
+        graph.removeEdge(block, skipped);
+        changed = true;
+        foldedBranch = true;
+      } else if (auto result = evaluate(value->opcode, lhs, rhs); result.has_value()) {
+        value->replacement = graph.constant(*result);
+        changed = true;
+      }
+    }
+  }
+
+  graph.resolveReplacements();
+  if (foldedBranch) {
+    graph.computeDominators();
+  }
+  return changed;
+}
+
+// Redundancy elimination
+//==--------------------------------------------------------------------==//
+
+/// A condition that holds on entry of a block whose only predecessor branches on it.
+struct Fact
+{
+  enum class Kind
+  {
+    // The left-hand side is a non-null reference
+    NonNull,
+    // The left-hand side is less than the right-hand side, as signed ints
+    Less,
+  };
+
+  Kind kind;
+  SsaValue* lhs;
+  SsaValue* rhs;
+};
+
+struct ValueKey
+{
+  SsaOpcode opcode;
+  uint64_t immediate;
+  std::array<SsaValue*, 2> inputs;
+
+  bool operator==(const ValueKey&) const = default;
+};
+
+struct ValueKeyHash
+{
+  size_t operator()(const ValueKey& key) const
+  {
+    size_t hash = std::hash<uint64_t>{}(key.immediate) * 31 + static_cast<size_t>(key.opcode);
+    for (SsaValue* input : key.inputs) {
+      hash = hash * 31 + std::hash<SsaValue*>{}(input);
+    }
+    return hash;
+  }
+};
+
+/// Walks the dominator tree, replacing pure operations and array length loads by equal ones that dominate them, and
+/// removing checks that are known to succeed. The tables of available values and successful checks are scoped to the
+/// dominator subtree of the block that added them.
+class RedundancyElimination
+{
+public:
+  explicit RedundancyElimination(SsaGraph& graph)
+    : mGraph(graph), mChildren(graph.blockCount()), mFacts(graph.blockCount())
+  {
+  }
+
+  void run();
+
+private:
+  void collectFacts(SsaBlock* block);
+  void visit(SsaBlock* block);
+
+  /// Returns true if `lhs < rhs` is known to hold in \p block, for any right-hand side if \p rhs is nullptr.
+  bool isKnownLess(const SsaBlock* block, SsaValue* lhs, SsaValue* rhs) const;
+  bool isNonNegative(SsaValue* value, std::unordered_set<SsaValue*>& visiting) const;
+  bool isInBounds(const SsaBlock* block, SsaValue* index, SsaValue* length) const;
+
+private:
+  SsaGraph& mGraph;
+  // Dominator tree
+  std::vector<std::vector<SsaBlock*>> mChildren;
+  // Facts on entry of every block, by block id
+  std::vector<std::vector<Fact>> mFacts;
+  std::unordered_map<ValueKey, SsaValue*, ValueKeyHash> mAvailable;
+  std::unordered_set<SsaValue*> mNonNull;
+  std::unordered_set<SsaValue*> mNonZero;
+  std::set<std::pair<SsaValue*, SsaValue*>> mCheckedBounds;
+};
+
+void RedundancyElimination::run()
+{
+  for (SsaBlock* block : mGraph.blocks()) {
+    if (block != mGraph.entry()) {
+      mChildren[block->dominator->id].push_back(block);
+    }
+    this->collectFacts(block);
+  }
+
+  this->visit(mGraph.entry());
+  mGraph.resolveReplacements();
+}
+
+void RedundancyElimination::collectFacts(SsaBlock* block)
+{
+  SsaValue* branch = block->terminator();
+  if (branch->opcode != SsaOpcode::Branch) {
+    return;
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    SsaBlock* successor = block->successors[i];
+    if (successor->predecessors.size() != 1) {
+      // The condition does not hold when the successor is entered along other edges
+      continue;
+    }
+
+    SsaCondition condition = i == 0 ? branch->condition() : negate(branch->condition());
+    SsaValue* lhs = branch->inputs[0];
+    SsaValue* rhs = branch->inputs[1];
+    if (branch->isWideComparison()) {
+      if (condition == SsaCondition::NotEqual && rhs->opcode == SsaOpcode::Constant && rhs->immediate == 0) {
+        mFacts[successor->id].push_back(Fact{.kind = Fact::Kind::NonNull, .lhs = lhs, .rhs = nullptr});
+      }
+    } else if (condition == SsaCondition::Less) {
+      mFacts[successor->id].push_back(Fact{.kind = Fact::Kind::Less, .lhs = lhs, .rhs = rhs});
+    } else if (condition == SsaCondition::Greater) {
+      mFacts[successor->id].push_back(Fact{.kind = Fact::Kind::Less, .lhs = rhs, .rhs = lhs});
+    }
+  }
+}
+
+bool RedundancyElimination::isKnownLess(const SsaBlock* block, SsaValue* lhs, SsaValue* rhs) const
+{
+  while (true) {
+    for (const Fact& fact : mFacts[block->id]) {
+      if (fact.kind == Fact::Kind::Less && fact.lhs->resolve() == lhs && (rhs == nullptr || fact.rhs->resolve() == rhs)) {
+        return true;
+      }
+    }
+    if (block->dominator == block) {
+      return false;
+    }
+    block = block->dominator;
+  }
+}
+
+bool RedundancyElimination::isNonNegative(SsaValue* value, std::unordered_set<SsaValue*>& visiting) const
+{
+  auto isNonNegativeConstant = [](SsaValue* value) {
+    return value->opcode == SsaOpcode::Constant && static_cast<int32_t>(value->immediate) >= 0;
+  };
+
+  switch (value->opcode) {
+    case SsaOpcode::Constant: return isNonNegativeConstant(value);
+    case SsaOpcode::ArrayLength:
+    case SsaOpcode::I2C: return true;
+    case SsaOpcode::IAnd: return isNonNegativeConstant(value->inputs[0]) || isNonNegativeConstant(value->inputs[1]);
+    case SsaOpcode::IUShr: return value->inputs[1]->opcode == SsaOpcode::Constant && (value->inputs[1]->immediate & 0x1F) != 0;
+    case SsaOpcode::Phi: {
+      if (!visiting.insert(value).second) {
+        return false;
+      }
+      // Loop counters starting at a non-negative value that are only incremented by one while they are less than
+      // some other int cannot overflow, so they stay non-negative
+      bool result = std::ranges::all_of(value->inputs, [&](SsaValue* input) {
+        input = input->resolve();
+        bool isIncrement = input->opcode == SsaOpcode::IAdd && input->inputs[0]->resolve() == value && input->inputs[1]->opcode == SsaOpcode::Constant &&
+                           input->inputs[1]->immediate == 1;
+        if (isIncrement) {
+          return this->isKnownLess(input->block, value, nullptr);
+        }
+        return this->isNonNegative(input, visiting);
+      });
+      visiting.erase(value);
+      return result;
+    }
+    default: return false;
+  }
+}
+
+bool RedundancyElimination::isInBounds(const SsaBlock* block, SsaValue* index, SsaValue* length) const
+{
+  if (mCheckedBounds.contains({index, length})) {
+    return true;
+  }
+
+  std::unordered_set<SsaValue*> visiting;
+  return this->isKnownLess(block, index, length) && this->isNonNegative(index, visiting);
+}
+
+void RedundancyElimination::visit(SsaBlock* block)
+{
+  std::vector<ValueKey> addedValues;
+  std::vector<SsaValue*> addedNonNull;
+  std::vector<SsaValue*> addedNonZero;
+  std::vector<std::pair<SsaValue*, SsaValue*>> addedBounds;
+
+  auto addNonNull = [&](SsaValue* value) {
+    if (mNonNull.insert(value).second) {
+      addedNonNull.push_back(value);
+    }
+  };
+
+  for (const Fact& fact : mFacts[block->id]) {
+    if (fact.kind == Fact::Kind::NonNull) {
+      addNonNull(fact.lhs->resolve());
+    }
+  }
+
+  for (SsaValue* value : block->instructions) {
+    for (SsaValue*& input : value->inputs) {
+      input = input->resolve();
+    }
+
+    switch (value->opcode) {
+      case SsaOpcode::NullCheck:
+        if (mNonNull.contains(value->inputs[0])) {
+          value->replacement = mGraph.undefined();
+        } else {
+          addNonNull(value->inputs[0]);
+        }
+        break;
+      case SsaOpcode::ZeroCheck:
+        if (mNonZero.contains(value->inputs[0])) {
+          value->replacement = mGraph.undefined();
+        } else if (mNonZero.insert(value->inputs[0]).second) {
+          addedNonZero.push_back(value->inputs[0]);
+        }
+        break;
+      case SsaOpcode::BoundsCheck: {
+        std::pair key{value->inputs[0], value->inputs[1]};
+        if (this->isInBounds(block, key.first, key.second)) {
+          value->replacement = mGraph.undefined();
+        } else if (mCheckedBounds.insert(key).second) {
+          addedBounds.push_back(key);
+        }
+        break;
+      }
+      default:
+        if (value->isPure() || value->opcode == SsaOpcode::ArrayLength) {
+          ValueKey key{.opcode = value->opcode, .immediate = value->immediate, .inputs = {}};
+          std::ranges::copy(value->inputs, key.inputs.begin());
+          auto [it, inserted] = mAvailable.try_emplace(key, value);
+          if (inserted) {
+            addedValues.push_back(key);
+          } else {
+            value->replacement = it->second;
+          }
+        }
+        break;
+    }
+  }
+
+  for (SsaBlock* child : mChildren[block->id]) {
+    this->visit(child);
+  }
+
+  for (const ValueKey& key : addedValues) {
+    mAvailable.erase(key);
+  }
+  for (SsaValue* value : addedNonNull) {
+    mNonNull.erase(value);
+  }
+  for (SsaValue* value : addedNonZero) {
+    mNonZero.erase(value);
+  }
+  for (const auto& key : addedBounds) {
+    mCheckedBounds.erase(key);
+  }
+}
+
+// Loop-invariant code motion
+//==--------------------------------------------------------------------==//
+
+/// Returns true if a null check of \p array is executed on every path to the end of \p block.
+bool isCheckedNonNull(const SsaBlock* block, SsaValue* array)
+{
+  while (true) {
+    for (SsaValue* value : block->instructions) {
+      if (value->opcode == SsaOpcode::NullCheck && value->inputs[0] == array) {
+        return true;
+      }
+    }
+    if (block->dominator == block) {
+      return false;
+    }
+    block = block->dominator;
+  }
+}
+
+/// Hoists the loop-invariant pure operations of the loop with \p header into its preheader, creating the preheader if
+/// the header is entered from a block with multiple successors.
+void hoistLoopInvariants(SsaGraph& graph, SsaBlock* header)
+{
+  // The loop body consists of all blocks that reach a back edge without passing the header
+  std::vector<bool> inLoop(graph.blockCount(), false);
+  std::vector<SsaBlock*> worklist;
+  inLoop[header->id] = true;
+  for (SsaBlock* predecessor : header->predecessors) {
+    if (SsaGraph::dominates(header, predecessor) && !inLoop[predecessor->id]) {
+      inLoop[predecessor->id] = true;
+      worklist.push_back(predecessor);
+    }
+  }
+  while (!worklist.empty()) {
+    SsaBlock* block = worklist.back();
+    worklist.pop_back();
+    for (SsaBlock* predecessor : block->predecessors) {
+      if (!inLoop[predecessor->id]) {
+        inLoop[predecessor->id] = true;
+        worklist.push_back(predecessor);
+      }
+    }
+  }
+
+  SsaBlock* preheader = nullptr;
+  for (SsaBlock* predecessor : header->predecessors) {
+    if (!inLoop[predecessor->id]) {
+      if (preheader != nullptr) {
+        // Multiple entries
+        return;
+      }
+      preheader = predecessor;
+    }
+  }
+  if (preheader == nullptr) {
+    return;
+  }
+  if (preheader->successors.size() != 1) {
+    SsaBlock* split = graph.splitEdge(preheader, header);
+    split->dominator = preheader;
+    header->dominator = split;
+    preheader = split;
+  }
+
+  auto isInvariant = [&](SsaValue* value) {
+    return value->block == nullptr || value->block->id >= inLoop.size() || !inLoop[value->block->id];
+  };
+
+  for (SsaBlock* block : graph.blocks()) {
+    if (!inLoop[block->id]) {
+      continue;
+    }
+
+    std::erase_if(block->instructions, [&](SsaValue* value) {
+      bool canHoist = std::ranges::all_of(value->inputs, isInvariant) &&
+                      (value->isPure() || (value->opcode == SsaOpcode::ArrayLength && isCheckedNonNull(preheader, value->inputs[0])));
+      if (!canHoist) {
+        return false;
+      }
+      value->block = preheader;
+      preheader->instructions.insert(preheader->instructions.end() - 1, value);
+      return true;
+    });
+  }
+}
+
+void hoistLoopInvariants(SsaGraph& graph)
+{
+  std::vector<SsaBlock*> headers;
+  for (SsaBlock* block : graph.blocks()) {
+    if (std::ranges::any_of(block->predecessors, [&](SsaBlock* predecessor) {
+          return SsaGraph::dominates(block, predecessor);
+        })) {
+      headers.push_back(block);
+    }
+  }
+
+  // Inner loops first, so that their invariants can move further out. Dominators are recomputed after every loop, as
+  // a preheader may have been inserted.
+  for (SsaBlock* header : headers | std::views::reverse) {
+    hoistLoopInvariants(graph, header);
+    graph.computeDominators();
+  }
+}
+
+// Dead code elimination
+//==--------------------------------------------------------------------==//
+
+bool hasSideEffects(const SsaValue* value)
+{
+  switch (value->opcode) {
+    case SsaOpcode::ArrayStore:
+    case SsaOpcode::NullCheck:
+    case SsaOpcode::BoundsCheck:
+    case SsaOpcode::ZeroCheck: return true;
+    default: return value->isTerminator();
+  }
+}
+
+void removeDeadValues(SsaGraph& graph)
+{
+  std::vector<bool> isLive(graph.valueCount(), false);
+  std::vector<SsaValue*> worklist;
+  auto markLive = [&](SsaValue* value) {
+    if (!isLive[value->id]) {
+      isLive[value->id] = true;
+      worklist.push_back(value);
+    }
+  };
+
+  for (SsaBlock* block : graph.blocks()) {
+    for (SsaValue* value : block->instructions) {
+      if (hasSideEffects(value)) {
+        markLive(value);
+      }
+    }
+  }
+
+  while (!worklist.empty()) {
+    SsaValue* value = worklist.back();
+    worklist.pop_back();
+    std::ranges::for_each(value->inputs, markLive);
+    if (value->frameState != nullptr) {
+      std::ranges::for_each(value->frameState->locals, markLive);
+      std::ranges::for_each(value->frameState->stack, markLive);
+    }
+  }
+
+  auto isDead = [&](SsaValue* value) {
+    return !isLive[value->id];
+  };
+  for (SsaBlock* block : graph.blocks()) {
+    std::erase_if(block->phis, isDead);
+    std::erase_if(block->instructions, isDead);
+  }
+}
+
+} // namespace
+
+void geevm::optimizeSsaGraph(SsaGraph& graph)
+{
+  graph.computeDominators();
+  removeTrivialPhis(graph);
+
+  // Folding branches removes phi inputs, which may turn phis into constants that can be folded again
+  bool changed = true;
+  while (changed) {
+    changed = foldConstants(graph);
+    changed |= removeTrivialPhis(graph);
+  }
+
+  RedundancyElimination(graph).run();
+  hoistLoopInvariants(graph);
+  removeDeadValues(graph);
+  graph.computeDominators();
+}
@@ -0,0 +1,25 @@
+#ifndef GEEVM_VM_SSAOPTIMIZER_H
+#define GEEVM_VM_SSAOPTIMIZER_H
+
+#include "vm/SsaGraph.h"
+
+namespace geevm
+{
+
+/// Optimizes \p graph in place:
+///
+///  * removes phis that merge a single value,
+///  * folds operations and branches on constants and removes blocks that become unreachable,
+///  * merges equal pure operations and array length loads along the dominator tree,
+///  * removes null checks of references that were already checked or compared against null, and bounds checks of
+///    indices that were already checked or are known to be below the array length, in particular non-negative loop
+///    counters compared against the length in the loop condition,
+///  * hoists loop-invariant pure operations into loop preheaders,
+///  * removes values without uses.
+///
+/// Dominators are up to date afterwards.
+void optimizeSsaGraph(SsaGraph& graph);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SSAOPTIMIZER_H
@@ -806,16 +806,16 @@ StackMap::FrameReferences StackMap::calculateFrameReferences(types::u4 pc)
       case INVOKESPECIAL:
       case INVOKESTATIC: {
         auto index = code.readU2();
-        const JMethod* method = mClass->runtimeConstantPool().getMethodRef(index);
-        for (int i = 0; i < method->descriptor().numParameterSlots(); i++) {
+        MethodDescriptor descriptor = mClass->runtimeConstantPool().methodRefDescriptor(index);
+        for (int i = 0; i < descriptor.numParameterSlots(); i++) {
           sp--;
         }
 
-        if (method->isStatic()) {
+        if (opcode == INVOKESTATIC) {
           sp--;
         }
 
-        auto returnTy = method->descriptor().returnType();
+        auto returnTy = descriptor.returnType();
         if (!returnTy.isVoid()) {
           stackRefs[sp++] = returnTy.getType().isReferenceOrArray();
           if (returnTy.getType().isCategoryTwo()) {
@@ -826,15 +826,15 @@ StackMap::FrameReferences StackMap::calculateFrameReferences(types::u4 pc)
       }
       case INVOKEINTERFACE: {
         auto index = code.readU2();
-        const JMethod* method = mClass->runtimeConstantPool().getMethodRef(index);
+        MethodDescriptor descriptor = mClass->runtimeConstantPool().methodRefDescriptor(index);
 
         code.readU2();
 
-        for (int i = 0; i < method->descriptor().numParameterSlots(); i++) {
+        for (int i = 0; i < descriptor.numParameterSlots(); i++) {
           sp--;
         }
 
-        auto returnTy = method->descriptor().returnType();
+        auto returnTy = descriptor.returnType();
         if (!returnTy.isVoid()) {
           stackRefs[sp++] = returnTy.getType().isReferenceOrArray();
           if (returnTy.getType().isCategoryTwo()) {
@@ -0,0 +1,242 @@
+#include "vm/Superinstructions.h"
+#include "class_file/Opcode.h"
+#include "vm/Class.h"
+#include "vm/Method.h"
+#include "vm/Vm.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <format>
+#include <unordered_map>
+
+using namespace geevm;
+
+namespace
+{
+
+int32_t readS4(const std::vector<types::u1>& bytes, size_t pos)
+{
+  return std::bit_cast<int32_t>(static_cast<uint32_t>((bytes[pos] << 24u) | (bytes[pos + 1] << 16u) | (bytes[pos + 2] << 8u) | bytes[pos + 3]));
+}
+
+/// Returns the length of the instruction at \p pc, including its operands.
+size_t instructionLength(const std::vector<types::u1>& bytes, size_t pc)
+{
+  switch (static_cast<Opcode>(bytes[pc])) {
+    using enum Opcode;
+    case BIPUSH:
+    case LDC:
+    case ILOAD:
+    case LLOAD:
+    case FLOAD:
+    case DLOAD:
+    case ALOAD:
+    case ISTORE:
+    case LSTORE:
+    case FSTORE:
+    case DSTORE:
+    case ASTORE:
+    case RET:
+    case NEWARRAY: return 2;
+    case SIPUSH:
+    case LDC_W:
+    case LDC2_W:
+    case IINC:
+    case IFEQ:
+    case IFNE:
+    case IFLT:
+    case IFGE:
+    case IFGT:
+    case IFLE:
+    case IF_ICMPEQ:
+    case IF_ICMPNE:
+    case IF_ICMPLT:
+    case IF_ICMPGE:
+    case IF_ICMPGT:
+    case IF_ICMPLE:
+    case IF_ACMPEQ:
+    case IF_ACMPNE:
+    case GOTO:
+    case JSR:
+    case GETSTATIC:
+    case PUTSTATIC:
+    case GETFIELD:
+    case PUTFIELD:
+    case INVOKEVIRTUAL:
+    case INVOKESPECIAL:
+    case INVOKESTATIC:
+    case NEW:
+    case ANEWARRAY:
+    case CHECKCAST:
+    case INSTANCEOF:
+    case IFNULL:
+    case IFNONNULL: return 3;
+    case MULTIANEWARRAY: return 4;
+    case INVOKEINTERFACE:
+    case INVOKEDYNAMIC:
+    case GOTO_W:
+    case JSR_W: return 5;
+    case WIDE: return static_cast<Opcode>(bytes[pc + 1]) == IINC ? 6 : 4;
+    case TABLESWITCH: {
+      // The operands are aligned to four bytes from the start of the code
+      size_t operands = (pc + 4) & ~size_t{3};
+      int64_t low = readS4(bytes, operands + 4);
+      int64_t high = readS4(bytes, operands + 8);
+      return operands + 12 + static_cast<size_t>(high - low + 1) * 4 - pc;
+    }
+    case LOOKUPSWITCH: {
+      size_t operands = (pc + 4) & ~size_t{3};
+      auto pairs = static_cast<size_t>(readS4(bytes, operands + 4));
+      return operands + 8 + pairs * 8 - pc;
+    }
+    default: return 1;
+  }
+}
+
+bool isIntLoad(Opcode opcode)
+{
+  return opcode == Opcode::ILOAD || (opcode >= Opcode::ILOAD_0 && opcode <= Opcode::ILOAD_3);
+}
+
+bool isIntConstant(Opcode opcode)
+{
+  return (opcode >= Opcode::ICONST_M1 && opcode <= Opcode::ICONST_5) || opcode == Opcode::BIPUSH || opcode == Opcode::SIPUSH;
+}
+
+/// Returns the variant of a superinstruction starting with a load, given the variant starting with `?load <index>`
+/// and the load opcodes. The `?load_<n>` variants follow the `?load <index>` variant.
+std::optional<Opcode> loadVariant(Opcode load, Opcode genericLoad, Opcode firstShortLoad, Opcode genericVariant)
+{
+  if (load == genericLoad) {
+    return genericVariant;
+  }
+
+  auto n = static_cast<int32_t>(load) - static_cast<int32_t>(firstShortLoad);
+  if (n < 0 || n > 3) {
+    return std::nullopt;
+  }
+
+  return static_cast<Opcode>(static_cast<int32_t>(genericVariant) + 1 + n);
+}
+
+struct Fusion
+{
+  Opcode superinstruction;
+  // Length of the fused instruction sequence
+  size_t length;
+};
+
+std::optional<Fusion> matchSuperinstruction(const std::vector<types::u1>& bytes, size_t pc)
+{
+  // Offsets and opcodes of the (up to) three instructions starting at pc
+  std::array<size_t, 4> starts{pc};
+  std::array<Opcode, 3> opcodes{};
+  size_t count = 0;
+  while (count < 3 && starts[count] < bytes.size()) {
+    opcodes[count] = static_cast<Opcode>(bytes[starts[count]]);
+    starts[count + 1] = starts[count] + instructionLength(bytes, starts[count]);
+    if (starts[count + 1] > bytes.size()) {
+      break;
+    }
+    count++;
+  }
+
+  using enum Opcode;
+  auto fuse = [&](std::optional<Opcode> superinstruction, size_t length) -> std::optional<Fusion> {
+    if (!superinstruction.has_value()) {
+      return std::nullopt;
+    }
+    return Fusion{.superinstruction = *superinstruction, .length = starts[length] - pc};
+  };
+
+  if (count >= 2) {
+    if (opcodes[0] == ALOAD_0 && opcodes[1] == GETFIELD) {
+      return fuse(ALOAD_0_GETFIELD, 2);
+    }
+    if (opcodes[0] == IINC && opcodes[1] == GOTO) {
+      return fuse(IINC_GOTO, 2);
+    }
+    if (opcodes[1] == ARRAYLENGTH) {
+      if (auto fusion = fuse(loadVariant(opcodes[0], ALOAD, ALOAD_0, ALOAD_ARRAYLENGTH), 2)) {
+        return fusion;
+      }
+    }
+  }
+
+  if (count == 3 && isIntLoad(opcodes[0])) {
+    if (isIntLoad(opcodes[1]) && opcodes[2] == IADD) {
+      return fuse(loadVariant(opcodes[0], ILOAD, ILOAD_0, ILOAD_ILOAD_IADD), 3);
+    }
+    if (isIntConstant(opcodes[1]) && opcodes[2] == IF_ICMPGE) {
+      return fuse(loadVariant(opcodes[0], ILOAD, ILOAD_0, ILOAD_ICONST_IF_ICMPGE), 3);
+    }
+  }
+
+  return std::nullopt;
+}
+
+} // namespace
+
+std::optional<std::vector<types::u1>> geevm::fuseSuperinstructions(const std::vector<types::u1>& bytes)
+{
+  std::optional<std::vector<types::u1>> fused;
+
+  size_t pc = 0;
+  while (pc < bytes.size()) {
+    auto fusion = matchSuperinstruction(bytes, pc);
+    if (!fusion.has_value()) {
+      pc += instructionLength(bytes, pc);
+      continue;
+    }
+
+    if (!fused.has_value()) {
+      fused = bytes;
+    }
+    (*fused)[pc] = static_cast<types::u1>(fusion->superinstruction);
+
+    // The following instructions are executed by the superinstruction, so they cannot start another one
+    pc += fusion->length;
+  }
+
+  return fused;
+}
+
+void geevm::printBytecodePairs(Vm& vm, std::ostream& out, size_t count)
+{
+  std::unordered_map<uint32_t, uint64_t> pairCounts;
+  for (const auto& [_, klass] : vm.bootstrapClassLoader().loadedClasses()) {
+    InstanceClass* instanceClass = klass->asInstanceClass();
+    if (instanceClass == nullptr) {
+      continue;
+    }
+
+    for (const auto& [_, method] : instanceClass->methods()) {
+      uint64_t weight = uint64_t{method->invocationCount()} + method->backedgeCount();
+      if (weight == 0 || !method->getMethodInfo().hasCode()) {
+        continue;
+      }
+
+      const std::vector<types::u1>& bytes = method->getCode().bytes();
+      size_t pc = 0;
+      while (pc < bytes.size()) {
+        size_t next = pc + instructionLength(bytes, pc);
+        if (next < bytes.size()) {
+          pairCounts[(uint32_t{bytes[pc]} << 8u) | bytes[next]] += weight;
+        }
+        pc = next;
+      }
+    }
+  }
+
+  std::vector<std::pair<uint32_t, uint64_t>> pairs(pairCounts.begin(), pairCounts.end());
+  std::ranges::sort(pairs, std::greater{}, &std::pair<uint32_t, uint64_t>::second);
+
+  out << std::format("{:>5} {:>16}  {}\n", "num", "#executions", "opcode pair");
+  out << std::string(60, '-') << '\n';
+  for (size_t i = 0; i < std::min(count, pairs.size()); i++) {
+    auto [pair, executions] = pairs[i];
+    out << std::format("{:>4}: {:>16}  {} {}\n", i + 1, executions, opcodeToString(static_cast<Opcode>(pair >> 8u)),
+                       opcodeToString(static_cast<Opcode>(pair & 0xffu)));
+  }
+}
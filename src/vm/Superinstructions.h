@@ -0,0 +1,45 @@
+#ifndef GEEVM_VM_SUPERINSTRUCTIONS_H
+#define GEEVM_VM_SUPERINSTRUCTIONS_H
+
+#include "common/JvmTypes.h"
+
+#include <cstddef>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace geevm
+{
+
+class Vm;
+
+/// Rewrites \p bytes into the bytecode executed by the interpreter, in which frequent instruction sequences are fused
+/// into superinstructions that are dispatched only once. Returns an empty optional if the code contains no such
+/// sequence, so that the interpreter can execute the original bytecode.
+///
+/// Only the first opcode of a sequence is replaced by its superinstruction, all other bytes stay in place and the
+/// superinstruction reads the operands of the fused instructions from their original positions. Bytecode offsets
+/// therefore keep their meaning: exception handler ranges, stack maps and line numbers refer to the same instructions,
+/// the program counter is inside the same instruction as without fusion when an instruction throws, and jumps into
+/// the middle of a sequence, or exits of compiled code there, continue with the original instructions.
+///
+/// The fused sequences are the most frequent opcode pairs and triples of typical code, where `iload` and `aload` stand
+/// for all forms of the instruction and `iconst` for `iconst_<i>`, `bipush` and `sipush`:
+///
+///   aload_0; getfield             ALOAD_0_GETFIELD
+///   iload; iload; iadd            ILOAD[_<n>]_ILOAD_IADD
+///   iload; iconst; if_icmpge      ILOAD[_<n>]_ICONST_IF_ICMPGE
+///   aload; arraylength            ALOAD[_<n>]_ARRAYLENGTH
+///   iinc; goto                    IINC_GOTO
+///
+/// The first instruction is part of the superinstruction opcode, as its opcode is replaced.
+std::optional<std::vector<types::u1>> fuseSuperinstructions(const std::vector<types::u1>& bytes);
+
+/// Prints the \p count most frequent pairs of consecutive opcodes in the methods executed so far, as candidates for
+/// superinstructions. Every pair in the bytecode of a method is weighted by the invocation and backward branch counts
+/// of the method, which approximates how often it was executed without profiling the interpreter itself.
+void printBytecodePairs(Vm& vm, std::ostream& out, size_t count);
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SUPERINSTRUCTIONS_H
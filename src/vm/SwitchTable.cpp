@@ -0,0 +1,75 @@
+#include "vm/SwitchTable.h"
+
+#include "class_file/Opcode.h"
+#include "common/JvmError.h"
+
+#include <cassert>
+#include <numeric>
+
+using namespace geevm;
+
+static int32_t readInt(std::span<const types::u1> code, size_t pos)
+{
+  assert(pos + 4 <= code.size());
+  uint32_t value = (code[pos] << 24u) | (code[pos + 1] << 16u) | (code[pos + 2] << 8u) | code[pos + 3];
+  return static_cast<int32_t>(value);
+}
+
+SwitchTable::SwitchTable(std::span<const types::u1> code, int64_t opcodePos)
+{
+  auto opcode = static_cast<Opcode>(code[opcodePos]);
+  assert(opcode == Opcode::TABLESWITCH || opcode == Opcode::LOOKUPSWITCH);
+  mIsLookup = opcode == Opcode::LOOKUPSWITCH;
+
+  // The payload starts at the next 4-byte boundary after the opcode
+  size_t pos = (opcodePos + 4) & ~int64_t{3};
+
+  mDefaultTarget = opcodePos + readInt(code, pos);
+  pos += 4;
+
+  if (!mIsLookup) {
+    mLow = readInt(code, pos);
+    int32_t high = readInt(code, pos + 4);
+    pos += 8;
+    if (mLow > high) {
+      geevm_panic("tableswitch with 'low' greater than 'high'");
+    }
+
+    size_t count = static_cast<size_t>(int64_t{high} - mLow + 1);
+    mTargets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      mTargets.push_back(opcodePos + readInt(code, pos + 4 * i));
+    }
+
+    return;
+  }
+
+  int32_t numPairs = readInt(code, pos);
+  pos += 4;
+  assert(numPairs >= 0);
+
+  mKeys.reserve(numPairs);
+  mTargets.reserve(numPairs);
+  for (int32_t i = 0; i < numPairs; ++i) {
+    mKeys.push_back(readInt(code, pos + 8 * i));
+    mTargets.push_back(opcodePos + readInt(code, pos + 8 * i + 4));
+  }
+
+  if (!std::ranges::is_sorted(mKeys)) {
+    // The JVM specification requires sorted keys, but the class file may not have been verified
+    std::vector<size_t> order(mKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, {}, [this](size_t i) {
+      return mKeys[i];
+    });
+
+    std::vector<int32_t> keys;
+    std::vector<int64_t> targets;
+    for (size_t i : order) {
+      keys.push_back(mKeys[i]);
+      targets.push_back(mTargets[i]);
+    }
+    mKeys = std::move(keys);
+    mTargets = std::move(targets);
+  }
+}
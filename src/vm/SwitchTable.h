@@ -0,0 +1,54 @@
+#ifndef GEEVM_VM_SWITCHTABLE_H
+#define GEEVM_VM_SWITCHTABLE_H
+
+#include "common/JvmTypes.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace geevm
+{
+
+/// Decoded payload of a `tableswitch` or `lookupswitch` instruction.
+///
+/// Switch payloads are decoded once per instruction and cached in the method, so executing a switch neither
+/// re-reads the padded bytecode nor allocates. Jump targets are stored as absolute bytecode offsets: a `tableswitch`
+/// becomes a direct jump table, a `lookupswitch` a sorted key array searched with binary search.
+class SwitchTable
+{
+public:
+  /// Decodes the switch instruction whose opcode is at \p opcodePos in \p code.
+  SwitchTable(std::span<const types::u1> code, int64_t opcodePos);
+
+  /// Returns the bytecode offset to continue execution at for \p key.
+  int64_t target(int32_t key) const
+  {
+    if (!mIsLookup) {
+      // Wrapping subtraction maps keys below 'low' to large indices, so a single comparison checks both bounds
+      uint32_t index = static_cast<uint32_t>(key) - static_cast<uint32_t>(mLow);
+      return index < mTargets.size() ? mTargets[index] : mDefaultTarget;
+    }
+
+    auto it = std::ranges::lower_bound(mKeys, key);
+    if (it == mKeys.end() || *it != key) {
+      return mDefaultTarget;
+    }
+
+    return mTargets[it - mKeys.begin()];
+  }
+
+private:
+  bool mIsLookup;
+  int64_t mDefaultTarget;
+  // Lowest key of a tableswitch
+  int32_t mLow = 0;
+  // Sorted keys of a lookupswitch
+  std::vector<int32_t> mKeys;
+  std::vector<int64_t> mTargets;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_SWITCHTABLE_H
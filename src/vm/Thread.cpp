@@ -1,5 +1,6 @@
 #include "vm/Thread.h"
 #include "common/Memory.h"
+#include "vm/Backtrace.h"
 #include "vm/Instance.h"
 #include "vm/Interpreter.h"
 #include "vm/Vm.h"
@@ -12,7 +13,7 @@
 using namespace geevm;
 
 JavaThread::JavaThread(Vm& vm)
-  : mVm(vm), mCurrentException(nullptr), mThreadInstance(nullptr)
+  : mVm(vm), mInterpreterFactory(selectInterpreter(vm.settings())), mCurrentException(nullptr), mThreadInstance(nullptr)
 {
   mCallStackSpace = std::unique_ptr<char[]>(new char[vm.settings().maxStackSize]);
   mCallStackTop = mCallStackSpace.get();
@@ -23,7 +24,7 @@ void JavaThread::initialize(const types::JString& name, Instance* threadGroup)
   auto klass = mVm.resolveClass(u"java/lang/Thread");
   assert(klass.has_value());
 
-  mThreadInstance = heap().gc().pin(heap().allocate<ObjectInstance>((*klass)->asInstanceClass())).release();
+  mThreadInstance = heap().gc().immortalRef(heap().allocateImmortal<ObjectInstance>((*klass)->asInstanceClass()));
 
   auto nameInstance = heap().intern(name);
   mThreadInstance->setFieldValue<Instance*>(u"name", u"Ljava/lang/String;", nameInstance.get());
@@ -147,37 +148,65 @@ std::optional<Value> JavaThread::invokeWithArgs(JMethod* method, std::vector<Val
 
 std::optional<Value> JavaThread::executeTopFrame()
 {
-  auto interpreter = createDefaultInterpreter(*this);
+  auto interpreter = mInterpreterFactory(*this);
   return interpreter->execute();
 }
 
 void JavaThread::handleCalleeException(CallFrame* callerFrame)
 {
-  if (mCurrentException != nullptr) {
-    if (callerFrame != nullptr) {
-      auto callerMethod = callerFrame->currentMethod();
-      if (callerMethod->isNative() || callerMethod->getCode().exceptionTable().empty()) {
-        // The caller frame won't be able to handle the exception and pushing the exception to the
-        // operand stack is not safe. Let the caller of the caller handle it.
-        return;
-      }
-      callerFrame->clearOperandStack();
-      callerFrame->pushOperand<Instance*>(mCurrentException.get());
-    } else {
-      auto handler = mThreadInstance->getFieldValue<Instance*>(u"uncaughtExceptionHandler", u"Ljava/lang/Thread$UncaughtExceptionHandler;");
-      auto handlerMethod = handler->getClass()->getVirtualMethod(u"uncaughtException", u"(Ljava/lang/Thread;Ljava/lang/Throwable;)V");
-      assert(handlerMethod.has_value());
-
-      Instance* currentException = mCurrentException.get();
-      this->clearException();
+  if (mCurrentException == nullptr || callerFrame != nullptr) {
+    // Frames still on the call stack return until the exception reaches the frame given by unwindTarget()
+    return;
+  }
+
+  auto handler = mThreadInstance->getFieldValue<Instance*>(u"uncaughtExceptionHandler", u"Ljava/lang/Thread$UncaughtExceptionHandler;");
+  auto handlerMethod = handler->getClass()->getVirtualMethod(u"uncaughtException", u"(Ljava/lang/Thread;Ljava/lang/Throwable;)V");
+  assert(handlerMethod.has_value());
+
+  Instance* currentException = mCurrentException.get();
+  this->clearException();
+
+  mHasUncaughtException = true;
+  this->invokeWithArgs(*handlerMethod, {Value::from(handler), Value::from(mThreadInstance.get()), Value::from(currentException)});
 
-      mHasUncaughtException = true;
-      this->invokeWithArgs(*handlerMethod, {Value::from(handler), Value::from(mThreadInstance.get()), Value::from(currentException)});
+  // TODO: We should exit with exit code 1, but some of our current tests would break
+  std::exit(0);
+}
+
+const JavaThread::UnwindTarget& JavaThread::unwindTarget()
+{
+  assert(mCurrentException != nullptr);
+  if (mUnwindTarget.has_value()) {
+    return *mUnwindTarget;
+  }
 
-      // TODO: We should exit with exit code 1, but some of our current tests would break
-      std::exit(0);
+  JClass* exceptionClass = mCurrentException->getClass();
+  CallFrame* frame = mCurrentFrame;
+  while (frame != nullptr) {
+    JMethod* method = frame->currentMethod();
+    if (method->isNative()) {
+      // Native code observes the pending exception itself
+      break;
+    }
+
+    // The program counter is already past the opcode of the throwing (or, in callers, the invoking) instruction
+    auto handlerPc = method->exceptionHandlers().findHandler(exceptionClass, frame->programCounter() - 1);
+    if (!handlerPc.has_value()) {
+      // The catch type of a handler could not be resolved: the resolution error replaces the current exception and is
+      // propagated to the caller, as the handlers of this method would fail to resolve again
+      this->clearException();
+      this->throwException(handlerPc.error().exception(), handlerPc.error().message());
+      exceptionClass = mCurrentException->getClass();
+    } else if (handlerPc->has_value()) {
+      mUnwindTarget = UnwindTarget{.frame = frame, .handlerPc = *handlerPc};
+      return *mUnwindTarget;
     }
+
+    frame = frame->previous();
   }
+
+  mUnwindTarget = UnwindTarget{.frame = frame, .handlerPc = std::nullopt};
+  return *mUnwindTarget;
 }
 
 std::optional<Value> JavaThread::executeNative(JMethod* method, CallFrame& frame, std::vector<Value> arguments)
@@ -208,10 +237,8 @@ void JavaThread::throwException(Instance* exceptionInstance)
 
   assert(mCurrentException == nullptr && "There is already an exception instance");
   mCurrentException = mVm.heap().gc().pin(exceptionInstance).release();
-  if (!currentFrame().currentMethod()->isNative()) {
-    currentFrame().clearOperandStack();
-    currentFrame().pushOperand(exceptionInstance);
-  }
+  // The exception is pushed onto the operand stack of the catching frame when control reaches its handler
+  mUnwindTarget.reset();
 }
 
 void JavaThread::throwException(const types::JString& name, const types::JString& message)
@@ -222,108 +249,126 @@ void JavaThread::throwException(const types::JString& name, const types::JString
     geevm_panic("failure to resolve exception class");
   }
 
-  GcRootRef<> exceptionInstance = heap().gc().pin(heap().allocate<ObjectInstance>((*klass)->asInstanceClass())).release();
-  GcRootRef<> messageInstance = heap().intern(message);
-  exceptionInstance->setFieldValue(u"detailMessage", u"Ljava/lang/String;", messageInstance.get());
+  Instance* allocated = heap().allocate<ObjectInstance>((*klass)->asInstanceClass());
+  if (allocated == nullptr) {
+    this->throwOutOfMemoryError();
+    return;
+  }
+
+  // The exception stays pinned until it is thrown, as allocating the message and the backtrace may relocate it
+  ScopedGcRootRef<> exceptionInstance = heap().gc().pin(allocated);
+
+  // Messages usually contain runtime values (indices, class names), so they are not interned: an interned string
+  // lives in the immortal region for as long as the VM
+  JavaString* messageInstance = heap().allocateString(message);
+  if (messageInstance == nullptr) {
+    this->throwOutOfMemoryError();
+    return;
+  }
+  exceptionInstance->setFieldValue<Instance*>(u"detailMessage", u"Ljava/lang/String;", messageInstance);
 
-  auto stackTrace = createStackTrace();
-  exceptionInstance->setFieldValue(u"stackTrace", u"[Ljava/lang/StackTraceElement;", stackTrace);
+  // Only the compact backtrace is stored: with 'stackTrace' left null, Throwable creates the stack trace elements
+  // from the backtrace when they are first requested.
+  JavaArray<int64_t>* backtrace = Backtrace::capture(*this);
+  auto* throwable = static_cast<JavaThrowable*>(exceptionInstance.get());
+  throwable->mBacktrace = backtrace;
+  throwable->mDepth = backtrace != nullptr ? Backtrace(backtrace).depth() : 0;
 
   this->throwException(exceptionInstance.get());
 }
 
-void JavaThread::clearException()
+static types::JStringRef implicitExceptionClassName(ImplicitException kind)
 {
-  assert(mCurrentException != nullptr && "There should be an exception instance");
-  heap().gc().release(mCurrentException);
-  mCurrentException = nullptr;
+  switch (kind) {
+    case ImplicitException::NullPointer: return u"java/lang/NullPointerException";
+    case ImplicitException::ArrayIndexOutOfBounds: return u"java/lang/ArrayIndexOutOfBoundsException";
+    case ImplicitException::Arithmetic: return u"java/lang/ArithmeticException";
+  }
+  GEEVM_UNREACHBLE("Unknown implicit exception");
 }
 
-static int32_t getFrameLineNumber(const CallFrame& callFrame)
+void JavaThread::throwImplicitException(ImplicitException kind, const types::JString& message)
 {
-  if (!callFrame.currentMethod()->isNative()) {
-    int32_t lineNumber = -1;
-    size_t pc = callFrame.programCounter();
-    const Code& code = callFrame.currentMethod()->getCode();
-    auto& lineNumbers = code.lineNumberTable();
-    for (size_t i = 0; i < lineNumbers.size(); ++i) {
-      if (i == lineNumbers.size() - 1) {
-        // This is the last entry in the table
-        if (lineNumbers[i].startPc < pc) {
-          lineNumber = lineNumbers[i].lineNumber;
-        }
-      } else if (lineNumbers[i].startPc <= pc && pc <= lineNumbers[i + 1].startPc) {
-        lineNumber = lineNumbers[i].lineNumber;
-      }
+  const VmSettings& settings = mVm.settings();
+  if (settings.omitStackTraceInFastThrow && !currentFrame().currentMethod()->isNative()) {
+    // The program counter is at a fixed position within the throwing instruction, so it identifies the location
+    const types::u1* location = currentFrame().currentMethod()->getCode().bytes().data() + currentFrame().programCounter();
+    uint32_t& count = mImplicitExceptionCounts[location][static_cast<size_t>(kind)];
+    if (count >= settings.fastThrowThreshold) {
+      this->throwException(this->fastThrowException(kind));
+      return;
     }
-
-    if (lineNumber != -1) {
-      return lineNumber;
-    }
-  } else {
-    // -2 is the magic line number in the JDK for native methods
-    return -2;
+    count++;
   }
 
-  // We signify unknown line numbers as -1
-  return -1;
+  this->throwException(types::JString{implicitExceptionClassName(kind)}, message);
 }
 
-Instance* JavaThread::createStackTrace()
+Instance* JavaThread::fastThrowException(ImplicitException kind)
 {
-  auto stackTraceElementCls = resolveClass(u"java/lang/StackTraceElement");
-  assert(stackTraceElementCls);
-  auto stackTraceArrayCls = resolveClass(u"[Ljava/lang/StackTraceElement;");
-  assert(stackTraceArrayCls.has_value());
-
-  auto throwable = resolveClass(u"java/lang/Throwable");
-
-  std::vector<ScopedGcRootRef<>> stackTrace;
-
-  bool include = false;
-
-  std::vector<CallFrame*> callStackVector;
-  for (CallFrame& frame : this->callStack()) {
-    callStackVector.push_back(&frame);
+  Instance*& cached = mFastThrowExceptions.at(static_cast<size_t>(kind));
+  if (cached == nullptr) {
+    cached = this->preallocateException(implicitExceptionClassName(kind), u"");
   }
 
-  for (const CallFrame* framePtr : callStackVector) {
-    const CallFrame& callFrame = *framePtr;
-    if (!callFrame.currentClass()->isInstanceOf(*throwable)) {
-      include = true;
-    }
+  return cached;
+}
 
-    if (include) {
-      auto stackTraceElement = heap().gc().pin(heap().allocate<ObjectInstance>((*stackTraceElementCls)->asInstanceClass()));
-      auto declaringClass = heap().intern(callFrame.currentClass()->javaClassName());
-      auto declaringClassObject = callFrame.currentClass()->classInstance();
-      auto methodName = heap().intern(callFrame.currentMethod()->name());
+void JavaThread::throwOutOfMemoryError()
+{
+  mVm.reportOutOfMemoryError();
 
-      GcRootRef<> sourceFile = nullptr;
-      if (auto sourceFileStr = callFrame.currentClass()->sourceFile(); sourceFileStr) {
-        sourceFile = heap().intern(*sourceFileStr);
-      }
+  // The heap is exhausted, so the error cannot be allocated when it is thrown
+  if (mOutOfMemoryError == nullptr) {
+    mOutOfMemoryError = this->preallocateException(u"java/lang/OutOfMemoryError", u"Java heap space");
+  }
 
-      stackTraceElement->setFieldValue<Instance*>(u"declaringClass", u"Ljava/lang/String;", declaringClass.get());
-      stackTraceElement->setFieldValue<Instance*>(u"declaringClassObject", u"Ljava/lang/Class;", declaringClassObject.get());
-      stackTraceElement->setFieldValue<Instance*>(u"methodName", u"Ljava/lang/String;", methodName.get());
-      stackTraceElement->setFieldValue<Instance*>(u"fileName", u"Ljava/lang/String;", sourceFile.get());
+  this->throwException(mOutOfMemoryError);
+}
 
-      int32_t lineNumber = getFrameLineNumber(callFrame);
-      if (lineNumber != -1) {
-        stackTraceElement->setFieldValue<int32_t>(u"lineNumber", u"I", getFrameLineNumber(callFrame));
-      }
+Instance* JavaThread::preallocateException(types::JStringRef className, types::JStringRef message)
+{
+  auto klass = mVm.resolveClass(types::JString{className});
+  auto stackTraceArrayClass = mVm.resolveClass(u"[Ljava/lang/StackTraceElement;");
+  if (!klass || !stackTraceArrayClass) {
+    geevm_panic("failure to resolve exception class");
+  }
 
-      stackTrace.emplace_back(std::move(stackTraceElement));
-    }
+  // Preallocated exceptions are shared by all throws, so they have an empty stack trace.
+  // Immortal objects are never relocated, so the instance can be cached without pinning it.
+  InstanceClass* exceptionClass = (*klass)->asInstanceClass();
+  auto* exception = heap().allocateImmortal<ObjectInstance>(exceptionClass);
+
+  // The instance is constructed like any other exception, so that the fields initialized by Throwable (the cause and
+  // the list of suppressed exceptions) behave the same
+  exceptionClass->initialize(*this);
+  auto constructor = exceptionClass->getMethod(u"<init>", u"()V");
+  if (mCurrentException != nullptr || !constructor) {
+    geevm_panic("failure to construct preallocated exception");
+  }
+  this->invokeWithArgs(*constructor, {Value::from<Instance*>(exception)});
+  if (mCurrentException != nullptr) {
+    geevm_panic("failure to construct preallocated exception");
   }
 
-  JavaArray<Instance*>* array = heap().allocateArray<Instance*>((*stackTraceArrayCls)->asArrayClass(), stackTrace.size());
-  for (int32_t i = 0; i < stackTrace.size(); i++) {
-    array->setArrayElement(i, stackTrace[i].get());
+  // Drop the backtrace of the construction, the stack trace of a preallocated exception is always empty
+  auto* throwable = static_cast<JavaThrowable*>(static_cast<Instance*>(exception));
+  throwable->mBacktrace = nullptr;
+  throwable->mDepth = 0;
+  throwable->mStackTrace = heap().allocateImmortalArray<Instance*>((*stackTraceArrayClass)->asArrayClass(), 0);
+  if (!message.empty()) {
+    throwable->mDetailMessage = heap().intern(types::JString{message}).get();
   }
 
-  return array;
+  return exception;
+}
+
+void JavaThread::clearException()
+{
+  assert(mCurrentException != nullptr && "There should be an exception instance");
+  heap().gc().release(mCurrentException);
+  mCurrentException = nullptr;
+  mUnwindTarget.reset();
 }
 
 GcRootRef<> JavaThread::addJniHandle(Instance* instance)
@@ -399,6 +444,10 @@ void* JavaThread::allocateCallFrameSpace(size_t allocationSize)
 void JavaThread::popFrame()
 {
   assert(mCurrentFrame != nullptr);
+  if (mUnwindTarget.has_value() && mUnwindTarget->frame == mCurrentFrame) {
+    // A native frame returned with a pending exception, it has to be unwound further
+    mUnwindTarget.reset();
+  }
   mCallStackTop = reinterpret_cast<char*>(mCurrentFrame);
   mCurrentFrame = mCurrentFrame->previous();
 }
@@ -4,9 +4,13 @@
 #include "common/JvmError.h"
 #include "vm/Frame.h"
 #include "vm/GarbageCollector.h"
+#include "vm/Interpreter.h"
 
+#include <array>
 #include <list>
+#include <optional>
 #include <thread>
+#include <unordered_map>
 
 namespace geevm
 {
@@ -14,6 +18,14 @@ namespace geevm
 class JavaHeap;
 class Vm;
 
+/// Exceptions that bytecode instructions throw implicitly, without an explicit `athrow`.
+enum class ImplicitException
+{
+  NullPointer,
+  ArrayIndexOutOfBounds,
+  Arithmetic,
+};
+
 class JavaThread
 {
 public:
@@ -46,6 +58,13 @@ public:
     return mThreadInstance;
   }
 
+  /// Number of instructions executed by this thread per opcode, only counted with `-XX:+CountBytecodes` or
+  /// `-XX:ProfileFile`
+  std::array<uint64_t, 256>& bytecodeCounts()
+  {
+    return mBytecodeCounts;
+  }
+
   // Virtual machine and heap access
   //==------------------------------------------------------------------------==
   JavaHeap& heap();
@@ -75,10 +94,34 @@ public:
 
   void throwException(Instance* exceptionInstance);
   void throwException(const types::JString& name, const types::JString& message = u"");
-  Instance* createStackTrace();
+
+  /// Throws an exception raised implicitly by the bytecode instruction currently executed.
+  ///
+  /// If `VmSettings::omitStackTraceInFastThrow` is set and the current bytecode location already threw this kind of
+  /// exception more than `VmSettings::fastThrowThreshold` times, a preallocated instance without message and with an
+  /// empty stack trace is thrown instead of creating a new exception object.
+  void throwImplicitException(ImplicitException kind, const types::JString& message = u"");
+
+  /// Throws an `OutOfMemoryError` after an allocation on the Java heap failed. The error is preallocated in the immortal
+  /// region, so throwing it does not allocate on the exhausted heap, and it has no stack trace.
+  void throwOutOfMemoryError();
 
   void clearException();
 
+  /// The frame that handles the current exception.
+  struct UnwindTarget
+  {
+    // The catching frame, a native frame that receives the pending exception or nullptr if the exception is uncaught
+    CallFrame* frame;
+    // Bytecode offset of the exception handler, if the catching frame is a Java frame
+    std::optional<types::u2> handlerPc;
+  };
+
+  /// Returns the frame handling the current exception. The target is determined in a single walk over the call stack
+  /// when first requested and is kept until the exception is cleared, so frames between the throwing frame and the
+  /// catching frame only compare against it while returning.
+  const UnwindTarget& unwindTarget();
+
   GcRootRef<> currentException() const
   {
     return mCurrentException;
@@ -92,6 +135,12 @@ public:
   /// Note that this method call is valid only in native frames.
   GcRootRef<Instance> addJniHandle(Instance* instance);
 
+  /// Returns the JNI references of all active native frames, from the outermost to the innermost one.
+  const std::vector<std::vector<GcRootRef<>>>& jniHandles() const
+  {
+    return mJniHandles;
+  }
+
 private:
   /// Executes the topmost frame of the call stack
   std::optional<Value> executeTopFrame();
@@ -106,8 +155,13 @@ private:
   void popFrame();
   void* allocateCallFrameSpace(size_t size);
 
+  Instance* fastThrowException(ImplicitException kind);
+  Instance* preallocateException(types::JStringRef className, types::JStringRef message);
+
 private:
   Vm& mVm;
+  // Interpreter variant for the diagnostics enabled in the VM settings, selected once when the thread is created
+  InterpreterFactory mInterpreterFactory;
   // Method to run and arguments
   JMethod* mMethod = nullptr;
   std::vector<Value> mArguments;
@@ -120,8 +174,18 @@ private:
 
   // Exceptions
   GcRootRef<Instance> mCurrentException;
+  // Frame that catches the current exception, computed on demand
+  std::optional<UnwindTarget> mUnwindTarget;
   // True if the thread is executing an uncaught exception handler
   bool mHasUncaughtException = false;
+  // Number of implicit exceptions thrown per bytecode location and exception kind
+  std::unordered_map<const types::u1*, std::array<uint32_t, 3>> mImplicitExceptionCounts;
+  // Preallocated implicit exceptions for fast throws, allocated in the immortal region on first use
+  std::array<Instance*, 3> mFastThrowExceptions{};
+  // Preallocated on the first failed allocation
+  Instance* mOutOfMemoryError = nullptr;
+  // Executed instructions per opcode, merged over all threads when printed
+  std::array<uint64_t, 256> mBytecodeCounts{};
 
   // List of JNI references
   std::vector<std::vector<GcRootRef<>>> mJniHandles;
@@ -1,6 +1,8 @@
 #include "Vm.h"
 #include "vm/Frame.h"
+#include "vm/HeapDump.h"
 
+#include <fstream>
 #include <iostream>
 
 using namespace geevm;
@@ -20,7 +22,7 @@ void Vm::initialize()
 
   auto threadGroupCls = this->requireClass(u"java/lang/ThreadGroup");
 
-  auto mainThreadGroup = heap().allocate<ObjectInstance>(threadGroupCls->asInstanceClass());
+  auto mainThreadGroup = heap().allocateImmortal<ObjectInstance>(threadGroupCls->asInstanceClass());
   mainThreadGroup->setFieldValue<Instance*>(u"name", u"Ljava/lang/String;", mHeap.intern(u"main").get());
   mainThreadGroup->setFieldValue<int32_t>(u"maxPriority", u"I", 10);
 
@@ -42,6 +44,45 @@ JvmExpected<JClass*> Vm::resolveClass(const types::JString& name)
   return mBootstrapClassLoader.loadClass(name);
 }
 
+ArrayClass* Vm::primitiveArrayClass(PrimitiveType elementType)
+{
+  ArrayClass*& cached = mPrimitiveArrayClasses.at(static_cast<size_t>(elementType));
+  if (cached == nullptr) {
+    auto klass = this->resolveClass(FieldType{elementType, 1}.asArrayType()->className());
+    assert(klass.has_value() && "Primitive array classes must always be resolvable!");
+    cached = (*klass)->asArrayClass();
+  }
+
+  return cached;
+}
+
+JClass* Vm::throwableClass()
+{
+  if (mThrowableClass == nullptr) {
+    auto klass = this->resolveClass(u"java/lang/Throwable");
+    assert(klass.has_value() && "java/lang/Throwable must always be resolvable!");
+    mThrowableClass = *klass;
+  }
+
+  return mThrowableClass;
+}
+
+void Vm::reportOutOfMemoryError()
+{
+  if (!mSettings.heapDumpOnOutOfMemoryError || mHeapDumpedOnOutOfMemoryError) {
+    return;
+  }
+  mHeapDumpedOnOutOfMemoryError = true;
+
+  std::ofstream out(mSettings.heapDumpPath, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "Error: Could not open heap dump file " << mSettings.heapDumpPath << std::endl;
+    return;
+  }
+  std::cerr << "Dumping heap to " << mSettings.heapDumpPath << " ..." << std::endl;
+  writeHeapDump(*this, out);
+}
+
 JClass* Vm::requireClass(const types::JString& name)
 {
   auto klass = this->resolveClass(name);
@@ -61,4 +102,7 @@ void Vm::setUpJavaLangClass()
   classClass->linkFields();
 
   classClass->prepare(mBootstrapClassLoader, mHeap);
+  if (mProfiles.has_value()) {
+    mProfiles->apply(*classClass);
+  }
 }
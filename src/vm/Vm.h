@@ -2,24 +2,72 @@
 #define GEEVM_VM_VM_H
 
 #include "common/JvmError.h"
+#include "vm/AotMethods.h"
+#include "vm/BaselineCompiler.h"
+#include "vm/CodeCache.h"
 #include "vm/Class.h"
 #include "vm/ClassLoader.h"
 #include "vm/Heap.h"
 #include "vm/Interpreter.h"
 #include "vm/NativeMethods.h"
+#include "vm/OptimizingCompiler.h"
+#include "vm/ProfileStore.h"
 #include "vm/Thread.h"
 
+#include <array>
 #include <ranges>
 #include <unordered_map>
 
 namespace geevm
 {
 
+enum class GarbageCollectorKind
+{
+  SemiSpace,
+  Epsilon
+};
+
 struct VmSettings
 {
   bool runGcAfterEveryAllocation = false;
+  // Collect garbage before every call and allocation in the interpreter
+  bool stressGcInInterpreter = false;
   bool noSystemInit = false;
+  GarbageCollectorKind collector = GarbageCollectorKind::SemiSpace;
   size_t maxHeapSize = 2048l * 1024;
+  // Size of the address range reserved by the epsilon collector. Memory is only committed when it is used.
+  size_t epsilonHeapSize = 4l * 1024 * 1024 * 1024;
+  // Write a heap dump to heapDumpPath when the first OutOfMemoryError is thrown
+  bool heapDumpOnOutOfMemoryError = false;
+  std::string heapDumpPath = "java.hprof";
+  // GC event logging, disabled if empty
+  std::optional<GcLogSettings> gcLog = std::nullopt;
+  // Throw preallocated implicit exceptions without stack traces from bytecode locations that throw them frequently
+  bool omitStackTraceInFastThrow = true;
+  // Number of implicit exceptions a single bytecode location throws with full stack traces before fast throws are used
+  uint32_t fastThrowThreshold = 100;
+  // Keep the interpreter state and the topmost operand stack values in registers while executing simple instructions
+  bool useStackCaching = false;
+  // Log every instruction executed by the interpreter
+  bool traceBytecodes = false;
+  // Count the instructions executed by the interpreter per opcode
+  bool countBytecodes = false;
+  // Compile hot methods with the baseline compiler, only effective on x86-64
+  bool useBaselineJit = false;
+  // Number of invocations and backward branches after which a method is compiled
+  uint32_t compileThreshold = 1000;
+  // Recompile hot methods with the optimizing compiler, only effective on x86-64
+  bool useOptimizingJit = false;
+  // Number of invocations and backward branches after which a method is compiled by the optimizing compiler
+  uint32_t optimizeThreshold = 10000;
+  // Generate the code of the optimizing compiler with LLVM, only effective in builds with GEEVM_ENABLE_LLVM
+  bool useLlvmJit = false;
+  // Shared library with methods compiled ahead of time by geevm-aot, only effective on x86-64
+  std::optional<std::string> aotLibrary = std::nullopt;
+  // File the method profiles are restored from at startup and written to at exit
+  std::optional<std::string> profileFile = std::nullopt;
+  // Size of the address range reserved for compiled code
+  size_t codeCacheSize = 32l * 1024 * 1024;
   size_t maxStackSize = 1024l * 1024;
   std::string javaHome = "";
 };
@@ -31,10 +79,44 @@ public:
     : mSettings(std::move(settings)), mBootstrapClassLoader(*this), mHeap(*this)
   {
     mMainThread = mThreads.emplace_back(std::make_unique<JavaThread>(*this)).get();
+    if ((mSettings.useBaselineJit || mSettings.useOptimizingJit) && BaselineCompiler::isSupported()) {
+      mCodeCache.emplace(mSettings.codeCacheSize);
+      if (mSettings.useBaselineJit) {
+        // Baseline loops leave to the interpreter once they become hot enough for the optimizing compiler
+        std::optional<uint32_t> tierUpThreshold;
+        if (mSettings.useOptimizingJit) {
+          tierUpThreshold = mSettings.optimizeThreshold;
+        }
+        mBaselineCompiler.emplace(*mCodeCache, tierUpThreshold);
+      }
+      if (mSettings.useOptimizingJit) {
+        mOptimizingCompiler.emplace(*mCodeCache, mSettings.useLlvmJit);
+      }
+    }
+    if (mSettings.aotLibrary.has_value() && BaselineCompiler::isSupported()) {
+      auto library = DynamicLibrary::open(*mSettings.aotLibrary);
+      if (library == nullptr) {
+        geevm_panic("Could not load AOT library " + *mSettings.aotLibrary);
+      }
+      mAotMethods.emplace(std::move(library));
+    }
+    if (mSettings.profileFile.has_value()) {
+      mProfiles.emplace(ProfileStore::load(*mSettings.profileFile));
+    }
   }
 
   JvmExpected<JClass*> resolveClass(const types::JString& name);
 
+  /// Returns the array class with the given primitive element type, e.g. `[I` for `PrimitiveType::Int`.
+  ArrayClass* primitiveArrayClass(PrimitiveType elementType);
+
+  /// Returns the class `java.lang.Throwable`.
+  JClass* throwableClass();
+
+  /// Called before an OutOfMemoryError is thrown. Writes a heap dump for the first error if
+  /// `-XX:+HeapDumpOnOutOfMemoryError` is enabled.
+  void reportOutOfMemoryError();
+
   void initialize();
 
   JavaHeap& heap()
@@ -69,6 +151,36 @@ public:
     return mSettings;
   }
 
+  /// Returns the code cache shared by all compilers, or nullptr if compilation is disabled.
+  CodeCache* codeCache()
+  {
+    return mCodeCache.has_value() ? &*mCodeCache : nullptr;
+  }
+
+  /// Returns the baseline compiler, or nullptr if it is disabled.
+  BaselineCompiler* baselineCompiler()
+  {
+    return mBaselineCompiler.has_value() ? &*mBaselineCompiler : nullptr;
+  }
+
+  /// Returns the optimizing compiler, or nullptr if it is disabled.
+  OptimizingCompiler* optimizingCompiler()
+  {
+    return mOptimizingCompiler.has_value() ? &*mOptimizingCompiler : nullptr;
+  }
+
+  /// Returns the methods compiled ahead of time, or nullptr if no AOT library is used.
+  AotMethodRegistry* aotMethods()
+  {
+    return mAotMethods.has_value() ? &*mAotMethods : nullptr;
+  }
+
+  /// Returns the profile restored from the previous run, or nullptr if profiles are not persisted.
+  ProfileStore* profiles()
+  {
+    return mProfiles.has_value() ? &*mProfiles : nullptr;
+  }
+
 private:
   /// Resolves and initializes a core class
   JClass* requireClass(const types::JString& name);
@@ -80,6 +192,15 @@ private:
   std::unordered_map<types::JString, std::unique_ptr<JClass>> mLoadedClasses;
   NativeMethodRegistry mNativeMethods;
   JavaHeap mHeap;
+  // Primitive array classes, resolved on first use
+  std::array<ArrayClass*, 8> mPrimitiveArrayClasses{};
+  JClass* mThrowableClass = nullptr;
+  bool mHeapDumpedOnOutOfMemoryError = false;
+  std::optional<CodeCache> mCodeCache;
+  std::optional<BaselineCompiler> mBaselineCompiler;
+  std::optional<OptimizingCompiler> mOptimizingCompiler;
+  std::optional<AotMethodRegistry> mAotMethods;
+  std::optional<ProfileStore> mProfiles;
   // TODO: We only support one thread
   JavaThread* mMainThread = nullptr;
   std::vector<std::unique_ptr<JavaThread>> mThreads;
@@ -0,0 +1,469 @@
+#include "vm/X86Assembler.h"
+
+#include <cassert>
+#include <limits>
+
+using namespace geevm;
+
+static uint8_t regCode(Reg reg)
+{
+  return static_cast<uint8_t>(reg);
+}
+
+static bool isInt8(int32_t value)
+{
+  return value >= std::numeric_limits<int8_t>::min() && value <= std::numeric_limits<int8_t>::max();
+}
+
+void X86Assembler::emit(types::u1 byte)
+{
+  mCode.push_back(byte);
+}
+
+void X86Assembler::emit32(uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    this->emit(static_cast<types::u1>(value >> (i * 8)));
+  }
+}
+
+void X86Assembler::emit64(uint64_t value)
+{
+  this->emit32(static_cast<uint32_t>(value));
+  this->emit32(static_cast<uint32_t>(value >> 32));
+}
+
+void X86Assembler::emitRex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool byteRegister)
+{
+  uint8_t rex = (wide ? 0x08 : 0x00) | ((reg & 0x08) >> 1) | ((index & 0x08) >> 2) | ((base & 0x08) >> 3);
+  if (rex != 0 || byteRegister) {
+    this->emit(0x40 | rex);
+  }
+}
+
+void X86Assembler::emitOp(bool wide, std::initializer_list<types::u1> opcode, uint8_t reg, Reg rm, bool byteRegister)
+{
+  this->emitRex(wide, reg, 0, regCode(rm), byteRegister);
+  for (types::u1 byte : opcode) {
+    this->emit(byte);
+  }
+  this->emit(0xC0 | ((reg & 0x07) << 3) | (regCode(rm) & 0x07));
+}
+
+void X86Assembler::emitOp(bool wide, std::initializer_list<types::u1> opcode, uint8_t reg, Mem rm, bool byteRegister)
+{
+  uint8_t base = regCode(rm.base);
+  uint8_t index = rm.index.has_value() ? regCode(*rm.index) : 0;
+  this->emitRex(wide, reg, index, base, byteRegister);
+  for (types::u1 byte : opcode) {
+    this->emit(byte);
+  }
+
+  // Without a displacement, RBP and R13 as base would encode RIP-relative addressing, so they use a zero disp8
+  uint8_t mod = rm.displacement == 0 && (base & 0x07) != 0b101 ? 0b00 : isInt8(rm.displacement) ? 0b01 : 0b10;
+  if (rm.index.has_value() || (base & 0x07) == 0b100) {
+    // RSP and R12 as base can only be encoded with a SIB byte, where index 0b100 means no index
+    assert(rm.index != Reg::RSP);
+    uint8_t scaleBits = rm.scale == 8 ? 3 : rm.scale == 4 ? 2 : rm.scale == 2 ? 1 : 0;
+    assert((1u << scaleBits) == rm.scale);
+    uint8_t indexBits = rm.index.has_value() ? (index & 0x07) : 0b100;
+    this->emit((mod << 6) | ((reg & 0x07) << 3) | 0b100);
+    this->emit((scaleBits << 6) | (indexBits << 3) | (base & 0x07));
+  } else {
+    this->emit((mod << 6) | ((reg & 0x07) << 3) | (base & 0x07));
+  }
+
+  if (mod == 0b01) {
+    this->emit(static_cast<types::u1>(rm.displacement));
+  } else if (mod == 0b10) {
+    this->emit32(static_cast<uint32_t>(rm.displacement));
+  }
+}
+
+void X86Assembler::emitRel32(Label& target)
+{
+  if (target.mPosition.has_value()) {
+    auto offset = static_cast<int64_t>(*target.mPosition) - static_cast<int64_t>(mCode.size() + 4);
+    this->emit32(static_cast<uint32_t>(offset));
+  } else {
+    target.mFixups.push_back(mCode.size());
+    this->emit32(0);
+  }
+}
+
+void X86Assembler::bind(Label& label)
+{
+  assert(!label.mPosition.has_value());
+  label.mPosition = mCode.size();
+  for (size_t fixup : label.mFixups) {
+    auto offset = static_cast<uint32_t>(static_cast<int64_t>(mCode.size()) - static_cast<int64_t>(fixup + 4));
+    for (int i = 0; i < 4; ++i) {
+      mCode[fixup + i] = static_cast<types::u1>(offset >> (i * 8));
+    }
+  }
+  label.mFixups.clear();
+}
+
+// Moves
+//==--------------------------------------------------------------------==//
+
+void X86Assembler::mov32(Reg dst, Mem src)
+{
+  this->emitOp(false, {0x8B}, regCode(dst), src);
+}
+
+void X86Assembler::mov64(Reg dst, Mem src)
+{
+  this->emitOp(true, {0x8B}, regCode(dst), src);
+}
+
+void X86Assembler::mov32(Mem dst, Reg src)
+{
+  this->emitOp(false, {0x89}, regCode(src), dst);
+}
+
+void X86Assembler::mov64(Mem dst, Reg src)
+{
+  this->emitOp(true, {0x89}, regCode(src), dst);
+}
+
+void X86Assembler::mov16(Mem dst, Reg src)
+{
+  this->emit(0x66);
+  this->emitOp(false, {0x89}, regCode(src), dst);
+}
+
+void X86Assembler::mov8(Mem dst, Reg src)
+{
+  this->emitOp(false, {0x88}, regCode(src), dst, regCode(src) >= 4);
+}
+
+void X86Assembler::mov32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x89}, regCode(src), dst);
+}
+
+void X86Assembler::mov64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x89}, regCode(src), dst);
+}
+
+void X86Assembler::movImm32(Reg dst, uint32_t imm)
+{
+  this->emitRex(false, 0, 0, regCode(dst), false);
+  this->emit(0xB8 + (regCode(dst) & 0x07));
+  this->emit32(imm);
+}
+
+void X86Assembler::movImm64(Reg dst, uint64_t imm)
+{
+  if (imm <= std::numeric_limits<uint32_t>::max()) {
+    this->movImm32(dst, static_cast<uint32_t>(imm));
+    return;
+  }
+
+  this->emitRex(true, 0, 0, regCode(dst), false);
+  this->emit(0xB8 + (regCode(dst) & 0x07));
+  this->emit64(imm);
+}
+
+void X86Assembler::movsx8(Reg dst, Mem src)
+{
+  this->emitOp(false, {0x0F, 0xBE}, regCode(dst), src);
+}
+
+void X86Assembler::movsx16(Reg dst, Mem src)
+{
+  this->emitOp(false, {0x0F, 0xBF}, regCode(dst), src);
+}
+
+void X86Assembler::movzx16(Reg dst, Mem src)
+{
+  this->emitOp(false, {0x0F, 0xB7}, regCode(dst), src);
+}
+
+void X86Assembler::movsx8(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x0F, 0xBE}, regCode(dst), src, regCode(src) >= 4);
+}
+
+void X86Assembler::movsx16(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x0F, 0xBF}, regCode(dst), src);
+}
+
+void X86Assembler::movzx16(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x0F, 0xB7}, regCode(dst), src);
+}
+
+void X86Assembler::movzx8(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x0F, 0xB6}, regCode(dst), src, regCode(src) >= 4);
+}
+
+void X86Assembler::movsxd(Reg dst, Mem src)
+{
+  this->emitOp(true, {0x63}, regCode(dst), src);
+}
+
+void X86Assembler::movsxd(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x63}, regCode(dst), src);
+}
+
+// Arithmetic
+//==--------------------------------------------------------------------==//
+
+void X86Assembler::add32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x01}, regCode(src), dst);
+}
+
+void X86Assembler::add64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x01}, regCode(src), dst);
+}
+
+void X86Assembler::sub32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x29}, regCode(src), dst);
+}
+
+void X86Assembler::sub64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x29}, regCode(src), dst);
+}
+
+void X86Assembler::and32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x21}, regCode(src), dst);
+}
+
+void X86Assembler::and64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x21}, regCode(src), dst);
+}
+
+void X86Assembler::or32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x09}, regCode(src), dst);
+}
+
+void X86Assembler::or64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x09}, regCode(src), dst);
+}
+
+void X86Assembler::xor32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x31}, regCode(src), dst);
+}
+
+void X86Assembler::xor64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x31}, regCode(src), dst);
+}
+
+void X86Assembler::imul32(Reg dst, Reg src)
+{
+  this->emitOp(false, {0x0F, 0xAF}, regCode(dst), src);
+}
+
+void X86Assembler::imul64(Reg dst, Reg src)
+{
+  this->emitOp(true, {0x0F, 0xAF}, regCode(dst), src);
+}
+
+void X86Assembler::neg32(Reg reg)
+{
+  this->emitOp(false, {0xF7}, 3, reg);
+}
+
+void X86Assembler::neg64(Reg reg)
+{
+  this->emitOp(true, {0xF7}, 3, reg);
+}
+
+void X86Assembler::shl32(Reg reg)
+{
+  this->emitOp(false, {0xD3}, 4, reg);
+}
+
+void X86Assembler::shl64(Reg reg)
+{
+  this->emitOp(true, {0xD3}, 4, reg);
+}
+
+void X86Assembler::shr32(Reg reg)
+{
+  this->emitOp(false, {0xD3}, 5, reg);
+}
+
+void X86Assembler::shr64(Reg reg)
+{
+  this->emitOp(true, {0xD3}, 5, reg);
+}
+
+void X86Assembler::sar32(Reg reg)
+{
+  this->emitOp(false, {0xD3}, 7, reg);
+}
+
+void X86Assembler::sar64(Reg reg)
+{
+  this->emitOp(true, {0xD3}, 7, reg);
+}
+
+void X86Assembler::cdq()
+{
+  this->emit(0x99);
+}
+
+void X86Assembler::cqo()
+{
+  this->emit(0x48);
+  this->emit(0x99);
+}
+
+void X86Assembler::idiv32(Reg divisor)
+{
+  this->emitOp(false, {0xF7}, 7, divisor);
+}
+
+void X86Assembler::idiv64(Reg divisor)
+{
+  this->emitOp(true, {0xF7}, 7, divisor);
+}
+
+void X86Assembler::addImm32(Mem dst, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(false, {0x83}, 0, dst);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(false, {0x81}, 0, dst);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Assembler::addImm64(Reg dst, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(true, {0x83}, 0, dst);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(true, {0x81}, 0, dst);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Assembler::subImm64(Reg dst, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(true, {0x83}, 5, dst);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(true, {0x81}, 5, dst);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+// Comparisons
+//==--------------------------------------------------------------------==//
+
+void X86Assembler::cmp32(Reg lhs, Reg rhs)
+{
+  this->emitOp(false, {0x39}, regCode(rhs), lhs);
+}
+
+void X86Assembler::cmp64(Reg lhs, Reg rhs)
+{
+  this->emitOp(true, {0x39}, regCode(rhs), lhs);
+}
+
+void X86Assembler::cmp32(Reg lhs, Mem rhs)
+{
+  this->emitOp(false, {0x3B}, regCode(lhs), rhs);
+}
+
+void X86Assembler::cmpImm32(Reg lhs, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(false, {0x83}, 7, lhs);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(false, {0x81}, 7, lhs);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Assembler::cmpImm32(Mem lhs, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(false, {0x83}, 7, lhs);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(false, {0x81}, 7, lhs);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Assembler::cmpImm64(Reg lhs, int32_t imm)
+{
+  if (isInt8(imm)) {
+    this->emitOp(true, {0x83}, 7, lhs);
+    this->emit(static_cast<types::u1>(imm));
+  } else {
+    this->emitOp(true, {0x81}, 7, lhs);
+    this->emit32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Assembler::test32(Reg lhs, Reg rhs)
+{
+  this->emitOp(false, {0x85}, regCode(rhs), lhs);
+}
+
+void X86Assembler::test64(Reg lhs, Reg rhs)
+{
+  this->emitOp(true, {0x85}, regCode(rhs), lhs);
+}
+
+void X86Assembler::setcc(Cond cond, Reg dst)
+{
+  this->emitOp(false, {0x0F, static_cast<types::u1>(0x90 | static_cast<uint8_t>(cond))}, 0, dst, regCode(dst) >= 4);
+}
+
+// Control flow
+//==--------------------------------------------------------------------==//
+
+void X86Assembler::push(Reg reg)
+{
+  this->emitRex(false, 0, 0, regCode(reg), false);
+  this->emit(0x50 + (regCode(reg) & 0x07));
+}
+
+void X86Assembler::pop(Reg reg)
+{
+  this->emitRex(false, 0, 0, regCode(reg), false);
+  this->emit(0x58 + (regCode(reg) & 0x07));
+}
+
+void X86Assembler::jmp(Label& target)
+{
+  this->emit(0xE9);
+  this->emitRel32(target);
+}
+
+void X86Assembler::jcc(Cond cond, Label& target)
+{
+  this->emit(0x0F);
+  this->emit(0x80 | static_cast<uint8_t>(cond));
+  this->emitRel32(target);
+}
+
+void X86Assembler::ret()
+{
+  this->emit(0xC3);
+}
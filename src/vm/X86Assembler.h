@@ -0,0 +1,188 @@
+#ifndef GEEVM_VM_X86ASSEMBLER_H
+#define GEEVM_VM_X86ASSEMBLER_H
+
+#include "common/JvmTypes.h"
+
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+
+namespace geevm
+{
+
+/// General purpose x86-64 registers, numbered by their encoding. Registers R8 to R15 are encoded with the REX.R,
+/// REX.X or REX.B prefix bits.
+enum class Reg : uint8_t
+{
+  RAX = 0,
+  RCX = 1,
+  RDX = 2,
+  RBX = 3,
+  RSP = 4,
+  RBP = 5,
+  RSI = 6,
+  RDI = 7,
+  R8 = 8,
+  R9 = 9,
+  R10 = 10,
+  R11 = 11,
+  R12 = 12,
+  R13 = 13,
+  R14 = 14,
+  R15 = 15,
+};
+
+/// Condition codes, encoded as the lower nibble of `jcc` and `setcc` opcodes.
+enum class Cond : uint8_t
+{
+  Below = 0x2,
+  AboveEqual = 0x3,
+  Equal = 0x4,
+  NotEqual = 0x5,
+  BelowEqual = 0x6,
+  Above = 0x7,
+  Less = 0xC,
+  GreaterEqual = 0xD,
+  LessEqual = 0xE,
+  Greater = 0xF,
+};
+
+/// Returns the condition that holds exactly if \p cond does not.
+inline Cond negate(Cond cond)
+{
+  return static_cast<Cond>(static_cast<uint8_t>(cond) ^ 0x1);
+}
+
+/// A memory operand of the form `[base + index * scale + displacement]`. RSP cannot be used as an index.
+struct Mem
+{
+  Reg base;
+  std::optional<Reg> index = std::nullopt;
+  uint8_t scale = 1;
+  int32_t displacement = 0;
+};
+
+/// Minimal x86-64 machine code emitter.
+///
+/// Only the instructions needed by the compilers are supported. Instructions with an operand size suffix of
+/// 32 operate on the lower half of the registers, which zero-extends the result into the full register; instructions
+/// with suffix 64 use the REX.W prefix.
+class X86Assembler
+{
+public:
+  /// A position in the code that jumps can refer to before it is bound.
+  class Label
+  {
+    friend class X86Assembler;
+
+    std::optional<size_t> mPosition;
+    // Offsets of rel32 fields that refer to this label
+    std::vector<size_t> mFixups;
+  };
+
+  void mov32(Reg dst, Mem src);
+  void mov64(Reg dst, Mem src);
+  void mov32(Mem dst, Reg src);
+  void mov64(Mem dst, Reg src);
+  void mov16(Mem dst, Reg src);
+  void mov8(Mem dst, Reg src);
+  void mov32(Reg dst, Reg src);
+  void mov64(Reg dst, Reg src);
+  void movImm32(Reg dst, uint32_t imm);
+  void movImm64(Reg dst, uint64_t imm);
+
+  // Sign- and zero-extending loads into a 32-bit register
+  void movsx8(Reg dst, Mem src);
+  void movsx16(Reg dst, Mem src);
+  void movzx16(Reg dst, Mem src);
+  void movsx8(Reg dst, Reg src);
+  void movsx16(Reg dst, Reg src);
+  void movzx16(Reg dst, Reg src);
+  void movzx8(Reg dst, Reg src);
+  // Sign-extends a 32-bit value into a 64-bit register
+  void movsxd(Reg dst, Mem src);
+  void movsxd(Reg dst, Reg src);
+
+  void add32(Reg dst, Reg src);
+  void add64(Reg dst, Reg src);
+  void sub32(Reg dst, Reg src);
+  void sub64(Reg dst, Reg src);
+  void and32(Reg dst, Reg src);
+  void and64(Reg dst, Reg src);
+  void or32(Reg dst, Reg src);
+  void or64(Reg dst, Reg src);
+  void xor32(Reg dst, Reg src);
+  void xor64(Reg dst, Reg src);
+  void imul32(Reg dst, Reg src);
+  void imul64(Reg dst, Reg src);
+  void neg32(Reg reg);
+  void neg64(Reg reg);
+  // Shifts by the count in CL
+  void shl32(Reg reg);
+  void shl64(Reg reg);
+  void sar32(Reg reg);
+  void sar64(Reg reg);
+  void shr32(Reg reg);
+  void shr64(Reg reg);
+  // Signed division of EDX:EAX (RDX:RAX) by the given register
+  void cdq();
+  void cqo();
+  void idiv32(Reg divisor);
+  void idiv64(Reg divisor);
+  void addImm32(Mem dst, int32_t imm);
+  void addImm64(Reg dst, int32_t imm);
+  void subImm64(Reg dst, int32_t imm);
+
+  void cmp32(Reg lhs, Reg rhs);
+  void cmp64(Reg lhs, Reg rhs);
+  void cmp32(Reg lhs, Mem rhs);
+  void cmpImm32(Reg lhs, int32_t imm);
+  void cmpImm32(Mem lhs, int32_t imm);
+  void cmpImm64(Reg lhs, int32_t imm);
+  void test32(Reg lhs, Reg rhs);
+  void test64(Reg lhs, Reg rhs);
+  void setcc(Cond cond, Reg dst);
+
+  void push(Reg reg);
+  void pop(Reg reg);
+
+  void jmp(Label& target);
+  void jcc(Cond cond, Label& target);
+  void ret();
+
+  /// Binds \p label to the current position and resolves all jumps to it.
+  void bind(Label& label);
+
+  size_t size() const
+  {
+    return mCode.size();
+  }
+
+  /// Returns the emitted code. All labels that were jumped to must be bound.
+  const std::vector<types::u1>& code() const
+  {
+    return mCode;
+  }
+
+private:
+  void emit(types::u1 byte);
+  void emit32(uint32_t value);
+  void emit64(uint64_t value);
+  void emitRel32(Label& target);
+
+  // Emits a REX prefix if one is needed: for 64-bit operations, for extended registers, and for byte operations on
+  // SPL, BPL, SIL and DIL, which would otherwise encode AH, CH, DH and BH.
+  void emitRex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool byteRegister);
+
+  // Emits an instruction with a ModRM byte, where \p reg is either a register or an opcode extension.
+  void emitOp(bool wide, std::initializer_list<types::u1> opcode, uint8_t reg, Reg rm, bool byteRegister = false);
+  void emitOp(bool wide, std::initializer_list<types::u1> opcode, uint8_t reg, Mem rm, bool byteRegister = false);
+
+private:
+  std::vector<types::u1> mCode;
+};
+
+} // namespace geevm
+
+#endif // GEEVM_VM_X86ASSEMBLER_H
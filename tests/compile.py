@@ -39,6 +39,8 @@ if __name__ == "__main__":
     parser.add_argument('-d', '--directory', required=True, type=str)
     parser.add_argument('-m', '--main', type=str)
     parser.add_argument('--no-copy-sources', action='store_true', default=False)
+    parser.add_argument('--vm-arg', action='append', default=[], dest='vm_args', help='pass an option to the VM')
+    parser.add_argument('--aot', action='store_true', help='compile all classes ahead of time with geevm-aot')
     parser.add_argument('-v', '--verbose', action='store_true')
 
     base_dir = os.environ['GEEVM_TEST_BASE_DIR']
@@ -79,6 +81,15 @@ if __name__ == "__main__":
     if jasmin_files:
         execute_jasmin(jasmin_files)
 
+    vm_args = args.vm_args
+    if args.aot:
+        aot_tool_path = f'{os.environ['GEEVM_BINARY_DIR']}/geevm-aot'
+        class_files = [str(path) for path in destdir.glob('./**/*.class')]
+        result = subprocess.run([aot_tool_path, '-o', 'aot.so', *class_files], stderr=subprocess.PIPE, stdout=subprocess.PIPE)
+        if result.returncode != 0:
+            raise RuntimeError("geevm-aot failed: " + result.stderr.decode())
+        vm_args = [*vm_args, '-XX:AOTLibrary', 'aot.so']
+
     # Execute the geevm binary
     java_tool_path = f'{os.environ['GEEVM_BINARY_DIR']}/java'
 
@@ -90,7 +101,7 @@ if __name__ == "__main__":
     else:
         raise RuntimeError("main must be set!")
 
-    java_command = [java_tool_path, main_class]
+    java_command = [java_tool_path, *vm_args, main_class]
     if verbose:
         print(f'Running java command: {java_command}')
     r = subprocess.run(java_command, stdout=sys.stdout, stderr=sys.stderr, cwd=destdir)
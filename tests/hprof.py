@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Prints the stack traces and the instances of selected classes of an HPROF heap dump in a textual form."""
+import argparse
+import struct
+
+# Top-level record tags
+TAG_STRING = 0x01
+TAG_LOAD_CLASS = 0x02
+TAG_STACK_FRAME = 0x04
+TAG_STACK_TRACE = 0x05
+TAG_HEAP_DUMP = 0x0C
+TAG_HEAP_DUMP_SEGMENT = 0x1C
+
+# Heap dump sub-record tags
+ROOT_UNKNOWN = 0xFF
+ROOT_JNI_GLOBAL = 0x01
+ROOT_JNI_LOCAL = 0x02
+ROOT_JAVA_FRAME = 0x03
+ROOT_NATIVE_STACK = 0x04
+ROOT_STICKY_CLASS = 0x05
+ROOT_THREAD_BLOCK = 0x06
+ROOT_MONITOR_USED = 0x07
+ROOT_THREAD_OBJECT = 0x08
+CLASS_DUMP = 0x20
+INSTANCE_DUMP = 0x21
+OBJECT_ARRAY_DUMP = 0x22
+PRIMITIVE_ARRAY_DUMP = 0x23
+
+# Basic types: (size, struct format, name)
+BASIC_TYPES = {
+    2: (None, None, 'object'),
+    4: (1, '>?', 'boolean'),
+    5: (2, '>H', 'char'),
+    6: (4, '>f', 'float'),
+    7: (8, '>d', 'double'),
+    8: (1, '>b', 'byte'),
+    9: (2, '>h', 'short'),
+    10: (4, '>i', 'int'),
+    11: (8, '>q', 'long'),
+}
+
+
+class Reader:
+    def __init__(self, data: bytes, id_size: int = 8):
+        self.data = data
+        self.pos = 0
+        self.id_size = id_size
+
+    def at_end(self) -> bool:
+        return self.pos >= len(self.data)
+
+    def bytes(self, size: int) -> bytes:
+        result = self.data[self.pos:self.pos + size]
+        if len(result) != size:
+            raise ValueError(f'truncated heap dump at offset {self.pos}')
+        self.pos += size
+        return result
+
+    def unpack(self, fmt: str):
+        return struct.unpack(fmt, self.bytes(struct.calcsize(fmt)))[0]
+
+    def u1(self) -> int:
+        return self.unpack('>B')
+
+    def u2(self) -> int:
+        return self.unpack('>H')
+
+    def u4(self) -> int:
+        return self.unpack('>I')
+
+    def i4(self) -> int:
+        return self.unpack('>i')
+
+    def id(self) -> int:
+        return int.from_bytes(self.bytes(self.id_size), 'big')
+
+    def value(self, basic_type: int):
+        size, fmt, _ = BASIC_TYPES[basic_type]
+        if size is None:
+            return self.id()
+        return self.unpack(fmt)
+
+
+class HeapDump:
+    def __init__(self):
+        self.strings = {}
+        self.class_names = {}
+        self.class_serials = {}
+        self.frames = {}
+        self.traces = []
+        # class id -> (super class id, [(field name, basic type)])
+        self.class_dumps = {}
+        # (object id, class id, raw field values)
+        self.instances = []
+
+    def parse(self, data: bytes):
+        header_end = data.index(b'\0')
+        if data[:header_end] != b'JAVA PROFILE 1.0.2':
+            raise ValueError('not an HPROF 1.0.2 file')
+        reader = Reader(data)
+        reader.pos = header_end + 1
+        reader.id_size = reader.u4()
+        reader.bytes(8)
+
+        while not reader.at_end():
+            tag = reader.u1()
+            reader.u4()
+            length = reader.u4()
+            body = Reader(reader.bytes(length), reader.id_size)
+            if tag == TAG_STRING:
+                string_id = body.id()
+                self.strings[string_id] = body.bytes(length - reader.id_size).decode('utf-8')
+            elif tag == TAG_LOAD_CLASS:
+                serial = body.u4()
+                class_id = body.id()
+                body.u4()
+                name = self.strings[body.id()]
+                self.class_names[class_id] = name
+                self.class_serials[serial] = name
+            elif tag == TAG_STACK_FRAME:
+                frame_id = body.id()
+                method = self.strings[body.id()]
+                signature = self.strings[body.id()]
+                source_file = self.strings[body.id()]
+                class_serial = body.u4()
+                line = body.i4()
+                self.frames[frame_id] = (self.class_serials.get(class_serial, '?'), method, signature, source_file, line)
+            elif tag == TAG_STACK_TRACE:
+                serial = body.u4()
+                thread_serial = body.u4()
+                frame_ids = [body.id() for _ in range(body.u4())]
+                self.traces.append((serial, thread_serial, frame_ids))
+            elif tag in (TAG_HEAP_DUMP, TAG_HEAP_DUMP_SEGMENT):
+                self.parse_heap_dump(body)
+
+    def parse_heap_dump(self, reader: Reader):
+        while not reader.at_end():
+            subtag = reader.u1()
+            if subtag in (ROOT_UNKNOWN, ROOT_STICKY_CLASS, ROOT_MONITOR_USED):
+                reader.id()
+            elif subtag == ROOT_JNI_GLOBAL:
+                reader.id()
+                reader.id()
+            elif subtag in (ROOT_JNI_LOCAL, ROOT_JAVA_FRAME, ROOT_THREAD_OBJECT):
+                reader.id()
+                reader.u4()
+                reader.u4()
+            elif subtag in (ROOT_NATIVE_STACK, ROOT_THREAD_BLOCK):
+                reader.id()
+                reader.u4()
+            elif subtag == CLASS_DUMP:
+                class_id = reader.id()
+                reader.u4()
+                super_id = reader.id()
+                for _ in range(5):
+                    reader.id()
+                reader.u4()
+                for _ in range(reader.u2()):
+                    reader.u2()
+                    reader.value(reader.u1())
+                for _ in range(reader.u2()):
+                    reader.id()
+                    reader.value(reader.u1())
+                fields = []
+                for _ in range(reader.u2()):
+                    name = self.strings[reader.id()]
+                    fields.append((name, reader.u1()))
+                self.class_dumps[class_id] = (super_id, fields)
+            elif subtag == INSTANCE_DUMP:
+                object_id = reader.id()
+                reader.u4()
+                class_id = reader.id()
+                values = reader.bytes(reader.u4())
+                self.instances.append((object_id, class_id, values))
+            elif subtag == OBJECT_ARRAY_DUMP:
+                reader.id()
+                reader.u4()
+                length = reader.u4()
+                reader.id()
+                reader.bytes(length * reader.id_size)
+            elif subtag == PRIMITIVE_ARRAY_DUMP:
+                reader.id()
+                reader.u4()
+                length = reader.u4()
+                size, _, _ = BASIC_TYPES[reader.u1()]
+                reader.bytes(length * size)
+            else:
+                raise ValueError(f'unknown heap dump sub-record 0x{subtag:02x}')
+
+    def instance_fields(self, class_id: int, values: bytes):
+        """Decodes the field values of an instance dump, starting with the fields declared by its class."""
+        reader = Reader(values, 8)
+        result = []
+        while class_id != 0:
+            super_id, fields = self.class_dumps[class_id]
+            for name, basic_type in fields:
+                result.append((name, reader.value(basic_type)))
+            class_id = super_id
+        if not reader.at_end():
+            raise ValueError('instance dump is larger than its field layout')
+        return result
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('dump')
+    parser.add_argument('--class', dest='classes', action='append', default=[],
+                        help='print the instances of the class with this internal name')
+    args = parser.parse_args()
+
+    with open(args.dump, 'rb') as file:
+        heap_dump = HeapDump()
+        heap_dump.parse(file.read())
+
+    for serial, thread_serial, frame_ids in heap_dump.traces:
+        if not frame_ids:
+            continue
+        print(f'TRACE {serial} thread={thread_serial}')
+        for frame_id in frame_ids:
+            class_name, method, signature, source_file, line = heap_dump.frames[frame_id]
+            print(f'  FRAME {class_name}.{method}{signature} {source_file}:{line}')
+
+    for object_id, class_id, values in heap_dump.instances:
+        class_name = heap_dump.class_names.get(class_id)
+        if class_name not in args.classes:
+            continue
+        fields = ' '.join(f'{name}={value}' for name, value in heap_dump.instance_fields(class_id, values))
+        print(f'INSTANCE {class_name} {fields}')
@@ -18,3 +18,4 @@ config.environment["JASMIN_JAR"] = config.jasmin_jar
 
 config.substitutions.append(('%java', os.path.abspath(os.path.join('../cmake-build-debug', 'java'))))
 config.substitutions.append(('%compile', os.path.join(os.path.dirname(__file__), 'compile.py')))
+config.substitutions.append(('%hprof', os.path.join(os.path.dirname(__file__), 'hprof.py')))
@@ -0,0 +1,46 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.arrays;
+
+import org.geevm.util.Printer;
+
+public class MultiDimensionalArrayShapes {
+
+    public static void main(String[] args) {
+        // Only the first two dimensions are allocated
+        long[][][] partial = new long[2][3][];
+        Printer.println(partial.length);
+        Printer.println(partial[1].length);
+        Printer.println(partial[1][2] == null);
+        // CHECK: 2
+        // CHECK-NEXT: 3
+        // CHECK-NEXT: true
+
+        // A zero-length dimension stops the allocation of inner arrays
+        int[][][] empty = new int[2][0][5];
+        Printer.println(empty[0].length);
+        Printer.println(empty[1].length);
+        // CHECK-NEXT: 0
+        // CHECK-NEXT: 0
+
+        // Every inner array is a distinct object
+        String[][] strings = new String[2][2];
+        strings[0][0] = "a";
+        strings[1][1] = "b";
+        Printer.println(strings[0] != strings[1]);
+        Printer.println(strings[0][0]);
+        Printer.println(strings[1][0] == null);
+        Printer.println(strings[1][1]);
+        // CHECK-NEXT: true
+        // CHECK-NEXT: a
+        // CHECK-NEXT: true
+        // CHECK-NEXT: b
+
+        try {
+            int[][] negative = new int[2][-1];
+        } catch (NegativeArraySizeException ex) {
+            // CHECK-NEXT: Caught NegativeArraySizeException
+            Printer.println("Caught NegativeArraySizeException");
+        }
+    }
+
+}
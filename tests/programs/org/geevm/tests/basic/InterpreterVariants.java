@@ -0,0 +1,57 @@
+// RUN: %compile -d %t --vm-arg=-Xgc-stress-interpreter "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-Xgc-stress-interpreter --vm-arg=-XX:+UseTopOfStackCaching "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+CountBytecodes "%s" | FileCheck --check-prefixes=CHECK,COUNT "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+TraceBytecodes "%s" 2>&1 >/dev/null | FileCheck --check-prefix=TRACE "%s"
+package org.geevm.tests.basic;
+
+import org.geevm.util.Printer;
+
+public class InterpreterVariants {
+
+    int value;
+
+    InterpreterVariants(int value) {
+        this.value = value;
+    }
+
+    static int sum(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum = sum + i;
+        }
+        return sum;
+    }
+
+    // Every allocation and call collects garbage with -Xgc-stress-interpreter, the references in locals and on the
+    // operand stack must survive it
+    static int allocate(int n) {
+        InterpreterVariants[] instances = new InterpreterVariants[n];
+        for (int i = 0; i < n; i++) {
+            instances[i] = new InterpreterVariants(i);
+        }
+        int total = 0;
+        for (InterpreterVariants instance : instances) {
+            total = total + instance.value;
+        }
+        return total;
+    }
+
+    public static void main(String[] args) {
+        Printer.println(sum(100));
+        // CHECK: 4950
+        Printer.println(allocate(50));
+        // CHECK-NEXT: 1225
+    }
+}
+
+// The diagnostic variants execute the original bytecode, so fused superinstructions are reported as their parts
+// COUNT: num #executions opcode
+// COUNT-NOT: {{[A-Z0-9]+_(IADD|GETFIELD|IF_ICMPGE|ARRAYLENGTH|GOTO)}}
+// COUNT: Total
+
+// TRACE: org/geevm/tests/basic/InterpreterVariants.main([Ljava/lang/String;)V @0 BIPUSH
+// TRACE: org/geevm/tests/basic/InterpreterVariants.sum(I)I @0 ICONST_0
+// TRACE: org/geevm/tests/basic/InterpreterVariants.sum(I)I @{{[0-9]+}} ILOAD_1
+// TRACE-NEXT: org/geevm/tests/basic/InterpreterVariants.sum(I)I @{{[0-9]+}} ILOAD_2
+// TRACE-NEXT: org/geevm/tests/basic/InterpreterVariants.sum(I)I @{{[0-9]+}} IADD
+// TRACE: org/geevm/tests/basic/InterpreterVariants.allocate(I)I @{{[0-9]+}} ANEWARRAY
@@ -0,0 +1,98 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=100 "%s" | FileCheck "%s"
+package org.geevm.tests.basic;
+
+import org.geevm.util.Printer;
+
+public class Intrinsics {
+
+    public static void main(String[] args) {
+        // Math
+        Printer.println(Math.sqrt(2.0));
+        // CHECK: 1.41421
+        Printer.println(Math.abs(Integer.MIN_VALUE));
+        // CHECK-NEXT: -2147483648
+        Printer.println(Math.abs(-7L));
+        // CHECK-NEXT: 7
+        Printer.println(Double.doubleToRawLongBits(Math.abs(-0.0)));
+        // CHECK-NEXT: 0
+        Printer.println(Math.min(3, -4));
+        // CHECK-NEXT: -4
+        Printer.println(Math.max(3L, 9L));
+        // CHECK-NEXT: 9
+        Printer.println(Double.doubleToRawLongBits(Math.min(0.0, -0.0)));
+        // CHECK-NEXT: -9223372036854775808
+        Printer.println(Double.doubleToRawLongBits(Math.max(-0.0, 0.0)));
+        // CHECK-NEXT: 0
+        Printer.println(Float.floatToIntBits(Math.min(1.0f, Float.NaN)));
+        // CHECK-NEXT: 2143289344
+        Printer.println(Math.floor(-1.5));
+        // CHECK-NEXT: -2
+        Printer.println(Math.ceil(-1.5));
+        // CHECK-NEXT: -1
+        Printer.println(Math.rint(2.5));
+        // CHECK-NEXT: 2
+        Printer.println(Math.sin(0.0));
+        // CHECK-NEXT: 0
+        Printer.println(Math.cos(0.0));
+        // CHECK-NEXT: 1
+        Printer.println(Math.log10(1000.0));
+        // CHECK-NEXT: 3
+        Printer.println(StrictMath.sqrt(16.0));
+        // CHECK-NEXT: 4
+
+        // Float and Double
+        Printer.println(Float.floatToRawIntBits(1.0f));
+        // CHECK-NEXT: 1065353216
+        Printer.println(Float.intBitsToFloat(0x40490fdb));
+        // CHECK-NEXT: 3.14159
+        Printer.println(Double.doubleToRawLongBits(1.0));
+        // CHECK-NEXT: 4607182418800017408
+        Printer.println(Double.longBitsToDouble(0x400921fb54442d18L));
+        // CHECK-NEXT: 3.14159
+        // NaNs are canonicalized by 'doubleToLongBits' only
+        Printer.println(Double.doubleToLongBits(Double.longBitsToDouble(0x7ff0000000000001L)));
+        // CHECK-NEXT: 9221120237041090560
+        Printer.println(Double.doubleToRawLongBits(Double.longBitsToDouble(0x7ff0000000000001L)));
+        // CHECK-NEXT: 9218868437227405313
+
+        // Integer and Long
+        Printer.println(Integer.bitCount(0xff00ff));
+        // CHECK-NEXT: 16
+        Printer.println(Integer.numberOfLeadingZeros(1));
+        // CHECK-NEXT: 31
+        Printer.println(Integer.numberOfTrailingZeros(0));
+        // CHECK-NEXT: 32
+        Printer.println(Integer.rotateLeft(0x80000001, 1));
+        // CHECK-NEXT: 3
+        Printer.println(Integer.rotateRight(1, 1));
+        // CHECK-NEXT: -2147483648
+        Printer.println(Integer.reverseBytes(0x01020304));
+        // CHECK-NEXT: 67305985
+        Printer.println(Integer.highestOneBit(-1));
+        // CHECK-NEXT: -2147483648
+        Printer.println(Integer.lowestOneBit(100));
+        // CHECK-NEXT: 4
+        Printer.println(Long.bitCount(-1L));
+        // CHECK-NEXT: 64
+        Printer.println(Long.numberOfLeadingZeros(1L));
+        // CHECK-NEXT: 63
+        Printer.println(Long.numberOfTrailingZeros(0L));
+        // CHECK-NEXT: 64
+        Printer.println(Long.rotateLeft(1L, -1));
+        // CHECK-NEXT: -9223372036854775808
+        Printer.println(Long.reverseBytes(1L));
+        // CHECK-NEXT: 72057594037927936
+        Printer.println(Long.highestOneBit(0L));
+        // CHECK-NEXT: 0
+        Printer.println(Long.lowestOneBit(96L));
+        // CHECK-NEXT: 32
+
+        // Identity hash codes
+        Object object = new Object();
+        Printer.println(object.hashCode() == System.identityHashCode(object));
+        // CHECK-NEXT: true
+        Printer.println(System.identityHashCode(null));
+        // CHECK-NEXT: 0
+    }
+}
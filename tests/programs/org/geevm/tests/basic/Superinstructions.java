@@ -0,0 +1,91 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=100 "%s" | FileCheck "%s"
+package org.geevm.tests.basic;
+
+import org.geevm.util.Printer;
+
+public class Superinstructions {
+
+    int value;
+
+    Superinstructions(int value) {
+        this.value = value;
+    }
+
+    // aload_0; getfield
+    int getValue() {
+        return value;
+    }
+
+    // iload_<n>; iconst; if_icmpge, iload_<n>; iload_<n>; iadd and iinc; goto
+    static int triangle(int n) {
+        int sum = 0;
+        for (int i = 0; i < 1000; i++) {
+            if (i >= n) {
+                break;
+            }
+            sum = sum + i;
+        }
+        return sum;
+    }
+
+    // The `iload <index>` and `aload <index>` forms
+    static int manyLocals(int a, int b, int c, int d, int[] array) {
+        int e = a + b;
+        int f = c + d;
+        int g = e + f;
+        for (int i = 0; i < 5; i++) {
+            g = g + e;
+        }
+        return g + array.length;
+    }
+
+    // aload_0; getfield in a static method, where the receiver may be null
+    static int valueOf(Superinstructions instance) {
+        return instance.value;
+    }
+
+    static int length(int[] array) {
+        return array.length;
+    }
+
+    static int wrappingAdd(int a, int b) {
+        return a + b;
+    }
+
+    public static void main(String[] args) {
+        for (int i = 0; i < 200; i++) {
+            triangle(10);
+        }
+        Printer.println(triangle(100));
+        // CHECK: 4950
+        Printer.println(triangle(100000));
+        // CHECK-NEXT: 499500
+
+        Printer.println(manyLocals(1, 2, 3, 4, new int[7]));
+        // CHECK-NEXT: 32
+
+        Printer.println(wrappingAdd(Integer.MAX_VALUE, 1));
+        // CHECK-NEXT: -2147483648
+
+        Printer.println(new Superinstructions(42).getValue());
+        // CHECK-NEXT: 42
+
+        Printer.println(length(new int[3]));
+        // CHECK-NEXT: 3
+
+        try {
+            length(null);
+        } catch (NullPointerException e) {
+            Printer.println("null array");
+        }
+        // CHECK-NEXT: null array
+
+        try {
+            valueOf(null);
+        } catch (NullPointerException e) {
+            Printer.println("null instance");
+        }
+        // CHECK-NEXT: null instance
+    }
+}
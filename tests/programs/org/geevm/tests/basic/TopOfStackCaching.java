@@ -0,0 +1,72 @@
+// RUN: %compile -d %t --vm-arg=-XX:+UseTopOfStackCaching "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+UseTopOfStackCaching --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=100 "%s" | FileCheck "%s"
+package org.geevm.tests.basic;
+
+import org.geevm.util.Printer;
+
+public class TopOfStackCaching {
+
+    static int[] values = new int[]{3, 1, 4, 1, 5, 9, 2, 6};
+
+    static int sum(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum = sum + i;
+        }
+        return sum;
+    }
+
+    static long mix(long a, int b, double c) {
+        long result = a;
+        for (int i = 0; i < 10; i++) {
+            result = (result << 3) ^ (result >>> 7) ^ b;
+            b = (b * 31) + (byte) i;
+        }
+        return result + (long) c;
+    }
+
+    static int dupAndStore(int a, int b) {
+        int[] array = new int[1];
+        // The duplicated value stays cached below the local variable store and is spilled for the array store
+        array[0] = a = b;
+        return array[0] + a;
+    }
+
+    // Cached values are spilled before calls and allocations, so the values below the arguments survive them
+    static int spillAcrossCalls() {
+        int total = 0;
+        for (int i = 0; i < 100; i++) {
+            total = total + values[i % values.length] * (i + sum(i % 5));
+            Object garbage = new int[16];
+        }
+        return total;
+    }
+
+    static int nullChecks(Object value) {
+        if (value == null) {
+            return -1;
+        }
+        return value == values ? 1 : 0;
+    }
+
+    public static void main(String[] args) {
+        Printer.println(sum(1000));
+        // CHECK: 499500
+
+        Printer.println(mix(1234567890123L, 7, 2.5));
+        // CHECK-NEXT: -3279390853678944151
+
+        Printer.println(dupAndStore(1, 2));
+        // CHECK-NEXT: 4
+
+        Printer.println(spillAcrossCalls());
+        // CHECK-NEXT: 19557
+
+        Printer.println(nullChecks(null));
+        // CHECK-NEXT: -1
+        Printer.println(nullChecks(values));
+        // CHECK-NEXT: 1
+        Printer.println(nullChecks(new Object()));
+        // CHECK-NEXT: 0
+    }
+}
@@ -0,0 +1,61 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.controlflow;
+
+import org.geevm.util.Printer;
+
+public class SwitchEdgeCases {
+
+    public static void main(String[] args) {
+        // Sparse keys, including negative and extreme values
+        Printer.println(sparse(Integer.MIN_VALUE));
+        Printer.println(sparse(-1000));
+        Printer.println(sparse(0));
+        Printer.println(sparse(Integer.MAX_VALUE));
+        Printer.println(sparse(1));
+        // CHECK: 1
+        // CHECK-NEXT: 2
+        // CHECK-NEXT: 3
+        // CHECK-NEXT: 4
+        // CHECK-NEXT: 0
+
+        // Dense keys around a negative 'low'
+        Printer.println(dense(-3));
+        Printer.println(dense(-2));
+        Printer.println(dense(0));
+        Printer.println(dense(1));
+        Printer.println(dense(Integer.MIN_VALUE));
+        // CHECK-NEXT: 0
+        // CHECK-NEXT: 20
+        // CHECK-NEXT: 40
+        // CHECK-NEXT: 50
+        // CHECK-NEXT: 0
+
+        // The same switch instruction executed repeatedly
+        int sum = 0;
+        for (int i = -5; i < 5; i++) {
+            sum += dense(i);
+        }
+        Printer.println(sum);
+        // CHECK-NEXT: 140
+    }
+
+    public static int sparse(int key) {
+        switch (key) {
+            case Integer.MIN_VALUE: return 1;
+            case -1000: return 2;
+            case 0: return 3;
+            case Integer.MAX_VALUE: return 4;
+            default: return 0;
+        }
+    }
+
+    public static int dense(int key) {
+        switch (key) {
+            case -2: return 20;
+            case -1: return 30;
+            case 0: return 40;
+            case 1: return 50;
+            default: return 0;
+        }
+    }
+}
@@ -0,0 +1,111 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.exceptions;
+
+import org.geevm.util.Printer;
+
+public class DeepUnwinding {
+    public static void main(String[] args) {
+        // Unwinding through many frames without handlers
+        try {
+            recurse(500);
+        } catch (IllegalStateException ex) {
+            Printer.println(ex.getMessage());
+            // CHECK: bottom
+        }
+
+        // Frames with handlers that do not match the exception are skipped as well
+        try {
+            recurseWithHandlers(100);
+        } catch (IllegalStateException ex) {
+            Printer.println(ex.getMessage());
+            // CHECK-NEXT: bottom
+        }
+
+        // Nested handlers: the innermost matching handler wins
+        Printer.println(nested(0));
+        Printer.println(nested(1));
+        Printer.println(nested(2));
+        // CHECK-NEXT: 1
+        // CHECK-NEXT: 2
+        // CHECK-NEXT: 3
+
+        // Handlers in an intermediate frame catch the exception before outer frames do
+        try {
+            Printer.println(catchInMiddle(50));
+        } catch (RuntimeException ex) {
+            Printer.println(0);
+        }
+        // CHECK-NEXT: 42
+
+        // Finally blocks run on every level
+        counter = 0;
+        try {
+            recurseWithFinally(10);
+        } catch (IllegalStateException ex) {
+            Printer.println(counter);
+            // CHECK-NEXT: 11
+        }
+    }
+
+    static int counter;
+
+    static void recurse(int depth) {
+        if (depth == 0) {
+            throw new IllegalStateException("bottom");
+        }
+        recurse(depth - 1);
+    }
+
+    static void recurseWithHandlers(int depth) {
+        try {
+            recurse(depth);
+        } catch (ArithmeticException ex) {
+            Printer.println(-1);
+        }
+    }
+
+    static int nested(int kind) {
+        try {
+            try {
+                try {
+                    throwKind(kind);
+                } catch (IllegalStateException ex) {
+                    return 1;
+                }
+            } catch (IllegalArgumentException ex) {
+                return 2;
+            }
+        } catch (RuntimeException ex) {
+            return 3;
+        }
+        return 0;
+    }
+
+    static void throwKind(int kind) {
+        switch (kind) {
+            case 0: throw new IllegalStateException();
+            case 1: throw new IllegalArgumentException();
+            default: throw new UnsupportedOperationException();
+        }
+    }
+
+    static int catchInMiddle(int depth) {
+        try {
+            recurse(depth);
+        } catch (IllegalStateException ex) {
+            return 42;
+        }
+        return -1;
+    }
+
+    static void recurseWithFinally(int depth) {
+        try {
+            if (depth == 0) {
+                throw new IllegalStateException();
+            }
+            recurseWithFinally(depth - 1);
+        } finally {
+            counter++;
+        }
+    }
+}
@@ -0,0 +1,63 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.exceptions;
+
+import org.geevm.util.Printer;
+
+public class FastThrow {
+    public static void main(String[] args) {
+        int withStackTrace = 0;
+        int withoutStackTrace = 0;
+        NullPointerException previous = null;
+        boolean reused = true;
+        for (int i = 0; i < 1000; i++) {
+            try {
+                load(null);
+            } catch (NullPointerException ex) {
+                if (ex.getStackTrace().length != 0) {
+                    withStackTrace++;
+                } else {
+                    if (previous != null && previous != ex) {
+                        reused = false;
+                    }
+                    previous = ex;
+                    withoutStackTrace++;
+                }
+            }
+        }
+
+        // After a number of throws from the same location, a preallocated exception is thrown
+        Printer.println(withStackTrace > 0);
+        Printer.println(withoutStackTrace > 0);
+        Printer.println(withStackTrace + withoutStackTrace);
+        Printer.println(reused);
+        // CHECK: true
+        // CHECK-NEXT: true
+        // CHECK-NEXT: 1000
+        // CHECK-NEXT: true
+
+        // The preallocated exception is constructed like other exceptions
+        Printer.println(previous.getCause() == null);
+        previous.addSuppressed(new RuntimeException());
+        Printer.println(previous.getSuppressed().length);
+        // CHECK-NEXT: true
+        // CHECK-NEXT: 1
+
+        // Other locations still throw exceptions with stack traces
+        try {
+            Printer.println(divide(1, 0));
+        } catch (ArithmeticException ex) {
+            Printer.println(ex.getStackTrace().length != 0);
+            Printer.println(ex.getMessage());
+            // CHECK-NEXT: true
+            // CHECK-NEXT: / by zero
+        }
+    }
+
+    public static int load(int[] array) {
+        return array[0];
+    }
+
+    public static int divide(int a, int b) {
+        return a / b;
+    }
+}
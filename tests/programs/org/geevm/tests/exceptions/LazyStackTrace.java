@@ -0,0 +1,40 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.exceptions;
+
+import org.geevm.util.Printer;
+
+public class LazyStackTrace {
+    public static void main(String[] args) {
+        try {
+            thrower();
+        } catch (IllegalStateException ex) {
+            StackTraceElement[] trace = ex.getStackTrace();
+            Printer.println(trace[0].getMethodName());
+            Printer.println(trace[0].getLineNumber());
+            Printer.println(trace[1].getMethodName());
+            Printer.println(trace[1].getLineNumber());
+            // CHECK: thrower
+            // CHECK-NEXT: 34
+            // CHECK-NEXT: main
+            // CHECK-NEXT: 9
+        }
+
+        try {
+            Printer.println(divide(1, 0));
+        } catch (ArithmeticException ex) {
+            StackTraceElement[] trace = ex.getStackTrace();
+            Printer.println(trace[0].getMethodName());
+            Printer.println(trace[0].getLineNumber());
+            // CHECK-NEXT: divide
+            // CHECK-NEXT: 38
+        }
+    }
+
+    public static void thrower() {
+        throw new IllegalStateException("thrown");
+    }
+
+    public static int divide(int a, int b) {
+        return a / b;
+    }
+}
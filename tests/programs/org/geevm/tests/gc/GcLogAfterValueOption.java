@@ -0,0 +1,18 @@
+// RUN: %compile -d %t --vm-arg=-XX:CompileThreshold --vm-arg=100 --vm-arg=-Xlog:gc:stdout "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:HeapDumpPath --vm-arg=%t/exit.hprof --vm-arg=-Xlog:gc:stdout "%s" | FileCheck "%s"
+package org.geevm.tests.gc;
+
+import org.geevm.util.Printer;
+
+public class GcLogAfterValueOption {
+
+    public static void main(String[] args) {
+        // CHECK: before
+        Printer.println("before");
+        System.gc();
+        // CHECK: [gc] GC({{[0-9]+}}) Pause (Explicit)
+        // CHECK: after
+        Printer.println("after");
+    }
+
+}
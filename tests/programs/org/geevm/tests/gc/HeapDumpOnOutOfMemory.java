@@ -0,0 +1,35 @@
+// RUN: %compile -d %t --vm-arg=-XX:+HeapDumpOnOutOfMemoryError --vm-arg=-XX:HeapDumpPath --vm-arg=%t/oom.hprof "%s" | FileCheck --check-prefix=OUT "%s"
+// RUN: %hprof %t/oom.hprof --class org/geevm/tests/gc/HeapDumpOnOutOfMemory | FileCheck "%s"
+package org.geevm.tests.gc;
+
+import org.geevm.util.Printer;
+
+public class HeapDumpOnOutOfMemory {
+
+    int id;
+    long size;
+
+    HeapDumpOnOutOfMemory(int id, long size) {
+        this.id = id;
+        this.size = size;
+    }
+
+    static long[] allocate(int length) {
+        // CHECK: TRACE {{[0-9]+}} thread=1
+        // CHECK-NEXT: FRAME org/geevm/tests/gc/HeapDumpOnOutOfMemory.allocate(I)[J HeapDumpOnOutOfMemory.java:[[@LINE+1]]
+        return new long[length];
+    }
+
+    public static void main(String[] args) {
+        HeapDumpOnOutOfMemory marker = new HeapDumpOnOutOfMemory(42, 1L << 40);
+        try {
+            // CHECK-NEXT: FRAME org/geevm/tests/gc/HeapDumpOnOutOfMemory.main([Ljava/lang/String;)V HeapDumpOnOutOfMemory.java:[[@LINE+1]]
+            allocate(1 << 24);
+        } catch (OutOfMemoryError e) {
+            // OUT: 42
+            Printer.println(marker.id);
+        }
+    }
+
+    // CHECK: INSTANCE org/geevm/tests/gc/HeapDumpOnOutOfMemory {{(id=42 size=1099511627776|size=1099511627776 id=42)}}
+}
@@ -0,0 +1,22 @@
+// RUN: %compile -d %t "%s" 2>& 1 | FileCheck "%s"
+package org.geevm.tests.gc;
+
+import org.geevm.util.Printer;
+
+public class OutOfMemory {
+
+    public static void main(String[] args) {
+        try {
+            long[] array = new long[1 << 24];
+            Printer.println(array.length);
+        } catch (OutOfMemoryError e) {
+            // CHECK: Java heap space
+            Printer.println(e.getMessage());
+        }
+
+        // The heap is usable again once the failed allocation is gone
+        // CHECK-NEXT: 16
+        Printer.println(new long[16].length);
+    }
+
+}
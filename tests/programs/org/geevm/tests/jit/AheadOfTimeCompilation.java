@@ -0,0 +1,52 @@
+// RUN: %compile -d %t --aot "%s" | FileCheck "%s"
+package org.geevm.tests.jit;
+
+import org.geevm.util.Printer;
+
+public class AheadOfTimeCompilation {
+
+    // All methods are compiled ahead of time, so they run compiled code from their first invocation without any JIT
+    public static void main(String[] args) {
+        int[] values = new int[]{-15, -5, 5, 15, 25};
+        Printer.println(sum(values));
+        // CHECK: 25
+
+        Printer.println(triangle(100000));
+        // CHECK-NEXT: 4999950000
+
+        // Failing checks continue in the interpreter, which throws the exception
+        try {
+            Printer.println(divide(7, 0));
+        } catch (ArithmeticException e) {
+            Printer.println("divide by zero");
+        }
+        // CHECK-NEXT: divide by zero
+
+        try {
+            Printer.println(sum(null));
+        } catch (NullPointerException e) {
+            Printer.println("null array");
+        }
+        // CHECK-NEXT: null array
+    }
+
+    static int sum(int[] values) {
+        int sum = 0;
+        for (int i = 0; i < values.length; i++) {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    static long triangle(int n) {
+        long sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += i;
+        }
+        return sum;
+    }
+
+    static int divide(int a, int b) {
+        return a / b;
+    }
+}
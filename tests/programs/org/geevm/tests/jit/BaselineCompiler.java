@@ -0,0 +1,142 @@
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 "%s" | FileCheck "%s"
+// Methods that do not fit into a full code cache stay interpreted
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 --vm-arg=-XX:ReservedCodeCacheSize --vm-arg=4k "%s" | FileCheck "%s"
+package org.geevm.tests.jit;
+
+import org.geevm.util.Printer;
+
+public class BaselineCompiler {
+
+    public static void main(String[] args) {
+        int[] values = new int[]{-15, -5, 5, 15, 25};
+        long[] longs = new long[]{1L << 40, -3L, 7L};
+        byte[] bytes = new byte[]{-128, 127, 1};
+        char[] chars = new char[]{'a', '\uffff'};
+
+        // Every method is called repeatedly, so later calls run compiled code
+        for (int i = 0; i < 3; i++) {
+            Printer.println(sum(values));
+            Printer.println(sumLongs(longs));
+            Printer.println(divide(Integer.MIN_VALUE, -1));
+            Printer.println(remainder(-7, 2));
+            Printer.println(divideLongs(Long.MIN_VALUE, -1L));
+            Printer.println(shifts(-8, 33));
+            Printer.println(compare(3L, 5L));
+            Printer.println(bytes[0] + widen(bytes));
+            Printer.println(charAt(chars, 1));
+            Printer.println(fill(new short[4], (short) -2));
+        }
+        // CHECK: 25
+        // CHECK-NEXT: 1099511627780
+        // CHECK-NEXT: -2147483648
+        // CHECK-NEXT: -1
+        // CHECK-NEXT: -9223372036854775808
+        // CHECK-NEXT: 2147483640
+        // CHECK-NEXT: -1
+        // CHECK-NEXT: -128
+        // CHECK-NEXT: 65535
+        // CHECK-NEXT: -8
+        // CHECK: 25
+        // CHECK: 25
+
+        // Failing runtime checks in compiled code are handled by the interpreter
+        for (int i = 0; i < 3; i++) {
+            try {
+                Printer.println(divide(1, 0));
+            } catch (ArithmeticException e) {
+                Printer.println("divide by zero");
+            }
+            try {
+                Printer.println(sum(null));
+            } catch (NullPointerException e) {
+                Printer.println("null array");
+            }
+            try {
+                Printer.println(charAt(chars, -1));
+            } catch (ArrayIndexOutOfBoundsException e) {
+                Printer.println("index out of bounds");
+            }
+        }
+        // CHECK: divide by zero
+        // CHECK-NEXT: null array
+        // CHECK-NEXT: index out of bounds
+        // CHECK-NEXT: divide by zero
+        // CHECK-NEXT: null array
+        // CHECK-NEXT: index out of bounds
+        // CHECK-NEXT: divide by zero
+        // CHECK-NEXT: null array
+        // CHECK-NEXT: index out of bounds
+
+        // A hot loop calling into the interpreter
+        Printer.println(countVowels("compiled code"));
+        Printer.println(countVowels("interpreter"));
+        Printer.println(countVowels("baseline"));
+        // CHECK-NEXT: 5
+        // CHECK-NEXT: 4
+        // CHECK-NEXT: 4
+    }
+
+    static int sum(int[] values) {
+        int sum = 0;
+        for (int i = 0; i < values.length; i++) {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    static long sumLongs(long[] values) {
+        long sum = 0;
+        for (int i = 0; i < values.length; i++) {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    static int divide(int a, int b) {
+        return a / b;
+    }
+
+    static int remainder(int a, int b) {
+        return a % b;
+    }
+
+    static long divideLongs(long a, long b) {
+        return a / b;
+    }
+
+    static int shifts(int value, int count) {
+        return (value << count) >>> 1;
+    }
+
+    static int compare(long a, long b) {
+        return Long.compare(a, b) < 0 ? -1 : (a == b ? 0 : 1);
+    }
+
+    static int widen(byte[] bytes) {
+        return bytes[1] + bytes[2] - 128;
+    }
+
+    static int charAt(char[] chars, int index) {
+        return chars[index];
+    }
+
+    static int fill(short[] values, short value) {
+        int total = 0;
+        for (int i = 0; i < values.length; i++) {
+            values[i] = value;
+            total += values[i];
+        }
+        return total;
+    }
+
+    static int countVowels(String text) {
+        int count = 0;
+        for (int i = 0; i < text.length(); i++) {
+            char c = text.charAt(i);
+            if (c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u') {
+                count++;
+            }
+        }
+        return count;
+    }
+}
@@ -0,0 +1,49 @@
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 --vm-arg=-XX:+UseOptimizingJIT --vm-arg=-XX:Tier2CompileThreshold --vm-arg=100 "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 --vm-arg=-XX:+UseOptimizingJIT --vm-arg=-XX:+UseLLVMJIT --vm-arg=-XX:Tier2CompileThreshold --vm-arg=100 "%s" | FileCheck "%s"
+package org.geevm.tests.jit;
+
+import org.geevm.util.Printer;
+
+public class OnStackReplacement {
+
+    // The main method is only invoked once, so its loops are compiled while they run: they are entered in baseline
+    // code at their loop header after two backward branches, and in optimized code after a hundred
+    public static void main(String[] args) {
+        long sum = 0;
+        for (int i = 0; i < 100000; i++) {
+            sum += i;
+        }
+        Printer.println(sum);
+        // CHECK: 4999950000
+
+        int hash = 0;
+        for (int i = 0; i < 50000; i++) {
+            hash = hash * 31 + i;
+        }
+        Printer.println(hash);
+        // CHECK-NEXT: -1902014040
+
+        // The inner loop is replaced first, the outer loop is entered at its own header later
+        int even = 0;
+        for (int i = 0; i < 300; i++) {
+            for (int j = 0; j < 300; j++) {
+                if (((i ^ j) & 1) == 0) {
+                    even++;
+                }
+            }
+        }
+        Printer.println(even);
+        // CHECK-NEXT: 45000
+
+        // A failing check leaves the compiled loop with the locals it has computed so far
+        int quotients = 0;
+        try {
+            for (int i = 0; i < 1000; i++) {
+                quotients += 1000 / (i - 300);
+            }
+        } catch (ArithmeticException e) {
+            Printer.println(quotients);
+        }
+        // CHECK-NEXT: -6136
+    }
+}
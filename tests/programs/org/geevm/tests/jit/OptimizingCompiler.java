@@ -0,0 +1,153 @@
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 --vm-arg=-XX:+UseOptimizingJIT --vm-arg=-XX:Tier2CompileThreshold --vm-arg=4 "%s" | FileCheck "%s"
+// RUN: %compile -d %t --vm-arg=-XX:+UseBaselineJIT --vm-arg=-XX:CompileThreshold --vm-arg=2 --vm-arg=-XX:+UseOptimizingJIT --vm-arg=-XX:+UseLLVMJIT --vm-arg=-XX:Tier2CompileThreshold --vm-arg=4 "%s" | FileCheck "%s"
+package org.geevm.tests.jit;
+
+import org.geevm.util.Printer;
+
+public class OptimizingCompiler {
+
+    public static void main(String[] args) {
+        int[] values = new int[]{-15, -5, 5, 15, 25};
+
+        // Methods move to baseline code after two and to optimized code after four invocations and loop iterations, so
+        // the last iteration runs optimized code
+        for (int i = 0; i < 6; i++) {
+            int sum = sum(values);
+            int squares = sumOfSquares(values.length);
+            int fibonacci = fibonacci(40);
+            int scaled = scaledSum(values, 3, 7);
+            int mixed = mix(3, 5, 7);
+            int folded = folded(1);
+            if (i == 5) {
+                Printer.println(sum);
+                Printer.println(squares);
+                Printer.println(fibonacci);
+                Printer.println(scaled);
+                Printer.println(mixed);
+                Printer.println(folded);
+            }
+        }
+        // CHECK: 25
+        // CHECK-NEXT: 30
+        // CHECK-NEXT: 102334155
+        // CHECK-NEXT: 130
+        // CHECK-NEXT: 420
+        // CHECK-NEXT: 9
+
+        // Failing checks leave optimized code with the interpreter frame of the failing instruction, a failing check
+        // in an inlined method continues at its call
+        for (int i = 0; i < 6; i++) {
+            try {
+                Printer.println(quotient(7, i - 5));
+            } catch (ArithmeticException e) {
+                Printer.println("divide by zero");
+            }
+        }
+        // CHECK-NEXT: 0
+        // CHECK-NEXT: 0
+        // CHECK-NEXT: -1
+        // CHECK-NEXT: -2
+        // CHECK-NEXT: -6
+        // CHECK-NEXT: divide by zero
+
+        for (int i = 0; i < 6; i++) {
+            try {
+                Printer.println(elementAt(values, i));
+            } catch (ArrayIndexOutOfBoundsException e) {
+                Printer.println("index out of bounds");
+            }
+        }
+        // CHECK-NEXT: -15
+        // CHECK-NEXT: -5
+        // CHECK-NEXT: 5
+        // CHECK-NEXT: 15
+        // CHECK-NEXT: 25
+        // CHECK-NEXT: index out of bounds
+
+        try {
+            Printer.println(sum(null));
+        } catch (NullPointerException e) {
+            Printer.println("null array");
+        }
+        // CHECK-NEXT: null array
+    }
+
+    static int sum(int[] values) {
+        int sum = 0;
+        for (int i = 0; i < values.length; i++) {
+            sum += values[i];
+        }
+        return sum;
+    }
+
+    static int square(int value) {
+        return value * value;
+    }
+
+    static int sumOfSquares(int n) {
+        int sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += square(i);
+        }
+        return sum;
+    }
+
+    static int fibonacci(int n) {
+        int a = 0;
+        int b = 1;
+        for (int i = 0; i < n; i++) {
+            int next = a + b;
+            a = b;
+            b = next;
+        }
+        return a;
+    }
+
+    static int scaledSum(int[] values, int factor, int scale) {
+        int sum = 0;
+        for (int i = 0; i < values.length; i++) {
+            sum += values[i] + factor * scale;
+        }
+        return sum;
+    }
+
+    static int mix(int a, int b, int c) {
+        int x0 = a + b;
+        int x1 = b + c;
+        int x2 = a * c;
+        int x3 = a - c;
+        int x4 = b * b;
+        int x5 = c - b;
+        int x6 = a ^ c;
+        int x7 = b | c;
+        int x8 = a << 3;
+        int x9 = c >> 1;
+        int x10 = b & 6;
+        int x11 = a * 11;
+        int total = 0;
+        for (int i = 0; i < 3; i++) {
+            total += x0 + x1 + x2 + x3 + x4 + x5 + x6 + x7 + x8 + x9 + x10 + x11 + i;
+        }
+        return total;
+    }
+
+    static int folded(int x) {
+        int k = 4;
+        if (k > 3) {
+            return x + k * 2;
+        }
+        return 0;
+    }
+
+    static int divide(int a, int b) {
+        return a / b;
+    }
+
+    static int quotient(int a, int b) {
+        return divide(a, b) + 1;
+    }
+
+    static int elementAt(int[] values, int index) {
+        return values[index];
+    }
+}
@@ -0,0 +1,81 @@
+// RUN: rm -f %t/profile.txt
+// RUN: %compile -d %t --vm-arg=-XX:ProfileFile --vm-arg=profile.txt "%s" | FileCheck "%s"
+// RUN: FileCheck --check-prefix=FIRST "%s" < %t/profile.txt
+// RUN: %compile -d %t --vm-arg=-XX:ProfileFile --vm-arg=profile.txt "%s" | FileCheck "%s"
+// RUN: FileCheck --check-prefix=SECOND "%s" < %t/profile.txt
+package org.geevm.tests.jit;
+
+import org.geevm.util.Printer;
+
+public class PersistedProfile {
+
+    interface Shape {
+        int area();
+    }
+
+    static class Square implements Shape {
+        int side;
+
+        Square(int side) {
+            this.side = side;
+        }
+
+        public int area() {
+            return side * side;
+        }
+    }
+
+    static class Rectangle implements Shape {
+        int width;
+        int height;
+
+        Rectangle(int width, int height) {
+            this.width = width;
+            this.height = height;
+        }
+
+        public int area() {
+            return width * height;
+        }
+    }
+
+    // The second run restores the counters and branch profiles written by the first one and continues counting
+    // from there, receiver types are recorded anew by the inline caches of each run
+    public static void main(String[] args) {
+        int sum = 0;
+        for (int i = 0; i < 2000; i++) {
+            sum += sign(i - 500);
+        }
+        Printer.println(sum);
+        // CHECK: 1000
+
+        Shape[] shapes = new Shape[]{new Square(3), new Rectangle(2, 5)};
+        int area = 0;
+        for (int i = 0; i < 2000; i++) {
+            area += shapes[i % 2].area();
+        }
+        Printer.println(area);
+        // CHECK-NEXT: 19000
+    }
+
+    static int sign(int x) {
+        if (x < 0) {
+            return -1;
+        }
+        return 1;
+    }
+
+    // FIRST: geevm-profile 1
+    // FIRST-DAG: class org/geevm/tests/jit/PersistedProfile {{[0-9a-f]+}}
+    // FIRST-DAG: method sign (I)I 2000 0
+    // FIRST-DAG: branch 1 1500 500
+    // FIRST-DAG: receiver {{[0-9]+}} org/geevm/tests/jit/PersistedProfile$Square 1000
+    // FIRST-DAG: receiver {{[0-9]+}} org/geevm/tests/jit/PersistedProfile$Rectangle 1000
+    // FIRST-DAG: method area ()I 1000 0
+
+    // SECOND: geevm-profile 1
+    // SECOND-DAG: method sign (I)I 4000 0
+    // SECOND-DAG: branch 1 3000 1000
+    // SECOND-DAG: receiver {{[0-9]+}} org/geevm/tests/jit/PersistedProfile$Square 1000
+    // SECOND-DAG: receiver {{[0-9]+}} org/geevm/tests/jit/PersistedProfile$Rectangle 1000
+}
@@ -0,0 +1,71 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.oop;
+
+import org.geevm.util.Printer;
+
+public class Devirtualization {
+    static class Account {
+        private int balance;
+
+        Account(int balance) {
+            this.balance = balance;
+        }
+
+        int getBalance() {
+            return balance;
+        }
+
+        final int getBalanceFinal() {
+            return balance;
+        }
+    }
+
+    // Loaded only once the first instance is created, after calls on Account were already devirtualized
+    static class PremiumAccount extends Account {
+        PremiumAccount(int balance) {
+            super(balance);
+        }
+
+        @Override
+        int getBalance() {
+            return super.getBalance() * 2;
+        }
+    }
+
+    static final class Counter {
+        int value;
+
+        int next() {
+            return ++value;
+        }
+    }
+
+    static int sum(Account account, int times) {
+        int result = 0;
+        for (int i = 0; i < times; i++) {
+            result += account.getBalance();
+        }
+        return result;
+    }
+
+    public static void main(String[] args) {
+        Account account = new Account(10);
+        Printer.println(sum(account, 5));
+        // CHECK: 50
+
+        // A newly loaded subclass overrides the method, the call site has to dispatch dynamically again
+        Account premium = new PremiumAccount(10);
+        Printer.println(sum(premium, 5));
+        Printer.println(sum(account, 5));
+        // CHECK-NEXT: 100
+        // CHECK-NEXT: 50
+
+        // Final methods and methods of final classes
+        Printer.println(premium.getBalanceFinal());
+        // CHECK-NEXT: 10
+        Counter counter = new Counter();
+        counter.next();
+        Printer.println(counter.next());
+        // CHECK-NEXT: 2
+    }
+}
@@ -0,0 +1,85 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.oop;
+
+import org.geevm.util.Printer;
+
+public class PolymorphicCallSites {
+    interface Shape {
+        long scaledArea(long factor, int offset);
+    }
+
+    static abstract class Base implements Shape {
+        abstract int id();
+    }
+
+    static class A extends Base {
+        int id() { return 1; }
+        public long scaledArea(long factor, int offset) { return factor + offset; }
+    }
+
+    static class B extends Base {
+        int id() { return 2; }
+        public long scaledArea(long factor, int offset) { return 2 * factor + offset; }
+    }
+
+    static class C extends Base {
+        int id() { return 3; }
+        public long scaledArea(long factor, int offset) { return 3 * factor + offset; }
+    }
+
+    static class D extends Base {
+        int id() { return 4; }
+        public long scaledArea(long factor, int offset) { return 4 * factor + offset; }
+    }
+
+    static class E extends Base {
+        int id() { return 5; }
+        public long scaledArea(long factor, int offset) { return 5 * factor + offset; }
+    }
+
+    static class F extends E {
+        // Inherits scaledArea from E
+        int id() { return 6; }
+    }
+
+    public static void main(String[] args) {
+        Base[] receivers = new Base[] { new A(), new B(), new C(), new D(), new E(), new F() };
+
+        // Monomorphic site
+        int sum = 0;
+        for (int i = 0; i < 10; i++) {
+            sum += receivers[0].id();
+        }
+        Printer.println(sum);
+        // CHECK: 10
+
+        // Megamorphic virtual call site, more receiver classes than cache entries
+        sum = 0;
+        for (int round = 0; round < 3; round++) {
+            for (Base receiver : receivers) {
+                sum += receiver.id();
+            }
+        }
+        Printer.println(sum);
+        // CHECK-NEXT: 63
+
+        // Interface call site with category two arguments
+        long total = 0;
+        for (int round = 0; round < 2; round++) {
+            for (Shape shape : receivers) {
+                total += shape.scaledArea(10L, 1);
+            }
+        }
+        Printer.println(total);
+        // CHECK-NEXT: 412
+
+        // Calls on null receivers throw at cached call sites too
+        Shape nothing = null;
+        try {
+            nothing.scaledArea(1L, 1);
+        } catch (NullPointerException ex) {
+            Printer.println("NPE");
+            // CHECK-NEXT: NPE
+        }
+    }
+}
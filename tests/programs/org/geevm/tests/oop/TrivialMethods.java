@@ -0,0 +1,113 @@
+// RUN: %compile -d %t "%s" | FileCheck "%s"
+package org.geevm.tests.oop;
+
+import org.geevm.util.Printer;
+
+public class TrivialMethods {
+    static class Base {
+    }
+
+    static class Point extends Base {
+        private int x;
+        private long y;
+        private double weight;
+        private boolean visible;
+        private String name;
+
+        int getX() { return x; }
+        void setX(int x) { this.x = x; }
+        long getY() { return y; }
+        void setY(long y) { this.y = y; }
+        double getWeight() { return weight; }
+        void setWeight(double weight) { this.weight = weight; }
+        boolean isVisible() { return visible; }
+        void setVisible(boolean visible) { this.visible = visible; }
+        String getName() { return name; }
+        void setName(String name) { this.name = name; }
+
+        int dimensions() { return 2; }
+        long big() { return 1L; }
+        float ratio() { return 2.0f; }
+        double half() { return 0.0; }
+        Object nothing() { return null; }
+        static int answer() { return 42; }
+        static int negative() { return -1000; }
+
+        // Same bytecode as a getter and setter, but with other parameters, so these are not trivial
+        int getXIgnoring(int unused) { return x; }
+        void setXIgnoring(int x, long unused) { this.x = x; }
+    }
+
+    static class Counted extends Base {
+        static int constructed;
+
+        Counted() {
+            constructed++;
+        }
+    }
+
+    public static void main(String[] args) {
+        Point p = new Point();
+        p.setX(3);
+        p.setY(1L << 40);
+        p.setWeight(1.5);
+        p.setVisible(true);
+        p.setName("origin");
+        Printer.println(p.getX());
+        Printer.println(p.getY());
+        Printer.println(p.getWeight());
+        Printer.println(p.isVisible());
+        Printer.println(p.getName());
+        // CHECK: 3
+        // CHECK-NEXT: 1099511627776
+        // CHECK-NEXT: 1.5
+        // CHECK-NEXT: true
+        // CHECK-NEXT: origin
+
+        Printer.println(p.dimensions());
+        Printer.println(p.big() + p.big());
+        Printer.println(p.ratio());
+        Printer.println(p.half());
+        Printer.println(p.nothing() == null);
+        Printer.println(Point.answer());
+        Printer.println(Point.negative());
+        // CHECK-NEXT: 2
+        // CHECK-NEXT: 2
+        // CHECK-NEXT: 2
+        // CHECK-NEXT: 0
+        // CHECK-NEXT: true
+        // CHECK-NEXT: 42
+        // CHECK-NEXT: -1000
+
+        p.setXIgnoring(5, 1L << 40);
+        Printer.println(p.getXIgnoring(7) + p.getX());
+        // CHECK-NEXT: 10
+
+        // Constructors with side effects are still executed
+        new Counted();
+        new Counted();
+        Printer.println(Counted.constructed);
+        // CHECK-NEXT: 2
+
+        // Calls on a null receiver still throw
+        Point nothing = null;
+        try {
+            nothing.getX();
+        } catch (NullPointerException ex) {
+            Printer.println("getter");
+            // CHECK-NEXT: getter
+        }
+        try {
+            nothing.setY(1L);
+        } catch (NullPointerException ex) {
+            Printer.println("setter");
+            // CHECK-NEXT: setter
+        }
+        try {
+            nothing.dimensions();
+        } catch (NullPointerException ex) {
+            Printer.println("constant");
+            // CHECK-NEXT: constant
+        }
+    }
+}